@@ -0,0 +1,248 @@
+/**
+ * @file epoch_bench.c
+ * @brief 세대 기반 회수(epoch.h) 스트레스 벤치마크: 접속/종료가 계속되는 동안 방 브로드캐스트 처리량
+ *
+ * 방마다 가짜 클라이언트를 채운 뒤, 브로드캐스트 스레드는 쉬지 않고 방 하나를 골라 모든 멤버에게
+ * 전달(멤버 정보 읽기)하고, 접속/종료 스레드는 클라이언트를 계속 퇴장시키고 새로 입장시킵니다.
+ *   - epoch : 브로드캐스트는 읽기 구역 안에서 잠금 없이 멤버 목록을 읽고, 퇴장한 클라이언트는 epoch_retire()
+ *   - rwlock: 이전 방식. 브로드캐스트는 방 읽기 잠금, 입장/퇴장은 쓰기 잠금, 퇴장한 클라이언트는 바로 해제
+ * 해제하는 클라이언트는 표시를 바꿔 두므로, 브로드캐스트가 해제된 클라이언트를 만나면 오류로 셉니다.
+ *
+ * 사용법: ./epoch_bench [브로드캐스트 스레드 수] [접속/종료 스레드 수] [초] [방 수] [방당 클라이언트 수]
+ */
+
+#include <time.h>
+#include "room.h"
+
+#define BENCH_DEFAULT_BROADCASTERS 4
+#define BENCH_DEFAULT_CHURNERS 4
+#define BENCH_DEFAULT_SECONDS 3
+#define BENCH_DEFAULT_ROOMS 8
+#define BENCH_DEFAULT_MEMBERS 256
+#define BENCH_CLIENT_LIVE 0x4c495645u
+#define BENCH_CLIENT_DEAD 0xdeadbeefu
+
+typedef struct {
+    volatile uint32_t magic;   // 해제할 때 BENCH_CLIENT_DEAD 로 바꿈
+    uint32_t id;
+    uint32_t room_index;       // room_join() 위치 저장소
+    int room;                  // 입장한 방
+} BenchClient;
+
+typedef struct {
+    int use_epoch;
+    int rooms;
+    Room **room_list;
+    pthread_rwlock_t *room_locks;   // rwlock 방식에서만 사용
+    EpochDomain domain;
+    atomic_bool stop;
+    atomic_long broadcasts;
+    atomic_long deliveries;
+    atomic_long churn_ops;
+    atomic_long use_after_free;
+    atomic_long max_pending;
+} Bench;
+
+typedef struct {
+    Bench *bench;
+    unsigned seed;
+    BenchClient **clients;   // 접속/종료 스레드가 소유한 클라이언트
+    int count;
+} Worker;
+
+static volatile uint64_t bench_sink;   // 멤버 읽기가 최적화로 사라지지 않도록
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_client_free(void *ptr) {
+    ((BenchClient *)ptr)->magic = BENCH_CLIENT_DEAD;
+    free(ptr);
+}
+
+static BenchClient *bench_join(Bench *bench, unsigned *seed) {
+    static atomic_uint next_id;
+    BenchClient *client = (BenchClient *)malloc(sizeof(BenchClient));
+
+    client->magic = BENCH_CLIENT_LIVE;
+    client->id = atomic_fetch_add(&next_id, 1);
+    client->room = (int)(rand_r(seed) % (unsigned)bench->rooms);
+    if (!bench->use_epoch) {
+        pthread_rwlock_wrlock(&bench->room_locks[client->room]);
+    }
+    room_join(bench->room_list[client->room], client, &client->room_index);
+    if (!bench->use_epoch) {
+        pthread_rwlock_unlock(&bench->room_locks[client->room]);
+    }
+    return client;
+}
+
+static void bench_leave(Bench *bench, BenchClient *client) {
+    if (bench->use_epoch) {
+        room_leave(bench->room_list[client->room], &client->room_index);
+        epoch_retire(&bench->domain, client, bench_client_free);
+        return;
+    }
+    pthread_rwlock_wrlock(&bench->room_locks[client->room]);
+    room_leave(bench->room_list[client->room], &client->room_index);
+    pthread_rwlock_unlock(&bench->room_locks[client->room]);
+    bench_client_free(client);
+}
+
+static void *broadcaster(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Bench *bench = worker->bench;
+    long broadcasts = 0, deliveries = 0, bad = 0;
+    uint64_t checksum = 0;
+
+    while (!atomic_load_explicit(&bench->stop, memory_order_relaxed)) {
+        int r = (int)(rand_r(&worker->seed) % (unsigned)bench->rooms);
+        if (bench->use_epoch) {
+            epoch_enter(&bench->domain);
+        } else {
+            pthread_rwlock_rdlock(&bench->room_locks[r]);
+        }
+        RoomMembers *members = room_members(bench->room_list[r]);
+        uint32_t count = room_members_count(members);
+        for (uint32_t i = 0; i < count; i++) {
+            BenchClient *client = (BenchClient *)room_member_at(members, i);
+            if (client == NULL) {
+                continue;  // 퇴장으로 비운 칸
+            }
+            deliveries++;
+            if (client->magic != BENCH_CLIENT_LIVE) {
+                bad++;
+                continue;
+            }
+            checksum += client->id;
+        }
+        if (bench->use_epoch) {
+            epoch_exit(&bench->domain);
+        } else {
+            pthread_rwlock_unlock(&bench->room_locks[r]);
+        }
+        broadcasts++;
+    }
+    atomic_fetch_add(&bench->broadcasts, broadcasts);
+    atomic_fetch_add(&bench->deliveries, deliveries);
+    bench_sink += checksum;
+    atomic_fetch_add(&bench->use_after_free, bad);
+    return NULL;
+}
+
+static void *churner(void *arg) {
+    Worker *worker = (Worker *)arg;
+    Bench *bench = worker->bench;
+    long ops = 0;
+
+    while (!atomic_load_explicit(&bench->stop, memory_order_relaxed)) {
+        int victim = (int)(rand_r(&worker->seed) % (unsigned)worker->count);
+        bench_leave(bench, worker->clients[victim]);
+        worker->clients[victim] = bench_join(bench, &worker->seed);
+        ops++;
+
+        long pending = epoch_pending(&bench->domain);
+        long max = atomic_load_explicit(&bench->max_pending, memory_order_relaxed);
+        while (pending > max && !atomic_compare_exchange_weak(&bench->max_pending, &max, pending)) {
+        }
+    }
+    atomic_fetch_add(&bench->churn_ops, ops);
+    return NULL;
+}
+
+static void run(int use_epoch, int broadcasters, int churners, int seconds, int rooms, int members) {
+    Bench bench;
+    RoomRegistry registry;
+
+    memset(&bench, 0, sizeof(bench));
+    bench.use_epoch = use_epoch;
+    bench.rooms = rooms;
+    epoch_domain_init(&bench.domain);
+    epoch_start_reclaimer(&bench.domain);
+    room_registry_init(&registry, &bench.domain);
+    bench.room_list = (Room **)calloc(rooms, sizeof(Room *));
+    bench.room_locks = (pthread_rwlock_t *)calloc(rooms, sizeof(pthread_rwlock_t));
+    for (int r = 0; r < rooms; r++) {
+        char name[16];
+        bench.room_list[r] = room_registry_get(&registry, name, (size_t)snprintf(name, sizeof(name), "%d", r + 1));
+        pthread_rwlock_init(&bench.room_locks[r], NULL);
+    }
+
+    // 클라이언트는 접속/종료 스레드들이 나눠 소유
+    int total = rooms * members;
+    Worker *workers = (Worker *)calloc(broadcasters + churners, sizeof(Worker));
+    pthread_t *threads = (pthread_t *)calloc(broadcasters + churners, sizeof(pthread_t));
+    for (int i = 0; i < broadcasters + churners; i++) {
+        workers[i].bench = &bench;
+        workers[i].seed = 12345u + (unsigned)i * 7919u;
+    }
+    for (int i = 0; i < churners; i++) {
+        Worker *worker = &workers[broadcasters + i];
+        worker->count = total / churners + (i < total % churners);
+        worker->clients = (BenchClient **)calloc(worker->count, sizeof(BenchClient *));
+        for (int j = 0; j < worker->count; j++) {
+            worker->clients[j] = bench_join(&bench, &worker->seed);
+        }
+    }
+
+    for (int i = 0; i < broadcasters; i++) {
+        pthread_create(&threads[i], NULL, broadcaster, &workers[i]);
+    }
+    for (int i = 0; i < churners; i++) {
+        pthread_create(&threads[broadcasters + i], NULL, churner, &workers[broadcasters + i]);
+    }
+    double begin = now_sec();
+    struct timespec duration = { seconds, 0 };
+    nanosleep(&duration, NULL);
+    atomic_store(&bench.stop, true);
+    for (int i = 0; i < broadcasters + churners; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_sec() - begin;
+
+    for (int i = 0; i < churners; i++) {
+        Worker *worker = &workers[broadcasters + i];
+        for (int j = 0; j < worker->count; j++) {
+            bench_leave(&bench, worker->clients[j]);
+        }
+        free(worker->clients);
+    }
+    long reclaimed_before = atomic_load(&bench.domain.reclaimed_count);
+    epoch_domain_destroy(&bench.domain);
+
+    printf("%-8s %12.0f %14.1f %12.0f %10ld %10ld %8ld\n", use_epoch ? "epoch" : "rwlock",
+           atomic_load(&bench.broadcasts) / elapsed, atomic_load(&bench.deliveries) / elapsed / 1e6,
+           atomic_load(&bench.churn_ops) / elapsed, use_epoch ? atomic_load(&bench.max_pending) : 0L,
+           use_epoch ? reclaimed_before : 0L, atomic_load(&bench.use_after_free));
+
+    free(workers);
+    free(threads);
+    free(bench.room_list);
+    free(bench.room_locks);
+}
+
+int main(int argc, char *argv[]) {
+    int broadcasters = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_BROADCASTERS;
+    int churners = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_CHURNERS;
+    int seconds = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_SECONDS;
+    int rooms = argc > 4 ? atoi(argv[4]) : BENCH_DEFAULT_ROOMS;
+    int members = argc > 5 ? atoi(argv[5]) : BENCH_DEFAULT_MEMBERS;
+
+    if (broadcasters <= 0 || churners <= 0 || seconds <= 0 || rooms <= 0 || members <= 0 ||
+        rooms * members < churners) {
+        fprintf(stderr, "사용법: %s [브로드캐스트 스레드 수] [접속/종료 스레드 수] [초] [방 수] [방당 클라이언트 수]\n",
+                argv[0]);
+        return 1;
+    }
+
+    printf("브로드캐스트 %d스레드, 접속/종료 %d스레드, 방 %d개 x %d명, %d초\n", broadcasters, churners, rooms, members,
+           seconds);
+    printf("%-8s %12s %14s %12s %10s %10s %8s\n", "방식", "방송/초", "전달(백만/초)", "접속종료/초", "최대대기",
+           "회수", "해제후접근");
+    run(0, broadcasters, churners, seconds, rooms, members);
+    run(1, broadcasters, churners, seconds, rooms, members);
+    return 0;
+}
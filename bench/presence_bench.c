@@ -0,0 +1,80 @@
+/**
+ * @file presence_bench.c
+ * @brief 접속 현황 테이블(presence.h) 벤치마크: 조회, 등록/해제 지연
+ *
+ * 별도 이름의 공유 메모리에 사용자 N명을 등록한 뒤 측정합니다.
+ *   - 조회(접속 중): 등록한 사용자명을 presence_lookup()
+ *   - 조회(없음): 등록하지 않은 사용자명을 presence_lookup()
+ *   - 등록/해제: 등록하지 않은 사용자명을 presence_claim() 후 presence_release()
+ * 끝나면 공유 메모리를 지웁니다.
+ *
+ * 사용법: ./presence_bench [등록할 사용자 수] [반복 수]
+ */
+
+#include <time.h>
+#include "presence.h"
+
+#define BENCH_SHM_NAME "/chat_presence_bench"
+#define BENCH_DEFAULT_USERS 4096
+#define BENCH_DEFAULT_ITERS 2000000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long users = argc > 1 ? atol(argv[1]) : BENCH_DEFAULT_USERS;
+    long iters = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_ITERS;
+    PresenceTable table;
+    char name[32];
+
+    if (users <= 0 || users > PRESENCE_SLOTS / 2 || iters <= 0) {
+        fprintf(stderr, "사용법: %s [등록할 사용자 수 (최대 %d)] [반복 수]\n", argv[0], PRESENCE_SLOTS / 2);
+        return 1;
+    }
+    shm_unlink(BENCH_SHM_NAME);
+    if (presence_open(&table, BENCH_SHM_NAME) < 0) {
+        perror("presence_open");
+        return 1;
+    }
+    for (long i = 0; i < users; i++) {
+        int len = snprintf(name, sizeof(name), "user%ld", i);
+        presence_claim(&table, name, (size_t)len);
+    }
+
+    long hits = 0;
+    double begin = now_sec();
+    for (long i = 0; i < iters; i++) {
+        int len = snprintf(name, sizeof(name), "user%ld", i % users);
+        hits += presence_lookup(&table, name, (size_t)len) != 0;
+    }
+    double hit_sec = now_sec() - begin;
+
+    long misses = 0;
+    begin = now_sec();
+    for (long i = 0; i < iters; i++) {
+        int len = snprintf(name, sizeof(name), "guest%ld", i % users);
+        misses += presence_lookup(&table, name, (size_t)len) == 0;
+    }
+    double miss_sec = now_sec() - begin;
+
+    long claims = iters / 10;
+    begin = now_sec();
+    for (long i = 0; i < claims; i++) {
+        int len = snprintf(name, sizeof(name), "guest%ld", i % users);
+        presence_release(&table, presence_claim(&table, name, (size_t)len));
+    }
+    double claim_sec = now_sec() - begin;
+
+    printf("등록된 사용자 %ld명, 칸 %d개\n", users, PRESENCE_SLOTS);
+    printf("%-16s %10s %12s\n", "작업", "반복", "작업당(ns)");
+    printf("%-16s %10ld %12.1f  (접속 중 %ld)\n", "조회(접속 중)", iters, hit_sec * 1e9 / iters, hits);
+    printf("%-16s %10ld %12.1f  (없음 %ld)\n", "조회(없음)", iters, miss_sec * 1e9 / iters, misses);
+    printf("%-16s %10ld %12.1f\n", "등록+해제", claims, claim_sec * 1e9 / claims);
+
+    presence_close(&table);
+    shm_unlink(BENCH_SHM_NAME);
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file queue_bench.c
+ * @brief 고정 용량 큐(queue.h) 벤치마크: 생산자 수에 따른 처리량과 넣기→꺼내기 지연
+ *
+ * 생산자 스레드들이 원소를 정해진 수만큼 넣고 소비자 스레드 하나가 꺼냅니다. 큐가 가득 차거나 비면
+ * sched_yield() 로 양보합니다. 원소 64개마다 넣은 시각을 기록해 꺼낼 때까지의 지연을 재고, 생산자별
+ * 순서가 지켜졌는지도 확인합니다.
+ *   - spsc      : SpscRing, 한 번에 하나씩 (생산자 1명일 때만)
+ *   - spsc-batch: SpscRing, 소비자가 묶음으로 꺼냄
+ *   - mpsc      : MpscQueue, 한 번에 하나씩
+ *   - mpsc-batch: MpscQueue, 소비자가 mpsc_dequeue_batch() 로 꺼냄
+ *   - mutex     : 뮤텍스로 보호하는 링 (비교 기준)
+ *
+ * 사용법: ./queue_bench [최대 생산자 수] [생산자당 원소 수] [큐 용량] [묶음 크기]
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "queue.h"
+
+#define BENCH_DEFAULT_PRODUCERS 8
+#define BENCH_DEFAULT_ITEMS 1000000
+#define BENCH_DEFAULT_CAPACITY 4096
+#define BENCH_DEFAULT_BATCH 32
+#define BENCH_SAMPLE_MASK 63   // 원소 64개마다 지연 측정
+
+typedef enum { KIND_SPSC, KIND_SPSC_BATCH, KIND_MPSC, KIND_MPSC_BATCH, KIND_MUTEX, KIND_COUNT } Kind;
+
+static const char *kind_names[KIND_COUNT] = { "spsc", "spsc-batch", "mpsc", "mpsc-batch", "mutex" };
+
+typedef struct {
+    uint64_t enqueued_ns;   // 측정하지 않는 원소는 0
+    uint32_t producer;
+    uint32_t seq;
+} Item;
+
+typedef struct {
+    pthread_mutex_t lock;
+    Item *items;
+    size_t mask;
+    size_t head;
+    size_t tail;
+} MutexRing;
+
+typedef struct {
+    Kind kind;
+    int producers;
+    long items;
+    size_t batch;
+    SpscRing spsc;
+    MpscQueue mpsc;
+    MutexRing mutex;
+    uint64_t *samples;
+    long sample_count;
+    long order_errors;
+} Bench;
+
+typedef struct {
+    Bench *bench;
+    uint32_t id;
+} Producer;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int mutex_enqueue(MutexRing *ring, const Item *item) {
+    int ret = -1;
+
+    pthread_mutex_lock(&ring->lock);
+    if (ring->tail - ring->head <= ring->mask) {
+        ring->items[ring->tail++ & ring->mask] = *item;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return ret;
+}
+
+static size_t mutex_dequeue_batch(MutexRing *ring, Item *out, size_t max) {
+    size_t count = 0;
+
+    pthread_mutex_lock(&ring->lock);
+    while (count < max && ring->head != ring->tail) {
+        out[count++] = ring->items[ring->head++ & ring->mask];
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return count;
+}
+
+static void *producer_thread(void *arg) {
+    Producer *producer = (Producer *)arg;
+    Bench *bench = producer->bench;
+
+    for (long i = 0; i < bench->items; i++) {
+        Item item = { .enqueued_ns = (i & BENCH_SAMPLE_MASK) == 0 ? now_ns() : 0, .producer = producer->id,
+                      .seq = (uint32_t)i };
+        int ret;
+        do {
+            if (bench->kind == KIND_SPSC || bench->kind == KIND_SPSC_BATCH) {
+                ret = spsc_enqueue(&bench->spsc, &item);
+            } else if (bench->kind == KIND_MUTEX) {
+                ret = mutex_enqueue(&bench->mutex, &item);
+            } else {
+                ret = mpsc_enqueue(&bench->mpsc, &item);
+            }
+            if (ret < 0) {
+                sched_yield();  // 가득 참
+            }
+        } while (ret < 0);
+    }
+    return NULL;
+}
+
+static void consume(Bench *bench) {
+    long total = bench->items * bench->producers;
+    size_t max = bench->kind == KIND_SPSC || bench->kind == KIND_MPSC ? 1 : bench->batch;
+    Item *batch = (Item *)malloc(max * sizeof(Item));
+    uint32_t *next_seq = (uint32_t *)calloc(bench->producers, sizeof(uint32_t));
+
+    for (long received = 0; received < total;) {
+        size_t count;
+        if (bench->kind == KIND_SPSC || bench->kind == KIND_SPSC_BATCH) {
+            count = spsc_dequeue_batch(&bench->spsc, batch, max);
+        } else if (bench->kind == KIND_MUTEX) {
+            count = mutex_dequeue_batch(&bench->mutex, batch, max);
+        } else if (bench->kind == KIND_MPSC) {
+            count = mpsc_dequeue(&bench->mpsc, batch) == 0;
+        } else {
+            count = mpsc_dequeue_batch(&bench->mpsc, batch, max);
+        }
+        if (count == 0) {
+            sched_yield();  // 비었음
+            continue;
+        }
+
+        uint64_t now = 0;
+        for (size_t i = 0; i < count; i++) {
+            Item *item = &batch[i];
+            if (item->seq != next_seq[item->producer]) {
+                bench->order_errors++;
+            }
+            next_seq[item->producer] = item->seq + 1;
+            if (item->enqueued_ns != 0) {
+                if (now == 0) {
+                    now = now_ns();
+                }
+                bench->samples[bench->sample_count++] = now - item->enqueued_ns;
+            }
+        }
+        received += (long)count;
+    }
+    free(batch);
+    free(next_seq);
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void run(Kind kind, int producers, long items, size_t capacity, size_t batch) {
+    Bench bench = { .kind = kind, .producers = producers, .items = items, .batch = batch };
+    pthread_t *threads = (pthread_t *)calloc(producers, sizeof(pthread_t));
+    Producer *args = (Producer *)calloc(producers, sizeof(Producer));
+
+    bench.samples = (uint64_t *)malloc(((size_t)items / (BENCH_SAMPLE_MASK + 1) + 1) * producers * sizeof(uint64_t));
+    spsc_init(&bench.spsc, capacity, sizeof(Item));
+    mpsc_init(&bench.mpsc, capacity, sizeof(Item));
+    pthread_mutex_init(&bench.mutex.lock, NULL);
+    bench.mutex.mask = queue_round_capacity(capacity) - 1;
+    bench.mutex.items = (Item *)malloc((bench.mutex.mask + 1) * sizeof(Item));
+
+    uint64_t begin = now_ns();
+    for (int i = 0; i < producers; i++) {
+        args[i] = (Producer){ .bench = &bench, .id = (uint32_t)i };
+        pthread_create(&threads[i], NULL, producer_thread, &args[i]);
+    }
+    consume(&bench);
+    double elapsed = (now_ns() - begin) / 1e9;
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    qsort(bench.samples, bench.sample_count, sizeof(uint64_t), compare_u64);
+    uint64_t sum = 0;
+    for (long i = 0; i < bench.sample_count; i++) {
+        sum += bench.samples[i];
+    }
+    long n = bench.sample_count;
+    printf("%-11s %6d %14.0f %10.0f %10lu %10lu %12lu %8ld\n", kind_names[kind], producers,
+           items * producers / elapsed, n > 0 ? (double)sum / n : 0.0,
+           n > 0 ? (unsigned long)bench.samples[n / 2] : 0UL, n > 0 ? (unsigned long)bench.samples[n * 99 / 100] : 0UL,
+           n > 0 ? (unsigned long)bench.samples[n - 1] : 0UL, bench.order_errors);
+
+    spsc_destroy(&bench.spsc);
+    mpsc_destroy(&bench.mpsc);
+    pthread_mutex_destroy(&bench.mutex.lock);
+    free(bench.mutex.items);
+    free(bench.samples);
+    free(threads);
+    free(args);
+}
+
+int main(int argc, char *argv[]) {
+    int max_producers = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_PRODUCERS;
+    long items = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_ITEMS;
+    long capacity = argc > 3 ? atol(argv[3]) : BENCH_DEFAULT_CAPACITY;
+    long batch = argc > 4 ? atol(argv[4]) : BENCH_DEFAULT_BATCH;
+
+    if (max_producers <= 0 || items <= 0 || items > UINT32_MAX || capacity <= 0 || batch <= 0) {
+        fprintf(stderr, "사용법: %s [최대 생산자 수] [생산자당 원소 수] [큐 용량] [묶음 크기]\n", argv[0]);
+        return 1;
+    }
+
+    printf("생산자당 원소 %ld개, 용량 %zu, 묶음 %ld, CPU %ld개 (지연: 넣은 뒤 꺼낼 때까지, ns)\n", items,
+           queue_round_capacity((size_t)capacity), batch, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-11s %6s %14s %10s %10s %10s %12s %8s\n", "큐", "생산자", "원소/초", "평균", "p50", "p99", "최대",
+           "순서오류");
+    run(KIND_SPSC, 1, items, (size_t)capacity, (size_t)batch);
+    run(KIND_SPSC_BATCH, 1, items, (size_t)capacity, (size_t)batch);
+    for (int producers = 1; producers <= max_producers; producers *= 2) {
+        run(KIND_MPSC, producers, items, (size_t)capacity, (size_t)batch);
+        run(KIND_MPSC_BATCH, producers, items, (size_t)capacity, (size_t)batch);
+        run(KIND_MUTEX, producers, items, (size_t)capacity, (size_t)batch);
+    }
+    return 0;
+}
@@ -0,0 +1,258 @@
+/**
+ * @file room_load_bench.c
+ * @brief 실행 중인 서버에 방마다 클라이언트를 붙여 초당 메시지/전달 수를 재는 부하 발생기
+ *
+ * 방마다 클라이언트 M명이 로그인(처음이면 가입)해 입장한 뒤, 멤버 0 을 뺀 나머지가 돌아가며 채팅을 보내고
+ * 모든 클라이언트가 받은 메시지를 셉니다. 방마다 멤버 0(관측자)이 아직 받지 못한 메시지가 창 크기만큼
+ * 쌓이면 더 보내지 않으므로, 서버가 처리할 수 있는 만큼만 보내고 느린 클라이언트 정책으로 버려지지 않습니다.
+ *
+ * 서버의 워커(이벤트 루프) 수를 바꿔 가며 실행하면 코어 수에 따른 확장성을 비교할 수 있습니다.
+ *   ./chat_server -m room -n 4 && ./bench/room_load_bench
+ *
+ * 사용법: ./room_load_bench [포트] [방 수] [방당 클라이언트 수] [초] [부하 스레드 수] [창 크기]
+ */
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include "protocol.h"
+
+#define BENCH_DEFAULT_PORT 5100
+#define BENCH_DEFAULT_ROOMS 64
+#define BENCH_DEFAULT_MEMBERS 8
+#define BENCH_DEFAULT_SECONDS 5
+#define BENCH_DEFAULT_THREADS 2
+#define BENCH_DEFAULT_WINDOW 32
+#define BENCH_PASSWORD "load"
+#define BENCH_MESSAGE "room load benchmark message"
+#define BENCH_EPOLL_EVENTS 64
+
+typedef struct {
+    int fd;
+    int room;            // rooms 배열 위치
+    FrameReader rx;
+} BenchClient;
+
+typedef struct {
+    int id;              // 채팅방 ID (1부터)
+    BenchClient *members;
+    long sent;           // 보낸 메시지 수
+    long observed;       // 관측자(멤버 0)가 받은 메시지 수
+    int next_sender;
+} BenchRoom;
+
+typedef struct {
+    int index;
+    int threads;
+    int window;
+    int members;
+    int num_rooms;
+    BenchRoom *rooms;
+    double deadline;
+    long sent;
+    long delivered;
+} Loader;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * 프레임 하나를 받을 때까지 읽음 (로그인 단계, 블로킹 소켓)
+ */
+static int read_frame(BenchClient *client, uint8_t *type, const char **payload, uint32_t *len) {
+    int ret;
+
+    while ((ret = frame_reader_next(&client->rx, type, payload, len)) == 0) {
+        size_t avail;
+        char *space = frame_reader_space(&client->rx, 4096, &avail);
+        if (space == NULL) {
+            return -1;
+        }
+        ssize_t n = recv(client->fd, space, avail, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        frame_reader_commit(&client->rx, (size_t)n);
+    }
+    return ret;
+}
+
+/**
+ * 접속해 가입/로그인 후 방에 입장 (가입은 이미 있는 사용자면 실패해도 무시)
+ */
+static int bench_connect(BenchClient *client, int port, int room_id, int member) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    char fields[64];
+    uint8_t type;
+    const char *payload;
+    uint32_t len;
+
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    frame_reader_init(&client->rx);
+    client->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client->fd < 0 || connect(client->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect()");
+        return -1;
+    }
+
+    int name_len = snprintf(fields, sizeof(fields), "load_%d_%d", room_id, member);
+    memcpy(fields + name_len + 1, BENCH_PASSWORD, sizeof(BENCH_PASSWORD));
+    uint32_t fields_len = (uint32_t)(name_len + 1 + sizeof(BENCH_PASSWORD) - 1);
+    char request[1 + sizeof(fields)];
+    for (int i = 0; i < 2; i++) {
+        request[0] = i == 0 ? AUTH_REGISTER : AUTH_LOGIN;
+        memcpy(request + 1, fields, fields_len);
+        if (frame_send(client->fd, FRAME_AUTH, request, 1 + fields_len) < 0 ||
+            read_frame(client, &type, &payload, &len) <= 0 || type != FRAME_AUTH_RESULT || len < 1) {
+            fprintf(stderr, "%s 인증 응답 없음\n", fields);
+            return -1;
+        }
+        if (i == 1 && payload[0] != AUTH_OK) {
+            fprintf(stderr, "%s 로그인 실패: %.*s\n", fields, (int)len - 1, payload + 1);
+            return -1;
+        }
+    }
+
+    uint32_t room_be = htonl((uint32_t)room_id);
+    return frame_send(client->fd, FRAME_HELLO, &room_be, sizeof(room_be));
+}
+
+/**
+ * 읽을 수 있는 만큼 읽어 받은 채팅 메시지 수를 돌려줌
+ */
+static long bench_drain(BenchClient *client) {
+    long frames = 0;
+    uint8_t type;
+    const char *payload;
+    uint32_t len;
+
+    while (1) {
+        size_t avail;
+        char *space = frame_reader_space(&client->rx, 4096, &avail);
+        ssize_t n = recv(client->fd, space, avail, MSG_DONTWAIT);
+        if (n <= 0) {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                fprintf(stderr, "서버가 연결을 끊었습니다.\n");
+                exit(1);
+            }
+            break;
+        }
+        frame_reader_commit(&client->rx, (size_t)n);
+        while (frame_reader_next(&client->rx, &type, &payload, &len) > 0) {
+            frames += type == FRAME_MESSAGE;
+        }
+    }
+    return frames;
+}
+
+static void *loader_thread(void *arg) {
+    Loader *loader = (Loader *)arg;
+    struct epoll_event events[BENCH_EPOLL_EVENTS];
+    int epoll_fd = epoll_create1(0);
+
+    // 방은 r % threads 로 나눠 맡음
+    for (int r = loader->index; r < loader->num_rooms; r += loader->threads) {
+        for (int m = 0; m < loader->members; m++) {
+            BenchClient *client = &loader->rooms[r].members[m];
+            struct epoll_event ev = { .events = EPOLLIN, .data.ptr = client };
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client->fd, &ev);
+        }
+    }
+
+    while (now_sec() < loader->deadline) {
+        for (int r = loader->index; r < loader->num_rooms; r += loader->threads) {
+            BenchRoom *room = &loader->rooms[r];
+            while (room->sent - room->observed < loader->window) {
+                BenchClient *sender = &room->members[1 + room->next_sender];
+                room->next_sender = (room->next_sender + 1) % (loader->members - 1);
+                // 서버는 느린 수신자 때문에 읽기를 멈추지 않으므로 작은 프레임은 블로킹으로 보내도 됨
+                if (frame_send(sender->fd, FRAME_CHAT, BENCH_MESSAGE, sizeof(BENCH_MESSAGE) - 1) < 0) {
+                    perror("send()");
+                    exit(1);
+                }
+                room->sent++;
+                loader->sent++;
+            }
+        }
+
+        int n = epoll_wait(epoll_fd, events, BENCH_EPOLL_EVENTS, 1);
+        for (int i = 0; i < n; i++) {
+            BenchClient *client = (BenchClient *)events[i].data.ptr;
+            long frames = bench_drain(client);
+            BenchRoom *room = &loader->rooms[client->room];
+            if (client == &room->members[0]) {
+                room->observed += frames;
+            }
+            loader->delivered += frames;
+        }
+    }
+    close(epoll_fd);
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : BENCH_DEFAULT_PORT;
+    int num_rooms = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_ROOMS;
+    int members = argc > 3 ? atoi(argv[3]) : BENCH_DEFAULT_MEMBERS;
+    int seconds = argc > 4 ? atoi(argv[4]) : BENCH_DEFAULT_SECONDS;
+    int threads = argc > 5 ? atoi(argv[5]) : BENCH_DEFAULT_THREADS;
+    int window = argc > 6 ? atoi(argv[6]) : BENCH_DEFAULT_WINDOW;
+
+    if (port <= 0 || num_rooms <= 0 || members < 2 || seconds <= 0 || threads <= 0 || window <= 0) {
+        fprintf(stderr, "사용법: %s [포트] [방 수] [방당 클라이언트 수(2 이상)] [초] [부하 스레드 수] [창 크기]\n",
+                argv[0]);
+        return 1;
+    }
+
+    BenchRoom *rooms = (BenchRoom *)calloc(num_rooms, sizeof(BenchRoom));
+    for (int r = 0; r < num_rooms; r++) {
+        rooms[r].id = r + 1;
+        rooms[r].members = (BenchClient *)calloc(members, sizeof(BenchClient));
+        for (int m = 0; m < members; m++) {
+            rooms[r].members[m].room = r;
+            if (bench_connect(&rooms[r].members[m], port, rooms[r].id, m) < 0) {
+                return 1;
+            }
+        }
+    }
+    sleep(1);  // 입장(워커로 넘겨받기)이 끝나기를 기다림
+
+    Loader *loaders = (Loader *)calloc(threads, sizeof(Loader));
+    pthread_t *tids = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    double begin = now_sec();
+    for (int i = 0; i < threads; i++) {
+        loaders[i] = (Loader){ .index = i, .threads = threads, .window = window, .members = members,
+                               .num_rooms = num_rooms, .rooms = rooms, .deadline = begin + seconds };
+        pthread_create(&tids[i], NULL, loader_thread, &loaders[i]);
+    }
+    long sent = 0, delivered = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        sent += loaders[i].sent;
+        delivered += loaders[i].delivered;
+    }
+    double elapsed = now_sec() - begin;
+
+    printf("방 %d개 x %d명, 부하 스레드 %d개, 창 %d, %.1f초\n", num_rooms, members, threads, window, elapsed);
+    printf("메시지/초: %.0f, 전달/초: %.0f (보낸 메시지 x 수신자 %d명 대비 %.1f%%)\n", sent / elapsed,
+           delivered / elapsed, members - 1, sent > 0 ? 100.0 * delivered / ((double)sent * (members - 1)) : 0.0);
+
+    for (int r = 0; r < num_rooms; r++) {
+        for (int m = 0; m < members; m++) {
+            close(rooms[r].members[m].fd);
+            frame_reader_free(&rooms[r].members[m].rx);
+        }
+        free(rooms[r].members);
+    }
+    free(rooms);
+    free(loaders);
+    free(tids);
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file user_snapshot_bench.c
+ * @brief 유저 데이터베이스 시작 비용 벤치마크: 텍스트 파일 파싱 vs 바이너리 스냅샷(user_snapshot.h) 매핑
+ *
+ * 유저 N명의 텍스트 파일과 같은 내용의 바이너리 스냅샷을 만든 뒤 측정합니다.
+ *   - 텍스트: read_users() 로 파싱하고 유저마다 할당해 해시 테이블에 등록
+ *   - 스냅샷: attach_user_snapshot() 로 매핑만 하고, 이어서 무작위 유저 조회
+ * 스냅샷은 측정 전에 페이지 캐시에서 내려(POSIX_FADV_DONTNEED) 조회가 디스크에서 페이지를 읽도록 합니다.
+ *
+ * 임시 디렉터리에서 실행하며 끝나면 파일을 지웁니다.
+ *
+ * 사용법: ./user_snapshot_bench [유저 수] [조회 수]
+ */
+
+#include <time.h>
+#include <fcntl.h>
+#include "user.h"
+
+#define BENCH_DEFAULT_USERS 1000000
+#define BENCH_DEFAULT_LOOKUPS 100000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief 파일을 페이지 캐시에서 내림
+ */
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+/**
+ * @brief 무작위 유저를 조회하고 비밀번호가 맞은 횟수를 반환
+ */
+static long lookup_random(UserDB *db, long users, long lookups) {
+    char user[32], pass[32];
+    unsigned int seed = 12345;
+    long hits = 0;
+
+    for (long i = 0; i < lookups; i++) {
+        long j = rand_r(&seed) % users;
+        snprintf(user, sizeof(user), "user%ld", j);
+        snprintf(pass, sizeof(pass), "pw%ld", j);
+        hits += query_user(db, user, pass) >= 0;
+    }
+    return hits;
+}
+
+int main(int argc, char *argv[]) {
+    long users = argc > 1 ? atol(argv[1]) : BENCH_DEFAULT_USERS;
+    long lookups = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_LOOKUPS;
+    char dir[] = "/tmp/user_snapshot_bench.XXXXXX";
+    char text_path[64], snap_path[64];
+    UserDB db;
+
+    if (users <= 0 || lookups < 0) {
+        fprintf(stderr, "사용법: %s [유저 수] [조회 수]\n", argv[0]);
+        return 1;
+    }
+    if (mkdtemp(dir) == NULL) {
+        kernel_errExit("Failed to create benchmark directory");
+    }
+    snprintf(text_path, sizeof(text_path), "%s/users.txt", dir);
+    snprintf(snap_path, sizeof(snap_path), "%s/users.snap", dir);
+
+    FILE *file = fopen(text_path, "w");
+    if (file == NULL) {
+        kernel_errExit("Failed to create user file");
+    }
+    for (long j = 0; j < users; j++) {
+        fprintf(file, "localhost user%ld pw%ld user\n", j, j);
+    }
+    fclose(file);
+
+    // 텍스트 파일 파싱
+    file = fopen(text_path, "r");
+    init_user_db(&db);
+    double begin = now_sec();
+    size_t loaded = read_users(&db, file);
+    double text_sec = now_sec() - begin;
+    fclose(file);
+    begin = now_sec();
+    long text_hits = lookup_random(&db, users, lookups);
+    double text_lookup_sec = now_sec() - begin;
+
+    if (write_user_snapshot(&db, snap_path) < 0) {
+        kernel_errExit("Failed to write snapshot");
+    }
+    free_user_db(&db);
+
+    // 바이너리 스냅샷 매핑 (페이지 캐시에 없는 상태에서)
+    drop_cache(snap_path);
+    init_user_db(&db);
+    begin = now_sec();
+    if (attach_user_snapshot(&db, snap_path) < 0) {
+        kernel_errExit("Failed to open snapshot");
+    }
+    double snap_sec = now_sec() - begin;
+    begin = now_sec();
+    long snap_hits = lookup_random(&db, users, lookups);
+    double snap_lookup_sec = now_sec() - begin;
+    size_t mapped = db.user_count;
+    free_user_db(&db);
+
+    printf("%-8s %10s %12s %14s %12s\n", "방식", "유저 수", "시작(s)", "첫 조회(us)", "조회 성공");
+    printf("%-8s %10zu %12.6f %14.2f %7ld/%ld\n", "text", loaded, text_sec,
+           lookups ? text_lookup_sec * 1e6 / lookups : 0.0, text_hits, lookups);
+    printf("%-8s %10zu %12.6f %14.2f %7ld/%ld\n", "snapshot", mapped, snap_sec,
+           lookups ? snap_lookup_sec * 1e6 / lookups : 0.0, snap_hits, lookups);
+
+    unlink(text_path);
+    unlink(snap_path);
+    rmdir(dir);
+    return 0;
+}
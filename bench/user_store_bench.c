@@ -0,0 +1,196 @@
+/**
+ * @file user_store_bench.c
+ * @brief 유저 등록/삭제 영속화 벤치마크: 저널 저장소(user_store.h) vs 이전 파일 방식
+ *
+ * 등록 2회마다 앞서 등록한 유저 1명을 삭제하는 작업열을 두 방식으로 실행합니다.
+ *   - 이전 방식: 등록마다 save_user_to_file() (fopen 후 한 줄 추가), 삭제마다 write_txt_file() (전체 재작성)
+ *   - 저널 방식: user_store_register()/user_store_delete() (저널에 한 줄 추가, 압축은 백그라운드)
+ * 이전 방식은 삭제가 O(N) 이라 전체 작업 수로는 끝나지 않으므로 더 적은 작업 수로 따로 측정합니다.
+ * 저널 방식은 마지막에 압축 후 다시 열어 시작 시 재생 시간도 측정합니다.
+ *
+ * 임시 디렉터리에서 실행하며 끝나면 파일을 지웁니다.
+ *
+ * 사용법: ./user_store_bench [저널 방식 작업 수] [이전 방식 작업 수]
+ */
+
+#include <time.h>
+#include <dirent.h>
+#include "user_store.h"
+
+#define BENCH_DEFAULT_OPS 1000000
+#define BENCH_DEFAULT_LEGACY_OPS 20000
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief 작업열 실행: j 번째 유저를 등록하고, j 가 홀수이면 j/2 번째 유저를 삭제
+ *
+ * @return 실행한 작업 수
+ */
+static long run_ops(long ops, bool (*reg)(void *, const char *, const char *),
+                    bool (*del)(void *, const char *), void *ctx) {
+    char user[32], pass[32];
+    long done = 0;
+
+    for (long j = 0; done < ops; j++) {
+        snprintf(user, sizeof(user), "user%ld", j);
+        snprintf(pass, sizeof(pass), "pw%ld", j);
+        reg(ctx, user, pass);
+        done++;
+        if ((j & 1) && done < ops) {
+            snprintf(user, sizeof(user), "user%ld", j / 2);
+            del(ctx, user);
+            done++;
+        }
+    }
+    return done;
+}
+
+static bool legacy_register(void *ctx, const char *user, const char *pass) {
+    if (!register_user((UserDB *)ctx, "localhost", user, pass, "user")) {
+        return false;
+    }
+    save_user_to_file("localhost", user, pass, "user");
+    return true;
+}
+
+static bool legacy_delete(void *ctx, const char *user) {
+    if (!delete_user((UserDB *)ctx, user)) {
+        return false;
+    }
+    write_txt_file((UserDB *)ctx);
+    return true;
+}
+
+static bool journal_register(void *ctx, const char *user, const char *pass) {
+    return user_store_register((UserStore *)ctx, "localhost", user, pass, "user");
+}
+
+static bool journal_delete(void *ctx, const char *user) {
+    return user_store_delete((UserStore *)ctx, user);
+}
+
+/**
+ * @brief 이전 방식 실행 (등록/삭제마다 진행 메시지를 출력하므로 그동안 stdout 을 버림)
+ */
+static double bench_legacy(long ops) {
+    UserDB db;
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+
+    init_user_db(&db);
+    fflush(stdout);
+    dup2(devnull, STDOUT_FILENO);
+    double begin = now_sec();
+    run_ops(ops, legacy_register, legacy_delete, &db);
+    double elapsed = now_sec() - begin;
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(devnull);
+
+    free_user_db(&db);
+    unlink(USER_DATA_FILE);
+    return elapsed;
+}
+
+/**
+ * @brief 저널 방식 실행 후 압축하고 다시 열어 재생 시간을 측정
+ */
+static double bench_journal(long ops, double *replay_sec, long *compactions, size_t *users) {
+    UserDB db;
+    UserStore store;
+
+    init_user_db(&db);
+    if (user_store_open(&store, &db, USER_DATA_FILE) < 0) {
+        kernel_errExit("Failed to open user store");
+    }
+    double begin = now_sec();
+    run_ops(ops, journal_register, journal_delete, &store);
+    double elapsed = now_sec() - begin;
+    *compactions = atomic_load(&store.compactions);
+    user_store_close(&store);
+    free_user_db(&db);
+
+    // 남은 저널 일부는 압축하지 않은 채로 두어, 스냅샷 + 저널 재생을 함께 측정
+    init_user_db(&db);
+    begin = now_sec();
+    user_store_open(&store, &db, USER_DATA_FILE);
+    *replay_sec = now_sec() - begin;
+    *users = db.user_count;
+    user_store_close(&store);
+    free_user_db(&db);
+    return elapsed;
+}
+
+/**
+ * @brief 임시 디렉터리의 파일을 모두 지우고 디렉터리를 삭제
+ */
+static void remove_dir(const char *dir) {
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    char path[512];
+
+    while (d != NULL && (entry = readdir(d)) != NULL) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            unlink(path);
+        }
+    }
+    if (d != NULL) {
+        closedir(d);
+    }
+    rmdir(dir);
+}
+
+int main(int argc, char *argv[]) {
+    long ops = argc > 1 ? atol(argv[1]) : BENCH_DEFAULT_OPS;
+    long legacy_ops = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_LEGACY_OPS;
+    char dir[] = "/tmp/user_store_bench.XXXXXX";
+    char cwd[512];
+
+    if (ops <= 0 || legacy_ops < 0) {
+        fprintf(stderr, "사용법: %s [저널 방식 작업 수] [이전 방식 작업 수]\n", argv[0]);
+        return 1;
+    }
+    if (getcwd(cwd, sizeof(cwd)) == NULL || mkdtemp(dir) == NULL || chdir(dir) < 0) {
+        kernel_errExit("Failed to create benchmark directory");
+    }
+
+    printf("등록 2회 + 삭제 1회 반복 (작업 수 = 등록 + 삭제)\n");
+    printf("%-8s %10s %10s %12s %12s\n", "방식", "작업 수", "시간(s)", "작업/초", "작업당(us)");
+    if (legacy_ops > 0) {
+        double legacy_sec = bench_legacy(legacy_ops);
+        printf("%-8s %10ld %10.3f %12.0f %12.2f\n", "legacy", legacy_ops, legacy_sec, legacy_ops / legacy_sec,
+               legacy_sec * 1e6 / legacy_ops);
+
+        double replay_sec;
+        long compactions;
+        size_t users;
+        double journal_sec = bench_journal(legacy_ops, &replay_sec, &compactions, &users);
+        printf("%-8s %10ld %10.3f %12.0f %12.2f\n", "journal", legacy_ops, journal_sec, legacy_ops / journal_sec,
+               journal_sec * 1e6 / legacy_ops);
+        remove_dir(dir);
+        if (mkdir(dir, 0700) < 0 || chdir(dir) < 0) {
+            kernel_errExit("Failed to recreate benchmark directory");
+        }
+    }
+
+    double replay_sec;
+    long compactions;
+    size_t users;
+    double journal_sec = bench_journal(ops, &replay_sec, &compactions, &users);
+    printf("%-8s %10ld %10.3f %12.0f %12.2f\n", "journal", ops, journal_sec, ops / journal_sec,
+           journal_sec * 1e6 / ops);
+    printf("백그라운드 압축 %ld회, 다시 열어 재생: 유저 %zu명, %.3f초\n", compactions, users, replay_sec);
+
+    if (chdir(cwd) < 0) {
+        perror("chdir");
+    }
+    remove_dir(dir);
+    return 0;
+}
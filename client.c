@@ -9,13 +9,28 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <pthread.h>
-#include "lib/include/user.h"  // 사용자 데이터베이스 처리
+#include <fcntl.h>
+#include "lib/include/user.h"  // 사용자명/비밀번호 길이 (MAX_STRING_SIZE)
+#include "lib/include/protocol.h"  // 서버와 공유하는 프레임 프로토콜
+#include "lib/include/chatlog.h"   // 비동기 채팅 로그
+#include "lib/include/logsearch.h" // 채팅 로그 색인 검색
+#include "lib/include/presence.h"  // 호스트 전체 접속 현황 (공유 메모리)
 
-// 로그 파일 경로
-pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+// 채팅 로그 (writer 스레드가 기록)
+ChatLog chat_log;
+
+// 채팅 로그 검색 색인 (검색할 때 새로 추가된 부분만 읽어 갱신)
+LogIndex log_index;
+
+// 같은 호스트의 서버가 기록하는 접속 현황 (로그인 전에 중복 로그인을 확인)
+PresenceTable presence;
+
+// 서버에서 받은 프레임 (로그인 응답을 기다릴 때와 채팅 수신 스레드가 이어서 사용)
+FrameReader server_reader;
 
 #define PORT 5100
 #define BUFFER_SIZE 1024
+#define SESSION_FILE ".chat_session"  // 서버가 발급한 세션 토큰을 저장하는 파일 (재접속 시 로그인 생략)
 
 /**
  * @brief 서버에 연결하는 함수
@@ -26,24 +41,61 @@ pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
  */
 int connect_to_server(const char *host, int port);
 
+/**
+ * @brief 서버에 인증 요청을 보내고 결과를 기다리는 함수
+ * 
+ * 사용자 데이터베이스는 서버에만 있으므로 회원가입, 로그인, 삭제 모두 이 요청으로 처리합니다.
+ * 
+ * @param sock 서버와 연결된 소켓 FD
+ * @param op 요청 종류 (AuthOp)
+ * @param fields 요청 내용 ("사용자명\0비밀번호" 또는 세션 토큰)
+ * @param len 요청 내용 길이
+ * @param reply 서버가 보낸 결과 문자열 (세션 토큰 + 사용자명 또는 사유)
+ * @param reply_size reply 버퍼 크기
+ * @return int AUTH_OK 또는 AUTH_FAILED, 연결이 끊기면 -1 반환
+ */
+int auth_request(int sock, uint8_t op, const char *fields, size_t len, char *reply, size_t reply_size);
+
+/**
+ * @brief 사용자명과 비밀번호를 입력받아 인증 요청 내용을 만드는 함수
+ * 
+ * @param username 입력받은 사용자명을 저장할 버퍼
+ * @param fields "사용자명\0비밀번호" 를 저장할 버퍼 (2 * MAX_STRING_SIZE 바이트)
+ * @return size_t 요청 내용 길이
+ */
+size_t read_credentials(char *username, char *fields);
+
 /**
  * @brief 클라이언트 로그인 함수
  * 
- * 사용자 데이터베이스에서 사용자 정보를 확인하고, 성공 시 로그인 처리합니다.
+ * 서버에 로그인을 요청하고, 성공 시 받은 세션 토큰을 저장합니다.
  * 
- * @param user_db 사용자 데이터베이스
- * @param username 로그인할 사용자명
- * @param password 로그인할 비밀번호
+ * @param sock 서버와 연결된 소켓 FD
+ * @param username 로그인한 사용자명을 저장할 버퍼
  * @return int 성공 시 1, 실패 시 0 반환
  */
-int client_login_user(UserDB *user_db, char *username, char *password);
+int client_login_user(int sock, char *username);
+
+/**
+ * @brief 저장된 세션 토큰으로 재접속하는 함수
+ * 
+ * 토큰이 만료되었으면 세션 파일을 지우고 로그인 메뉴로 돌아갑니다.
+ * 
+ * @param sock 서버와 연결된 소켓 FD
+ * @param username 로그인한 사용자명을 저장할 버퍼
+ * @return int 성공 시 1, 실패 시 0 반환
+ */
+int client_resume_session(int sock, char *username);
 
 /**
  * @brief 채팅방을 선택하는 함수
  * 
+ * 선택한 채팅방 번호(또는 이름)와 사용자명을 HELLO 프레임 하나로 서버에 보냅니다.
+ * 
  * @param sock 서버와 연결된 소켓 FD
+ * @param username 사용자명
  */
-void select_chat_room(int sock);
+void select_chat_room(int sock, const char *username);
 
 /**
  * @brief 채팅을 시작하는 함수
@@ -61,14 +113,18 @@ void chat(int sock, char *username);
 void log_chat_message(const char *message);
 
 /**
- * @brief 로그아웃 및 사용자 삭제 함수
+ * @brief 남은 채팅 로그를 모두 기록하고 로그 스레드를 종료하는 함수
  * 
- * 로그아웃 처리 후 사용자 정보를 삭제합니다.
+ * exit() 로 끝나는 경로에서도 호출되도록 atexit 에 등록합니다.
+ */
+void close_chat_log(void);
+
+/**
+ * @brief 로그아웃 함수
  * 
- * @param user_db 사용자 데이터베이스
  * @param username 로그아웃할 사용자명
  */
-void logout_and_delete_user(UserDB *user_db, const char *username);
+void logout_user(const char *username);
 
 /**
  * @brief 메시지 전송 스레드 함수
@@ -93,7 +149,7 @@ void *receive_messages(void *sock_fd);
  */
 void print_fixed_menu(const char *username) {
     // system("clear");
-    printf("\n[ 로그인 된 아이디 : %s, 채팅 메세지 키워드 : grep -r \"검색할 메세지\", 프로그램 종료 : \"exit\"]\n", username);
+    printf("\n[ 로그인 된 아이디 : %s, 채팅 메세지 키워드 : grep -r \"검색할 메세지\", 귓속말 : /w <사용자> <메세지>, 프로그램 종료 : \"exit\"]\n", username);
 }
 
 
@@ -129,25 +185,31 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // 사용자 데이터베이스 초기화 및 로드
-    UserDB user_db;
-    init_user_db(&user_db);
-    load_users_from_file(&user_db);
+    // 채팅 로그 시작 (종료 시 남은 로그 기록)
+    if (chatlog_open(&chat_log, CHAT_LOG_PATH_FORMAT, (ChatLogSync){ CHATLOG_SYNC_NONE, 0 }) == 0) {
+        atexit(close_chat_log);
+    }
+    log_index_init(&log_index, CHAT_LOG_PATH_FORMAT);
+    presence_open(&presence, PRESENCE_SHM_NAME);  // 실패하면 중복 로그인은 서버가 HELLO 에서만 확인
+    frame_reader_init(&server_reader);
 
     char choice_str[MAX_STRING_SIZE];
     int choice;
-    char username[MAX_STRING_SIZE], password[MAX_STRING_SIZE];
-    bool login_success = false;
-
-    while (1) {
+    char username[MAX_STRING_SIZE];
+    char fields[2 * MAX_STRING_SIZE];
+    char reply[BUFFER_SIZE];
+    size_t len;
+    // 저장된 세션 토큰이 있으면 비밀번호 없이 바로 재접속
+    bool login_success = client_resume_session(sock, username);
+
+    while (!login_success) {
         // 화면을 clear하고 메뉴를 출력
         system("clear");
 
         printf("\033[0;34m\n1. \033[0;32m회원가입\033[0;34m\n");  // 파랑 배경, 초록 글자
         printf("2. \033[0;33m로그인\033[0;34m\n");            // 노랑 글자
         printf("3. \033[0;31m사용자 삭제\033[0;34m\n");        // 빨강 글자
-        printf("4. \033[0;36m모든 사용자 출력\033[0;34m\n");    // 청록 글자
-        printf("5. \033[0;35m종료\033[0;34m\n");               // 자홍 글자
+        printf("4. \033[0;35m종료\033[0;34m\n");               // 자홍 글자
         printf("\033[0m");  // 색상 리셋
         printf("Enter your choice: ");
         scanf("%s", choice_str);  // 문자열로 입력을 받음
@@ -172,65 +234,53 @@ int main(int argc, char *argv[]) {
         choice = atoi(choice_str);
 
         switch (choice) {
-            case 1:  // 사용자 등록
+            case 1:  // 사용자 등록 (서버의 사용자 데이터베이스에 저장)
                 system("clear");
-                printf("Enter username: ");
-                scanf("%s", username);
-                printf("Enter password: ");
-                scanf("%s", password);
-                if (register_user(&user_db, "localhost", username, password, "user")) {
-                    printf("회원가입이 완료되었습니다.\n");
-                    save_user_to_file("localhost", username, password, "user");
-                } else {
-                    printf("회원가입에 실패했습니다.\n");
+                len = read_credentials(username, fields);
+                if (auth_request(sock, AUTH_REGISTER, fields, len, reply, sizeof(reply)) < 0) {
+                    printf("서버 연결 종료.\n");
+                    return 1;
                 }
+                printf("%s\n", reply);
+                sleep(2);
                 break;
             case 2:  // 사용자 로그인
                 system("clear");
-                if (client_login_user(&user_db, username, password)) {
+                if (client_login_user(sock, username)) {
                     login_success = true;
                 } else {
                     printf("로그인 실패\n");
                 }
                 break;
-            case 3:  // 사용자 삭제
+            case 3:  // 사용자 삭제 (본인 확인을 위해 비밀번호도 입력)
                 system("clear");
-                printf("Enter username to delete: ");
-                scanf("%s", username);
-                if (delete_user(&user_db, username)) {
-                    printf("사용자가 성공적으로 삭제되었습니다.\n");
-                    write_txt_file(&user_db);  // 사용자 삭제 후 파일 업데이트
-                } else {
-                    printf("사용자를 삭제할 수 없습니다.\n");
+                len = read_credentials(username, fields);
+                if (auth_request(sock, AUTH_DELETE, fields, len, reply, sizeof(reply)) < 0) {
+                    printf("서버 연결 종료.\n");
+                    return 1;
                 }
+                printf("%s\n", reply);
+                sleep(2);
                 break;
-            case 4:  // 모든 사용자 출력
-                display_all_users(&user_db);
-                getchar();
-                getchar();
-                break;
-            case 5:  // 종료
+            case 4:  // 종료
                 system("clear");
                 printf("Exiting...\n");
                 close(sock);
                 return 0;
             default:
-                // 1번과 5번이 아닌 입력에 대한 처리
-                printf("잘못된 입력입니다. 1번과 5번 중에서 선택하세요.\n");
+                // 1번과 4번이 아닌 입력에 대한 처리
+                printf("잘못된 입력입니다. 1번과 4번 중에서 선택하세요.\n");
                 sleep(2);  // 메시지를 잠시 보여주고 다시 입력 요청
                 break;
         }
-
-        // 로그인에 성공한 경우에만 채팅 진행
-        if (login_success) {
-            select_chat_room(sock);
-            chat(sock, username);  // username을 넘겨줌
-            break;
-        }
     }
 
-    // 로그아웃 및 사용자 삭제
-    logout_and_delete_user(&user_db, username);
+    // 로그인에 성공한 경우에만 채팅 진행
+    select_chat_room(sock, username);
+    chat(sock, username);  // username을 넘겨줌
+
+    // 로그아웃
+    logout_user(username);
 
     // 서버 연결 종료
     close(sock);
@@ -275,22 +325,94 @@ int connect_to_server(const char *host, int port) {
     return sock;
 }
 
+/**
+ * @brief 서버에 인증 요청을 보내고 결과를 기다리는 함수
+ * @param sock 서버와 연결된 소켓 FD
+ * @param op 요청 종류 (AuthOp)
+ * @param fields 요청 내용 ("사용자명\0비밀번호" 또는 세션 토큰)
+ * @param len 요청 내용 길이
+ * @param reply 서버가 보낸 결과 문자열 (세션 토큰 + 사용자명 또는 사유)
+ * @param reply_size reply 버퍼 크기
+ * @return int AUTH_OK 또는 AUTH_FAILED, 연결이 끊기면 -1 반환
+ */
+int auth_request(int sock, uint8_t op, const char *fields, size_t len, char *reply, size_t reply_size) {
+    char request[1 + 2 * MAX_STRING_SIZE];
+    const char *payload;
+    uint32_t payload_len;
+    uint8_t type;
+    size_t avail;
+    int ret, n;
+
+    if (len > sizeof(request) - 1) {
+        return -1;
+    }
+    request[0] = (char)op;
+    memcpy(request + 1, fields, len);
+    if (frame_send(sock, FRAME_AUTH, request, (uint32_t)(1 + len)) < 0) {
+        return -1;
+    }
+
+    while (1) {
+        while ((ret = frame_reader_next(&server_reader, &type, &payload, &payload_len)) > 0) {
+            if (type == FRAME_AUTH_RESULT && payload_len >= 1) {
+                size_t text_len = payload_len - 1 < reply_size - 1 ? payload_len - 1 : reply_size - 1;
+                memcpy(reply, payload + 1, text_len);
+                reply[text_len] = '\0';
+                return (uint8_t)payload[0];
+            }
+            if (type == FRAME_MESSAGE || type == FRAME_NOTICE) {
+                printf("%.*s\n", (int)payload_len, payload);  // 로그인 전에 받은 서버 공지
+            }
+        }
+        if (ret < 0) {
+            return -1;
+        }
+
+        char *space = frame_reader_space(&server_reader, BUFFER_SIZE, &avail);
+        if (space == NULL || (n = recv(sock, space, avail, 0)) <= 0) {
+            return -1;
+        }
+        frame_reader_commit(&server_reader, (size_t)n);
+    }
+}
+
+/**
+ * @brief 사용자명과 비밀번호를 입력받아 인증 요청 내용을 만드는 함수
+ * @param username 입력받은 사용자명을 저장할 버퍼
+ * @param fields "사용자명\0비밀번호" 를 저장할 버퍼 (2 * MAX_STRING_SIZE 바이트)
+ * @return size_t 요청 내용 길이
+ */
+size_t read_credentials(char *username, char *fields) {
+    char password[MAX_STRING_SIZE];
+
+    printf("사용자명: ");
+    scanf("%99s", username);
+    printf("비밀번호: ");
+    scanf("%99s", password);
+
+    // 요청 내용 = "사용자명\0비밀번호" (둘 다 공백 없는 한 단어)
+    size_t user_len = strlen(username);
+    size_t pass_len = strlen(password);
+    memcpy(fields, username, user_len + 1);
+    memcpy(fields + user_len + 1, password, pass_len);
+    return user_len + 1 + pass_len;
+}
+
 /**
  * @brief 클라이언트 로그인 함수
- * @param user_db 사용자 데이터베이스
- * @param username 로그인할 사용자명
- * @param password 로그인할 비밀번호
+ * @param sock 서버와 연결된 소켓 FD
+ * @param username 로그인한 사용자명을 저장할 버퍼
  * @return int 성공 시 1, 실패 시 0 반환
  */
-int client_login_user(UserDB *user_db, char *username, char *password) {
+int client_login_user(int sock, char *username) {
+    char fields[2 * MAX_STRING_SIZE];
+    char reply[BUFFER_SIZE];
+
     printf("로그인을 진행합니다.\n");
-    printf("사용자명: ");
-    scanf("%s", username);
-    printf("비밀번호: ");
-    scanf("%s", password);
+    size_t len = read_credentials(username, fields);
 
-    // 중복 로그인 방지
-    if (is_user_logined_in(username)) {
+    // 중복 로그인 방지 (공유 메모리 조회만 하고, 최종 확인은 서버가 HELLO 에서 함)
+    if (presence_lookup(&presence, username, strlen(username)) != 0) {
         printf("이미 로그인 중인 사용자입니다.\n");
         printf("계속하려면 Enter 키를 누르세요...\n");
         getchar(); // Enter 대기
@@ -298,33 +420,87 @@ int client_login_user(UserDB *user_db, char *username, char *password) {
         return 0;
     }
 
-    // 사용자 정보 확인
-    int user_idx = query_user(user_db, username, password);
-    if (user_idx >= 0) {
-        printf("로그인 성공!\n");
-        log_user_in(username);  // 로그인 시 숨김 파일 생성
-        system("clear");
-        return 1;  // 로그인 성공
-    } else {
-        printf("존재하지 않는 사용자입니다. 회원가입을 진행하세요.\n");
+    int status = auth_request(sock, AUTH_LOGIN, fields, len, reply, sizeof(reply));
+    if (status < 0) {
+        printf("서버 연결 종료.\n");
+        exit(1);
+    }
+    if (status != AUTH_OK) {
+        printf("%s\n", reply);
         printf("계속하려면 Enter 키를 누르세요...\n");
         getchar(); // Enter 대기
         getchar(); // 입력 방지 처리
         return 0;  // 로그인 실패
     }
+
+    // 결과 = "세션 토큰 사용자명", 다음 접속부터는 토큰으로 로그인
+    int fd = open(SESSION_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd >= 0) {
+        if (write(fd, reply, strlen(reply)) < 0) {
+            perror("세션 저장 실패");
+        }
+        close(fd);
+    }
+    printf("로그인 성공!\n");
+    system("clear");
+    return 1;  // 로그인 성공
 }
 
 /**
- * @brief 고정 메뉴 출력 함수
+ * @brief 저장된 세션 토큰으로 재접속하는 함수
+ * @param sock 서버와 연결된 소켓 FD
+ * @param username 로그인한 사용자명을 저장할 버퍼
+ * @return int 성공 시 1, 실패 시 0 반환
+ */
+int client_resume_session(int sock, char *username) {
+    char saved[BUFFER_SIZE];
+    char reply[BUFFER_SIZE];
+
+    int fd = open(SESSION_FILE, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    ssize_t n = read(fd, saved, sizeof(saved) - 1);
+    close(fd);
+    if (n <= 0) {
+        unlink(SESSION_FILE);
+        return 0;
+    }
+    saved[n] = '\0';
+
+    char *sep = strchr(saved, ' ');
+    int status = auth_request(sock, AUTH_RESUME, saved, sep != NULL ? (size_t)(sep - saved) : (size_t)n,
+                              reply, sizeof(reply));
+    if (status < 0) {
+        printf("서버 연결 종료.\n");
+        exit(1);
+    }
+    if (status != AUTH_OK || (sep = strchr(reply, ' ')) == NULL) {
+        printf("%s\n", reply);
+        unlink(SESSION_FILE);  // 만료된 토큰은 지우고 로그인 메뉴로
+        sleep(2);
+        return 0;
+    }
+    snprintf(username, MAX_STRING_SIZE, "%s", sep + 1);
+    printf("%s 님, 저장된 세션으로 다시 접속했습니다.\n", username);
+    return 1;
+}
+
+/**
+ * @brief 채팅방을 선택하는 함수
+ *
+ * 숫자를 입력하면 그 번호의 방에, 그 밖의 문자열은 그 이름의 방에 입장합니다. 없는 방은 서버가 만듭니다.
+ *
+ * @param sock 서버와 연결된 소켓 FD
  * @param username 사용자명
  * @return void
  */
-void select_chat_room(int sock) {
-    int chat_room_id;
+void select_chat_room(int sock, const char *username) {
+    unsigned long chat_room_id;
     char input_str[BUFFER_SIZE];
 
     while (1) {
-        printf("채팅룸을 선택하세요 (1 ~ 5): ");
+        printf("채팅룸 번호(1 ~ %d)나 이름을 입력하세요: ", HELLO_ROOM_ID_MAX);
         scanf("%s", input_str);  // 문자열로 입력 받기
 
         // 입력이 숫자인지 확인
@@ -336,18 +512,22 @@ void select_chat_room(int sock) {
             }
         }
 
-        // 숫자가 아닐 경우 예외 처리
+        // 숫자가 아니면 방 이름으로 사용
         if (!is_numeric) {
-            printf("잘못된 입력입니다. 숫자를 입력하세요.\n");
-            continue;  // 잘못된 입력이므로 다시 입력 받음
+            if (strlen(input_str) > HELLO_ROOM_NAME_MAX) {
+                printf("채팅룸 이름은 %d바이트까지 입력할 수 있습니다.\n", HELLO_ROOM_NAME_MAX);
+                continue;
+            }
+            chat_room_id = 0;
+            break;
         }
 
         // 숫자로 변환
-        chat_room_id = atoi(input_str);
+        chat_room_id = strtoul(input_str, NULL, 10);
 
-        // 1 ~ 5 범위의 채팅방 번호 확인
-        if (chat_room_id < 1 || chat_room_id > 5) {
-            printf("유효한 채팅룸을 선택하세요 (1 ~ 5): ");
+        // 1 ~ HELLO_ROOM_ID_MAX 범위의 채팅방 번호 확인
+        if (chat_room_id < 1 || chat_room_id > HELLO_ROOM_ID_MAX || strlen(input_str) > 10) {
+            printf("유효한 채팅룸 번호가 아닙니다 (1 ~ %d).\n", HELLO_ROOM_ID_MAX);
             continue;
         }
 
@@ -355,11 +535,25 @@ void select_chat_room(int sock) {
         break;
     }
 
-    char room_message[BUFFER_SIZE];
-    snprintf(room_message, sizeof(room_message), "%d", chat_room_id);
-    send(sock, room_message, strlen(room_message), 0);
+    // HELLO payload = [채팅방 ID 4바이트, 빅엔디언][사용자명][\0 채팅방 이름 (ID 가 0 일 때)]
+    // (사용자명은 서버가 로그인한 이름과 비교)
+    char hello[4 + MAX_STRING_SIZE + 1 + HELLO_ROOM_NAME_MAX];
+    uint32_t room_be = htonl((uint32_t)chat_room_id);
+    size_t name_len = strnlen(username, MAX_STRING_SIZE);
+    size_t hello_len = 4 + name_len;
+    memcpy(hello, &room_be, 4);
+    memcpy(hello + 4, username, name_len);
+    if (chat_room_id == 0) {
+        size_t room_len = strlen(input_str);
+        hello[hello_len++] = '\0';
+        memcpy(hello + hello_len, input_str, room_len);
+        hello_len += room_len;
+    }
+    if (frame_send(sock, FRAME_HELLO, hello, (uint32_t)hello_len) < 0) {
+        perror("HELLO 전송 실패");
+    }
 
-    printf("채팅룸 %d에 입장합니다.\n", chat_room_id);
+    printf("채팅룸 %s에 입장합니다.\n", input_str);
 }
 
 /**
@@ -396,8 +590,6 @@ void *send_messages(void *args) {
     char *username = (char *)&sock_and_username[1];
 
     char buffer[BUFFER_SIZE];
-    char message_with_username[BUFFER_SIZE + 50];  
-    char grep_command[BUFFER_SIZE + 50];  
 
     print_fixed_menu(username);
 
@@ -405,33 +597,16 @@ void *send_messages(void *args) {
         fgets(buffer, BUFFER_SIZE, stdin);
         buffer[strcspn(buffer, "\n")] = 0;
 
-        // grep 명령을 처리하는 경우
+        // grep 명령을 처리하는 경우 (색인 검색, 예: grep -r "good morning" alice -d 20240901:20240930)
         if (strncmp(buffer, "grep -r", 7) == 0) {
-            char command[BUFFER_SIZE + 100];
-            char log_filename[50];
-            time_t now = time(NULL);
-            struct tm *t = localtime(&now);
-
-            // 로그 파일명에 날짜 붙이기
-            strftime(log_filename, sizeof(log_filename), "/var/log/chatlog_%Y%m%d.log", t);
-
-            // grep 명령어에 로그 파일 경로 포함
-            snprintf(command, sizeof(command), "%s %s", buffer, log_filename);
-            system(command);  // 로그 파일에서 grep 명령 실행
+            log_index_search(&log_index, buffer + 7, stdout);
         } else {
-            int ret = snprintf(message_with_username, sizeof(message_with_username), "[%s]: %s", username, buffer);
-            if (ret >= sizeof(message_with_username)) {
-                printf("경고: 메시지가 너무 깁니다. 일부가 잘렸을 수 있습니다.\n");
-            }
-
-            send(sock, message_with_username, strlen(message_with_username), 0);
+            // 사용자명은 HELLO 로 이미 보냈으므로 본문만 전송 (서버가 "[사용자명]: " 을 붙임)
+            frame_send(sock, FRAME_CHAT, buffer, (uint32_t)strlen(buffer));
 
             if (strcmp(buffer, "exit") == 0 || strcmp(buffer, "...") == 0) {
                 printf("채팅을 종료합니다.\n");
 
-                // 로그아웃 시 숨김 파일 삭제
-                logout_user(username);
-
                 close(sock);
                 exit(0);
             }
@@ -450,17 +625,35 @@ void *send_messages(void *args) {
  */
 void *receive_messages(void *sock_fd) {
     int sock = *(int *)sock_fd;
-    char buffer[BUFFER_SIZE];
+    const char *payload;
+    uint32_t len;
+    uint8_t type;
+    size_t avail;
     int n;
 
+    // 로그인 응답과 함께 받아 둔 프레임부터 처리
     while (1) {
-        memset(buffer, 0, BUFFER_SIZE);
-        n = recv(sock, buffer, BUFFER_SIZE - 1, 0);
-        if (n > 0) {
-            // 본인이 보낸 메시지가 아닐 때만 출력
-            if (!strstr(buffer, "본인 [")) {
-                printf("%s\n", buffer);  // 수신한 메시지 출력
+        // 한 번의 recv 에 여러 메시지가 올 수도, 한 메시지가 나뉘어 올 수도 있음
+        int ret;
+        while ((ret = frame_reader_next(&server_reader, &type, &payload, &len)) > 0) {
+            if (type == FRAME_MESSAGE || type == FRAME_NOTICE) {
+                printf("%.*s\n", (int)len, payload);  // 수신한 메시지 출력
             }
+        }
+        if (ret < 0) {
+            printf("잘못된 메시지를 수신했습니다. 서버 연결 종료.\n");
+            exit(1);
+        }
+
+        char *space = frame_reader_space(&server_reader, BUFFER_SIZE, &avail);
+        if (space == NULL) {
+            perror("수신 버퍼 할당 실패");
+            exit(1);
+        }
+
+        n = recv(sock, space, avail, 0);
+        if (n > 0) {
+            frame_reader_commit(&server_reader, (size_t)n);
         } else if (n == 0) {
             printf("서버 연결 종료.\n");
             exit(0);
@@ -469,20 +662,13 @@ void *receive_messages(void *sock_fd) {
 }
 
 /**
- * @brief 로그아웃 및 사용자 삭제 함수
- * @param user_db 사용자 데이터베이스
+ * @brief 로그아웃 함수
  * @param username 로그아웃할 사용자명
  * @return void
  */
-void logout_and_delete_user(UserDB *user_db, const char *username) {
+void logout_user(const char *username) {
     printf("로그아웃 처리 중...\n");
     log_chat_message("User logged out.");
-
-    // 로그아웃 시 숨김 파일 삭제
-    logout_user(username);
-
-    delete_user(user_db, username);
-    write_txt_file(user_db);  // 파일에 저장
 }
 
 /**
@@ -491,28 +677,14 @@ void logout_and_delete_user(UserDB *user_db, const char *username) {
  * @return void
  */
 void log_chat_message(const char *message) {
-    // 절대 경로로 로그 파일 지정
-    char log_path[BUFFER_SIZE];
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-
-    // 현재 날짜를 기반으로 로그 파일명을 만듦
-    strftime(log_path, sizeof(log_path), "/var/log/chatlog_%Y%m%d.log", t);
-
-    // 뮤텍스 잠금으로 동시 접근 제어
-    pthread_mutex_lock(&log_mutex);
-
-    FILE *log_file = fopen(log_path, "a");
-    if (log_file == NULL) {
-        perror("로그 파일을 열 수 없습니다.");
-        pthread_mutex_unlock(&log_mutex);  // 잠금 해제
-        return;
-    }
-
-    // 로그 파일에 메시지 기록
-    fprintf(log_file, "%s\n", message);
-    fclose(log_file);
+    // 파일 기록은 로그 writer 스레드가 처리
+    chatlog_write(&chat_log, message, strlen(message));
+}
 
-    // 뮤텍스 잠금 해제
-    pthread_mutex_unlock(&log_mutex);
+/**
+ * @brief 남은 채팅 로그를 모두 기록하고 로그 스레드를 종료하는 함수
+ * @return void
+ */
+void close_chat_log(void) {
+    chatlog_close(&chat_log);
 }
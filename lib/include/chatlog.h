@@ -0,0 +1,517 @@
+#pragma once
+/**
+ * @file chatlog.h
+ * @brief 전용 writer 스레드가 묶음으로 기록하는 비동기 채팅 로그
+ *
+ * 메시지를 보내는 스레드는 lock-free MPSC 큐(queue.h)의 칸에 레코드를 바로 채워 넣고 돌아갑니다.
+ * writer 스레드 하나가 큐를 비우면서 레코드를 큰 버퍼에 모아 한 번의 writev() 로 기록하고,
+ * 로그 파일은 열어 둔 채로 자정에만 다음 날짜 파일로 교체합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+#include "queue.h"
+
+#define CHAT_LOG_PATH_FORMAT "/var/log/chatlog_%Y%m%d.log"   ///< 날짜별 로그 파일 (strftime 형식)
+#define CHATLOG_CAPACITY 4096        ///< 큐에 담을 수 있는 레코드 수 (2의 거듭제곱)
+#define CHATLOG_INLINE_MAX 480       ///< 칸 안에 바로 복사하는 최대 길이 (넘으면 힙 복사)
+#define CHATLOG_BATCH_SIZE 65536     ///< writer 스레드의 묶음 쓰기 버퍼 크기
+#define CHATLOG_IDLE_MS 100          ///< 큐가 비었을 때 writer 스레드가 기다리는 최대 시간
+#define CHATLOG_RETRY_SEC 5          ///< 로그 파일을 열지 못했을 때 다시 시도하기까지의 시간
+
+/**
+ * @brief fsync 정책 종류
+ */
+typedef enum {
+    CHATLOG_SYNC_NONE = 0,       ///< fsync 하지 않음 (커널에 맡김)
+    CHATLOG_SYNC_INTERVAL,       ///< every 밀리초마다
+    CHATLOG_SYNC_RECORDS         ///< 레코드 every 개마다
+} ChatLogSyncPolicy;
+
+/**
+ * @struct ChatLogSync
+ * @brief fsync 정책
+ */
+typedef struct {
+    ChatLogSyncPolicy policy;    ///< 정책 종류
+    long every;                  ///< 간격 (밀리초 또는 레코드 수)
+} ChatLogSync;
+
+/**
+ * @struct ChatLogRecord
+ * @brief 큐 칸에 담기는 레코드
+ */
+typedef struct {
+    uint64_t enqueued_ns;        ///< 넣은 시각 (CLOCK_MONOTONIC)
+    time_t when;                 ///< 넣은 시각 (날짜 교체 기준)
+    uint32_t len;                ///< 레코드 길이
+    char *heap;                  ///< 긴 레코드의 힙 복사본 (없으면 NULL)
+    char text[CHATLOG_INLINE_MAX]; ///< 짧은 레코드 본문
+} ChatLogRecord;
+
+/**
+ * @struct ChatLogStats
+ * @brief 로그 지표 스냅샷
+ */
+typedef struct {
+    long enqueued;               ///< 큐에 넣은 레코드 수
+    long dropped;                ///< 큐가 가득 차거나 파일을 열지 못해 버린 레코드 수
+    long written;                ///< 파일에 기록한 레코드 수
+    long bytes;                  ///< 파일에 기록한 바이트 수
+    long writes;                 ///< writev() 로 기록한 횟수 (묶음 수)
+    long fsyncs;                 ///< fdatasync() 호출 수
+    long enqueue_ns_total;       ///< 넣기에 걸린 시간 합 (나노초)
+    long enqueue_ns_max;         ///< 넣기에 걸린 최대 시간
+    long lag_ns_total;           ///< 넣은 뒤 writer 가 꺼낼 때까지 걸린 시간 합
+    long lag_ns_max;             ///< 위 시간의 최댓값
+} ChatLogStats;
+
+/**
+ * @brief 로그 파일에 데이터를 기록한 직후 writer 스레드에서 호출되는 함수
+ *
+ * @param ctx chatlog_set_flush_hook() 에 넘긴 값
+ * @param path 기록한 파일
+ * @param offset data 가 기록된 파일 위치
+ * @param data 기록한 데이터 (줄 단위가 아닐 수 있음)
+ * @param len 데이터 길이
+ */
+typedef void (*ChatLogFlushHook)(void *ctx, const char *path, uint64_t offset, const char *data, size_t len);
+
+/**
+ * @brief ChatLog::stat 인덱스
+ */
+enum {
+    CHATLOG_STAT_ENQUEUED = 0, CHATLOG_STAT_DROPPED, CHATLOG_STAT_WRITTEN, CHATLOG_STAT_BYTES,
+    CHATLOG_STAT_WRITES, CHATLOG_STAT_FSYNCS, CHATLOG_STAT_ENQUEUE_NS, CHATLOG_STAT_ENQUEUE_MAX,
+    CHATLOG_STAT_LAG_NS, CHATLOG_STAT_LAG_MAX, CHATLOG_STAT_COUNT
+};
+
+/**
+ * @struct ChatLog
+ * @brief 비동기 채팅 로그
+ */
+typedef struct {
+    MpscQueue queue;                    ///< ChatLogRecord 큐 (소비자는 writer 스레드)
+    char path_format[256];              ///< 로그 파일 경로 (strftime 형식)
+    ChatLogSync sync;                   ///< fsync 정책
+    int fd;                             ///< 열려 있는 로그 파일 (없으면 -1)
+    char path[512];                     ///< 열려 있는 로그 파일 경로
+    ChatLogFlushHook flush_hook;        ///< 기록 직후 호출 (NULL 가능)
+    void *flush_ctx;                    ///< flush_hook 인자
+    time_t rotate_at;                   ///< 다음 파일 교체 시각 (다음 자정)
+    char *batch;                        ///< 묶음 쓰기 버퍼
+    size_t batch_len;                   ///< 묶음 버퍼에 쌓인 바이트 수
+    long unsynced;                      ///< 마지막 fsync 이후 기록한 레코드 수
+    uint64_t last_sync_ns;              ///< 마지막 fsync 시각
+    pthread_t writer;                   ///< writer 스레드
+    pthread_mutex_t wake_lock;          ///< writer 깨우기용
+    pthread_cond_t wake;                ///< writer 깨우기용
+    _Atomic int sleeping;               ///< writer 가 대기 중이면 1
+    _Atomic int stop;                   ///< 종료 요청
+    _Atomic long stat[CHATLOG_STAT_COUNT]; ///< 지표 누적값
+} ChatLog;
+
+static inline uint64_t chatlog_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void chatlog_stat_max(ChatLog *log, int index, long value) {
+    long cur = atomic_load_explicit(&log->stat[index], memory_order_relaxed);
+    while (value > cur &&
+           !atomic_compare_exchange_weak_explicit(&log->stat[index], &cur, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief fsync 정책 문자열 해석 ("none", "interval:<ms>", "records:<n>")
+ *
+ * @param text 정책 문자열
+ * @param sync 해석 결과 (출력)
+ * @return 성공 시 0, 형식이 잘못되면 -1
+ */
+int chatlog_parse_sync(const char *text, ChatLogSync *sync) {
+    if (strcmp(text, "none") == 0) {
+        sync->policy = CHATLOG_SYNC_NONE;
+        sync->every = 0;
+        return 0;
+    }
+    if (strncmp(text, "interval:", 9) == 0) {
+        sync->policy = CHATLOG_SYNC_INTERVAL;
+        sync->every = atol(text + 9);
+    } else if (strncmp(text, "records:", 8) == 0) {
+        sync->policy = CHATLOG_SYNC_RECORDS;
+        sync->every = atol(text + 8);
+    } else {
+        return -1;
+    }
+    return sync->every > 0 ? 0 : -1;
+}
+
+/**
+ * @brief when 이 속한 날짜의 로그 파일을 열고 다음 자정을 교체 시각으로 설정
+ */
+static void chatlog_open_file(ChatLog *log, time_t when) {
+    struct tm tm;
+
+    localtime_r(&when, &tm);
+    strftime(log->path, sizeof(log->path), log->path_format, &tm);
+
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_mday += 1;
+    tm.tm_isdst = -1;
+    log->rotate_at = mktime(&tm);
+
+    log->fd = open(log->path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (log->fd < 0) {
+        perror("로그 파일을 열 수 없습니다.");
+        log->rotate_at = when + CHATLOG_RETRY_SEC;  // 그동안의 레코드는 버림
+    }
+}
+
+/**
+ * @brief fsync 정책에 따라 파일을 디스크에 반영
+ *
+ * @param force 정책과 무관하게 반영할지 여부 (파일 교체/종료 시)
+ */
+static void chatlog_sync(ChatLog *log, int force) {
+    if (log->fd < 0 || log->unsynced == 0) {
+        return;
+    }
+
+    uint64_t now = chatlog_now_ns();
+    int due = force && log->sync.policy != CHATLOG_SYNC_NONE;
+    if (log->sync.policy == CHATLOG_SYNC_INTERVAL) {
+        due |= now - log->last_sync_ns >= (uint64_t)log->sync.every * 1000000ull;
+    } else if (log->sync.policy == CHATLOG_SYNC_RECORDS) {
+        due |= log->unsynced >= log->sync.every;
+    }
+    if (!due) {
+        return;
+    }
+
+    fdatasync(log->fd);
+    log->unsynced = 0;
+    log->last_sync_ns = now;
+    atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_FSYNCS], 1, memory_order_relaxed);
+}
+
+/**
+ * @brief iovec 들을 현재 로그 파일에 모두 기록 (writer 스레드 전용)
+ *
+ * 짧게 기록되면 남은 부분부터 이어 씁니다. flush_hook 에는 iovec 조각마다 기록된 부분을 넘깁니다.
+ *
+ * @param iov 기록할 iovec 배열 (이어 쓰면서 내용을 바꿈)
+ * @param iovcnt iovec 수
+ */
+static void chatlog_writev_all(ChatLog *log, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(log->fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("로그 기록 실패");
+            return;
+        }
+        // O_APPEND 라 다른 프로세스가 중간에 기록했을 수 있으므로 실제 위치를 확인
+        off_t end = log->flush_hook != NULL ? lseek(log->fd, 0, SEEK_CUR) : -1;
+        uint64_t offset = end >= n ? (uint64_t)(end - n) : 0;
+        size_t left = (size_t)n;
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            if (end >= n && iov->iov_len > 0) {
+                log->flush_hook(log->flush_ctx, log->path, offset, (const char *)iov->iov_base, iov->iov_len);
+            }
+            offset += iov->iov_len;
+            left -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (left > 0) {
+            if (end >= n) {
+                log->flush_hook(log->flush_ctx, log->path, offset, (const char *)iov->iov_base, left);
+            }
+            iov->iov_base = (char *)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+        atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_BYTES], n, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_WRITES], 1, memory_order_relaxed);
+}
+
+/**
+ * @brief 묶음 버퍼를 파일에 기록
+ */
+static void chatlog_flush_batch(ChatLog *log) {
+    if (log->batch_len > 0 && log->fd >= 0) {
+        struct iovec iov = { .iov_base = log->batch, .iov_len = log->batch_len };
+        chatlog_writev_all(log, &iov, 1);
+    }
+    log->batch_len = 0;
+}
+
+/**
+ * @brief 레코드 하나를 묶음 버퍼에 추가 (필요하면 파일 교체 및 버퍼 기록)
+ *
+ * @return 기록했으면 1, 파일이 없어 버렸으면 0
+ */
+static int chatlog_append(ChatLog *log, const char *text, size_t len, time_t when) {
+    if (when >= log->rotate_at) {
+        chatlog_flush_batch(log);
+        chatlog_sync(log, 1);
+        if (log->fd >= 0) {
+            close(log->fd);
+        }
+        chatlog_open_file(log, when);
+    }
+    if (log->fd < 0) {
+        return 0;
+    }
+
+    if (log->batch_len + len + 1 > CHATLOG_BATCH_SIZE) {
+        chatlog_flush_batch(log);
+    }
+    if (len + 1 > CHATLOG_BATCH_SIZE) {
+        // 버퍼보다 큰 레코드는 복사하지 않고 본문과 개행을 한 번에 기록
+        struct iovec iov[2] = {
+            { .iov_base = (void *)text, .iov_len = len },
+            { .iov_base = (void *)"\n", .iov_len = 1 },
+        };
+        chatlog_writev_all(log, iov, 2);
+    } else {
+        memcpy(log->batch + log->batch_len, text, len);
+        log->batch[log->batch_len + len] = '\n';
+        log->batch_len += len + 1;
+    }
+    log->unsynced++;
+    return 1;
+}
+
+/**
+ * @brief 큐에 쌓인 레코드를 모두 꺼내 묶음으로 기록 (writer 스레드 전용)
+ *
+ * @return 꺼낸 레코드 수
+ */
+static long chatlog_drain(ChatLog *log) {
+    long drained = 0;
+    ChatLogRecord *record;
+
+    // 비었거나 생산자가 아직 채우는 중인 칸에서 멈춤
+    while ((record = (ChatLogRecord *)mpsc_peek(&log->queue)) != NULL) {
+        long lag = (long)(chatlog_now_ns() - record->enqueued_ns);
+        atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_LAG_NS], lag, memory_order_relaxed);
+        chatlog_stat_max(log, CHATLOG_STAT_LAG_MAX, lag);
+
+        const char *text = record->heap != NULL ? record->heap : record->text;
+        int stat = chatlog_append(log, text, record->len, record->when) ? CHATLOG_STAT_WRITTEN : CHATLOG_STAT_DROPPED;
+        atomic_fetch_add_explicit(&log->stat[stat], 1, memory_order_relaxed);
+        free(record->heap);
+
+        mpsc_pop(&log->queue);
+        drained++;
+    }
+
+    chatlog_flush_batch(log);
+    return drained;
+}
+
+/**
+ * @brief writer 스레드
+ */
+static void *chatlog_writer(void *arg) {
+    ChatLog *log = (ChatLog *)arg;
+
+    while (1) {
+        int stopping = atomic_load(&log->stop);
+        long drained = chatlog_drain(log);
+        chatlog_sync(log, 0);
+        if (drained > 0) {
+            continue;
+        }
+        if (stopping) {
+            break;  // 종료 요청 이후 큐가 빈 것을 확인했으므로 남은 레코드 없음
+        }
+
+        long wait_ms = CHATLOG_IDLE_MS;
+        if (log->sync.policy == CHATLOG_SYNC_INTERVAL && log->sync.every < wait_ms) {
+            wait_ms = log->sync.every;
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += wait_ms / 1000;
+        deadline.tv_nsec += (wait_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        // 잠들기 전에 큐를 다시 확인해, 그 사이에 들어온 레코드의 깨우기 신호를 놓치지 않음
+        pthread_mutex_lock(&log->wake_lock);
+        atomic_store(&log->sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (mpsc_peek(&log->queue) == NULL && !atomic_load(&log->stop)) {
+            pthread_cond_timedwait(&log->wake, &log->wake_lock, &deadline);
+        }
+        atomic_store(&log->sleeping, 0);
+        pthread_mutex_unlock(&log->wake_lock);
+    }
+
+    chatlog_sync(log, 1);
+    return NULL;
+}
+
+/**
+ * @brief 로그를 열고 writer 스레드를 시작
+ *
+ * fork() 이후의 프로세스에서 호출해야 합니다 (스레드는 fork 되지 않음).
+ *
+ * @param log 초기화할 로그
+ * @param path_format 로그 파일 경로 (strftime 형식, 예: CHAT_LOG_PATH_FORMAT)
+ * @param sync fsync 정책
+ * @return 성공 시 0, 실패 시 -1
+ */
+int chatlog_open(ChatLog *log, const char *path_format, ChatLogSync sync) {
+    memset(log, 0, sizeof(*log));
+    log->batch = (char *)malloc(CHATLOG_BATCH_SIZE);
+    if (log->batch == NULL || mpsc_init(&log->queue, CHATLOG_CAPACITY, sizeof(ChatLogRecord)) < 0) {
+        free(log->batch);
+        return -1;
+    }
+    snprintf(log->path_format, sizeof(log->path_format), "%s", path_format);
+    log->sync = sync;
+    log->fd = -1;
+    log->last_sync_ns = chatlog_now_ns();
+    pthread_mutex_init(&log->wake_lock, NULL);
+    pthread_cond_init(&log->wake, NULL);
+
+    if (pthread_create(&log->writer, NULL, chatlog_writer, log) != 0) {
+        mpsc_destroy(&log->queue);
+        free(log->batch);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 기록 직후 호출할 함수를 설정 (예: 검색 색인 갱신)
+ *
+ * 첫 chatlog_write() 이전에, 로그를 기록할 스레드들을 만들기 전에 호출해야 합니다.
+ *
+ * @param log 대상 로그
+ * @param hook 호출할 함수
+ * @param ctx hook 인자
+ */
+void chatlog_set_flush_hook(ChatLog *log, ChatLogFlushHook hook, void *ctx) {
+    log->flush_ctx = ctx;
+    log->flush_hook = hook;
+}
+
+/**
+ * @brief 레코드 하나를 기록 요청 (블로킹하지 않음)
+ *
+ * 큐가 가득 차면 기다리지 않고 레코드를 버리며 dropped 지표를 올립니다.
+ * 여러 스레드가 동시에 호출할 수 있습니다.
+ *
+ * @param log 대상 로그
+ * @param text 레코드 본문 (개행 제외)
+ * @param len 본문 길이
+ * @return 성공 시 0, 버렸으면 -1
+ */
+int chatlog_write(ChatLog *log, const char *text, size_t len) {
+    if (log->queue.slots == NULL) {
+        return -1;  // 열지 않았거나 이미 닫힌 로그
+    }
+
+    uint64_t start = chatlog_now_ns();
+    size_t ticket;
+    ChatLogRecord *record = (ChatLogRecord *)mpsc_reserve(&log->queue, &ticket);
+    if (record == NULL) {
+        atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_DROPPED], 1, memory_order_relaxed);
+        return -1;  // 가득 참
+    }
+
+    record->heap = NULL;
+    if (len > CHATLOG_INLINE_MAX) {
+        record->heap = (char *)malloc(len);
+        if (record->heap == NULL) {
+            len = CHATLOG_INLINE_MAX;  // 메모리가 없으면 잘라서라도 기록
+        }
+    }
+    memcpy(record->heap != NULL ? record->heap : record->text, text, len);
+    record->len = (uint32_t)len;
+    record->when = time(NULL);
+    record->enqueued_ns = start;
+
+    // 게시와 sleeping 확인 사이의 울타리가 writer 의 잠들기 직전 확인과 짝을 이뤄 깨우기를 놓치지 않게 함
+    mpsc_publish(&log->queue, ticket);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&log->sleeping, memory_order_relaxed)) {
+        pthread_mutex_lock(&log->wake_lock);
+        pthread_cond_signal(&log->wake);
+        pthread_mutex_unlock(&log->wake_lock);
+    }
+
+    long elapsed = (long)(chatlog_now_ns() - start);
+    atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_ENQUEUED], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log->stat[CHATLOG_STAT_ENQUEUE_NS], elapsed, memory_order_relaxed);
+    chatlog_stat_max(log, CHATLOG_STAT_ENQUEUE_MAX, elapsed);
+    return 0;
+}
+
+/**
+ * @brief 지표 스냅샷
+ *
+ * @param log 대상 로그
+ * @param stats 스냅샷 (출력)
+ */
+void chatlog_get_stats(ChatLog *log, ChatLogStats *stats) {
+    stats->enqueued = atomic_load(&log->stat[CHATLOG_STAT_ENQUEUED]);
+    stats->dropped = atomic_load(&log->stat[CHATLOG_STAT_DROPPED]);
+    stats->written = atomic_load(&log->stat[CHATLOG_STAT_WRITTEN]);
+    stats->bytes = atomic_load(&log->stat[CHATLOG_STAT_BYTES]);
+    stats->writes = atomic_load(&log->stat[CHATLOG_STAT_WRITES]);
+    stats->fsyncs = atomic_load(&log->stat[CHATLOG_STAT_FSYNCS]);
+    stats->enqueue_ns_total = atomic_load(&log->stat[CHATLOG_STAT_ENQUEUE_NS]);
+    stats->enqueue_ns_max = atomic_load(&log->stat[CHATLOG_STAT_ENQUEUE_MAX]);
+    stats->lag_ns_total = atomic_load(&log->stat[CHATLOG_STAT_LAG_NS]);
+    stats->lag_ns_max = atomic_load(&log->stat[CHATLOG_STAT_LAG_MAX]);
+}
+
+/**
+ * @brief 남은 레코드를 모두 기록하고 writer 스레드를 종료
+ *
+ * @param log 대상 로그
+ */
+void chatlog_close(ChatLog *log) {
+    if (log->queue.slots == NULL) {
+        return;
+    }
+
+    atomic_store(&log->stop, 1);
+    pthread_mutex_lock(&log->wake_lock);
+    pthread_cond_signal(&log->wake);
+    pthread_mutex_unlock(&log->wake_lock);
+    pthread_join(log->writer, NULL);
+
+    if (log->fd >= 0) {
+        close(log->fd);
+    }
+    mpsc_destroy(&log->queue);
+    free(log->batch);
+    log->batch = NULL;
+    pthread_mutex_destroy(&log->wake_lock);
+    pthread_cond_destroy(&log->wake);
+}
@@ -0,0 +1,311 @@
+#pragma once
+/**
+ * @file conn_table.h
+ * @brief 세대(generation) 태그 핸들로 접근하는 확장 가능한 연결 테이블
+ *
+ * 슬롯은 고정 크기 청크 단위로 할당되어 주소가 바뀌지 않으므로, 슬롯 포인터를 연결 수명 동안
+ * 보관해도 안전합니다. 삽입/삭제/조회는 모두 O(1) 입니다.
+ *
+ * 삽입/삭제는 뮤텍스로 직렬화하고, 조회와 순회는 잠금을 잡지 않습니다. 슬롯의 세대 값을 시퀀스
+ * 잠금처럼 사용해, 값을 복사한 앞뒤로 세대가 같을 때만 유효한 값으로 봅니다. 값이 가리키는 객체의
+ * 수명은 호출자가 epoch.h 의 읽기 구역으로 보호합니다. 순회는 살아 있는 항목이 없는 청크를 건너뜁니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define CONN_TABLE_CHUNK_SHIFT 10                            ///< 청크당 슬롯 수 = 1024
+#define CONN_TABLE_CHUNK_SIZE (1u << CONN_TABLE_CHUNK_SHIFT)
+#define CONN_TABLE_MAX_CHUNKS 4096                           ///< 최대 약 400만 슬롯
+#define CONN_GEN_MASK 0x0fffffffu                            ///< 세대 값은 28비트 (상위 비트는 태그용으로 남김)
+#define CONN_HANDLE_INVALID 0                                ///< 유효하지 않은 핸들
+
+/**
+ * @brief 연결 핸들 = (세대 << 32) | 슬롯 인덱스
+ *
+ * 슬롯이 재사용되면 세대가 바뀌므로, 이미 닫힌 연결의 핸들로는 새 연결에 접근할 수 없습니다.
+ */
+typedef uint64_t ConnHandle;
+
+/**
+ * @struct ConnSlotHeader
+ * @brief 슬롯 헤더 (값은 헤더 바로 뒤에 위치)
+ */
+typedef struct {
+    _Atomic uint32_t generation;   ///< 현재 세대 (0 이면 비어 있음, 값을 채운 뒤 release 로 기록)
+    uint32_t link;                 ///< 비어 있으면 다음 빈 슬롯 인덱스 + 1 (쓰는 쪽만 사용)
+} ConnSlotHeader;
+
+/**
+ * @struct ConnTable
+ * @brief 연결 테이블
+ */
+typedef struct {
+    char **chunks;                 ///< 청크 디렉터리 (청크 포인터 배열, 크기 고정)
+    _Atomic uint32_t num_chunks;   ///< 할당된 청크 수 (청크 포인터를 채운 뒤 release 로 늘림)
+    _Atomic uint32_t *chunk_live;  ///< 청크별 살아 있는 슬롯 수 (순회 시 빈 청크 건너뜀)
+    size_t value_size;             ///< 슬롯에 저장할 값 크기
+    size_t stride;                 ///< 슬롯 하나의 바이트 크기 (헤더 + 값, 8바이트 정렬)
+    uint32_t free_head;            ///< 빈 슬롯 리스트 head (인덱스 + 1, 0 이면 없음)
+    _Atomic uint32_t live_count;   ///< 살아 있는 슬롯 수
+    uint32_t next_generation;      ///< 다음에 부여할 세대
+    pthread_mutex_t lock;          ///< 삽입/삭제 직렬화 (조회/순회는 잠금 없음)
+} ConnTable;
+
+/**
+ * @brief 연결 테이블 초기화
+ *
+ * @param table 초기화할 테이블
+ * @param value_size 슬롯마다 저장할 값의 크기
+ * @return 성공 시 0, 실패 시 -1
+ */
+int conn_table_init(ConnTable *table, size_t value_size) {
+    memset(table, 0, sizeof(*table));
+    table->chunks = (char **)calloc(CONN_TABLE_MAX_CHUNKS, sizeof(char *));
+    table->chunk_live = (_Atomic uint32_t *)calloc(CONN_TABLE_MAX_CHUNKS, sizeof(uint32_t));
+    if (table->chunks == NULL || table->chunk_live == NULL) {
+        free(table->chunks);
+        free((void *)table->chunk_live);
+        return -1;
+    }
+    table->value_size = value_size;
+    table->stride = (sizeof(ConnSlotHeader) + value_size + 7) & ~(size_t)7;
+    table->next_generation = 1;
+    pthread_mutex_init(&table->lock, NULL);
+    return 0;
+}
+
+static inline ConnSlotHeader *conn_table_slot(ConnTable *table, uint32_t index) {
+    char *chunk = table->chunks[index >> CONN_TABLE_CHUNK_SHIFT];
+    return (ConnSlotHeader *)(chunk + (size_t)(index & (CONN_TABLE_CHUNK_SIZE - 1)) * table->stride);
+}
+
+static inline void *conn_table_slot_value(ConnSlotHeader *slot) {
+    return (void *)(slot + 1);
+}
+
+static inline ConnHandle conn_handle_make(uint32_t generation, uint32_t index) {
+    return ((ConnHandle)generation << 32) | index;
+}
+
+static inline uint32_t conn_handle_index(ConnHandle handle) {
+    return (uint32_t)handle;
+}
+
+static inline uint32_t conn_handle_generation(ConnHandle handle) {
+    return (uint32_t)(handle >> 32);
+}
+
+/**
+ * @brief 새 청크를 할당해 빈 슬롯 리스트에 연결 (잠금 상태에서 호출)
+ */
+static int conn_table_grow(ConnTable *table) {
+    uint32_t num_chunks = atomic_load_explicit(&table->num_chunks, memory_order_relaxed);
+    if (num_chunks >= CONN_TABLE_MAX_CHUNKS) {
+        return -1;
+    }
+
+    char *chunk = (char *)calloc(CONN_TABLE_CHUNK_SIZE, table->stride);
+    if (chunk == NULL) {
+        return -1;
+    }
+
+    uint32_t base = num_chunks << CONN_TABLE_CHUNK_SHIFT;
+    table->chunks[num_chunks] = chunk;
+    atomic_store_explicit(&table->num_chunks, num_chunks + 1, memory_order_release);
+
+    // 앞쪽 인덱스부터 재사용되도록 역순으로 연결
+    for (uint32_t i = CONN_TABLE_CHUNK_SIZE; i > 0; i--) {
+        ConnSlotHeader *slot = conn_table_slot(table, base + i - 1);
+        slot->link = table->free_head;
+        table->free_head = base + i;
+    }
+    return 0;
+}
+
+/**
+ * @brief 값을 테이블에 삽입
+ *
+ * @param table 대상 테이블
+ * @param value 복사할 값 (value_size 바이트)
+ * @param out_value 슬롯 안의 값 위치 (연결이 제거될 때까지 주소가 유지됨, NULL 가능)
+ * @return 새 핸들, 실패 시 CONN_HANDLE_INVALID
+ */
+ConnHandle conn_table_insert(ConnTable *table, const void *value, void **out_value) {
+    pthread_mutex_lock(&table->lock);
+
+    if (table->free_head == 0 && conn_table_grow(table) < 0) {
+        pthread_mutex_unlock(&table->lock);
+        return CONN_HANDLE_INVALID;
+    }
+
+    uint32_t index = table->free_head - 1;
+    ConnSlotHeader *slot = conn_table_slot(table, index);
+    table->free_head = slot->link;
+
+    uint32_t generation = table->next_generation;
+    table->next_generation = (table->next_generation + 1) & CONN_GEN_MASK;
+    if (table->next_generation == 0) {
+        table->next_generation = 1;
+    }
+
+    // 세대 0 을 기록한 뒤에 값을 덮어써야, 이전 값을 복사하던 쪽이 세대 변화로 알아챔
+    atomic_thread_fence(memory_order_release);
+    memcpy(conn_table_slot_value(slot), value, table->value_size);
+    atomic_store_explicit(&slot->generation, generation, memory_order_release);
+    atomic_fetch_add_explicit(&table->chunk_live[index >> CONN_TABLE_CHUNK_SHIFT], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&table->live_count, 1, memory_order_relaxed);
+
+    if (out_value != NULL) {
+        *out_value = conn_table_slot_value(slot);
+    }
+    pthread_mutex_unlock(&table->lock);
+    return conn_handle_make(generation, index);
+}
+
+/**
+ * @brief 핸들에 해당하는 항목을 제거
+ *
+ * 제거 직후에도 읽기 구역 안에서 복사해 둔 값은 그대로 쓸 수 있으며, 값이 가리키는 객체의 해제는
+ * 호출자가 epoch_retire() 로 미뤄야 합니다.
+ *
+ * @param table 대상 테이블
+ * @param handle 제거할 핸들
+ * @return 제거했으면 0, 이미 없으면 -1
+ */
+int conn_table_remove(ConnTable *table, ConnHandle handle) {
+    uint32_t index = conn_handle_index(handle);
+
+    pthread_mutex_lock(&table->lock);
+    if ((index >> CONN_TABLE_CHUNK_SHIFT) >= atomic_load_explicit(&table->num_chunks, memory_order_relaxed)) {
+        pthread_mutex_unlock(&table->lock);
+        return -1;
+    }
+
+    ConnSlotHeader *slot = conn_table_slot(table, index);
+    uint32_t generation = atomic_load_explicit(&slot->generation, memory_order_relaxed);
+    if (generation == 0 || generation != conn_handle_generation(handle)) {
+        pthread_mutex_unlock(&table->lock);
+        return -1;
+    }
+
+    atomic_store_explicit(&slot->generation, 0, memory_order_release);
+    atomic_fetch_sub_explicit(&table->chunk_live[index >> CONN_TABLE_CHUNK_SHIFT], 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&table->live_count, 1, memory_order_relaxed);
+    slot->link = table->free_head;
+    table->free_head = index + 1;
+    pthread_mutex_unlock(&table->lock);
+    return 0;
+}
+
+/**
+ * @brief 슬롯 값을 잠금 없이 복사 (세대가 복사 앞뒤로 같을 때만 성공)
+ *
+ * @return 복사한 값의 세대, 비어 있거나 복사 도중 바뀌었으면 0
+ */
+static uint32_t conn_table_read_slot(ConnTable *table, ConnSlotHeader *slot, void *out) {
+    uint32_t generation = atomic_load_explicit(&slot->generation, memory_order_acquire);
+    if (generation == 0) {
+        return 0;
+    }
+    memcpy(out, conn_table_slot_value(slot), table->value_size);
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->generation, memory_order_relaxed) == generation ? generation : 0;
+}
+
+/**
+ * @brief 핸들로 값을 잠금 없이 복사
+ *
+ * 다른 스레드가 동시에 제거해도 안전하며, 제거 전의 값이나 실패 중 하나를 돌려줍니다.
+ *
+ * @param table 대상 테이블
+ * @param handle 조회할 핸들
+ * @param out 값을 복사할 곳 (value_size 바이트)
+ * @return 성공 시 0, 이미 제거되었거나 재사용된 슬롯이면 -1
+ */
+int conn_table_read(ConnTable *table, ConnHandle handle, void *out) {
+    uint32_t index = conn_handle_index(handle);
+
+    if ((index >> CONN_TABLE_CHUNK_SHIFT) >= atomic_load_explicit(&table->num_chunks, memory_order_acquire)) {
+        return -1;
+    }
+    uint32_t generation = conn_table_read_slot(table, conn_table_slot(table, index), out);
+    return generation != 0 && generation == conn_handle_generation(handle) ? 0 : -1;
+}
+
+/**
+ * @brief 핸들로 슬롯 안의 값 위치를 조회
+ *
+ * 값 위치를 돌려주므로, 그 항목을 제거할 수 있는 스레드(연결을 소유한 스레드)에서만 사용합니다.
+ * 다른 스레드는 conn_table_read() 로 값을 복사합니다.
+ *
+ * @param table 대상 테이블
+ * @param handle 조회할 핸들
+ * @return 슬롯 안의 값, 이미 제거되었거나 재사용된 슬롯이면 NULL
+ */
+void *conn_table_get(ConnTable *table, ConnHandle handle) {
+    uint32_t index = conn_handle_index(handle);
+
+    if ((index >> CONN_TABLE_CHUNK_SHIFT) >= atomic_load_explicit(&table->num_chunks, memory_order_acquire)) {
+        return NULL;
+    }
+    ConnSlotHeader *slot = conn_table_slot(table, index);
+    if (atomic_load_explicit(&slot->generation, memory_order_acquire) != conn_handle_generation(handle)) {
+        return NULL;
+    }
+    return conn_table_slot_value(slot);
+}
+
+/**
+ * @brief 살아 있는 다음 항목을 잠금 없이 복사 (순회)
+ *
+ * cursor 를 0 으로 시작해 0 을 돌려줄 때까지 반복합니다. 순회 내내 테이블에 있던 항목은 정확히
+ * 한 번 나오고, 순회 도중 삽입/제거된 항목은 나올 수도 안 나올 수도 있습니다.
+ *
+ * @param table 대상 테이블
+ * @param cursor 순회 위치 (다음 슬롯 인덱스)
+ * @param out 값을 복사할 곳 (value_size 바이트)
+ * @return 항목을 복사했으면 1, 끝이면 0
+ */
+int conn_table_next(ConnTable *table, uint32_t *cursor, void *out) {
+    uint32_t num_chunks = atomic_load_explicit(&table->num_chunks, memory_order_acquire);
+
+    for (uint32_t index = *cursor; (index >> CONN_TABLE_CHUNK_SHIFT) < num_chunks; index++) {
+        uint32_t chunk = index >> CONN_TABLE_CHUNK_SHIFT;
+        if ((index & (CONN_TABLE_CHUNK_SIZE - 1)) == 0 &&
+            atomic_load_explicit(&table->chunk_live[chunk], memory_order_relaxed) == 0) {
+            index += CONN_TABLE_CHUNK_SIZE - 1;  // 빈 청크는 통째로 건너뜀
+            continue;
+        }
+        if (conn_table_read_slot(table, conn_table_slot(table, index), out) != 0) {
+            *cursor = index + 1;
+            return 1;
+        }
+    }
+    *cursor = num_chunks << CONN_TABLE_CHUNK_SHIFT;
+    return 0;
+}
+
+/**
+ * @brief 살아 있는 항목 수 (읽는 즉시 바뀔 수 있음)
+ */
+uint32_t conn_table_count(ConnTable *table) {
+    return atomic_load_explicit(&table->live_count, memory_order_relaxed);
+}
+
+/**
+ * @brief 테이블이 사용한 메모리를 해제 (저장된 값 자체는 호출자가 정리)
+ */
+void conn_table_destroy(ConnTable *table) {
+    uint32_t num_chunks = atomic_load(&table->num_chunks);
+    for (uint32_t i = 0; i < num_chunks; i++) {
+        free(table->chunks[i]);
+    }
+    free(table->chunks);
+    free((void *)table->chunk_live);
+    pthread_mutex_destroy(&table->lock);
+}
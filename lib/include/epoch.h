@@ -0,0 +1,350 @@
+#pragma once
+/**
+ * @file epoch.h
+ * @brief 세대(epoch) 기반 메모리 회수 (RCU 방식)
+ *
+ * 읽는 쪽은 epoch_enter() 와 epoch_exit() 사이(읽기 구역)에서 잠금 없이 공유 자료구조를 따라가고,
+ * 쓰는 쪽은 항목을 자료구조에서 떼어 낸 뒤 epoch_retire() 로 해제를 미룹니다.
+ *
+ * 전역 세대는 읽기 구역 안의 모든 스레드가 현재 세대를 본 뒤에만 1 증가합니다. 그래서 떼어 낸 시점의
+ * 세대보다 전역 세대가 2 이상 앞서면, 떼어 내기 전에 그 항목을 봤을 수 있는 읽기 구역은 모두 끝난
+ * 것입니다(유예 기간). 회수는 백그라운드 회수 스레드가 주기적으로 모아서 처리하므로 읽는 쪽과
+ * 떼어 내는 쪽 모두 해제 비용을 치르지 않습니다.
+ *
+ * 읽기 구역은 중첩할 수 있고, 그 안에서 잠금을 잡거나 소켓에 쓰는 것은 괜찮지만 오래 막히면
+ * 그동안 회수가 멈춥니다. 스레드 기록은 처음 읽기 구역에 들어갈 때 등록되고, 스레드가 끝나면
+ * 다음 스레드가 재사용합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define EPOCH_RECLAIM_INTERVAL_MS 10   ///< 회수 스레드가 세대를 올리고 회수를 시도하는 주기
+#define EPOCH_CACHE_LINE 64            ///< 스레드 기록 정렬 단위 (기록마다 캐시 라인을 따로 씀)
+
+struct EpochDomain;
+
+/**
+ * @struct EpochRecord
+ * @brief 스레드마다 하나씩 두는 읽기 구역 상태
+ */
+typedef struct EpochRecord {
+    _Alignas(EPOCH_CACHE_LINE) _Atomic uint64_t state;  ///< 읽기 구역 밖이면 0, 안이면 (세대 << 1) | 1
+    _Atomic int in_use;                                   ///< 스레드가 사용 중인지 (끝난 스레드의 기록은 재사용)
+    uint32_t depth;                                       ///< 읽기 구역 중첩 깊이 (소유 스레드만 사용)
+    struct EpochDomain *domain;                           ///< 소속 도메인
+    struct EpochRecord *next;                             ///< 등록 목록 (추가만 하고 제거하지 않음)
+} EpochRecord;
+
+/**
+ * @struct EpochRetired
+ * @brief 유예 기간이 지나기를 기다리는 항목
+ */
+typedef struct EpochRetired {
+    struct EpochRetired *next;    ///< 다음 항목
+    void (*reclaim)(void *ptr);   ///< 유예 기간 뒤에 호출할 해제 함수
+    void *ptr;                    ///< 해제할 객체
+    uint64_t epoch;               ///< 떼어 낸 시점의 전역 세대
+} EpochRetired;
+
+/**
+ * @struct EpochDomain
+ * @brief 세대 기반 회수 도메인 (같은 도메인의 읽기 구역끼리 유예 기간을 공유)
+ */
+typedef struct EpochDomain {
+    _Alignas(EPOCH_CACHE_LINE) _Atomic uint64_t global;   ///< 전역 세대
+    _Alignas(EPOCH_CACHE_LINE) _Atomic(EpochRetired *) retired;  ///< 새로 떼어 낸 항목 (잠금 없는 스택)
+    _Atomic(EpochRecord *) records;   ///< 스레드 기록 목록
+    pthread_key_t key;                ///< 스레드별 기록 (스레드 종료 시 반납)
+    pthread_mutex_t collect_lock;     ///< pending 보호 (회수 스레드와 epoch_barrier())
+    EpochRetired *pending;            ///< 아직 유예 기간이 지나지 않은 항목
+    pthread_t reclaimer;              ///< 회수 스레드
+    atomic_bool running;              ///< 회수 스레드 실행 여부
+    atomic_long retired_count;        ///< 누적 해제 요청 수
+    atomic_long reclaimed_count;      ///< 누적 해제 수
+    atomic_long advances;             ///< 세대 증가 횟수
+} EpochDomain;
+
+// 대부분의 프로그램은 도메인을 하나만 쓰므로 마지막으로 쓴 도메인의 기록을 스레드 지역 변수에 캐시
+static __thread EpochRecord *epoch_tls_record;
+
+/**
+ * @brief 스레드가 끝날 때 기록을 반납 (pthread 키 소멸자)
+ */
+static void epoch_thread_exit(void *arg) {
+    EpochRecord *record = (EpochRecord *)arg;
+
+    record->depth = 0;
+    atomic_store_explicit(&record->state, 0, memory_order_release);
+    atomic_store_explicit(&record->in_use, 0, memory_order_release);
+}
+
+/**
+ * @brief 도메인 초기화 (회수 스레드는 epoch_start_reclaimer() 로 따로 시작)
+ *
+ * @param domain 초기화할 도메인
+ * @return 성공 시 0, 실패 시 -1
+ */
+int epoch_domain_init(EpochDomain *domain) {
+    memset(domain, 0, sizeof(*domain));
+    atomic_init(&domain->global, 1);
+    if (pthread_key_create(&domain->key, epoch_thread_exit) != 0) {
+        return -1;
+    }
+    pthread_mutex_init(&domain->collect_lock, NULL);
+    return 0;
+}
+
+/**
+ * @brief 현재 스레드의 기록을 등록 (끝난 스레드가 남긴 기록이 있으면 재사용)
+ */
+static EpochRecord *epoch_register(EpochDomain *domain) {
+    EpochRecord *record;
+
+    for (record = atomic_load_explicit(&domain->records, memory_order_acquire); record != NULL; record = record->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&record->in_use, &expected, 1)) {
+            break;
+        }
+    }
+    if (record == NULL) {
+        record = (EpochRecord *)aligned_alloc(EPOCH_CACHE_LINE, sizeof(EpochRecord));
+        if (record == NULL) {
+            perror("epoch record");
+            abort();  // 읽기 구역을 보호할 수 없으면 계속할 수 없음
+        }
+        memset(record, 0, sizeof(*record));
+        atomic_init(&record->in_use, 1);
+        record->domain = domain;
+        record->next = atomic_load_explicit(&domain->records, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&domain->records, &record->next, record,
+                                                      memory_order_release, memory_order_relaxed)) {
+        }
+    }
+    record->depth = 0;
+    atomic_store_explicit(&record->state, 0, memory_order_relaxed);
+    pthread_setspecific(domain->key, record);
+    return record;
+}
+
+/**
+ * @brief 현재 스레드의 기록
+ */
+static inline EpochRecord *epoch_thread_record(EpochDomain *domain) {
+    EpochRecord *record = epoch_tls_record;
+
+    if (record == NULL || record->domain != domain) {
+        record = (EpochRecord *)pthread_getspecific(domain->key);
+        if (record == NULL) {
+            record = epoch_register(domain);
+        }
+        epoch_tls_record = record;
+    }
+    return record;
+}
+
+/**
+ * @brief 읽기 구역에 들어감
+ *
+ * 이후 epoch_exit() 까지 읽은 공유 포인터는 epoch_retire() 되더라도 해제되지 않습니다.
+ *
+ * @param domain 도메인
+ */
+static inline void epoch_enter(EpochDomain *domain) {
+    EpochRecord *record = epoch_thread_record(domain);
+
+    if (record->depth++ == 0) {
+        uint64_t global = atomic_load_explicit(&domain->global, memory_order_relaxed);
+        atomic_store_explicit(&record->state, (global << 1) | 1, memory_order_relaxed);
+        // 상태 기록이 이후의 공유 포인터 읽기보다 먼저 보이도록
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+}
+
+/**
+ * @brief 읽기 구역에서 나옴
+ *
+ * @param domain 도메인
+ */
+static inline void epoch_exit(EpochDomain *domain) {
+    EpochRecord *record = epoch_thread_record(domain);
+
+    if (--record->depth == 0) {
+        atomic_store_explicit(&record->state, 0, memory_order_release);
+    }
+}
+
+/**
+ * @brief 자료구조에서 떼어 낸 객체의 해제를 유예 기간 뒤로 미룸
+ *
+ * 객체는 이미 새 읽기 구역이 찾을 수 없는 상태여야 합니다. 읽기 구역 안에서도 부를 수 있습니다.
+ *
+ * @param domain 도메인
+ * @param ptr 해제할 객체
+ * @param reclaim 유예 기간 뒤에 회수 스레드가 호출할 해제 함수
+ */
+void epoch_retire(EpochDomain *domain, void *ptr, void (*reclaim)(void *)) {
+    EpochRetired *node = (EpochRetired *)malloc(sizeof(EpochRetired));
+
+    if (node == NULL) {
+        perror("epoch retire");
+        abort();  // 바로 해제하면 읽는 쪽이 해제된 메모리를 볼 수 있음
+    }
+    node->reclaim = reclaim;
+    node->ptr = ptr;
+    // 떼어 낸 기록이 세대 읽기보다 먼저 보이도록
+    atomic_thread_fence(memory_order_seq_cst);
+    node->epoch = atomic_load_explicit(&domain->global, memory_order_relaxed);
+    node->next = atomic_load_explicit(&domain->retired, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&domain->retired, &node->next, node,
+                                                  memory_order_release, memory_order_relaxed)) {
+    }
+    atomic_fetch_add_explicit(&domain->retired_count, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief 읽기 구역 안의 모든 스레드가 현재 세대를 봤으면 전역 세대를 1 올림
+ *
+ * @return 현재 전역 세대
+ */
+static uint64_t epoch_try_advance(EpochDomain *domain) {
+    uint64_t global = atomic_load_explicit(&domain->global, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    for (EpochRecord *record = atomic_load_explicit(&domain->records, memory_order_acquire); record != NULL;
+         record = record->next) {
+        uint64_t state = atomic_load_explicit(&record->state, memory_order_relaxed);
+        if ((state & 1) && (state >> 1) != global) {
+            return global;  // 이전 세대에 머무는 읽기 구역이 있음
+        }
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_compare_exchange_strong(&domain->global, &global, global + 1)) {
+        atomic_fetch_add_explicit(&domain->advances, 1, memory_order_relaxed);
+        return global + 1;
+    }
+    return global;  // 다른 스레드가 먼저 올림
+}
+
+/**
+ * @brief 세대를 올려 보고, 유예 기간이 지난 항목을 해제
+ *
+ * 회수 스레드가 주기적으로 호출하며, 읽기 구역 안에서 호출해도 되지만 그 구역이 세대를 붙잡습니다.
+ *
+ * @param domain 도메인
+ * @return 아직 유예 기간을 기다리는 항목 수
+ */
+long epoch_collect(EpochDomain *domain) {
+    long waiting = 0;
+
+    pthread_mutex_lock(&domain->collect_lock);
+    uint64_t global = epoch_try_advance(domain);
+
+    // 새로 떼어 낸 항목을 대기 목록으로 옮김
+    EpochRetired *node = atomic_exchange_explicit(&domain->retired, NULL, memory_order_acquire);
+    while (node != NULL) {
+        EpochRetired *next = node->next;
+        node->next = domain->pending;
+        domain->pending = node;
+        node = next;
+    }
+
+    EpochRetired **link = &domain->pending;
+    while ((node = *link) != NULL) {
+        if (node->epoch + 2 <= global) {
+            *link = node->next;
+            node->reclaim(node->ptr);
+            free(node);
+            atomic_fetch_add_explicit(&domain->reclaimed_count, 1, memory_order_relaxed);
+        } else {
+            link = &node->next;
+            waiting++;
+        }
+    }
+    pthread_mutex_unlock(&domain->collect_lock);
+    return waiting;
+}
+
+/**
+ * @brief 지금까지 떼어 낸 항목이 모두 해제될 때까지 기다림
+ *
+ * 읽기 구역 밖에서만 호출합니다 (자기 구역이 세대를 붙잡아 끝나지 않음).
+ *
+ * @param domain 도메인
+ */
+void epoch_barrier(EpochDomain *domain) {
+    while (epoch_collect(domain) > 0 || atomic_load_explicit(&domain->retired, memory_order_acquire) != NULL) {
+        sched_yield();
+    }
+}
+
+/**
+ * @brief 회수 스레드 본체
+ */
+static void *epoch_reclaimer(void *arg) {
+    EpochDomain *domain = (EpochDomain *)arg;
+    struct timespec interval = { 0, EPOCH_RECLAIM_INTERVAL_MS * 1000000L };
+
+    while (atomic_load(&domain->running)) {
+        epoch_collect(domain);
+        nanosleep(&interval, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 백그라운드 회수 스레드를 시작
+ *
+ * @param domain 도메인
+ * @return 성공 시 0, 실패 시 -1
+ */
+int epoch_start_reclaimer(EpochDomain *domain) {
+    atomic_store(&domain->running, true);
+    if (pthread_create(&domain->reclaimer, NULL, epoch_reclaimer, domain) != 0) {
+        atomic_store(&domain->running, false);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 유예 기간을 기다리는 항목 수 (진단용, 읽는 즉시 바뀔 수 있음)
+ */
+long epoch_pending(EpochDomain *domain) {
+    return atomic_load_explicit(&domain->retired_count, memory_order_relaxed) -
+           atomic_load_explicit(&domain->reclaimed_count, memory_order_relaxed);
+}
+
+/**
+ * @brief 회수 스레드를 멈추고 남은 항목을 모두 해제한 뒤 도메인을 정리
+ *
+ * 모든 스레드가 읽기 구역 밖에 있고 더 이상 도메인을 쓰지 않을 때 호출합니다.
+ *
+ * @param domain 도메인
+ */
+void epoch_domain_destroy(EpochDomain *domain) {
+    if (atomic_exchange(&domain->running, false)) {
+        pthread_join(domain->reclaimer, NULL);
+    }
+    epoch_barrier(domain);
+
+    EpochRecord *record = atomic_load(&domain->records);
+    while (record != NULL) {
+        EpochRecord *next = record->next;
+        if (epoch_tls_record == record) {
+            epoch_tls_record = NULL;
+        }
+        free(record);
+        record = next;
+    }
+    pthread_setspecific(domain->key, NULL);
+    pthread_key_delete(domain->key);
+    pthread_mutex_destroy(&domain->collect_lock);
+}
@@ -0,0 +1,275 @@
+#pragma once
+/**
+ * @file intern.h
+ * @brief 같은 문자열을 한 번만 저장하고 짧은 정수 핸들로 가리키는 인터닝 테이블
+ *
+ * 항목은 참조 수를 가지며, 마지막 참조가 반납되면 문자열을 해제하고 핸들을 재사용합니다.
+ * 항목 배열은 고정 크기 청크 단위로 할당되어 주소가 바뀌지 않으므로, 참조를 가진 쪽은
+ * intern_str() 로 잠금 없이 문자열을 읽을 수 있습니다. 등록/반납/검색은 잠금으로 직렬화합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#define INTERN_CHUNK_SHIFT 10                           ///< 청크당 항목 수 = 1024
+#define INTERN_CHUNK_SIZE (1u << INTERN_CHUNK_SHIFT)
+#define INTERN_MAX_CHUNKS 4096                          ///< 최대 약 400만 항목
+#define INTERN_INDEX_INITIAL 64                         ///< 해시 인덱스 초기 크기 (2의 거듭제곱)
+#define INTERN_NONE 0u                                  ///< 빈 핸들 (유효한 핸들은 1부터)
+#define INTERN_TOMBSTONE UINT32_MAX                     ///< 해시 인덱스의 삭제 표시
+
+typedef uint32_t InternId;
+
+/**
+ * @struct InternEntry
+ * @brief 인터닝된 문자열 하나
+ */
+typedef struct {
+    char *str;            ///< NUL 로 끝나는 문자열 (참조가 남아 있는 동안 주소 고정)
+    uint32_t len;         ///< 문자열 길이
+    uint32_t hash;        ///< FNV-1a 해시
+    uint32_t refs;        ///< 참조 수 (0 이면 빈 항목)
+    InternId next_free;   ///< 빈 항목 목록의 다음 핸들
+} InternEntry;
+
+/**
+ * @struct InternTable
+ * @brief 문자열 인터닝 테이블
+ */
+typedef struct {
+    InternEntry *chunks[INTERN_MAX_CHUNKS];  ///< 항목 청크 (핸들 = 청크 번호 << SHIFT | 위치)
+    uint32_t entry_count;                    ///< 한 번이라도 사용한 핸들 수 (0 번은 INTERN_NONE)
+    InternId free_head;                      ///< 재사용할 핸들 목록
+    InternId *index;                         ///< 선형 탐사 해시 인덱스 (빈 칸은 INTERN_NONE)
+    uint32_t index_capacity;                 ///< 해시 인덱스 크기 (2의 거듭제곱)
+    uint32_t index_used;                     ///< 사용 중이거나 삭제 표시된 칸 수
+    uint32_t live;                           ///< 살아 있는 문자열 수
+    size_t bytes;                            ///< 살아 있는 문자열 바이트 합
+    pthread_mutex_t lock;                    ///< 등록/반납/검색 직렬화
+} InternTable;
+
+static inline uint32_t intern_hash(const char *str, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline InternEntry *intern_entry(InternTable *table, InternId id) {
+    return &table->chunks[id >> INTERN_CHUNK_SHIFT][id & (INTERN_CHUNK_SIZE - 1)];
+}
+
+/**
+ * @brief 인터닝 테이블 초기화
+ *
+ * @param table 초기화할 테이블
+ * @return 성공 시 0, 실패 시 -1
+ */
+int intern_init(InternTable *table) {
+    memset(table, 0, sizeof(*table));
+    table->index = (InternId *)calloc(INTERN_INDEX_INITIAL, sizeof(InternId));
+    if (table->index == NULL) {
+        return -1;
+    }
+    table->index_capacity = INTERN_INDEX_INITIAL;
+    table->entry_count = 1;  // 0 번은 INTERN_NONE
+    pthread_mutex_init(&table->lock, NULL);
+    return 0;
+}
+
+/**
+ * @brief 해시 인덱스에서 문자열을 찾음 (잠금은 호출자가 잡음)
+ *
+ * @return 찾은 칸의 위치, 없으면 -1
+ */
+static long intern_lookup(InternTable *table, const char *str, size_t len, uint32_t hash) {
+    uint32_t mask = table->index_capacity - 1;
+    for (uint32_t i = hash & mask; table->index[i] != INTERN_NONE; i = (i + 1) & mask) {
+        InternId id = table->index[i];
+        if (id == INTERN_TOMBSTONE) {
+            continue;
+        }
+        InternEntry *entry = intern_entry(table, id);
+        if (entry->hash == hash && entry->len == len && memcmp(entry->str, str, len) == 0) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 해시 인덱스를 다시 만듦 (삭제 표시는 버림, 잠금은 호출자가 잡음)
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+static int intern_rehash(InternTable *table, uint32_t capacity) {
+    InternId *index = (InternId *)calloc(capacity, sizeof(InternId));
+    if (index == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < table->index_capacity; i++) {
+        InternId id = table->index[i];
+        if (id == INTERN_NONE || id == INTERN_TOMBSTONE) {
+            continue;
+        }
+        uint32_t j = intern_entry(table, id)->hash & (capacity - 1);
+        while (index[j] != INTERN_NONE) {
+            j = (j + 1) & (capacity - 1);
+        }
+        index[j] = id;
+    }
+    free(table->index);
+    table->index = index;
+    table->index_capacity = capacity;
+    table->index_used = table->live;
+    return 0;
+}
+
+/**
+ * @brief 빈 핸들을 하나 할당 (잠금은 호출자가 잡음)
+ *
+ * @return 핸들, 메모리 부족 또는 가득 차면 INTERN_NONE
+ */
+static InternId intern_new_id(InternTable *table) {
+    if (table->free_head != INTERN_NONE) {
+        InternId id = table->free_head;
+        table->free_head = intern_entry(table, id)->next_free;
+        return id;
+    }
+
+    InternId id = table->entry_count;
+    uint32_t chunk = id >> INTERN_CHUNK_SHIFT;
+    if (chunk >= INTERN_MAX_CHUNKS) {
+        return INTERN_NONE;
+    }
+    if (table->chunks[chunk] == NULL) {
+        table->chunks[chunk] = (InternEntry *)calloc(INTERN_CHUNK_SIZE, sizeof(InternEntry));
+        if (table->chunks[chunk] == NULL) {
+            return INTERN_NONE;
+        }
+    }
+    table->entry_count++;
+    return id;
+}
+
+/**
+ * @brief 문자열을 등록하고 참조 하나를 얻음 (이미 있으면 같은 핸들의 참조 수만 증가)
+ *
+ * @param table 인터닝 테이블
+ * @param str 문자열 (NUL 로 끝나지 않아도 됨)
+ * @param len 문자열 길이
+ * @return 핸들 (intern_release() 로 반납), 메모리 부족 시 INTERN_NONE
+ */
+InternId intern_acquire(InternTable *table, const char *str, size_t len) {
+    uint32_t hash = intern_hash(str, len);
+
+    pthread_mutex_lock(&table->lock);
+    long pos = intern_lookup(table, str, len, hash);
+    if (pos >= 0) {
+        InternId id = table->index[pos];
+        intern_entry(table, id)->refs++;
+        pthread_mutex_unlock(&table->lock);
+        return id;
+    }
+
+    // 적재율 50% 를 넘기 전에 인덱스를 키우거나 삭제 표시를 정리
+    if ((table->index_used + 1) * 2 > table->index_capacity) {
+        uint32_t capacity = (table->live + 1) * 4 > table->index_capacity ? table->index_capacity * 2
+                                                                          : table->index_capacity;
+        if (intern_rehash(table, capacity) < 0) {
+            pthread_mutex_unlock(&table->lock);
+            return INTERN_NONE;
+        }
+    }
+
+    char *copy = (char *)malloc(len + 1);
+    InternId id = copy != NULL ? intern_new_id(table) : INTERN_NONE;
+    if (id == INTERN_NONE) {
+        free(copy);
+        pthread_mutex_unlock(&table->lock);
+        return INTERN_NONE;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    InternEntry *entry = intern_entry(table, id);
+    entry->str = copy;
+    entry->len = (uint32_t)len;
+    entry->hash = hash;
+    entry->refs = 1;
+
+    uint32_t mask = table->index_capacity - 1;
+    uint32_t i = hash & mask;
+    while (table->index[i] != INTERN_NONE && table->index[i] != INTERN_TOMBSTONE) {
+        i = (i + 1) & mask;
+    }
+    if (table->index[i] == INTERN_NONE) {
+        table->index_used++;
+    }
+    table->index[i] = id;
+    table->live++;
+    table->bytes += len + 1;
+    pthread_mutex_unlock(&table->lock);
+    return id;
+}
+
+/**
+ * @brief 이미 가진 핸들의 참조를 하나 더 얻음
+ */
+void intern_retain(InternTable *table, InternId id) {
+    if (id == INTERN_NONE) {
+        return;
+    }
+    pthread_mutex_lock(&table->lock);
+    intern_entry(table, id)->refs++;
+    pthread_mutex_unlock(&table->lock);
+}
+
+/**
+ * @brief 참조 하나를 반납하고, 마지막 참조면 문자열을 해제하고 핸들을 재사용 목록에 넣음
+ */
+void intern_release(InternTable *table, InternId id) {
+    if (id == INTERN_NONE) {
+        return;
+    }
+
+    pthread_mutex_lock(&table->lock);
+    InternEntry *entry = intern_entry(table, id);
+    if (--entry->refs == 0) {
+        long pos = intern_lookup(table, entry->str, entry->len, entry->hash);
+        if (pos >= 0) {
+            table->index[pos] = INTERN_TOMBSTONE;
+        }
+        table->live--;
+        table->bytes -= entry->len + 1;
+        free(entry->str);
+        entry->str = NULL;
+        entry->next_free = table->free_head;
+        table->free_head = id;
+    }
+    pthread_mutex_unlock(&table->lock);
+}
+
+/**
+ * @brief 핸들의 문자열 (잠금 없음, 호출자가 참조를 가지고 있는 동안만 유효)
+ *
+ * @return 문자열, INTERN_NONE 이면 빈 문자열
+ */
+const char *intern_str(InternTable *table, InternId id) {
+    return id == INTERN_NONE ? "" : intern_entry(table, id)->str;
+}
+
+/**
+ * @brief 살아 있는 문자열 수와 바이트 합
+ */
+void intern_get_stats(InternTable *table, uint32_t *live, size_t *bytes) {
+    pthread_mutex_lock(&table->lock);
+    *live = table->live;
+    *bytes = table->bytes;
+    pthread_mutex_unlock(&table->lock);
+}
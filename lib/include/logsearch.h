@@ -0,0 +1,741 @@
+#pragma once
+/**
+ * @file logsearch.h
+ * @brief 날짜별 채팅 로그 파일에 대한 역색인 검색
+ *
+ * 로그 파일마다 토큰 -> 레코드 번호 목록(posting list) 색인과 레코드의 파일 위치를 메모리에 유지합니다.
+ * 색인은 파일에서 아직 읽지 않은 뒷부분만 이어서 읽어 갱신하며, 서버에서는 로그 writer 가 기록한
+ * 묶음을 바로 넘겨받아 갱신하므로 검색 시 파일을 다시 훑지 않습니다.
+ *
+ * 질의는 단어의 AND 이며, 따옴표로 묶으면 연속된 구(phrase)로 찾습니다. `-d 20240901:20240930`
+ * 처럼 날짜 범위를 주면 여러 날짜 파일을 함께 검색합니다 (기본값: 오늘).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#define LOG_TOKEN_MAX 64              ///< 토큰 최대 길이 (넘는 부분은 색인과 질의 모두에서 잘림)
+#define LOG_QUERY_MAX_TERMS 16        ///< 질의 하나의 최대 항 수
+#define LOG_QUERY_MAX_PHRASE 8        ///< 구 하나의 최대 토큰 수
+#define LOG_INDEX_READ_CHUNK 65536    ///< 파일을 이어 읽는 단위
+#define LOG_SEARCH_LIMIT 100          ///< 검색 결과 출력 상한
+#define LOG_SEARCH_MAX_DAYS 3660      ///< 날짜 범위 상한
+
+/**
+ * @struct LogRecordRef
+ * @brief 레코드(로그 한 줄)의 파일 내 위치
+ */
+typedef struct {
+    uint64_t offset;       ///< 줄 시작 위치
+    uint32_t len;          ///< 줄 길이 (개행 제외)
+} LogRecordRef;
+
+/**
+ * @struct LogPosting
+ * @brief 토큰 하나의 posting list
+ */
+typedef struct {
+    char *token;           ///< 토큰 (NULL 이면 빈 칸)
+    uint32_t len;          ///< 토큰 길이
+    uint32_t hash;         ///< 토큰 해시
+    uint32_t *ids;         ///< 토큰이 나온 레코드 번호 (오름차순, 중복 없음)
+    uint32_t count;        ///< 레코드 수
+    uint32_t capacity;     ///< ids 용량
+} LogPosting;
+
+/**
+ * @struct LogDayIndex
+ * @brief 로그 파일 하나의 색인
+ */
+typedef struct {
+    char path[512];               ///< 로그 파일 경로
+    uint64_t indexed_bytes;       ///< 색인에 반영한 파일 앞부분 크기 (항상 줄 경계)
+    LogRecordRef *records;        ///< 레코드 위치
+    uint32_t record_count;        ///< 레코드 수
+    uint32_t record_capacity;     ///< records 용량
+    LogPosting *table;            ///< 토큰 해시 테이블 (선형 탐사)
+    uint32_t table_capacity;      ///< 해시 테이블 크기 (2의 거듭제곱)
+    uint32_t token_count;         ///< 서로 다른 토큰 수
+} LogDayIndex;
+
+/**
+ * @struct LogIndex
+ * @brief 날짜별 색인 모음
+ */
+typedef struct {
+    char path_format[256];        ///< 로그 파일 경로 (strftime 형식)
+    LogDayIndex **days;           ///< 읽어 들인 날짜별 색인
+    uint32_t day_count;           ///< 색인 수
+    uint32_t day_capacity;        ///< days 용량
+    pthread_mutex_t lock;         ///< 색인 갱신과 검색을 직렬화
+} LogIndex;
+
+/**
+ * @struct LogQuery
+ * @brief 해석된 질의
+ */
+typedef struct {
+    char tokens[LOG_QUERY_MAX_TERMS][LOG_QUERY_MAX_PHRASE][LOG_TOKEN_MAX + 1]; ///< 항별 토큰
+    int token_count[LOG_QUERY_MAX_TERMS];  ///< 항별 토큰 수 (2 이상이면 구)
+    int term_count;                        ///< 항 수
+    time_t from;                           ///< 검색 시작 날짜 (정오 기준)
+    int days;                              ///< 검색할 날짜 수
+} LogQuery;
+
+/**
+ * @brief 다음 토큰을 꺼냄
+ *
+ * 토큰은 ASCII 영숫자 또는 UTF-8 멀티바이트 문자의 연속이며, ASCII 는 소문자로 바꿉니다.
+ *
+ * @param cur 읽을 위치 (갱신됨)
+ * @param end 입력 끝
+ * @param out 토큰 (LOG_TOKEN_MAX + 1 바이트, NUL 종료)
+ * @return 토큰 길이, 더 없으면 0
+ */
+static uint32_t log_next_token(const char **cur, const char *end, char *out) {
+    const unsigned char *p = (const unsigned char *)*cur;
+    const unsigned char *e = (const unsigned char *)end;
+    uint32_t len = 0;
+
+    while (p < e && !(isalnum(*p) || *p >= 0x80)) {
+        p++;
+    }
+    while (p < e && (isalnum(*p) || *p >= 0x80)) {
+        if (len < LOG_TOKEN_MAX) {
+            out[len++] = (char)tolower(*p);
+        }
+        p++;
+    }
+    out[len] = '\0';
+    *cur = (const char *)p;
+    return len;
+}
+
+static inline uint32_t log_token_hash(const char *token, uint32_t len) {
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)token[i]) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief 토큰의 posting list 를 찾음
+ */
+static LogPosting *log_day_lookup(LogDayIndex *day, const char *token, uint32_t len) {
+    if (day->table_capacity == 0) {
+        return NULL;
+    }
+    uint32_t hash = log_token_hash(token, len);
+    uint32_t mask = day->table_capacity - 1;
+    for (uint32_t i = hash & mask; day->table[i].token != NULL; i = (i + 1) & mask) {
+        LogPosting *p = &day->table[i];
+        if (p->hash == hash && p->len == len && memcmp(p->token, token, len) == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 해시 테이블을 두 배로 늘림
+ */
+static int log_day_grow_table(LogDayIndex *day) {
+    uint32_t capacity = day->table_capacity ? day->table_capacity * 2 : 1024;
+    LogPosting *table = (LogPosting *)calloc(capacity, sizeof(LogPosting));
+    if (table == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < day->table_capacity; i++) {
+        if (day->table[i].token == NULL) {
+            continue;
+        }
+        uint32_t j = day->table[i].hash & (capacity - 1);
+        while (table[j].token != NULL) {
+            j = (j + 1) & (capacity - 1);
+        }
+        table[j] = day->table[i];
+    }
+    free(day->table);
+    day->table = table;
+    day->table_capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief 레코드 id 를 토큰의 posting list 에 추가
+ */
+static int log_day_add_posting(LogDayIndex *day, const char *token, uint32_t len, uint32_t id) {
+    LogPosting *p = log_day_lookup(day, token, len);
+
+    if (p == NULL) {
+        if ((day->token_count + 1) * 2 > day->table_capacity && log_day_grow_table(day) < 0) {
+            return -1;
+        }
+        uint32_t hash = log_token_hash(token, len);
+        uint32_t i = hash & (day->table_capacity - 1);
+        while (day->table[i].token != NULL) {
+            i = (i + 1) & (day->table_capacity - 1);
+        }
+        p = &day->table[i];
+        p->token = (char *)malloc(len + 1);
+        if (p->token == NULL) {
+            return -1;
+        }
+        memcpy(p->token, token, len);
+        p->token[len] = '\0';
+        p->len = len;
+        p->hash = hash;
+        day->token_count++;
+    }
+
+    if (p->count > 0 && p->ids[p->count - 1] == id) {
+        return 0;  // 같은 줄에 두 번 나온 토큰
+    }
+    if (p->count == p->capacity) {
+        uint32_t capacity = p->capacity ? p->capacity * 2 : 4;
+        uint32_t *ids = (uint32_t *)realloc(p->ids, capacity * sizeof(uint32_t));
+        if (ids == NULL) {
+            return -1;
+        }
+        p->ids = ids;
+        p->capacity = capacity;
+    }
+    p->ids[p->count++] = id;
+    return 0;
+}
+
+/**
+ * @brief 색인 도중 실패한 줄의 posting 을 되돌림
+ *
+ * 줄의 토큰을 다시 훑어 마지막 항목이 id 인 posting list 에서 그 항목을 빼고, 레코드 번호도 반납합니다.
+ * (새로 만든 토큰 칸은 빈 목록으로 남으며, 다음 시도에서 그대로 씀)
+ */
+static void log_day_undo_line(LogDayIndex *day, const char *line, uint32_t len, uint32_t id) {
+    const char *cur = line;
+    char token[LOG_TOKEN_MAX + 1];
+    uint32_t token_len;
+    while ((token_len = log_next_token(&cur, line + len, token)) > 0) {
+        LogPosting *p = log_day_lookup(day, token, token_len);
+        if (p != NULL && p->count > 0 && p->ids[p->count - 1] == id) {
+            p->count--;
+        }
+    }
+    day->record_count = id;
+}
+
+/**
+ * @brief 로그 한 줄을 색인에 추가
+ *
+ * 실패하면 그 줄에서 추가한 posting 을 되돌리므로, 호출자는 같은 줄을 다시 넘겨 재시도할 수 있습니다.
+ */
+static int log_day_add_line(LogDayIndex *day, uint64_t offset, const char *line, uint32_t len) {
+    if (day->record_count == day->record_capacity) {
+        uint32_t capacity = day->record_capacity ? day->record_capacity * 2 : 1024;
+        LogRecordRef *records = (LogRecordRef *)realloc(day->records, capacity * sizeof(LogRecordRef));
+        if (records == NULL) {
+            return -1;
+        }
+        day->records = records;
+        day->record_capacity = capacity;
+    }
+
+    uint32_t id = day->record_count++;
+    day->records[id].offset = offset;
+    day->records[id].len = len;
+
+    const char *cur = line;
+    char token[LOG_TOKEN_MAX + 1];
+    uint32_t token_len;
+    while ((token_len = log_next_token(&cur, line + len, token)) > 0) {
+        if (log_day_add_posting(day, token, token_len, id) < 0) {
+            log_day_undo_line(day, line, len, id);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief indexed_bytes 위치부터 이어지는 데이터에서 완성된 줄을 모두 색인
+ *
+ * 메모리가 부족해 한 줄을 색인하지 못하면 거기서 멈추고 indexed_bytes 를 그 줄 앞에 둡니다. 남은 줄은
+ * 다음 log_day_catch_up() 이 파일에서 다시 읽어 색인합니다.
+ *
+ * @return 색인에 반영한 바이트 수 (마지막으로 색인한 줄의 개행까지)
+ */
+static size_t log_day_consume(LogDayIndex *day, const char *data, size_t len) {
+    size_t start = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != '\n') {
+            continue;
+        }
+        if (log_day_add_line(day, day->indexed_bytes, data + start, (uint32_t)(i - start)) < 0) {
+            break;
+        }
+        day->indexed_bytes += i + 1 - start;
+        start = i + 1;
+    }
+    return start;
+}
+
+/**
+ * @brief 색인을 비움 (파일이 잘렸거나 바뀐 경우)
+ */
+static void log_day_reset(LogDayIndex *day) {
+    for (uint32_t i = 0; i < day->table_capacity; i++) {
+        free(day->table[i].token);
+        free(day->table[i].ids);
+    }
+    free(day->table);
+    free(day->records);
+    day->table = NULL;
+    day->records = NULL;
+    day->table_capacity = day->token_count = 0;
+    day->record_capacity = day->record_count = 0;
+    day->indexed_bytes = 0;
+}
+
+/**
+ * @brief 파일에서 아직 색인하지 않은 뒷부분을 읽어 색인
+ */
+static void log_day_catch_up(LogDayIndex *day) {
+    int fd = open(day->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (uint64_t)st.st_size == day->indexed_bytes) {
+        close(fd);
+        return;
+    }
+    if ((uint64_t)st.st_size < day->indexed_bytes) {
+        log_day_reset(day);
+    }
+
+    size_t cap = LOG_INDEX_READ_CHUNK;
+    size_t have = 0;
+    char *buf = (char *)malloc(cap);
+    uint64_t pos = day->indexed_bytes;
+
+    while (buf != NULL) {
+        ssize_t n = pread(fd, buf + have, cap - have, (off_t)pos);
+        if (n <= 0) {
+            break;
+        }
+        pos += (uint64_t)n;
+        have += (size_t)n;
+
+        size_t used = log_day_consume(day, buf, have);
+        memmove(buf, buf + used, have - used);
+        have -= used;
+        if (have == cap) {
+            // 한 줄이 버퍼보다 길면 늘림
+            char *bigger = (char *)realloc(buf, cap * 2);
+            if (bigger == NULL) {
+                break;
+            }
+            buf = bigger;
+            cap *= 2;
+        }
+    }
+    free(buf);
+    close(fd);
+}
+
+/**
+ * @brief 경로에 해당하는 날짜 색인을 찾고, 없으면 만듦 (잠금 상태에서 호출)
+ */
+static LogDayIndex *log_index_day(LogIndex *index, const char *path) {
+    for (uint32_t i = 0; i < index->day_count; i++) {
+        if (strcmp(index->days[i]->path, path) == 0) {
+            return index->days[i];
+        }
+    }
+
+    if (index->day_count == index->day_capacity) {
+        uint32_t capacity = index->day_capacity ? index->day_capacity * 2 : 32;
+        LogDayIndex **days = (LogDayIndex **)realloc(index->days, capacity * sizeof(LogDayIndex *));
+        if (days == NULL) {
+            return NULL;
+        }
+        index->days = days;
+        index->day_capacity = capacity;
+    }
+
+    LogDayIndex *day = (LogDayIndex *)calloc(1, sizeof(LogDayIndex));
+    if (day == NULL) {
+        return NULL;
+    }
+    snprintf(day->path, sizeof(day->path), "%s", path);
+    index->days[index->day_count++] = day;
+    return day;
+}
+
+/**
+ * @brief 색인 초기화 (파일은 처음 검색하거나 기록될 때 읽음)
+ *
+ * @param index 초기화할 색인
+ * @param path_format 로그 파일 경로 (strftime 형식)
+ */
+void log_index_init(LogIndex *index, const char *path_format) {
+    memset(index, 0, sizeof(*index));
+    snprintf(index->path_format, sizeof(index->path_format), "%s", path_format);
+    pthread_mutex_init(&index->lock, NULL);
+}
+
+/**
+ * @brief 로그 파일에 방금 기록된 데이터를 색인에 반영 (ChatLogFlushHook 형태)
+ *
+ * 로그 writer 스레드에서 불리므로 넘겨받은 묶음만 이어 붙이고 파일은 읽지 않습니다. 색인이 offset 과
+ * 맞지 않거나 (서버 시작 전 내용, 다른 프로세스가 기록한 줄 등) 검색이 색인을 쓰고 있으면 이번 묶음은
+ * 건너뛰고, 다음 검색이 log_day_catch_up() 으로 파일에서 이어 읽어 맞춥니다.
+ *
+ * @param ctx LogIndex
+ * @param path 기록된 파일
+ * @param offset data 가 기록된 파일 위치
+ * @param data 기록된 데이터
+ * @param len 데이터 길이
+ */
+void log_index_on_flush(void *ctx, const char *path, uint64_t offset, const char *data, size_t len) {
+    LogIndex *index = (LogIndex *)ctx;
+
+    // 검색이 오래된 파일을 따라 읽는 동안 로그 기록이 기다리지 않도록 잠금을 기다리지 않음
+    if (pthread_mutex_trylock(&index->lock) != 0) {
+        return;
+    }
+    LogDayIndex *day = log_index_day(index, path);
+    if (day != NULL && day->indexed_bytes == offset) {
+        log_day_consume(day, data, len);
+    }
+    pthread_mutex_unlock(&index->lock);
+}
+
+/**
+ * @brief 날짜 문자열(YYYYMMDD)을 그날 정오의 time_t 로 변환
+ */
+static int log_parse_date(const char *text, size_t len, time_t *out) {
+    struct tm tm;
+
+    if (len != 8) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)text[i])) {
+            return -1;
+        }
+    }
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10 + (text[3] - '0') - 1900;
+    tm.tm_mon = (text[4] - '0') * 10 + (text[5] - '0') - 1;
+    tm.tm_mday = (text[6] - '0') * 10 + (text[7] - '0');
+    tm.tm_hour = 12;
+    tm.tm_isdst = -1;
+    *out = mktime(&tm);
+    return *out == (time_t)-1 ? -1 : 0;
+}
+
+/**
+ * @brief 질의 문자열 해석
+ *
+ * 예: `hello world` (AND), `"good morning" alice` (구 + 단어), `-d 20240901:20240930 hello`.
+ * grep 호환을 위해 `-r` 은 무시합니다.
+ *
+ * @return 성공 시 0, 잘못된 질의면 -1
+ */
+static int log_parse_query(const char *text, LogQuery *query) {
+    const char *p = text;
+    time_t now = time(NULL);
+    struct tm tm;
+
+    memset(query, 0, sizeof(*query));
+    localtime_r(&now, &tm);
+    tm.tm_hour = 12;
+    tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    query->from = mktime(&tm);
+    query->days = 1;
+
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+
+        const char *start = p;
+        const char *end;
+        if (*p == '"') {
+            start = ++p;
+            while (*p != '\0' && *p != '"') {
+                p++;
+            }
+            end = p;
+            if (*p == '"') {
+                p++;
+            }
+        } else {
+            while (*p != '\0' && *p != ' ' && *p != '\t') {
+                p++;
+            }
+            end = p;
+        }
+
+        if (end - start == 2 && strncmp(start, "-r", 2) == 0) {
+            continue;
+        }
+        if (end - start == 2 && strncmp(start, "-d", 2) == 0) {
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            const char *range = p;
+            while (*p != '\0' && *p != ' ' && *p != '\t') {
+                p++;
+            }
+            const char *colon = memchr(range, ':', (size_t)(p - range));
+            time_t from, to;
+            if (colon == NULL) {
+                if (log_parse_date(range, (size_t)(p - range), &from) < 0) {
+                    return -1;
+                }
+                to = from;
+            } else if (log_parse_date(range, (size_t)(colon - range), &from) < 0 ||
+                       log_parse_date(colon + 1, (size_t)(p - colon - 1), &to) < 0 || to < from) {
+                return -1;
+            }
+            query->from = from;
+            query->days = (int)((to - from + 43200) / 86400) + 1;
+            if (query->days > LOG_SEARCH_MAX_DAYS) {
+                return -1;
+            }
+            continue;
+        }
+
+        if (query->term_count == LOG_QUERY_MAX_TERMS) {
+            return -1;
+        }
+        int term = query->term_count;
+        const char *cur = start;
+        while (query->token_count[term] < LOG_QUERY_MAX_PHRASE &&
+               log_next_token(&cur, end, query->tokens[term][query->token_count[term]]) > 0) {
+            query->token_count[term]++;
+        }
+        if (query->token_count[term] > 0) {
+            query->term_count++;
+        }
+    }
+    return query->term_count > 0 ? 0 : -1;
+}
+
+/**
+ * @brief 정렬된 목록에 id 가 있는지 이진 탐색
+ */
+static int log_posting_has(const LogPosting *p, uint32_t id) {
+    uint32_t lo = 0, hi = p->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (p->ids[mid] < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < p->count && p->ids[lo] == id;
+}
+
+/**
+ * @brief 줄에 질의의 구가 모두 연속된 토큰으로 들어 있는지 확인
+ */
+static int log_line_has_phrases(const LogQuery *query, const char *line, uint32_t len) {
+    char (*tokens)[LOG_TOKEN_MAX + 1] = NULL;
+    uint32_t count = 0, capacity = 0;
+    const char *cur = line;
+    int ok = 1;
+
+    while (1) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            void *grown = realloc(tokens, capacity * sizeof(*tokens));
+            if (grown == NULL) {
+                free(tokens);
+                return 0;
+            }
+            tokens = grown;
+        }
+        if (log_next_token(&cur, line + len, tokens[count]) == 0) {
+            break;
+        }
+        count++;
+    }
+
+    for (int t = 0; t < query->term_count && ok; t++) {
+        int n = query->token_count[t];
+        if (n < 2) {
+            continue;
+        }
+        ok = 0;
+        for (uint32_t s = 0; s + (uint32_t)n <= count && !ok; s++) {
+            int k = 0;
+            while (k < n && strcmp(tokens[s + k], query->tokens[t][k]) == 0) {
+                k++;
+            }
+            ok = k == n;
+        }
+    }
+    free(tokens);
+    return ok;
+}
+
+/**
+ * @brief 한 날짜 색인에서 질의를 실행하고 결과를 출력 (잠금 상태에서 호출)
+ *
+ * @return 일치한 레코드 수
+ */
+static long log_day_search(LogDayIndex *day, const LogQuery *query, const char *date, FILE *out, long *printed) {
+    const LogPosting *lists[LOG_QUERY_MAX_TERMS * LOG_QUERY_MAX_PHRASE];
+    int list_count = 0;
+    int has_phrase = 0;
+
+    for (int t = 0; t < query->term_count; t++) {
+        has_phrase |= query->token_count[t] > 1;
+        for (int k = 0; k < query->token_count[t]; k++) {
+            const char *token = query->tokens[t][k];
+            const LogPosting *p = log_day_lookup(day, token, (uint32_t)strlen(token));
+            if (p == NULL) {
+                return 0;  // 없는 토큰이 하나라도 있으면 AND 결과는 비어 있음
+            }
+            lists[list_count++] = p;
+        }
+    }
+
+    // 가장 짧은 목록을 후보로 두고 나머지 목록에서 이진 탐색
+    int shortest = 0;
+    for (int i = 1; i < list_count; i++) {
+        if (lists[i]->count < lists[shortest]->count) {
+            shortest = i;
+        }
+    }
+
+    int fd = -1;
+    char *line = NULL;
+    uint32_t line_cap = 0;
+    long matches = 0;
+
+    for (uint32_t c = 0; c < lists[shortest]->count; c++) {
+        uint32_t id = lists[shortest]->ids[c];
+        int all = 1;
+        for (int i = 0; i < list_count && all; i++) {
+            all = i == shortest || log_posting_has(lists[i], id);
+        }
+        if (!all) {
+            continue;
+        }
+
+        int need_text = has_phrase || *printed < LOG_SEARCH_LIMIT;
+        const LogRecordRef *rec = &day->records[id];
+        if (need_text) {
+            if (fd < 0 && (fd = open(day->path, O_RDONLY | O_CLOEXEC)) < 0) {
+                break;
+            }
+            if (rec->len > line_cap) {
+                char *grown = (char *)realloc(line, rec->len);
+                if (grown == NULL) {
+                    break;
+                }
+                line = grown;
+                line_cap = rec->len;
+            }
+            if (pread(fd, line, rec->len, (off_t)rec->offset) != (ssize_t)rec->len) {
+                continue;
+            }
+            if (has_phrase && !log_line_has_phrases(query, line, rec->len)) {
+                continue;
+            }
+        }
+
+        matches++;
+        if (*printed < LOG_SEARCH_LIMIT) {
+            fprintf(out, "%s %.*s\n", date, (int)rec->len, line);
+            (*printed)++;
+        }
+    }
+
+    free(line);
+    if (fd >= 0) {
+        close(fd);
+    }
+    return matches;
+}
+
+/**
+ * @brief 질의를 실행해 일치하는 로그 줄을 출력
+ *
+ * 처음 검색하는 날짜의 파일은 한 번 읽어 색인하고, 이후에는 새로 추가된 부분만 읽습니다.
+ *
+ * @param index 색인
+ * @param text 질의 (예: `"good morning" alice -d 20240901:20240930`)
+ * @param out 결과 출력 스트림
+ * @return 일치한 줄 수, 잘못된 질의면 -1
+ */
+long log_index_search(LogIndex *index, const char *text, FILE *out) {
+    LogQuery query;
+    struct timespec t0, t1;
+    long total = 0, printed = 0;
+
+    if (log_parse_query(text, &query) < 0) {
+        fprintf(out, "검색어가 올바르지 않습니다. 예: hello \"good morning\" -d 20240901:20240930\n");
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_mutex_lock(&index->lock);
+    for (int d = 0; d < query.days; d++) {
+        time_t when = query.from + (time_t)d * 86400;
+        struct tm tm;
+        char path[512], date[16];
+        struct stat st;
+
+        localtime_r(&when, &tm);
+        strftime(path, sizeof(path), index->path_format, &tm);
+        strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+        if (stat(path, &st) < 0) {
+            continue;
+        }
+
+        LogDayIndex *day = log_index_day(index, path);
+        if (day == NULL) {
+            break;
+        }
+        log_day_catch_up(day);
+        total += log_day_search(day, &query, date, out, &printed);
+    }
+    pthread_mutex_unlock(&index->lock);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    fprintf(out, "검색 결과: %ld건%s (%.2f ms)\n", total, total > printed ? ", 앞부분만 출력" : "",
+            (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    return total;
+}
+
+/**
+ * @brief 색인이 사용한 메모리를 해제
+ */
+void log_index_destroy(LogIndex *index) {
+    for (uint32_t i = 0; i < index->day_count; i++) {
+        log_day_reset(index->days[i]);
+        free(index->days[i]);
+    }
+    free(index->days);
+    pthread_mutex_destroy(&index->lock);
+}
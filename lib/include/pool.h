@@ -0,0 +1,306 @@
+#pragma once
+/**
+ * @file pool.h
+ * @brief 스레드별 캐시를 둔 고정 크기 객체 풀
+ *
+ * 객체는 슬랩 단위로 한꺼번에 할당되고, 해제된 객체는 OS 에 돌려주지 않고 재사용합니다.
+ * 각 스레드는 풀마다 작은 캐시를 가지며, 캐시가 비거나 넘칠 때만 전역 목록의 잠금을 잡고
+ * POOL_BATCH 개씩 주고받습니다. 객체 앞의 헤더에 소속 풀이 기록되어 있으므로 pool_free() 는
+ * 풀 인자 없이 호출할 수 있고, 그래서 SharedPtr 의 deleter 로 그대로 쓸 수 있습니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define POOL_CACHE_SIZE 32     ///< 스레드 캐시에 보관하는 최대 객체 수
+#define POOL_BATCH 16          ///< 스레드 캐시와 전역 목록이 한 번에 주고받는 객체 수
+#define POOL_SLAB_OBJECTS 64   ///< 전역 목록이 비었을 때 한 번에 만드는 객체 수
+
+/**
+ * @struct PoolHeader
+ * @brief 풀 객체 앞에 붙는 헤더 (객체가 max_align_t 로 정렬되도록 크기를 맞춤)
+ */
+typedef struct PoolHeader {
+    _Alignas(max_align_t) struct ObjectPool *pool;  ///< 소속 풀 (슬랩을 만들 때 한 번 기록)
+    struct PoolHeader *next;                        ///< 전역 빈 목록 연결 (빈 객체일 때만 사용)
+} PoolHeader;
+
+/**
+ * @brief 풀 지표 종류 (ObjectPool.stat 인덱스)
+ */
+enum PoolStat {
+    POOL_STAT_HITS,      ///< 스레드 캐시에서 바로 꺼낸 할당
+    POOL_STAT_REFILLS,   ///< 스레드 캐시가 비어 전역 목록에서 가져온 할당
+    POOL_STAT_MISSES,    ///< 빈 객체가 없어 슬랩을 새로 만든 할당
+    POOL_STAT_FREES,     ///< 반납된 객체 수
+    POOL_STAT_COUNT
+};
+
+/**
+ * @struct PoolStats
+ * @brief pool_get_stats() 결과
+ */
+typedef struct {
+    long hits;       ///< 스레드 캐시 적중
+    long refills;    ///< 전역 목록 적중
+    long misses;     ///< 새 메모리 할당
+    long in_use;     ///< 현재 사용 중인 객체 수
+    long capacity;   ///< 지금까지 만든 객체 수
+} PoolStats;
+
+/**
+ * @struct PoolCache
+ * @brief 스레드별 캐시 (pthread key 에 보관, 스레드 종료 시 전역 목록으로 반납)
+ */
+typedef struct {
+    struct ObjectPool *pool;               ///< 소속 풀
+    uint32_t count;                        ///< 보관 중인 객체 수
+    PoolHeader *items[POOL_CACHE_SIZE];    ///< 보관 중인 객체
+} PoolCache;
+
+/**
+ * @struct ObjectPool
+ * @brief 고정 크기 객체 풀
+ */
+typedef struct ObjectPool {
+    const char *name;            ///< 지표 출력용 이름
+    size_t object_size;          ///< 객체 크기
+    size_t align;                ///< 객체 정렬 (2의 거듭제곱, max_align_t 이상)
+    size_t header_size;          ///< 블록 시작에서 객체까지의 거리 (헤더는 객체 바로 앞)
+    size_t block_size;           ///< 헤더를 포함한 블록 크기 (align 의 배수)
+    void (*init)(void *obj);     ///< 새로 만든 객체에 한 번만 호출 (NULL 가능, 재사용 시에는 호출하지 않음)
+    pthread_key_t cache_key;     ///< 스레드 캐시
+    pthread_mutex_t lock;        ///< 아래 전역 상태 보호
+    PoolHeader *free_list;       ///< 전역 빈 목록
+    void **slabs;                ///< 할당한 슬랩 (pool_destroy 에서 해제)
+    size_t slab_count;           ///< 슬랩 수
+    size_t slab_capacity;        ///< slabs 배열 용량
+    _Atomic long stat[POOL_STAT_COUNT];  ///< 지표
+} ObjectPool;
+
+/**
+ * @brief 스레드 종료 시 캐시에 남은 객체를 전역 목록으로 반납
+ */
+static void pool_cache_release(void *arg) {
+    PoolCache *cache = (PoolCache *)arg;
+    ObjectPool *pool = cache->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    while (cache->count > 0) {
+        PoolHeader *header = cache->items[--cache->count];
+        header->next = pool->free_list;
+        pool->free_list = header;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    free(cache);
+}
+
+/**
+ * @brief 정렬을 지정해 객체 풀 초기화 (캐시 라인 정렬이 필요한 객체용)
+ *
+ * @param pool 초기화할 풀
+ * @param name 지표 출력용 이름
+ * @param object_size 객체 크기
+ * @param align 객체 정렬 (2의 거듭제곱, max_align_t 보다 작으면 max_align_t)
+ * @param init 새로 만든 객체 초기화 함수 (NULL 가능)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int pool_init_aligned(ObjectPool *pool, const char *name, size_t object_size, size_t align,
+                      void (*init)(void *obj)) {
+    if (align < _Alignof(max_align_t)) {
+        align = _Alignof(max_align_t);
+    }
+    if ((align & (align - 1)) != 0) {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    pool->name = name;
+    pool->object_size = object_size;
+    pool->align = align;
+    pool->header_size = (sizeof(PoolHeader) + align - 1) & ~(align - 1);
+    pool->block_size = (pool->header_size + object_size + align - 1) & ~(align - 1);
+    pool->init = init;
+    if (pthread_key_create(&pool->cache_key, pool_cache_release) != 0) {
+        return -1;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    for (int i = 0; i < POOL_STAT_COUNT; i++) {
+        atomic_init(&pool->stat[i], 0);
+    }
+    return 0;
+}
+
+/**
+ * @brief 객체 풀 초기화
+ *
+ * @param pool 초기화할 풀
+ * @param name 지표 출력용 이름
+ * @param object_size 객체 크기
+ * @param init 새로 만든 객체 초기화 함수 (NULL 가능)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int pool_init(ObjectPool *pool, const char *name, size_t object_size, void (*init)(void *obj)) {
+    return pool_init_aligned(pool, name, object_size, _Alignof(max_align_t), init);
+}
+
+/**
+ * @brief 현재 스레드의 캐시 (처음 쓰는 스레드면 생성, 메모리 부족 시 NULL)
+ */
+static PoolCache *pool_cache(ObjectPool *pool) {
+    PoolCache *cache = (PoolCache *)pthread_getspecific(pool->cache_key);
+    if (cache == NULL) {
+        cache = (PoolCache *)calloc(1, sizeof(PoolCache));
+        if (cache == NULL) {
+            return NULL;
+        }
+        cache->pool = pool;
+        pthread_setspecific(pool->cache_key, cache);
+    }
+    return cache;
+}
+
+/**
+ * @brief 슬랩을 하나 만들어 전역 빈 목록에 넣음 (잠금은 호출자가 잡음)
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+static int pool_grow(ObjectPool *pool) {
+    if (pool->slab_count == pool->slab_capacity) {
+        size_t capacity = pool->slab_capacity ? pool->slab_capacity * 2 : 16;
+        void **slabs = (void **)realloc(pool->slabs, capacity * sizeof(void *));
+        if (slabs == NULL) {
+            return -1;
+        }
+        pool->slabs = slabs;
+        pool->slab_capacity = capacity;
+    }
+
+    char *slab = (char *)aligned_alloc(pool->align, POOL_SLAB_OBJECTS * pool->block_size);
+    if (slab == NULL) {
+        return -1;
+    }
+    pool->slabs[pool->slab_count++] = slab;
+    for (int i = POOL_SLAB_OBJECTS - 1; i >= 0; i--) {
+        char *block = slab + (size_t)i * pool->block_size;
+        PoolHeader *header = (PoolHeader *)(block + pool->header_size) - 1;
+        header->pool = pool;
+        if (pool->init != NULL) {
+            pool->init(header + 1);
+        }
+        header->next = pool->free_list;
+        pool->free_list = header;
+    }
+    return 0;
+}
+
+/**
+ * @brief 객체 하나를 할당
+ *
+ * 내용은 초기화되지 않으며, 재사용된 객체에는 이전 내용이 남아 있습니다.
+ *
+ * @param pool 객체 풀
+ * @return 객체, 메모리 부족 시 NULL
+ */
+void *pool_alloc(ObjectPool *pool) {
+    PoolCache *cache = pool_cache(pool);
+    if (cache != NULL && cache->count > 0) {
+        atomic_fetch_add_explicit(&pool->stat[POOL_STAT_HITS], 1, memory_order_relaxed);
+        return cache->items[--cache->count] + 1;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    int stat = POOL_STAT_REFILLS;
+    if (pool->free_list == NULL) {
+        stat = POOL_STAT_MISSES;
+        if (pool_grow(pool) < 0) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+    }
+    PoolHeader *header = pool->free_list;
+    pool->free_list = header->next;
+    // 다음 할당을 위해 캐시도 함께 채움
+    while (cache != NULL && cache->count < POOL_BATCH && pool->free_list != NULL) {
+        cache->items[cache->count++] = pool->free_list;
+        pool->free_list = pool->free_list->next;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    atomic_fetch_add_explicit(&pool->stat[stat], 1, memory_order_relaxed);
+    return header + 1;
+}
+
+/**
+ * @brief 객체를 소속 풀에 반납
+ *
+ * SharedPtr/UniquePtr 의 deleter 로 바로 쓸 수 있습니다. NULL 이면 아무것도 하지 않습니다.
+ *
+ * @param obj pool_alloc() 으로 받은 객체
+ */
+void pool_free(void *obj) {
+    if (obj == NULL) {
+        return;
+    }
+
+    PoolHeader *header = (PoolHeader *)obj - 1;
+    ObjectPool *pool = header->pool;
+    PoolCache *cache = pool_cache(pool);
+
+    atomic_fetch_add_explicit(&pool->stat[POOL_STAT_FREES], 1, memory_order_relaxed);
+    if (cache != NULL && cache->count < POOL_CACHE_SIZE) {
+        cache->items[cache->count++] = header;
+        return;
+    }
+
+    // 캐시가 가득 찼으면 절반을 전역 목록으로 돌려보냄
+    pthread_mutex_lock(&pool->lock);
+    header->next = pool->free_list;
+    pool->free_list = header;
+    while (cache != NULL && cache->count > POOL_CACHE_SIZE - POOL_BATCH) {
+        PoolHeader *spill = cache->items[--cache->count];
+        spill->next = pool->free_list;
+        pool->free_list = spill;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief 풀 지표 스냅샷
+ */
+void pool_get_stats(ObjectPool *pool, PoolStats *stats) {
+    long allocs;
+
+    stats->hits = atomic_load_explicit(&pool->stat[POOL_STAT_HITS], memory_order_relaxed);
+    stats->refills = atomic_load_explicit(&pool->stat[POOL_STAT_REFILLS], memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&pool->stat[POOL_STAT_MISSES], memory_order_relaxed);
+    allocs = stats->hits + stats->refills + stats->misses;
+    stats->in_use = allocs - atomic_load_explicit(&pool->stat[POOL_STAT_FREES], memory_order_relaxed);
+
+    pthread_mutex_lock(&pool->lock);
+    stats->capacity = (long)(pool->slab_count * POOL_SLAB_OBJECTS);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief 풀의 모든 메모리를 해제 (사용 중인 객체가 없고 다른 스레드가 쓰지 않을 때만 호출)
+ */
+void pool_destroy(ObjectPool *pool) {
+    PoolCache *cache = (PoolCache *)pthread_getspecific(pool->cache_key);
+    if (cache != NULL) {
+        pthread_setspecific(pool->cache_key, NULL);
+        free(cache);
+    }
+    pthread_key_delete(pool->cache_key);
+    for (size_t i = 0; i < pool->slab_count; i++) {
+        free(pool->slabs[i]);
+    }
+    free(pool->slabs);
+    pthread_mutex_destroy(&pool->lock);
+    memset(pool, 0, sizeof(*pool));
+}
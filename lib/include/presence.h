@@ -0,0 +1,432 @@
+#pragma once
+/**
+ * @file presence.h
+ * @brief 같은 호스트의 서버와 클라이언트가 공유하는 접속 현황 테이블 (POSIX 공유 메모리)
+ *
+ * 사용자명마다 공유 메모리의 한 칸에 소유 프로세스 PID 와 하트비트 시각을 둡니다. 잠금 없이 원자 연산만 쓰므로
+ * 조회는 해시 계산과 몇 번의 메모리 읽기로 끝나며, 파일 시스템에 접근하지 않습니다.
+ *
+ * 칸 구조: 선형 탐사 테이블. 칸의 상태/세대/PID 는 64비트 워드 하나에 묶어 CAS 로만 바꿉니다.
+ *   - EMPTY: 한 번도 쓰지 않은 칸 (탐사는 여기서 끝남)
+ *   - WRITING: 사용자명을 쓰는 중 (PID 는 쓰는 프로세스)
+ *   - READY: 사용자명이 확정된 칸 (PID 가 0 이면 접속 중이 아님)
+ * 한 번 쓴 칸은 EMPTY 로 돌아가지 않으므로 탐사 구간이 끊기지 않고, 접속 중이 아닌 칸은 다른 사용자명이
+ * 세대를 올려 다시 씁니다. 세대가 워드에 들어 있어, 이름을 읽은 뒤 칸이 바뀌었으면 CAS 가 실패합니다.
+ *
+ * 소유 프로세스가 죽으면(kill(pid, 0) 이 ESRCH) 또는 하트비트가 PRESENCE_STALE_MS 이상 멈추면 그 칸은
+ * 비어 있는 것으로 보고 다시 차지할 수 있습니다. 조회는 하트비트만 보고, 등록은 PID 생존도 확인합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "intern.h"
+
+#define PRESENCE_SHM_NAME "/chat_presence"  ///< 기본 공유 메모리 이름
+#define PRESENCE_MAGIC 0x5052534e43453031ull  ///< "PRSNCE01"
+#define PRESENCE_SLOTS 16384                  ///< 칸 수 (2의 거듭제곱)
+#define PRESENCE_NAME_MAX 104                 ///< 사용자명 최대 길이 (칸을 128바이트로 맞춤)
+#define PRESENCE_HEARTBEAT_MS 1000            ///< 하트비트 갱신 주기
+#define PRESENCE_STALE_MS 5000                ///< 하트비트가 이보다 오래 멈추면 소유자가 없는 것으로 봄
+#define PRESENCE_WRITE_SPINS 1000             ///< WRITING 칸이 끝나기를 기다리는 최대 횟수
+
+#define PRESENCE_BUSY (-2)   ///< presence_claim(): 다른 살아 있는 프로세스가 쓰는 사용자명
+
+// 칸 워드: [세대 30비트][상태 2비트][PID 32비트]
+#define PRESENCE_EMPTY 0u
+#define PRESENCE_WRITING 1u
+#define PRESENCE_READY 2u
+#define PRESENCE_WORD(gen, state, pid) (((uint64_t)(gen) << 34) | ((uint64_t)(state) << 32) | (uint32_t)(pid))
+#define PRESENCE_WORD_GEN(w) ((w) >> 34)
+#define PRESENCE_WORD_STATE(w) ((uint32_t)((w) >> 32) & 3u)
+#define PRESENCE_WORD_PID(w) ((pid_t)(uint32_t)(w))
+
+/**
+ * @struct PresenceSlot
+ * @brief 사용자 한 명의 칸 (128바이트)
+ */
+typedef struct {
+    _Atomic uint64_t word;           ///< 세대/상태/PID
+    _Atomic int64_t heartbeat_ms;    ///< 마지막 하트비트 (CLOCK_MONOTONIC, 호스트 전체 공통)
+    uint32_t hash;                   ///< 사용자명 해시 (intern_hash)
+    uint32_t len;                    ///< 사용자명 길이
+    char name[PRESENCE_NAME_MAX];    ///< 사용자명 (NUL 로 끝나지 않음)
+} PresenceSlot;
+
+_Static_assert(sizeof(PresenceSlot) == 128, "PresenceSlot 은 128바이트여야 합니다");
+
+/**
+ * @struct PresenceShared
+ * @brief 공유 메모리 배치
+ */
+typedef struct {
+    _Atomic uint64_t magic;      ///< PRESENCE_MAGIC (처음 연 프로세스가 기록)
+    uint32_t slot_count;         ///< 칸 수
+    uint32_t slot_size;          ///< 칸 크기 (배치 확인용)
+    char pad[112];
+    PresenceSlot slots[PRESENCE_SLOTS];
+} PresenceShared;
+
+/**
+ * @struct PresenceTable
+ * @brief 프로세스가 연 접속 현황 테이블 (shared 가 NULL 이면 열리지 않은 상태로, 모든 함수가 아무것도 하지 않음)
+ */
+typedef struct {
+    PresenceShared *shared;      ///< 매핑한 공유 메모리
+    pid_t pid;                   ///< 이 프로세스의 PID (칸 소유자 표시)
+    pthread_t heartbeat;         ///< 하트비트 스레드
+    int heartbeat_running;       ///< 하트비트 스레드 실행 여부
+    atomic_int stopping;         ///< 하트비트 스레드 종료 요청
+} PresenceTable;
+
+static inline int64_t presence_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 공유 메모리를 열거나 만들어 매핑
+ *
+ * @param table 초기화할 테이블
+ * @param name 공유 메모리 이름 (보통 PRESENCE_SHM_NAME)
+ * @return 성공 시 0, 실패 시 -1 (table 은 열리지 않은 상태로 남아 모든 함수가 아무것도 하지 않음)
+ */
+int presence_open(PresenceTable *table, const char *name) {
+    struct stat st;
+
+    memset(table, 0, sizeof(*table));
+    table->pid = getpid();
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    // 여러 프로세스가 동시에 늘려도 같은 크기로 0 이 채워지므로 안전
+    if (fstat(fd, &st) < 0 || ((size_t)st.st_size < sizeof(PresenceShared) &&
+                               ftruncate(fd, sizeof(PresenceShared)) < 0)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(PresenceShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    PresenceShared *shared = (PresenceShared *)map;
+    uint64_t magic = 0;
+    if (atomic_compare_exchange_strong(&shared->magic, &magic, PRESENCE_MAGIC)) {
+        shared->slot_count = PRESENCE_SLOTS;
+        shared->slot_size = sizeof(PresenceSlot);
+    } else if (magic != PRESENCE_MAGIC) {
+        munmap(map, sizeof(PresenceShared));
+        errno = EPROTO;
+        return -1;
+    }
+    table->shared = shared;
+    return 0;
+}
+
+/**
+ * @brief 칸의 소유 프로세스가 죽었거나 하트비트가 멈췄는지 확인
+ *
+ * WRITING 칸의 하트비트는 아직 이전 소유자의 값일 수 있으므로 PID 생존만 봅니다.
+ *
+ * @param check_pid 1 이면 kill(pid, 0) 으로 프로세스 생존까지 확인 (시스템 호출)
+ */
+static bool presence_owner_dead(PresenceSlot *slot, uint64_t word, int64_t now, int check_pid) {
+    pid_t pid = PRESENCE_WORD_PID(word);
+
+    if (PRESENCE_WORD_STATE(word) == PRESENCE_WRITING) {
+        return check_pid && kill(pid, 0) < 0 && errno == ESRCH;
+    }
+    if (pid == 0) {
+        return true;
+    }
+    if (now - atomic_load_explicit(&slot->heartbeat_ms, memory_order_relaxed) >= PRESENCE_STALE_MS) {
+        return true;
+    }
+    return check_pid && kill(pid, 0) < 0 && errno == ESRCH;
+}
+
+/**
+ * @brief 칸의 사용자명이 같은지 확인 (READY 상태의 워드를 읽은 뒤 호출하고, 호출 후 워드가 그대로인지 다시 확인)
+ */
+static bool presence_name_equals(const PresenceSlot *slot, const char *name, size_t len, uint32_t hash) {
+    return slot->hash == hash && slot->len == len && memcmp(slot->name, name, len) == 0;
+}
+
+/**
+ * @brief WRITING 칸이 끝나기를 잠깐 기다림 (쓰던 프로세스가 죽었으면 기다리지 않음)
+ *
+ * @return 기다린 뒤의 워드
+ */
+static uint64_t presence_wait_written(PresenceSlot *slot, uint64_t word) {
+    for (int spins = 0; PRESENCE_WORD_STATE(word) == PRESENCE_WRITING && spins < PRESENCE_WRITE_SPINS; spins++) {
+        sched_yield();
+        word = atomic_load(&slot->word);
+    }
+    return word;
+}
+
+/**
+ * @brief 사용자명의 칸을 찾음
+ *
+ * @param word_out 찾은 칸의 워드 (이름을 비교한 뒤에도 바뀌지 않았음을 확인한 값)
+ * @param reusable 탐사 중 처음 만난 다시 쓸 수 있는 칸 (없으면 -1, NULL 이면 찾지 않음)
+ * @param empty 탐사를 끝낸 EMPTY 칸 (테이블이 가득 차면 -1)
+ * @return 찾은 칸 위치, 없으면 -1
+ */
+static long presence_find(PresenceTable *table, const char *name, size_t len, uint32_t hash, uint64_t *word_out,
+                          long *reusable, long *empty) {
+    PresenceShared *shared = table->shared;
+    uint32_t mask = PRESENCE_SLOTS - 1;
+    int64_t now = reusable != NULL ? presence_now_ms() : 0;
+
+    if (reusable != NULL) {
+        *reusable = -1;
+    }
+    *empty = -1;
+    for (uint32_t i = hash & mask, probes = 0; probes < PRESENCE_SLOTS; i = (i + 1) & mask, probes++) {
+        PresenceSlot *slot = &shared->slots[i];
+        uint64_t word = presence_wait_written(slot, atomic_load(&slot->word));
+
+        if (PRESENCE_WORD_STATE(word) == PRESENCE_EMPTY) {
+            *empty = (long)i;
+            return -1;
+        }
+        if (PRESENCE_WORD_STATE(word) == PRESENCE_READY && presence_name_equals(slot, name, len, hash) &&
+            atomic_load(&slot->word) == word) {
+            *word_out = word;
+            return (long)i;
+        }
+        // 쓰던 도중 죽은 WRITING 칸, 접속 중이 아닌 READY 칸은 다른 사용자명이 다시 쓸 수 있음
+        if (reusable != NULL && *reusable < 0 && presence_owner_dead(slot, word, now, 1)) {
+            *reusable = (long)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 같은 사용자명을 가진 다른 살아 있는 칸이 있는지 확인 (새 칸에 이름을 쓴 뒤 호출)
+ *
+ * 두 프로세스가 동시에 서로 다른 칸에 같은 이름을 쓰면, 적어도 한쪽은 다른 쪽의 칸을 보게 되므로
+ * 본 쪽이 물러나면 중복이 남지 않습니다.
+ */
+static bool presence_has_other(PresenceTable *table, const char *name, size_t len, uint32_t hash, long mine) {
+    PresenceShared *shared = table->shared;
+    uint32_t mask = PRESENCE_SLOTS - 1;
+    int64_t now = presence_now_ms();
+
+    for (uint32_t i = hash & mask, probes = 0; probes < PRESENCE_SLOTS; i = (i + 1) & mask, probes++) {
+        PresenceSlot *slot = &shared->slots[i];
+        uint64_t word = presence_wait_written(slot, atomic_load(&slot->word));
+
+        if (PRESENCE_WORD_STATE(word) == PRESENCE_EMPTY) {
+            break;
+        }
+        if ((long)i != mine && PRESENCE_WORD_STATE(word) == PRESENCE_READY &&
+            !presence_owner_dead(slot, word, now, 0) && presence_name_equals(slot, name, len, hash) &&
+            atomic_load(&slot->word) == word) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 사용자명을 이 프로세스 소유로 등록
+ *
+ * @param table 테이블
+ * @param name 사용자명 (NUL 로 끝나지 않아도 됨)
+ * @param len 사용자명 길이
+ * @return 칸 위치 (presence_release() 에 넘김), 다른 프로세스가 쓰는 중이면 PRESENCE_BUSY,
+ *         테이블이 열리지 않았거나 가득 찼거나 이름이 너무 길면 -1 (중복 확인 없이 진행해도 됨)
+ */
+long presence_claim(PresenceTable *table, const char *name, size_t len) {
+    if (table->shared == NULL || len == 0 || len > PRESENCE_NAME_MAX) {
+        return -1;
+    }
+    uint32_t hash = intern_hash(name, len);
+    uint64_t mine_ready;
+
+    for (;;) {
+        uint64_t word;
+        long reusable, empty;
+        long pos = presence_find(table, name, len, hash, &word, &reusable, &empty);
+
+        if (pos >= 0) {
+            PresenceSlot *slot = &table->shared->slots[pos];
+            if (!presence_owner_dead(slot, word, presence_now_ms(), 1)) {
+                return PRESENCE_BUSY;
+            }
+            atomic_store(&slot->heartbeat_ms, presence_now_ms());
+            mine_ready = PRESENCE_WORD(PRESENCE_WORD_GEN(word), PRESENCE_READY, table->pid);
+            if (!atomic_compare_exchange_strong(&slot->word, &word, mine_ready)) {
+                continue;  // 다른 프로세스가 먼저 바꿈
+            }
+            if (!presence_has_other(table, name, len, hash, pos)) {
+                return pos;
+            }
+            // 같은 이름의 다른 칸을 누가 동시에 차지함: 물러나고 다시 (다음에는 둘 중 앞 칸에서 CAS 로 갈림)
+            uint64_t released = PRESENCE_WORD(PRESENCE_WORD_GEN(word), PRESENCE_READY, 0);
+            atomic_compare_exchange_strong(&slot->word, &mine_ready, released);
+            continue;
+        }
+
+        // 새 칸 차지: 다시 쓸 수 있는 칸이 있으면 그 칸, 없으면 탐사가 끝난 EMPTY 칸
+        long target = reusable >= 0 ? reusable : empty;
+        if (target < 0) {
+            return -1;
+        }
+        PresenceSlot *slot = &table->shared->slots[target];
+        uint64_t expected = atomic_load(&slot->word);
+        if ((target == empty && PRESENCE_WORD_STATE(expected) != PRESENCE_EMPTY) ||
+            (target == reusable && PRESENCE_WORD_STATE(expected) == PRESENCE_EMPTY)) {
+            continue;
+        }
+        uint64_t gen = PRESENCE_WORD_GEN(expected) + 1;
+        if (target == reusable && !presence_owner_dead(slot, expected, presence_now_ms(), 1)) {
+            continue;
+        }
+        if (!atomic_compare_exchange_strong(&slot->word, &expected, PRESENCE_WORD(gen, PRESENCE_WRITING, table->pid))) {
+            continue;
+        }
+        atomic_store(&slot->heartbeat_ms, presence_now_ms());
+        slot->hash = hash;
+        slot->len = (uint32_t)len;
+        memcpy(slot->name, name, len);
+        mine_ready = PRESENCE_WORD(gen, PRESENCE_READY, table->pid);
+        atomic_store(&slot->word, mine_ready);
+
+        if (!presence_has_other(table, name, len, hash, target)) {
+            return target;
+        }
+        // 동시에 같은 이름을 쓴 칸이 있음: 물러나고 처음부터 다시 (다음에는 그 칸을 찾음)
+        uint64_t released = PRESENCE_WORD(gen, PRESENCE_READY, 0);
+        atomic_compare_exchange_strong(&slot->word, &mine_ready, released);
+    }
+}
+
+/**
+ * @brief presence_claim() 으로 등록한 사용자명을 해제
+ *
+ * @param table 테이블
+ * @param pos presence_claim() 이 돌려준 칸 위치 (음수면 아무것도 하지 않음)
+ */
+void presence_release(PresenceTable *table, long pos) {
+    if (table->shared == NULL || pos < 0) {
+        return;
+    }
+    PresenceSlot *slot = &table->shared->slots[pos];
+    uint64_t word = atomic_load(&slot->word);
+    // 이미 다른 프로세스가 (하트비트가 멈춘 동안) 가져갔으면 건드리지 않음
+    if (PRESENCE_WORD_STATE(word) == PRESENCE_READY && PRESENCE_WORD_PID(word) == table->pid) {
+        atomic_compare_exchange_strong(&slot->word, &word, PRESENCE_WORD(PRESENCE_WORD_GEN(word), PRESENCE_READY, 0));
+    }
+}
+
+/**
+ * @brief 사용자명을 가진 살아 있는 프로세스를 조회 (시스템 호출 없음)
+ *
+ * @param table 테이블
+ * @param name 사용자명 (NUL 로 끝나지 않아도 됨)
+ * @param len 사용자명 길이
+ * @return 소유 프로세스 PID, 접속 중이 아니거나 테이블이 열리지 않았으면 0
+ */
+pid_t presence_lookup(PresenceTable *table, const char *name, size_t len) {
+    if (table->shared == NULL || len == 0 || len > PRESENCE_NAME_MAX) {
+        return 0;
+    }
+    uint32_t hash = intern_hash(name, len);
+    uint64_t word;
+    long empty;
+    long pos = presence_find(table, name, len, hash, &word, NULL, &empty);
+
+    if (pos < 0 || presence_owner_dead(&table->shared->slots[pos], word, presence_now_ms(), 0)) {
+        return 0;
+    }
+    return PRESENCE_WORD_PID(word);
+}
+
+/**
+ * @brief 이 프로세스가 가진 모든 칸의 하트비트를 갱신
+ *
+ * @return 갱신한 칸 수
+ */
+size_t presence_refresh(PresenceTable *table) {
+    size_t count = 0;
+
+    if (table->shared == NULL) {
+        return 0;
+    }
+    int64_t now = presence_now_ms();
+    for (uint32_t i = 0; i < PRESENCE_SLOTS; i++) {
+        PresenceSlot *slot = &table->shared->slots[i];
+        uint64_t word = atomic_load_explicit(&slot->word, memory_order_relaxed);
+        if (PRESENCE_WORD_STATE(word) == PRESENCE_READY && PRESENCE_WORD_PID(word) == table->pid) {
+            atomic_store_explicit(&slot->heartbeat_ms, now, memory_order_relaxed);
+            count++;
+        }
+    }
+    return count;
+}
+
+static void *presence_heartbeat_thread(void *arg) {
+    PresenceTable *table = (PresenceTable *)arg;
+
+    while (!atomic_load(&table->stopping)) {
+        presence_refresh(table);
+        usleep(PRESENCE_HEARTBEAT_MS * 1000);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 하트비트 스레드를 시작 (칸을 등록하는 프로세스만 필요)
+ *
+ * @return 성공 시 0, 테이블이 열리지 않았거나 스레드 생성 실패 시 -1
+ */
+int presence_start_heartbeat(PresenceTable *table) {
+    if (table->shared == NULL || table->heartbeat_running) {
+        return -1;
+    }
+    atomic_store(&table->stopping, 0);
+    if (pthread_create(&table->heartbeat, NULL, presence_heartbeat_thread, table) != 0) {
+        return -1;
+    }
+    table->heartbeat_running = 1;
+    return 0;
+}
+
+/**
+ * @brief 하트비트 스레드를 멈추고 이 프로세스의 칸을 모두 해제한 뒤 매핑을 닫음
+ */
+void presence_close(PresenceTable *table) {
+    if (table->shared == NULL) {
+        return;
+    }
+    if (table->heartbeat_running) {
+        atomic_store(&table->stopping, 1);
+        pthread_join(table->heartbeat, NULL);
+        table->heartbeat_running = 0;
+    }
+    for (long i = 0; i < PRESENCE_SLOTS; i++) {
+        presence_release(table, i);
+    }
+    munmap(table->shared, sizeof(PresenceShared));
+    table->shared = NULL;
+}
@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * @file probe.h
+ * @brief 선형 탐사 해시 테이블 공용 연산
+ *
+ * 크기가 2의 거듭제곱인 항목 배열에서 빈 칸 찾기, 재배치, 조회, 삭제를 한 곳에 모았습니다.
+ * 모든 바이트가 0 인 칸을 빈 칸으로 보며, 삭제는 뒤따르는 항목을 당겨 채우므로 삭제 표시를 남기지 않습니다.
+ *
+ * 테이블마다 PROBE_TABLE() 로 항목 형식에 맞는 함수를 만들어 씁니다. 빈 칸 판별, 해시, 키 비교는 매크로
+ * 인자로 받아 만들어진 함수 본문에 그대로 펼쳐지므로, 최적화 없이 빌드해도 탐사 한 걸음마다 함수를 부르지
+ * 않습니다. 잠금은 모두 호출자가 잡습니다.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief 항목 형식 하나에 대한 빈 칸 찾기/재배치/삭제 함수를 만듦
+ *
+ * 만들어지는 함수:
+ * - prefix_probe_slot(entries, capacity, hash): 해시가 들어갈 빈 칸 위치 (빈 칸이 하나 이상 있어야 함)
+ * - prefix_probe_resize(entries, capacity, new_capacity): 새 크기 배열로 옮긴 배열, 메모리 부족 시 NULL
+ *   (성공하면 기존 배열을 해제하고, 실패하면 그대로 둠)
+ * - prefix_probe_remove_at(entries, capacity, pos): pos 칸을 비우고 뒤따르는 탐사 구간을 당겨 채움
+ *   (pos 에 다른 항목이 당겨 올 수 있으므로, 테이블을 훑으며 지우는 쪽은 같은 위치를 다시 확인)
+ *
+ * @param prefix 함수 이름 앞부분
+ * @param Type 항목 형식
+ * @param EMPTY 항목 포인터를 받아 빈 칸이면 참인 식을 만드는 매크로
+ * @param HASH 항목 포인터를 받아 uint32_t 해시를 만드는 매크로 (빈 칸이 아닐 때만 펼쳐짐)
+ */
+#define PROBE_TABLE(prefix, Type, EMPTY, HASH)                                                        \
+static inline size_t prefix##_probe_slot(const Type *entries, size_t capacity, uint32_t hash) {       \
+    size_t mask = capacity - 1;                                                                       \
+    size_t i = hash & mask;                                                                           \
+    while (!EMPTY(&entries[i])) {                                                                     \
+        i = (i + 1) & mask;                                                                           \
+    }                                                                                                 \
+    return i;                                                                                         \
+}                                                                                                     \
+                                                                                                      \
+static inline Type *prefix##_probe_resize(Type *entries, size_t capacity, size_t new_capacity) {      \
+    Type *resized = (Type *)calloc(new_capacity, sizeof(Type));                                       \
+    if (resized == NULL) {                                                                            \
+        return NULL;                                                                                  \
+    }                                                                                                 \
+    for (size_t i = 0; i < capacity; i++) {                                                           \
+        if (!EMPTY(&entries[i])) {                                                                    \
+            resized[prefix##_probe_slot(resized, new_capacity, HASH(&entries[i]))] = entries[i];      \
+        }                                                                                             \
+    }                                                                                                 \
+    free(entries);                                                                                    \
+    return resized;                                                                                   \
+}                                                                                                     \
+                                                                                                      \
+static inline void prefix##_probe_remove_at(Type *entries, size_t capacity, size_t pos) {            \
+    size_t mask = capacity - 1;                                                                       \
+    size_t hole = pos;                                                                                \
+    for (size_t i = (hole + 1) & mask; !EMPTY(&entries[i]); i = (i + 1) & mask) {                     \
+        size_t home = HASH(&entries[i]) & mask;                                                       \
+        /* home 이 (hole, i] 구간 밖이면 hole 로 옮겨도 탐사 경로가 끊기지 않음 */                         \
+        if (((i - home) & mask) >= ((i - hole) & mask)) {                                             \
+            entries[hole] = entries[i];                                                               \
+            hole = i;                                                                                 \
+        }                                                                                             \
+    }                                                                                                 \
+    memset(&entries[hole], 0, sizeof(Type));                                                          \
+}
+
+/**
+ * @brief 키로 항목 위치를 찾는 함수를 만듦
+ *
+ * 만들어지는 함수 name(entries, capacity, hash, key) 는 찾은 칸의 위치를, 없으면 -1 을 돌려줍니다.
+ *
+ * @param name 함수 이름
+ * @param Type 항목 형식
+ * @param KeyType 키 형식
+ * @param EMPTY 항목 포인터를 받아 빈 칸이면 참인 식을 만드는 매크로
+ * @param MATCH 항목 포인터와 키를 받아 같으면 참인 식을 만드는 매크로
+ */
+#define PROBE_FIND(name, Type, KeyType, EMPTY, MATCH)                                                 \
+static inline long name(const Type *entries, size_t capacity, uint32_t hash, KeyType key) {          \
+    size_t mask = capacity - 1;                                                                       \
+    for (size_t i = hash & mask; !EMPTY(&entries[i]); i = (i + 1) & mask) {                           \
+        if (MATCH(&entries[i], key)) {                                                                \
+            return (long)i;                                                                           \
+        }                                                                                             \
+    }                                                                                                 \
+    return -1;                                                                                        \
+}
@@ -0,0 +1,238 @@
+#pragma once
+/**
+ * @file protocol.h
+ * @brief 서버와 클라이언트가 공유하는 길이 기반 프레임 프로토콜
+ *
+ * 프레임 = [payload 길이 4바이트, 빅엔디언][type 1바이트][payload].
+ * TCP 는 경계를 보존하지 않으므로 수신 측은 FrameReader 에 쌓아 두고 완성된 프레임만 꺼냅니다.
+ * 한 번의 read() 로 여러 프레임을 받을 수도, 한 프레임이 여러 read() 에 나뉘어 올 수도 있습니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define FRAME_HEADER_SIZE 5          ///< 길이(4) + 타입(1)
+#define FRAME_MAX_PAYLOAD 65536      ///< 허용하는 최대 payload 크기 (넘으면 프로토콜 오류)
+#define FRAME_READER_INITIAL 2048    ///< 수신 버퍼 초기 크기
+#define HELLO_ROOM_ID_MAX 0x3fffffff ///< HELLO 로 고를 수 있는 숫자 채팅방 ID 상한
+#define HELLO_ROOM_NAME_MAX 31       ///< HELLO 채팅방 이름 최대 바이트 수 (UTF-8, 제어 문자 불가)
+
+/**
+ * @brief 프레임 종류
+ */
+enum FrameType {
+    FRAME_HELLO = 1,     ///< 클라이언트 -> 서버: [채팅방 ID 4바이트, 빅엔디언][사용자명 (생략 가능, 로그인한 이름과 같아야 함)][\0 채팅방 이름 (ID 가 0 일 때만)]
+    FRAME_CHAT = 2,      ///< 클라이언트 -> 서버: 채팅 메시지 본문
+    FRAME_MESSAGE = 3,   ///< 서버 -> 클라이언트: 방 메시지 또는 서버 공지 ("[보낸이]: 본문")
+    FRAME_NOTICE = 4,    ///< 서버 -> 클라이언트: 강제 퇴장 등 시스템 알림
+    FRAME_AUTH = 5,      ///< 클라이언트 -> 서버: [요청 1바이트 (AuthOp)][필드] (HELLO 전에만 허용)
+    FRAME_AUTH_RESULT = 6  ///< 서버 -> 클라이언트: [결과 1바이트 (AuthStatus)][세션 토큰 + ' ' + 사용자명, 또는 사유]
+};
+
+/**
+ * @brief 인증 요청 종류 (FRAME_AUTH 첫 바이트)
+ *
+ * 로그인/가입/삭제의 필드는 "사용자명\0비밀번호", 재접속의 필드는 세션 토큰 16진수 문자열입니다.
+ * 로그인과 재접속이 성공하면 연결은 HELLO 대기 상태가 되고, 가입/삭제는 몇 번이든 보낼 수 있습니다.
+ */
+enum AuthOp {
+    AUTH_LOGIN = 'L',      ///< 비밀번호 로그인 (성공 시 새 세션 토큰 발급)
+    AUTH_RESUME = 'T',     ///< 세션 토큰으로 재접속 (비밀번호 확인 생략)
+    AUTH_REGISTER = 'R',   ///< 회원가입
+    AUTH_DELETE = 'D'      ///< 사용자 삭제 (비밀번호 확인, 발급된 세션도 폐기)
+};
+
+/**
+ * @brief 인증 결과 (FRAME_AUTH_RESULT 첫 바이트)
+ */
+enum AuthStatus {
+    AUTH_OK = 0,
+    AUTH_FAILED = 1
+};
+
+/**
+ * @struct FrameReader
+ * @brief 연결별 수신 버퍼
+ */
+typedef struct {
+    char *buf;       ///< 수신 데이터
+    size_t start;    ///< 아직 처리하지 않은 데이터의 시작 위치
+    size_t end;      ///< 수신 데이터의 끝 위치
+    size_t cap;      ///< 버퍼 크기
+} FrameReader;
+
+/**
+ * @brief 프레임 헤더를 기록
+ *
+ * @param out FRAME_HEADER_SIZE 바이트 이상의 출력 버퍼
+ * @param type 프레임 종류
+ * @param len payload 길이
+ */
+static inline void frame_encode_header(char *out, uint8_t type, uint32_t len) {
+    uint32_t be = htonl(len);
+    memcpy(out, &be, 4);
+    out[4] = (char)type;
+}
+
+/**
+ * @brief 수신 버퍼 초기화 (메모리는 첫 수신 때 할당)
+ */
+void frame_reader_init(FrameReader *reader) {
+    memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * @brief 수신 버퍼 해제
+ */
+void frame_reader_free(FrameReader *reader) {
+    free(reader->buf);
+    memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * @brief read() 로 바로 채울 수 있는 빈 공간을 확보
+ *
+ * 처리한 앞부분을 당겨 오고, 그래도 부족하면 버퍼를 늘립니다.
+ *
+ * @param reader 수신 버퍼
+ * @param min_free 최소한 확보할 바이트 수
+ * @param avail 확보된 바이트 수 (출력)
+ * @return 빈 공간의 시작 주소, 메모리 부족 시 NULL
+ */
+char *frame_reader_space(FrameReader *reader, size_t min_free, size_t *avail) {
+    if (reader->start == reader->end) {
+        reader->start = reader->end = 0;
+    }
+    if (reader->cap - reader->end < min_free && reader->start > 0) {
+        memmove(reader->buf, reader->buf + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->cap - reader->end < min_free) {
+        size_t cap = reader->cap ? reader->cap : FRAME_READER_INITIAL;
+        while (cap - reader->end < min_free) {
+            cap *= 2;
+        }
+        char *buf = (char *)realloc(reader->buf, cap);
+        if (buf == NULL) {
+            return NULL;
+        }
+        reader->buf = buf;
+        reader->cap = cap;
+    }
+
+    *avail = reader->cap - reader->end;
+    return reader->buf + reader->end;
+}
+
+/**
+ * @brief frame_reader_space() 로 받은 공간에 n 바이트를 채웠음을 기록
+ */
+void frame_reader_commit(FrameReader *reader, size_t n) {
+    reader->end += n;
+}
+
+/**
+ * @brief 다른 버퍼에 받은 데이터를 수신 버퍼에 복사
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+int frame_reader_append(FrameReader *reader, const char *data, size_t len) {
+    size_t avail;
+    char *space = frame_reader_space(reader, len, &avail);
+    if (space == NULL) {
+        return -1;
+    }
+    memcpy(space, data, len);
+    frame_reader_commit(reader, len);
+    return 0;
+}
+
+/**
+ * @brief 완성된 프레임 하나를 꺼냄
+ *
+ * 반환된 payload 는 다음 frame_reader_space()/frame_reader_append() 호출 전까지만 유효합니다.
+ *
+ * @param reader 수신 버퍼
+ * @param type 프레임 종류 (출력)
+ * @param payload payload 시작 주소 (출력, NUL 로 끝나지 않음)
+ * @param len payload 길이 (출력)
+ * @return 프레임을 꺼냈으면 1, 데이터가 더 필요하면 0, 잘못된 프레임이면 -1
+ */
+int frame_reader_next(FrameReader *reader, uint8_t *type, const char **payload, uint32_t *len) {
+    size_t buffered = reader->end - reader->start;
+    uint32_t be;
+
+    if (buffered < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+
+    const char *header = reader->buf + reader->start;
+    memcpy(&be, header, 4);
+    uint32_t payload_len = ntohl(be);
+    if (payload_len > FRAME_MAX_PAYLOAD) {
+        return -1;
+    }
+    if (buffered < FRAME_HEADER_SIZE + (size_t)payload_len) {
+        return 0;
+    }
+
+    *type = (uint8_t)header[4];
+    *payload = header + FRAME_HEADER_SIZE;
+    *len = payload_len;
+    reader->start += FRAME_HEADER_SIZE + payload_len;
+    return 1;
+}
+
+/**
+ * @brief 프레임 하나를 블로킹 소켓으로 모두 전송 (헤더와 payload 를 한 번의 sendmsg 로)
+ *
+ * @param sock 소켓
+ * @param type 프레임 종류
+ * @param payload 본문
+ * @param len 본문 길이
+ * @return 성공 시 0, 실패 시 -1
+ */
+int frame_send(int sock, uint8_t type, const void *payload, uint32_t len) {
+    char header[FRAME_HEADER_SIZE];
+    struct iovec iov[2];
+    size_t total = FRAME_HEADER_SIZE + (size_t)len;
+    size_t sent = 0;
+
+    frame_encode_header(header, type, len);
+    while (sent < total) {
+        struct msghdr msg;
+        int iovcnt = 0;
+
+        memset(&msg, 0, sizeof(msg));
+        if (sent < FRAME_HEADER_SIZE) {
+            iov[iovcnt].iov_base = header + sent;
+            iov[iovcnt].iov_len = FRAME_HEADER_SIZE - sent;
+            iovcnt++;
+        }
+        size_t body_sent = sent > FRAME_HEADER_SIZE ? sent - FRAME_HEADER_SIZE : 0;
+        if (len > body_sent) {
+            iov[iovcnt].iov_base = (char *)payload + body_sent;
+            iov[iovcnt].iov_len = len - body_sent;
+            iovcnt++;
+        }
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovcnt;
+
+        ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    return 0;
+}
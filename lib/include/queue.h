@@ -0,0 +1,334 @@
+#pragma once
+/**
+ * @file queue.h
+ * @brief 스레드 사이에 값을 넘기는 고정 용량 lock-free 큐
+ *
+ * - SpscRing : 생산자 하나, 소비자 하나. 양쪽이 상대 위치의 사본을 들고 있어 링이 가득/비어 보일 때만
+ *              상대 캐시 라인을 읽고, 묶음 넣기/꺼내기는 위치를 한 번만 게시합니다.
+ * - MpscQueue: 생산자 여럿, 소비자 하나. 칸마다 순번을 두는 방식이라 생산자는 꼬리 위치 CAS 한 번으로
+ *              칸을 차지하고, 소비자는 잠금 없이 순번만 보고 꺼냅니다. mpsc_reserve()/mpsc_publish() 로
+ *              칸 안에 바로 쓰고, mpsc_peek()/mpsc_pop() 으로 칸 안에서 바로 읽을 수도 있습니다.
+ *
+ * 두 큐 모두 용량은 2의 거듭제곱으로 올림하고, 원소는 elem_size 바이트 값으로 복사합니다. 가득 차면
+ * 넣기가 실패하므로 버릴지, 다른 곳에 둘지는 호출자가 정합니다. 생산자가 쓰는 위치와 소비자가 쓰는
+ * 위치는 서로 다른 캐시 라인에 두어 거짓 공유(false sharing)를 막습니다.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define QUEUE_CACHE_LINE 64   ///< 생산자/소비자 위치를 나누는 정렬 단위
+
+/**
+ * @struct SpscRing
+ * @brief 단일 생산자/단일 소비자 링
+ */
+typedef struct {
+    _Alignas(QUEUE_CACHE_LINE) _Atomic size_t tail;  ///< 다음에 넣을 위치 (생산자만 씀)
+    size_t head_cache;                                ///< 생산자가 마지막으로 본 head
+    _Alignas(QUEUE_CACHE_LINE) _Atomic size_t head;  ///< 다음에 꺼낼 위치 (소비자만 씀)
+    size_t tail_cache;                                ///< 소비자가 마지막으로 본 tail
+    _Alignas(QUEUE_CACHE_LINE) char *buf;            ///< 원소 배열
+    size_t mask;                                      ///< 용량 - 1
+    size_t elem_size;                                 ///< 원소 크기
+} SpscRing;
+
+/**
+ * @struct MpscQueue
+ * @brief 다중 생산자/단일 소비자 큐
+ *
+ * 칸은 [순번][원소] 로 이루어지고, 순번이 위치와 같으면 비어 있어 생산자가 차지할 수 있고, 위치 + 1 이면
+ * 게시되어 소비자가 꺼낼 수 있습니다. 소비자는 꺼낸 칸의 순번을 위치 + 용량 으로 바꿔 다음 바퀴의
+ * 생산자에게 돌려줍니다.
+ */
+typedef struct {
+    _Alignas(QUEUE_CACHE_LINE) _Atomic size_t tail;  ///< 생산자가 다음에 차지할 위치 (생산자끼리 CAS)
+    _Alignas(QUEUE_CACHE_LINE) size_t head;          ///< 다음에 꺼낼 위치 (소비자 전용)
+    _Alignas(QUEUE_CACHE_LINE) char *slots;          ///< 칸 배열
+    size_t mask;                                      ///< 용량 - 1
+    size_t elem_size;                                 ///< 원소 크기
+    size_t stride;                                    ///< 칸 크기 (순번 + 원소, max_align_t 정렬)
+} MpscQueue;
+
+#define QUEUE_SLOT_HEADER \
+    ((sizeof(_Atomic size_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))  ///< 칸 안 원소 위치
+
+/**
+ * @brief 용량을 2의 거듭제곱으로 올림 (최소 2)
+ */
+static inline size_t queue_round_capacity(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    return size;
+}
+
+/**
+ * @brief SPSC 링 초기화
+ *
+ * @param ring 초기화할 링
+ * @param capacity 최대 원소 수 (2의 거듭제곱으로 올림)
+ * @param elem_size 원소 크기
+ * @return 성공 시 0, 메모리가 없으면 -1
+ */
+int spsc_init(SpscRing *ring, size_t capacity, size_t elem_size) {
+    capacity = queue_round_capacity(capacity);
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = (char *)aligned_alloc(QUEUE_CACHE_LINE,
+                                      (capacity * elem_size + QUEUE_CACHE_LINE - 1) & ~(size_t)(QUEUE_CACHE_LINE - 1));
+    if (ring->buf == NULL) {
+        return -1;
+    }
+    ring->mask = capacity - 1;
+    ring->elem_size = elem_size;
+    return 0;
+}
+
+/**
+ * @brief SPSC 링 해제 (남은 원소는 버림)
+ */
+void spsc_destroy(SpscRing *ring) {
+    free(ring->buf);
+    ring->buf = NULL;
+}
+
+/**
+ * @brief 원소를 최대 count 개 넣음 (생산자 전용)
+ *
+ * @param ring 대상 링
+ * @param elems 넣을 원소 배열
+ * @param count 원소 수
+ * @return 넣은 원소 수 (빈 칸이 모자라면 count 보다 작음)
+ */
+static inline size_t spsc_enqueue_batch(SpscRing *ring, const void *elems, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t capacity = ring->mask + 1;
+
+    if (capacity - (tail - ring->head_cache) < count) {
+        ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+    }
+    size_t space = capacity - (tail - ring->head_cache);
+    if (count > space) {
+        count = space;
+    }
+
+    // 끝에서 잘리면 두 번에 나눠 복사
+    size_t index = tail & ring->mask;
+    size_t first = count < capacity - index ? count : capacity - index;
+    memcpy(ring->buf + index * ring->elem_size, elems, first * ring->elem_size);
+    memcpy(ring->buf, (const char *)elems + first * ring->elem_size, (count - first) * ring->elem_size);
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief 원소 하나를 넣음 (생산자 전용)
+ *
+ * @return 성공 시 0, 가득 찼으면 -1
+ */
+static inline int spsc_enqueue(SpscRing *ring, const void *elem) {
+    return spsc_enqueue_batch(ring, elem, 1) == 1 ? 0 : -1;
+}
+
+/**
+ * @brief 원소를 최대 max 개 꺼냄 (소비자 전용)
+ *
+ * @param ring 대상 링
+ * @param out 꺼낸 원소를 담을 배열
+ * @param max 배열 크기
+ * @return 꺼낸 원소 수 (비었으면 0)
+ */
+static inline size_t spsc_dequeue_batch(SpscRing *ring, void *out, size_t max) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t capacity = ring->mask + 1;
+
+    if (ring->tail_cache - head < max) {
+        ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    }
+    size_t count = ring->tail_cache - head;
+    if (count > max) {
+        count = max;
+    }
+
+    size_t index = head & ring->mask;
+    size_t first = count < capacity - index ? count : capacity - index;
+    memcpy(out, ring->buf + index * ring->elem_size, first * ring->elem_size);
+    memcpy((char *)out + first * ring->elem_size, ring->buf, (count - first) * ring->elem_size);
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief 원소 하나를 꺼냄 (소비자 전용)
+ *
+ * @return 성공 시 0, 비었으면 -1
+ */
+static inline int spsc_dequeue(SpscRing *ring, void *out) {
+    return spsc_dequeue_batch(ring, out, 1) == 1 ? 0 : -1;
+}
+
+/**
+ * @brief 들어 있는 원소 수 (다른 쪽이 동시에 움직이면 근삿값)
+ */
+static inline size_t spsc_size(SpscRing *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return atomic_load_explicit(&ring->tail, memory_order_acquire) - head;
+}
+
+static inline _Atomic size_t *mpsc_slot_seq(MpscQueue *queue, size_t pos) {
+    return (_Atomic size_t *)(queue->slots + (pos & queue->mask) * queue->stride);
+}
+
+static inline void *mpsc_slot_elem(MpscQueue *queue, size_t pos) {
+    return queue->slots + (pos & queue->mask) * queue->stride + QUEUE_SLOT_HEADER;
+}
+
+/**
+ * @brief MPSC 큐 초기화
+ *
+ * @param queue 초기화할 큐
+ * @param capacity 최대 원소 수 (2의 거듭제곱으로 올림)
+ * @param elem_size 원소 크기
+ * @return 성공 시 0, 메모리가 없으면 -1
+ */
+int mpsc_init(MpscQueue *queue, size_t capacity, size_t elem_size) {
+    capacity = queue_round_capacity(capacity);
+    memset(queue, 0, sizeof(*queue));
+    queue->stride = (QUEUE_SLOT_HEADER + elem_size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+    queue->slots = (char *)aligned_alloc(QUEUE_CACHE_LINE, (capacity * queue->stride + QUEUE_CACHE_LINE - 1) &
+                                                               ~(size_t)(QUEUE_CACHE_LINE - 1));
+    if (queue->slots == NULL) {
+        return -1;
+    }
+    queue->mask = capacity - 1;
+    queue->elem_size = elem_size;
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(mpsc_slot_seq(queue, i), i);
+    }
+    return 0;
+}
+
+/**
+ * @brief MPSC 큐 해제 (남은 원소는 버림)
+ */
+void mpsc_destroy(MpscQueue *queue) {
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+/**
+ * @brief 빈 칸 하나를 차지 (여러 생산자가 동시에 호출 가능)
+ *
+ * 돌려받은 칸에 원소를 채운 뒤 반드시 mpsc_publish() 로 게시해야 합니다. 게시하지 않은 칸 뒤의 원소는
+ * 소비자가 꺼낼 수 없습니다.
+ *
+ * @param queue 대상 큐
+ * @param ticket 차지한 위치 (출력, mpsc_publish() 에 넘김)
+ * @return 원소를 채울 칸, 가득 찼으면 NULL
+ */
+static inline void *mpsc_reserve(MpscQueue *queue, size_t *ticket) {
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    while (1) {
+        size_t seq = atomic_load_explicit(mpsc_slot_seq(queue, pos), memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *ticket = pos;
+                return mpsc_slot_elem(queue, pos);
+            }
+        } else if (diff < 0) {
+            return NULL;  // 소비자가 아직 한 바퀴 전 원소를 꺼내지 않음
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief mpsc_reserve() 로 차지해 채운 칸을 소비자에게 게시
+ */
+static inline void mpsc_publish(MpscQueue *queue, size_t ticket) {
+    atomic_store_explicit(mpsc_slot_seq(queue, ticket), ticket + 1, memory_order_release);
+}
+
+/**
+ * @brief 원소 하나를 복사해 넣음 (여러 생산자가 동시에 호출 가능)
+ *
+ * @return 성공 시 0, 가득 찼으면 -1
+ */
+static inline int mpsc_enqueue(MpscQueue *queue, const void *elem) {
+    size_t ticket;
+    void *slot = mpsc_reserve(queue, &ticket);
+
+    if (slot == NULL) {
+        return -1;
+    }
+    memcpy(slot, elem, queue->elem_size);
+    mpsc_publish(queue, ticket);
+    return 0;
+}
+
+/**
+ * @brief 다음 원소를 꺼내지 않고 칸 안에서 봄 (소비자 전용)
+ *
+ * @return 다음 원소, 비었거나 생산자가 아직 채우는 중이면 NULL
+ */
+static inline void *mpsc_peek(MpscQueue *queue) {
+    size_t seq = atomic_load_explicit(mpsc_slot_seq(queue, queue->head), memory_order_acquire);
+    return seq == queue->head + 1 ? mpsc_slot_elem(queue, queue->head) : NULL;
+}
+
+/**
+ * @brief mpsc_peek() 로 본 원소의 칸을 생산자에게 돌려줌 (소비자 전용)
+ */
+static inline void mpsc_pop(MpscQueue *queue) {
+    atomic_store_explicit(mpsc_slot_seq(queue, queue->head), queue->head + queue->mask + 1, memory_order_release);
+    queue->head++;
+}
+
+/**
+ * @brief 게시된 원소를 최대 max 개 복사해 꺼냄 (소비자 전용)
+ *
+ * 앞에서부터 이어서 게시된 원소까지만 꺼내므로, 생산자가 채우는 중인 칸을 만나면 거기서 멈춥니다.
+ *
+ * @param queue 대상 큐
+ * @param out 꺼낸 원소를 담을 배열
+ * @param max 배열 크기
+ * @return 꺼낸 원소 수
+ */
+static inline size_t mpsc_dequeue_batch(MpscQueue *queue, void *out, size_t max) {
+    size_t count = 0;
+    void *elem;
+
+    while (count < max && (elem = mpsc_peek(queue)) != NULL) {
+        memcpy((char *)out + count * queue->elem_size, elem, queue->elem_size);
+        mpsc_pop(queue);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 원소 하나를 복사해 꺼냄 (소비자 전용)
+ *
+ * @return 성공 시 0, 비었으면 -1
+ */
+static inline int mpsc_dequeue(MpscQueue *queue, void *out) {
+    return mpsc_dequeue_batch(queue, out, 1) == 1 ? 0 : -1;
+}
+
+/**
+ * @brief 생산자가 지금까지 차지한 위치의 끝
+ *
+ * 이 위치 앞의 칸은 모두 게시됐거나 차지한 생산자가 채우는 중이므로, 소비자는 head 가 이 위치에
+ * 닿을 때까지 꺼내면 호출 시점 이전에 넣기 시작한 원소를 모두 처리한 것입니다.
+ */
+static inline size_t mpsc_reserved(MpscQueue *queue) {
+    return atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
@@ -0,0 +1,718 @@
+#pragma once
+/**
+ * @file room.h
+ * @brief 채팅방 이름/ID 로 방을 찾고, 방마다 멤버 목록을 유지하는 방 레지스트리
+ *
+ * 방은 처음 입장할 때 생성되고, 마지막 멤버가 나간 뒤 유예 시간(idle_grace_ms) 동안 아무도 들어오지
+ * 않으면 정리 스레드가 회수합니다. 방은 이름과 ID 두 해시 인덱스로 O(1) 에 찾습니다. 숫자 이름("7")의
+ * 방은 그 숫자를 ID 로 쓰고, 그 밖의 이름은 ROOM_ID_NUMERIC_MAX 위의 ID 를 생성 순서대로 받습니다.
+ * 멤버 목록은 조밀 배열이며, 각 멤버는 배열 안의 자기 위치를 기억하고 브로드캐스트는 해당 방의
+ * 멤버만 순회합니다.
+ *
+ * 방 조회와 방 배열 순회는 레지스트리 읽기 잠금 안에서 하고, 방 생성/회수만 쓰기 잠금을 잡습니다.
+ * 찾은 방의 멤버 배열은 RCU 방식으로 게시합니다. 순회하는 쪽은 epoch_enter() 안에서 room_members() 로
+ * 얻은 배열을 방 뮤텍스 없이 읽고, 입장/퇴장은 방 뮤텍스로 직렬화합니다. 입장은 빈 자리가 있으면 배열
+ * 끝에 추가만 하고, 퇴장은 자기 칸을 비워 두기만 하므로(순회하는 쪽은 빈 칸을 건너뜀) 남은 멤버가 자리를
+ * 옮기지 않아 순회 중인 쪽이 멤버를 놓치지 않습니다. 빈 칸이 절반을 넘으면 빈 칸을 뺀 새 배열을 만들어
+ * 교체하고 이전 배열을 epoch_retire() 로 넘기므로, 대량 퇴장도 멤버당 상수 시간에 처리됩니다. 회수한
+ * 방도 epoch_retire() 로 해제하므로, 읽기 구역 안에서 찾은 방은 레지스트리 잠금을 푼 뒤에도 구역이
+ * 끝날 때까지 유효합니다.
+ *
+ * 방마다 멤버 수, 누적 메시지 수, 초당 메시지 수, 마지막 활동 시각을 원자 변수로 유지하므로, 방이
+ * 수만 개여도 목록 출력은 레지스트리 읽기 잠금 안에서 방 배열을 훑으며 이 값들만 읽고, 멤버 배열이나
+ * 방 뮤텍스는 건드리지 않습니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "epoch.h"
+
+#define ROOM_REGISTRY_INITIAL_CAPACITY 16   ///< 해시 인덱스 초기 크기 (2의 거듭제곱)
+#define ROOM_INITIAL_MEMBERS 8              ///< 방 멤버 배열 초기 크기
+#define ROOM_COMPACT_MIN_HOLES 16           ///< 빈 칸이 이만큼 쌓이고 절반 이상이면 멤버 배열을 압축
+#define ROOM_NAME_MAX 32                    ///< 방 이름 최대 길이 (NUL 포함)
+#define ROOM_ID_NUMERIC_MAX 0x3fffffff      ///< 숫자 이름 방의 ID 상한 (이름 방은 그 위의 ID 를 받음)
+#define ROOM_IDLE_GRACE_MS 60000            ///< 빈 방을 회수하기까지 기본 유예 시간
+#define ROOM_SWEEP_INTERVAL_MS 1000         ///< 정리 스레드 주기 (통계 갱신 간격)
+#define ROOM_RATE_WEIGHT 0.3                ///< 초당 메시지 지수 평균에서 새 구간의 비중
+
+/**
+ * @struct RoomMember
+ * @brief 방 멤버 항목
+ */
+typedef struct {
+    _Atomic(void *) member; ///< 멤버 (서버에서는 ClientInfo, 퇴장한 빈 칸은 NULL)
+    uint32_t *index;        ///< 멤버 쪽에 저장된 배열 위치 (압축으로 자리를 옮길 때 갱신)
+} RoomMember;
+
+/**
+ * @struct RoomMembers
+ * @brief 한 시점의 멤버 목록 (게시된 뒤에는 끝에 추가하거나 칸을 비우기만 함)
+ */
+typedef struct {
+    _Atomic uint32_t count;    ///< 사용한 칸 수, 빈 칸 포함 (항목을 채운 뒤 release 로 늘림)
+    uint32_t holes;            ///< 퇴장으로 비운 칸 수 (방 뮤텍스 보호)
+    uint32_t capacity;         ///< 항목 용량
+    RoomMember items[];        ///< 멤버 배열 (퇴장한 빈 칸은 member 가 NULL)
+} RoomMembers;
+
+/**
+ * @struct Room
+ * @brief 채팅방
+ */
+typedef struct Room {
+    int room_id;                       ///< 채팅방 ID (회수된 방의 ID 는 같은 이름이 다시 만들어질 때만 재사용)
+    uint32_t name_hash;                ///< room_name_hash(name)
+    uint32_t slot;                     ///< 레지스트리 rooms 배열 위치
+    uint8_t name_len;                  ///< 이름 길이
+    char name[ROOM_NAME_MAX];          ///< 채팅방 이름 (NUL 종료)
+    _Atomic(RoomMembers *) members;    ///< 현재 멤버 목록 (입장 전에는 NULL)
+    pthread_mutex_t lock;              ///< 입장/퇴장 직렬화 (순회는 잠금 없음)
+    EpochDomain *epoch;                ///< 교체한 멤버 목록을 회수할 도메인
+    _Atomic uint32_t member_count;     ///< 멤버 수 (목록 출력용, 입장/퇴장 때 갱신)
+    atomic_long messages;              ///< 누적 메시지 수
+    _Atomic int64_t last_active_ms;    ///< 마지막 입장/퇴장/메시지 시각 (CLOCK_MONOTONIC)
+    _Atomic double rate;               ///< 초당 메시지 수 (정리 스레드가 갱신하는 지수 평균)
+    long swept_messages;               ///< 정리 스레드가 마지막으로 본 messages (정리 스레드 전용)
+} Room;
+
+/**
+ * @struct RoomStats
+ * @brief 방 지표 (room_get_stats())
+ */
+typedef struct {
+    uint32_t members;      ///< 멤버 수
+    long messages;         ///< 누적 메시지 수
+    double rate;           ///< 초당 메시지 수
+    int64_t idle_ms;       ///< 마지막 활동 이후 지난 시간
+} RoomStats;
+
+/**
+ * @struct RoomRegistry
+ * @brief 방 이름/ID -> 방 해시 인덱스와 전체 방 목록
+ */
+typedef struct {
+    Room **rooms;              ///< 모든 방 (회수하면 마지막 방이 빈 자리로 옮겨감)
+    uint32_t room_count;       ///< 방 수
+    uint32_t room_capacity;    ///< rooms 배열 용량
+    Room **by_id;              ///< ID 선형 탐사 해시 테이블 (빈 칸은 NULL)
+    Room **by_name;            ///< 이름 선형 탐사 해시 테이블 (빈 칸은 NULL)
+    uint32_t index_capacity;   ///< 두 해시 테이블의 크기 (2의 거듭제곱)
+    int next_named_id;         ///< 다음 이름 방 ID
+    pthread_rwlock_t lock;     ///< 방 생성/회수는 쓰기, 조회/입장/순회는 읽기 잠금
+    EpochDomain *epoch;        ///< 멤버 목록과 회수한 방을 해제할 도메인
+    int64_t idle_grace_ms;     ///< 빈 방을 회수하기까지 유예 시간
+    int64_t swept_ms;          ///< 마지막 정리 시각 (정리 스레드 전용)
+    pthread_t sweeper;         ///< 정리 스레드
+    atomic_bool running;       ///< 정리 스레드 실행 여부
+    atomic_long created;       ///< 누적 생성한 방 수
+    atomic_long reclaimed;     ///< 누적 회수한 방 수
+} RoomRegistry;
+
+static inline int64_t room_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 방 레지스트리 초기화 (정리 스레드는 room_registry_start_sweeper() 로 따로 시작)
+ *
+ * @param registry 초기화할 레지스트리
+ * @param epoch 멤버 목록을 읽는 쪽이 사용하는 회수 도메인
+ * @return 성공 시 0, 실패 시 -1
+ */
+int room_registry_init(RoomRegistry *registry, EpochDomain *epoch) {
+    memset(registry, 0, sizeof(*registry));
+    registry->epoch = epoch;
+    registry->by_id = (Room **)calloc(ROOM_REGISTRY_INITIAL_CAPACITY, sizeof(Room *));
+    registry->by_name = (Room **)calloc(ROOM_REGISTRY_INITIAL_CAPACITY, sizeof(Room *));
+    if (registry->by_id == NULL || registry->by_name == NULL) {
+        free(registry->by_id);
+        free(registry->by_name);
+        return -1;
+    }
+    registry->index_capacity = ROOM_REGISTRY_INITIAL_CAPACITY;
+    registry->next_named_id = ROOM_ID_NUMERIC_MAX + 1;
+    registry->idle_grace_ms = ROOM_IDLE_GRACE_MS;
+    pthread_rwlock_init(&registry->lock, NULL);
+    return 0;
+}
+
+static inline uint32_t room_hash(int room_id) {
+    uint32_t h = (uint32_t)room_id;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * @brief 방 이름 해시 (FNV-1a, 이름 인덱스와 room 모드의 소유 워커 선택에 사용)
+ */
+static inline uint32_t room_name_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return room_hash((int)h);
+}
+
+/**
+ * @brief 숫자 이름이면 그 숫자를, 아니면 0 을 돌려줌 ("7" -> 7, "07" 과 "x7" -> 0)
+ */
+static int room_name_number(const char *name, size_t len) {
+    long value = 0;
+
+    if (len == 0 || len > 10 || name[0] == '0') {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return 0;
+        }
+        value = value * 10 + (name[i] - '0');
+    }
+    return value <= ROOM_ID_NUMERIC_MAX ? (int)value : 0;
+}
+
+static inline uint32_t room_index_hash(const Room *room, int by_name) {
+    return by_name ? room->name_hash : room_hash(room->room_id);
+}
+
+/**
+ * @brief ID 해시 테이블에서 방을 찾음 (잠금은 호출자가 잡음)
+ */
+static Room *room_registry_lookup(RoomRegistry *registry, int room_id) {
+    uint32_t mask = registry->index_capacity - 1;
+    for (uint32_t i = room_hash(room_id) & mask; registry->by_id[i] != NULL; i = (i + 1) & mask) {
+        if (registry->by_id[i]->room_id == room_id) {
+            return registry->by_id[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 이름 해시 테이블에서 방을 찾음 (잠금은 호출자가 잡음)
+ */
+static Room *room_registry_lookup_name(RoomRegistry *registry, const char *name, size_t len, uint32_t hash) {
+    uint32_t mask = registry->index_capacity - 1;
+    for (uint32_t i = hash & mask; registry->by_name[i] != NULL; i = (i + 1) & mask) {
+        Room *room = registry->by_name[i];
+        if (room->name_hash == hash && room->name_len == len && memcmp(room->name, name, len) == 0) {
+            return room;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 해시 테이블에 방을 넣음 (쓰기 잠금 상태에서 호출, 빈 칸이 있어야 함)
+ */
+static void room_registry_place(Room **index, uint32_t capacity, Room *room, int by_name) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = room_index_hash(room, by_name) & mask;
+    while (index[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    index[i] = room;
+}
+
+/**
+ * @brief 해시 테이블에서 방을 뺌 (쓰기 잠금 상태에서 호출)
+ *
+ * 빈 칸 뒤의 항목 중 원래 자리가 빈 칸 이전인 것을 당겨 채우므로 삭제 표시 없이 탐사가 이어집니다.
+ */
+static void room_registry_erase(Room **index, uint32_t capacity, Room *room, int by_name) {
+    uint32_t mask = capacity - 1;
+    uint32_t hole = room_index_hash(room, by_name) & mask;
+    while (index[hole] != room) {
+        hole = (hole + 1) & mask;
+    }
+    index[hole] = NULL;
+
+    for (uint32_t i = (hole + 1) & mask; index[i] != NULL; i = (i + 1) & mask) {
+        uint32_t home = room_index_hash(index[i], by_name) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            index[hole] = index[i];
+            index[i] = NULL;
+            hole = i;
+        }
+    }
+}
+
+/**
+ * @brief ID 로 방을 찾음
+ *
+ * 정리 스레드가 돌고 있으면 epoch_enter() 와 epoch_exit() 사이에서 호출하고 사용합니다.
+ *
+ * @param registry 방 레지스트리
+ * @param room_id 채팅방 ID
+ * @return 방, 없으면 NULL
+ */
+Room *room_registry_find(RoomRegistry *registry, int room_id) {
+    pthread_rwlock_rdlock(&registry->lock);
+    Room *room = room_registry_lookup(registry, room_id);
+    pthread_rwlock_unlock(&registry->lock);
+    return room;
+}
+
+/**
+ * @brief 이름으로 방을 찾음 (숫자 방은 "7" 처럼 10진수 이름)
+ *
+ * 정리 스레드가 돌고 있으면 epoch_enter() 와 epoch_exit() 사이에서 호출하고 사용합니다.
+ *
+ * @param registry 방 레지스트리
+ * @param name 채팅방 이름
+ * @param len 이름 길이
+ * @return 방, 없으면 NULL
+ */
+Room *room_registry_find_name(RoomRegistry *registry, const char *name, size_t len) {
+    uint32_t hash = room_name_hash(name, len);
+    pthread_rwlock_rdlock(&registry->lock);
+    Room *room = room_registry_lookup_name(registry, name, len, hash);
+    pthread_rwlock_unlock(&registry->lock);
+    return room;
+}
+
+/**
+ * @brief 새 방을 만들어 등록 (쓰기 잠금 상태에서 호출)
+ *
+ * @return 방, 메모리 부족 시 NULL
+ */
+static Room *room_registry_create(RoomRegistry *registry, const char *name, size_t len, uint32_t hash) {
+    // 적재율 50% 를 넘기 전에 해시 테이블을 두 배로
+    if ((registry->room_count + 1) * 2 > registry->index_capacity) {
+        uint32_t capacity = registry->index_capacity * 2;
+        Room **by_id = (Room **)calloc(capacity, sizeof(Room *));
+        Room **by_name = (Room **)calloc(capacity, sizeof(Room *));
+        if (by_id == NULL || by_name == NULL) {
+            free(by_id);
+            free(by_name);
+            return NULL;
+        }
+        for (uint32_t i = 0; i < registry->room_count; i++) {
+            room_registry_place(by_id, capacity, registry->rooms[i], 0);
+            room_registry_place(by_name, capacity, registry->rooms[i], 1);
+        }
+        free(registry->by_id);
+        free(registry->by_name);
+        registry->by_id = by_id;
+        registry->by_name = by_name;
+        registry->index_capacity = capacity;
+    }
+
+    if (registry->room_count == registry->room_capacity) {
+        uint32_t capacity = registry->room_capacity ? registry->room_capacity * 2 : ROOM_REGISTRY_INITIAL_CAPACITY;
+        Room **rooms = (Room **)realloc(registry->rooms, capacity * sizeof(Room *));
+        if (rooms == NULL) {
+            return NULL;
+        }
+        registry->rooms = rooms;
+        registry->room_capacity = capacity;
+    }
+
+    Room *room = (Room *)calloc(1, sizeof(Room));
+    if (room == NULL) {
+        return NULL;
+    }
+    room->room_id = room_name_number(name, len);
+    if (room->room_id == 0) {
+        // 이름 방 ID 는 다 쓰면 처음부터 다시 (살아 있는 방과 겹치면 건너뜀)
+        do {
+            room->room_id = registry->next_named_id;
+            registry->next_named_id = registry->next_named_id == INT32_MAX ? ROOM_ID_NUMERIC_MAX + 1
+                                                                            : registry->next_named_id + 1;
+        } while (room_registry_lookup(registry, room->room_id) != NULL);
+    }
+    room->name_hash = hash;
+    room->name_len = (uint8_t)len;
+    memcpy(room->name, name, len);
+    room->epoch = registry->epoch;
+    pthread_mutex_init(&room->lock, NULL);
+    atomic_init(&room->last_active_ms, room_now_ms());
+
+    room->slot = registry->room_count;
+    registry->rooms[registry->room_count++] = room;
+    room_registry_place(registry->by_id, registry->index_capacity, room, 0);
+    room_registry_place(registry->by_name, registry->index_capacity, room, 1);
+    atomic_fetch_add_explicit(&registry->created, 1, memory_order_relaxed);
+    return room;
+}
+
+/**
+ * @brief 이름으로 방을 찾고, 없으면 새로 만듦
+ *
+ * 돌려준 방은 정리 스레드가 회수할 수 있으므로, 정리 스레드를 쓰면 room_registry_join() 을 씁니다.
+ *
+ * @param registry 방 레지스트리
+ * @param name 채팅방 이름 (ROOM_NAME_MAX - 1 바이트 이하)
+ * @param len 이름 길이
+ * @return 방, 메모리 부족이나 이름이 너무 길면 NULL
+ */
+Room *room_registry_get(RoomRegistry *registry, const char *name, size_t len) {
+    uint32_t hash = room_name_hash(name, len);
+
+    if (len == 0 || len >= ROOM_NAME_MAX) {
+        return NULL;
+    }
+    pthread_rwlock_rdlock(&registry->lock);
+    Room *room = room_registry_lookup_name(registry, name, len, hash);
+    pthread_rwlock_unlock(&registry->lock);
+    if (room != NULL) {
+        return room;
+    }
+
+    pthread_rwlock_wrlock(&registry->lock);
+    room = room_registry_lookup_name(registry, name, len, hash);  // 잠금 사이에 다른 스레드가 만들었을 수 있음
+    if (room == NULL) {
+        room = room_registry_create(registry, name, len, hash);
+    }
+    pthread_rwlock_unlock(&registry->lock);
+    return room;
+}
+
+static void room_members_free(void *members) {
+    free(members);
+}
+
+/**
+ * @brief 회수한 방을 해제 (유예 기간이 지난 뒤 회수 스레드가 호출)
+ */
+static void room_free(void *ptr) {
+    Room *room = (Room *)ptr;
+    free(atomic_load_explicit(&room->members, memory_order_relaxed));
+    pthread_mutex_destroy(&room->lock);
+    free(room);
+}
+
+/**
+ * @brief 빈 칸을 뺀 멤버 목록을 새로 만들어 게시하고 이전 목록은 유예 기간 뒤에 해제 (방 뮤텍스 안에서 호출)
+ *
+ * @param room 대상 방
+ * @param capacity 새 목록 용량 (현재 멤버 수 이상)
+ * @return 성공 시 새 목록, 메모리 부족 시 NULL (현재 목록은 그대로)
+ */
+static RoomMembers *room_members_replace(Room *room, uint32_t capacity) {
+    RoomMembers *old = atomic_load_explicit(&room->members, memory_order_relaxed);
+    uint32_t count = old != NULL ? atomic_load_explicit(&old->count, memory_order_relaxed) : 0;
+    RoomMembers *members = (RoomMembers *)malloc(sizeof(RoomMembers) + capacity * sizeof(RoomMember));
+    uint32_t live = 0;
+
+    if (members == NULL) {
+        return NULL;
+    }
+    members->capacity = capacity;
+    members->holes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        void *member = atomic_load_explicit(&old->items[i].member, memory_order_relaxed);
+        if (member != NULL) {
+            atomic_init(&members->items[live].member, member);
+            members->items[live].index = old->items[i].index;
+            *members->items[live].index = live;
+            live++;
+        }
+    }
+    atomic_init(&members->count, live);
+    atomic_store_explicit(&room->members, members, memory_order_release);
+    if (old != NULL) {
+        epoch_retire(room->epoch, old, room_members_free);
+    }
+    return members;
+}
+
+/**
+ * @brief 방에 멤버를 추가
+ *
+ * @param room 대상 방
+ * @param member 추가할 멤버
+ * @param index 멤버 쪽에서 배열 위치를 저장할 곳 (퇴장할 때까지 유효해야 함)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int room_join(Room *room, void *member, uint32_t *index) {
+    pthread_mutex_lock(&room->lock);
+    RoomMembers *members = atomic_load_explicit(&room->members, memory_order_relaxed);
+    uint32_t count = members != NULL ? atomic_load_explicit(&members->count, memory_order_relaxed) : 0;
+    uint32_t live = members != NULL ? count - members->holes : 0;
+    if (members == NULL || count == members->capacity) {
+        // 늘리면서 빈 칸도 함께 정리
+        members = room_members_replace(room, live ? live * 2 : ROOM_INITIAL_MEMBERS);
+        if (members == NULL) {
+            pthread_mutex_unlock(&room->lock);
+            return -1;
+        }
+        count = live;
+    }
+
+    // 항목을 채운 뒤 멤버 수를 늘려, 순회하는 쪽이 채우기 전의 항목을 보지 않게 함
+    *index = count;
+    members->items[count].index = index;
+    atomic_store_explicit(&members->items[count].member, member, memory_order_release);
+    atomic_store_explicit(&members->count, count + 1, memory_order_release);
+    atomic_store_explicit(&room->member_count, live + 1, memory_order_relaxed);
+    atomic_store_explicit(&room->last_active_ms, room_now_ms(), memory_order_relaxed);
+    pthread_mutex_unlock(&room->lock);
+    return 0;
+}
+
+/**
+ * @brief 이름으로 방을 찾거나 만들어 멤버를 추가
+ *
+ * 레지스트리 잠금을 잡은 채 입장하므로, 정리 스레드가 방금 찾은 빈 방을 회수하는 일이 없습니다.
+ *
+ * @param registry 방 레지스트리
+ * @param name 채팅방 이름 (ROOM_NAME_MAX - 1 바이트 이하)
+ * @param len 이름 길이
+ * @param member 추가할 멤버
+ * @param index 멤버 쪽에서 배열 위치를 저장할 곳 (퇴장할 때까지 유효해야 함)
+ * @return 입장한 방, 메모리 부족이나 이름이 너무 길면 NULL
+ */
+Room *room_registry_join(RoomRegistry *registry, const char *name, size_t len, void *member, uint32_t *index) {
+    uint32_t hash = room_name_hash(name, len);
+
+    if (len == 0 || len >= ROOM_NAME_MAX) {
+        return NULL;
+    }
+    pthread_rwlock_rdlock(&registry->lock);
+    Room *room = room_registry_lookup_name(registry, name, len, hash);
+    if (room != NULL) {
+        room = room_join(room, member, index) == 0 ? room : NULL;
+        pthread_rwlock_unlock(&registry->lock);
+        return room;
+    }
+    pthread_rwlock_unlock(&registry->lock);
+
+    pthread_rwlock_wrlock(&registry->lock);
+    room = room_registry_lookup_name(registry, name, len, hash);  // 잠금 사이에 다른 스레드가 만들었을 수 있음
+    if (room == NULL) {
+        room = room_registry_create(registry, name, len, hash);
+    }
+    if (room != NULL && room_join(room, member, index) < 0) {
+        room = NULL;
+    }
+    pthread_rwlock_unlock(&registry->lock);
+    return room;
+}
+
+/**
+ * @brief 방에서 멤버를 제거 (자기 칸만 비움)
+ *
+ * 남은 멤버를 옮기지 않고 칸을 비우므로 순회 중인 쪽이 다른 멤버를 건너뛰지 않고, 새 목록을 만들지 않아
+ * 대량 퇴장에도 복사가 없습니다. 끝쪽 빈 칸은 칸 수를 줄여 잘라내고, 빈 칸이 ROOM_COMPACT_MIN_HOLES 개
+ * 이상이면서 절반을 넘으면 빈 칸을 뺀 목록을 게시합니다 (압축 한 번의 복사는 그 사이의 퇴장 수에
+ * 비례하므로 퇴장당 상수 비용). 메모리가 부족하면 압축을 다음 퇴장으로 미룹니다.
+ * 방이 비면 그때부터 유예 시간을 셉니다.
+ *
+ * @param room 대상 방
+ * @param index room_join() 에 넘겼던 위치 저장소
+ */
+void room_leave(Room *room, uint32_t *index) {
+    pthread_mutex_lock(&room->lock);
+    RoomMembers *members = atomic_load_explicit(&room->members, memory_order_relaxed);
+    uint32_t count = atomic_load_explicit(&members->count, memory_order_relaxed);
+
+    atomic_store_explicit(&members->items[*index].member, NULL, memory_order_relaxed);
+    members->holes++;
+    while (count > 0 && atomic_load_explicit(&members->items[count - 1].member, memory_order_relaxed) == NULL) {
+        count--;
+        members->holes--;
+    }
+    atomic_store_explicit(&members->count, count, memory_order_release);
+
+    uint32_t live = count - members->holes;
+    if (members->holes >= ROOM_COMPACT_MIN_HOLES && members->holes * 2 >= count) {
+        room_members_replace(room, members->capacity);
+    }
+    atomic_store_explicit(&room->last_active_ms, room_now_ms(), memory_order_relaxed);
+    atomic_store_explicit(&room->member_count, live, memory_order_relaxed);
+    pthread_mutex_unlock(&room->lock);
+}
+
+/**
+ * @brief 방의 현재 멤버 목록
+ *
+ * epoch_enter() 와 epoch_exit() 사이에서 호출하고 사용합니다.
+ *
+ * @param room 대상 방
+ * @return 멤버 목록, 아직 아무도 입장하지 않았으면 NULL
+ */
+RoomMembers *room_members(Room *room) {
+    return atomic_load_explicit(&room->members, memory_order_acquire);
+}
+
+/**
+ * @brief 멤버 목록의 칸 수 (퇴장으로 비운 칸 포함)
+ *
+ * @param members room_members() 결과 (NULL 가능)
+ * @return 칸 수
+ */
+uint32_t room_members_count(RoomMembers *members) {
+    return members != NULL ? atomic_load_explicit(&members->count, memory_order_acquire) : 0;
+}
+
+/**
+ * @brief 멤버 목록의 pos 번째 멤버
+ *
+ * @param members room_members() 결과
+ * @param pos 0 ~ room_members_count() - 1
+ * @return 멤버, 퇴장으로 비운 칸이면 NULL (호출자가 건너뜀)
+ */
+void *room_member_at(RoomMembers *members, uint32_t pos) {
+    return atomic_load_explicit(&members->items[pos].member, memory_order_acquire);
+}
+
+/**
+ * @brief 방의 멤버 수 (진단용, 읽는 즉시 바뀔 수 있음)
+ */
+uint32_t room_member_count(Room *room) {
+    return atomic_load_explicit(&room->member_count, memory_order_relaxed);
+}
+
+/**
+ * @brief 방에 메시지 하나가 오갔음을 기록 (초당 메시지 수와 마지막 활동 시각은 정리 스레드가 계산)
+ */
+static inline void room_note_message(Room *room) {
+    atomic_fetch_add_explicit(&room->messages, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief 방 지표를 읽음 (잠금 없음, 각 값은 읽는 즉시 바뀔 수 있음)
+ *
+ * @param room 대상 방
+ * @param stats 결과
+ * @param now_ms room_now_ms() 값 (여러 방을 읽을 때 한 번만 구함)
+ */
+void room_get_stats(Room *room, RoomStats *stats, int64_t now_ms) {
+    stats->members = atomic_load_explicit(&room->member_count, memory_order_relaxed);
+    stats->messages = atomic_load_explicit(&room->messages, memory_order_relaxed);
+    stats->rate = atomic_load_explicit(&room->rate, memory_order_relaxed);
+    stats->idle_ms = now_ms - atomic_load_explicit(&room->last_active_ms, memory_order_relaxed);
+}
+
+/**
+ * @brief 방 하나를 두 인덱스와 방 목록에서 빼고 유예 기간 뒤에 해제 (쓰기 잠금 상태에서 호출)
+ */
+static void room_registry_remove(RoomRegistry *registry, Room *room) {
+    room_registry_erase(registry->by_id, registry->index_capacity, room, 0);
+    room_registry_erase(registry->by_name, registry->index_capacity, room, 1);
+    Room *moved = registry->rooms[--registry->room_count];
+    registry->rooms[room->slot] = moved;
+    moved->slot = room->slot;
+    epoch_retire(registry->epoch, room, room_free);
+}
+
+/**
+ * @brief 방 지표를 갱신하고 유예 시간이 지난 빈 방을 회수
+ *
+ * 읽기 잠금으로 모든 방의 초당 메시지 수와 마지막 활동 시각을 갱신하고, 회수할 방이 있을 때만 쓰기
+ * 잠금을 잡습니다. 입장은 레지스트리 읽기 잠금 안에서만 하므로 쓰기 잠금 동안 빈 방은 계속 비어
+ * 있습니다. 한 스레드에서만 호출합니다 (보통 정리 스레드).
+ *
+ * @param registry 방 레지스트리
+ * @return 회수한 방 수
+ */
+long room_registry_sweep(RoomRegistry *registry) {
+    int64_t now = room_now_ms();
+    int64_t elapsed = registry->swept_ms > 0 ? now - registry->swept_ms : 0;
+    long expired = 0;
+
+    registry->swept_ms = now;
+    pthread_rwlock_rdlock(&registry->lock);
+    for (uint32_t i = 0; i < registry->room_count; i++) {
+        Room *room = registry->rooms[i];
+        long messages = atomic_load_explicit(&room->messages, memory_order_relaxed);
+        long delta = messages - room->swept_messages;
+
+        room->swept_messages = messages;
+        if (elapsed > 0) {
+            double rate = atomic_load_explicit(&room->rate, memory_order_relaxed);
+            rate += (delta * 1000.0 / elapsed - rate) * ROOM_RATE_WEIGHT;
+            atomic_store_explicit(&room->rate, rate < 0.01 ? 0.0 : rate, memory_order_relaxed);
+        }
+        if (delta > 0) {
+            atomic_store_explicit(&room->last_active_ms, now, memory_order_relaxed);
+        } else if (atomic_load_explicit(&room->member_count, memory_order_relaxed) == 0 &&
+                   now - atomic_load_explicit(&room->last_active_ms, memory_order_relaxed) >=
+                       registry->idle_grace_ms) {
+            expired++;
+        }
+    }
+    pthread_rwlock_unlock(&registry->lock);
+    if (expired == 0) {
+        return 0;
+    }
+
+    long reclaimed = 0;
+    pthread_rwlock_wrlock(&registry->lock);
+    for (uint32_t i = 0; i < registry->room_count;) {
+        Room *room = registry->rooms[i];
+        int idle = 0;
+        if (atomic_load_explicit(&room->member_count, memory_order_relaxed) == 0) {
+            // 방 뮤텍스를 거쳐 방금 끝난 퇴장의 활동 시각까지 보고, 퇴장이 방을 다 쓴 뒤에 회수
+            pthread_mutex_lock(&room->lock);
+            idle = now - atomic_load_explicit(&room->last_active_ms, memory_order_relaxed) >= registry->idle_grace_ms;
+            pthread_mutex_unlock(&room->lock);
+        }
+        if (idle) {
+            room_registry_remove(registry, room);  // 마지막 방이 i 로 옮겨오므로 i 를 그대로 둠
+            reclaimed++;
+        } else {
+            i++;
+        }
+    }
+    pthread_rwlock_unlock(&registry->lock);
+    atomic_fetch_add_explicit(&registry->reclaimed, reclaimed, memory_order_relaxed);
+    return reclaimed;
+}
+
+/**
+ * @brief 정리 스레드 본체
+ */
+static void *room_registry_sweeper(void *arg) {
+    RoomRegistry *registry = (RoomRegistry *)arg;
+    struct timespec interval = { ROOM_SWEEP_INTERVAL_MS / 1000, (ROOM_SWEEP_INTERVAL_MS % 1000) * 1000000L };
+
+    while (atomic_load(&registry->running)) {
+        room_registry_sweep(registry);
+        nanosleep(&interval, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 방 지표를 갱신하고 빈 방을 회수하는 백그라운드 정리 스레드를 시작
+ *
+ * @param registry 방 레지스트리
+ * @param idle_grace_ms 빈 방을 회수하기까지 유예 시간
+ * @return 성공 시 0, 실패 시 -1
+ */
+int room_registry_start_sweeper(RoomRegistry *registry, int64_t idle_grace_ms) {
+    registry->idle_grace_ms = idle_grace_ms;
+    atomic_store(&registry->running, true);
+    if (pthread_create(&registry->sweeper, NULL, room_registry_sweeper, registry) != 0) {
+        atomic_store(&registry->running, false);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 방 목록 순회를 위해 레지스트리 읽기 잠금을 잡음
+ */
+void room_registry_rdlock(RoomRegistry *registry) {
+    pthread_rwlock_rdlock(&registry->lock);
+}
+
+/**
+ * @brief room_registry_rdlock() 으로 잡은 잠금을 해제
+ */
+void room_registry_unlock(RoomRegistry *registry) {
+    pthread_rwlock_unlock(&registry->lock);
+}
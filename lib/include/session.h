@@ -0,0 +1,309 @@
+#pragma once
+/**
+ * @file session.h
+ * @brief 로그인에 성공한 연결에 발급하는 세션 토큰 캐시
+ *
+ * 토큰은 getrandom() 으로 만든 128비트 난수이며, 클라이언트에는 32자 16진수 문자열로 전달합니다.
+ * 다시 접속한 클라이언트가 토큰을 보내면 비밀번호와 유저 데이터베이스를 보지 않고 해시 조회 한 번으로
+ * 사용자명을 얻습니다. 토큰 자체가 난수이므로 앞 8바이트를 그대로 해시로 씁니다.
+ *
+ * 테이블은 해시 상위 비트로 고른 스트라이프로 나뉘고 스트라이프 안은 선형 탐사(probe.h)입니다.
+ * 스트라이프마다 잠금을 따로 가지므로, 재접속이 몰려도 한 잠금에서 경합하지 않습니다. 세션은 마지막 사용 후
+ * SESSION_TTL_MS 가 지나면 만료되며, 만료된 항목은 조회할 때와 스트라이프를 키우기 전에 정리합니다.
+ * 서버 메모리에만 있으므로 서버를 다시 시작하면 모두 사라집니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/random.h>
+#include "intern.h"
+#include "probe.h"
+
+#define SESSION_TOKEN_BYTES 16                            ///< 토큰 크기 (128비트)
+#define SESSION_TOKEN_HEX (SESSION_TOKEN_BYTES * 2)       ///< 16진수 문자열 길이
+#define SESSION_TTL_MS (24L * 60 * 60 * 1000)             ///< 마지막 사용 후 유효 기간 (하루)
+#define SESSION_STRIPE_SHIFT 4                            ///< 스트라이프 수 = 16
+#define SESSION_STRIPES (1u << SESSION_STRIPE_SHIFT)
+#define SESSION_STRIPE_INITIAL 64                         ///< 스트라이프별 초기 크기 (2의 거듭제곱)
+
+/**
+ * @struct SessionEntry
+ * @brief 세션 하나 (name 이 INTERN_NONE 이면 빈 칸)
+ */
+typedef struct {
+    uint8_t token[SESSION_TOKEN_BYTES];  ///< 토큰
+    InternId name;                       ///< 사용자명 (세션이 참조 하나를 가짐)
+    int64_t expires_ms;                  ///< 만료 시각 (CLOCK_MONOTONIC)
+} SessionEntry;
+
+/**
+ * @struct SessionStripe
+ * @brief 잠금 하나로 보호하는 세션 테이블 조각
+ */
+typedef struct {
+    SessionEntry *entries;    ///< 선형 탐사 테이블
+    uint32_t capacity;        ///< 테이블 크기 (2의 거듭제곱)
+    uint32_t count;           ///< 사용 중인 칸 수
+    pthread_mutex_t lock;     ///< 발급/조회/폐기 직렬화
+} SessionStripe;
+
+/**
+ * @struct SessionTable
+ * @brief 토큰 -> 사용자명 세션 테이블
+ */
+typedef struct {
+    InternTable *names;                        ///< 사용자명 인터닝 테이블
+    SessionStripe stripes[SESSION_STRIPES];    ///< 토큰 상위 비트로 나눈 조각
+} SessionTable;
+
+static inline int64_t session_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static inline uint64_t session_token_hash(const uint8_t *token) {
+    uint64_t hash;
+    memcpy(&hash, token, sizeof(hash));
+    return hash;
+}
+
+static inline SessionStripe *session_stripe(SessionTable *table, uint64_t hash) {
+    return &table->stripes[hash >> (64 - SESSION_STRIPE_SHIFT)];
+}
+
+// 스트라이프 안의 위치는 해시 하위 비트로 정함 (상위 비트는 스트라이프 선택에 씀)
+#define SESSION_EMPTY(entry) ((entry)->name == INTERN_NONE)
+#define SESSION_HASH(entry) ((uint32_t)session_token_hash((entry)->token))
+#define SESSION_MATCH(entry, bytes) (memcmp((entry)->token, (bytes), SESSION_TOKEN_BYTES) == 0)
+
+PROBE_TABLE(session, SessionEntry, SESSION_EMPTY, SESSION_HASH)
+PROBE_FIND(session_find, SessionEntry, const uint8_t *, SESSION_EMPTY, SESSION_MATCH)
+
+/**
+ * @brief 세션 테이블 초기화
+ *
+ * @param table 초기화할 테이블
+ * @param names 사용자명을 인터닝하는 테이블
+ * @return 성공 시 0, 실패 시 -1
+ */
+int session_table_init(SessionTable *table, InternTable *names) {
+    memset(table, 0, sizeof(*table));
+    table->names = names;
+    for (uint32_t i = 0; i < SESSION_STRIPES; i++) {
+        SessionStripe *stripe = &table->stripes[i];
+        stripe->entries = (SessionEntry *)calloc(SESSION_STRIPE_INITIAL, sizeof(SessionEntry));
+        if (stripe->entries == NULL) {
+            return -1;
+        }
+        stripe->capacity = SESSION_STRIPE_INITIAL;
+        pthread_mutex_init(&stripe->lock, NULL);
+    }
+    return 0;
+}
+
+/**
+ * @brief 칸을 비우고 뒤따르는 탐사 구간을 당겨 채움 (잠금은 호출자가 잡음, 사용자명 참조는 호출자가 반납)
+ */
+static void session_remove_at(SessionStripe *stripe, uint32_t pos) {
+    session_probe_remove_at(stripe->entries, stripe->capacity, pos);
+    stripe->count--;
+}
+
+/**
+ * @brief 스트라이프의 만료된 세션을 모두 정리 (잠금은 호출자가 잡음)
+ */
+static void session_sweep(SessionTable *table, SessionStripe *stripe, int64_t now) {
+    for (uint32_t i = 0; i < stripe->capacity;) {
+        SessionEntry *entry = &stripe->entries[i];
+        if (entry->name != INTERN_NONE && entry->expires_ms <= now) {
+            intern_release(table->names, entry->name);
+            session_remove_at(stripe, i);  // 당겨 온 항목을 다시 확인하도록 i 는 그대로
+            continue;
+        }
+        i++;
+    }
+}
+
+/**
+ * @brief 스트라이프 테이블을 두 배로 키움 (잠금은 호출자가 잡음)
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+static int session_grow(SessionStripe *stripe) {
+    uint32_t capacity = stripe->capacity * 2;
+    SessionEntry *entries = session_probe_resize(stripe->entries, stripe->capacity, capacity);
+    if (entries == NULL) {
+        return -1;
+    }
+    stripe->entries = entries;
+    stripe->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief 128비트 난수 토큰 생성
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int session_random_token(uint8_t *token) {
+    size_t filled = 0;
+    while (filled < SESSION_TOKEN_BYTES) {
+        ssize_t n = getrandom(token + filled, SESSION_TOKEN_BYTES - filled, 0);
+        if (n < 0) {
+            return -1;
+        }
+        filled += (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief 세션을 발급
+ *
+ * @param table 세션 테이블
+ * @param name 사용자명 핸들 (세션이 참조 하나를 더 얻음)
+ * @param hex 토큰 16진수 문자열을 받을 버퍼 (SESSION_TOKEN_HEX + 1 바이트)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int session_create(SessionTable *table, InternId name, char *hex) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+
+    if (name == INTERN_NONE || session_random_token(token) < 0) {
+        return -1;
+    }
+    uint64_t hash = session_token_hash(token);
+    SessionStripe *stripe = session_stripe(table, hash);
+    int64_t now = session_now_ms();
+
+    pthread_mutex_lock(&stripe->lock);
+    // 적재율 50% 를 넘지 않도록 유지 (키우기 전에 만료된 세션부터 정리)
+    if ((stripe->count + 1) * 2 > stripe->capacity) {
+        session_sweep(table, stripe, now);
+        if ((stripe->count + 1) * 2 > stripe->capacity && session_grow(stripe) < 0) {
+            pthread_mutex_unlock(&stripe->lock);
+            return -1;
+        }
+    }
+    size_t i = session_probe_slot(stripe->entries, stripe->capacity, (uint32_t)hash);
+    memcpy(stripe->entries[i].token, token, SESSION_TOKEN_BYTES);
+    stripe->entries[i].name = name;
+    stripe->entries[i].expires_ms = now + SESSION_TTL_MS;
+    stripe->count++;
+    intern_retain(table->names, name);
+    pthread_mutex_unlock(&stripe->lock);
+
+    for (int b = 0; b < SESSION_TOKEN_BYTES; b++) {
+        snprintf(hex + b * 2, 3, "%02x", token[b]);
+    }
+    return 0;
+}
+
+/**
+ * @brief 16진수 토큰 문자열을 바이트로 변환
+ *
+ * @return 성공 시 0, 형식이 잘못되면 -1
+ */
+static int session_parse_token(const char *hex, size_t len, uint8_t *token) {
+    if (len != SESSION_TOKEN_HEX) {
+        return -1;
+    }
+    for (int b = 0; b < SESSION_TOKEN_BYTES; b++) {
+        int value = 0;
+        for (int k = 0; k < 2; k++) {
+            char c = hex[b * 2 + k];
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0) {
+                return -1;
+            }
+            value = value * 16 + digit;
+        }
+        token[b] = (uint8_t)value;
+    }
+    return 0;
+}
+
+/**
+ * @brief 토큰으로 세션을 찾아 유효 기간을 연장
+ *
+ * @param table 세션 테이블
+ * @param hex 토큰 16진수 문자열 (NUL 로 끝나지 않아도 됨)
+ * @param len 문자열 길이
+ * @return 사용자명 핸들 (호출자가 참조 하나를 얻으므로 intern_release() 로 반납), 없거나 만료되면 INTERN_NONE
+ */
+InternId session_resume(SessionTable *table, const char *hex, size_t len) {
+    uint8_t token[SESSION_TOKEN_BYTES];
+    InternId name = INTERN_NONE;
+
+    if (session_parse_token(hex, len, token) < 0) {
+        return INTERN_NONE;
+    }
+    uint64_t hash = session_token_hash(token);
+    SessionStripe *stripe = session_stripe(table, hash);
+    int64_t now = session_now_ms();
+
+    pthread_mutex_lock(&stripe->lock);
+    long pos = session_find(stripe->entries, stripe->capacity, (uint32_t)hash, token);
+    if (pos >= 0) {
+        SessionEntry *entry = &stripe->entries[pos];
+        if (entry->expires_ms <= now) {
+            intern_release(table->names, entry->name);
+            session_remove_at(stripe, (uint32_t)pos);
+        } else {
+            name = entry->name;
+            intern_retain(table->names, name);
+            entry->expires_ms = now + SESSION_TTL_MS;
+        }
+    }
+    pthread_mutex_unlock(&stripe->lock);
+    return name;
+}
+
+/**
+ * @brief 사용자의 모든 세션을 폐기 (사용자를 삭제할 때 호출, 테이블 전체를 훑음)
+ *
+ * @param table 세션 테이블
+ * @param name 사용자명 핸들
+ * @return 폐기한 세션 수
+ */
+uint32_t session_revoke_user(SessionTable *table, InternId name) {
+    uint32_t revoked = 0;
+
+    if (name == INTERN_NONE) {
+        return 0;
+    }
+    for (uint32_t s = 0; s < SESSION_STRIPES; s++) {
+        SessionStripe *stripe = &table->stripes[s];
+        pthread_mutex_lock(&stripe->lock);
+        for (uint32_t i = 0; i < stripe->capacity;) {
+            if (stripe->entries[i].name == name) {
+                intern_release(table->names, name);
+                session_remove_at(stripe, i);
+                revoked++;
+                continue;
+            }
+            i++;
+        }
+        pthread_mutex_unlock(&stripe->lock);
+    }
+    return revoked;
+}
+
+/**
+ * @brief 유효한 세션 수 (만료됐지만 아직 정리되지 않은 세션 포함)
+ */
+uint32_t session_count(SessionTable *table) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < SESSION_STRIPES; i++) {
+        pthread_mutex_lock(&table->stripes[i].lock);
+        count += table->stripes[i].count;
+        pthread_mutex_unlock(&table->stripes[i].lock);
+    }
+    return count;
+}
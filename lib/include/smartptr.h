@@ -1,95 +1,93 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <pthread.h>
-#include <netdb.h>
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <sys/types.h>
-#include <unistd.h>
-#include <errno.h>
-#include <semaphore.h>
-#include <sys/socket.h>
-#include <sys/wait.h>
-#include <fcntl.h>
-#include <stdbool.h>
-#include <stdarg.h>
-#include <dlfcn.h>
-#include <pthread.h>
-#include <stdlib.h>
-#include <sys/socket.h>
-
-// 고급 오류 처리 함수 구현
-#include "ename.c.inc"
+#pragma once
+/**
+ * @file smartptr.h
+ * @brief 참조 카운트 스마트 포인터
+ *
+ * 제어 블록(참조 카운트)과 데이터를 한 번의 malloc 으로 연속 할당하고, 참조 카운트는 C11 원자 연산으로
+ * 증감합니다. retain 은 relaxed 로 충분하고, release 는 release 순서로 감소시킨 뒤 마지막 참조를 놓은
+ * 스레드만 acquire 펜스를 거쳐 메모리를 해제합니다. 그래서 다른 스레드가 해제 전에 기록한 내용이
+ * 해제하는 스레드에 모두 보입니다. smart_ptr_alloc_pooled() 로 만들면 블록은 객체 풀에서 가져오고 풀로 돌려줍니다.
+ */
 
-#define BUF_SIZE 100
-#define NUM_THREADS 3
-#define MAX_STRING_SIZE 100
+#include <stddef.h>
+#include <stdatomic.h>
+#include "kernel_util.h"
+#include "pool.h"
 
 typedef struct SmartPtr SmartPtr;
 #define CREATE_SMART_PTR(type, ...) create_smart_ptr(sizeof(type), __VA_ARGS__)
 
-static void retain(SmartPtr *sp);
-static void release(SmartPtr *sp);
-static void safe_kernel_printf(const char *format, ...);
-static void kernel_socket_communication(int sock_fd, const char *message, char *response, size_t response_size);
-static void kernel_create_thread(pthread_t *thread, void *(*start_routine)(void *), void *arg);
+static inline void retain(SmartPtr *sp);
+static inline void release(SmartPtr *sp);
 static void* thread_function(void* arg);
-static void terminate(bool useExit3);
-static void kernel_join_thread(pthread_t thread);
-static void kernel_wait_for_process(pid_t pid);
-static void kernel_errExit(const char *format, ...);
-static void outputError(bool useErr, int err, bool flushStdout, const char *format, va_list ap);
 
-static pthread_mutex_t print_mutex = PTHREAD_MUTEX_INITIALIZER;
+/**
+ * @struct SmartPtrControl
+ * @brief 스마트 포인터 제어 블록
+ *
+ * 데이터는 제어 블록 바로 뒤(payload)에 놓이며, 어떤 타입이든 담을 수 있도록 max_align_t 로 정렬합니다.
+ */
+typedef struct SmartPtrControl {
+    _Atomic int ref_count;                            ///< 참조 카운트
+    void (*free_block)(void *block);                  ///< 블록 해제 함수 (free 또는 pool_free)
+    _Alignas(max_align_t) unsigned char payload[];    ///< 실제 데이터
+} SmartPtrControl;
 
 /**
  * @struct SmartPtr
  * @brief 스마트 포인터 구조체
  *
- * 이 구조체는 포인터와 참조 카운트, 뮤텍스를 관리합니다.
+ * 값으로 복사해 전달하며, 복사본마다 retain()/release() 짝을 맞춥니다.
  */
 typedef struct SmartPtr {
-    void *ptr;                ///< 실제 메모리를 가리킴
-    int *ref_count;           ///< 참조 카운트
-    pthread_mutex_t *mutex;   ///< 뮤텍스 보호
+    void *ptr;                ///< 실제 메모리를 가리킴 (ctrl->payload)
+    SmartPtrControl *ctrl;    ///< 참조 카운트가 담긴 제어 블록
 } SmartPtr;
 
 /**
- * @brief 네트워크 정보를 저장하는 구조체
+ * @brief 초기화하지 않은 size 바이트 데이터를 담는 스마트 포인터를 할당 (참조 카운트 1)
+ *
+ * @param size 데이터 크기
+ * @return SmartPtr 스마트 포인터, 메모리 부족 시 ptr 이 NULL
  */
-typedef struct {
-    char ip[INET_ADDRSTRLEN];  ///< IPv4 주소
-    sa_family_t family;        ///< 주소 패밀리 (AF_INET 등)
-} NetworkInfo;
+SmartPtr smart_ptr_alloc(size_t size) {
+    SmartPtr sp = { NULL, NULL };
+    SmartPtrControl *ctrl = (SmartPtrControl *)malloc(sizeof(SmartPtrControl) + size);
+
+    if (ctrl == NULL) {
+        return sp;
+    }
+    atomic_init(&ctrl->ref_count, 1);
+    ctrl->free_block = free;
+    sp.ptr = ctrl->payload;
+    sp.ctrl = ctrl;
+    return sp;
+}
 
 /**
- * @brief 로컬 네트워크 정보를 가져오는 함수
+ * @brief 객체 풀의 블록에 데이터를 담는 스마트 포인터를 할당 (참조 카운트 1)
+ *
+ * 제어 블록과 데이터가 풀 객체 크기를 넘으면 smart_ptr_alloc() 으로 대신 할당합니다.
  *
- * @return NetworkInfo 로컬 네트워크 정보가 저장된 구조체
+ * @param pool 객체 풀
+ * @param size 데이터 크기
+ * @return SmartPtr 스마트 포인터, 메모리 부족 시 ptr 이 NULL
  */
-NetworkInfo get_local_network_info() {
-    struct addrinfo hints, *res;
-    NetworkInfo net_info;
-
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_flags = AI_PASSIVE;
+SmartPtr smart_ptr_alloc_pooled(ObjectPool *pool, size_t size) {
+    SmartPtr sp = { NULL, NULL };
 
-    char hostname[256];
-    gethostname(hostname, sizeof(hostname));
-    if (getaddrinfo(hostname, NULL, &hints, &res) != 0) {
-        perror("getaddrinfo 실패");
-        exit(EXIT_FAILURE);
+    if (sizeof(SmartPtrControl) + size > pool->object_size) {
+        return smart_ptr_alloc(size);
     }
-
-    struct sockaddr_in *ipv4 = (struct sockaddr_in *)res->ai_addr;
-    inet_ntop(AF_INET, &(ipv4->sin_addr), net_info.ip, INET_ADDRSTRLEN);
-    net_info.family = res->ai_family;
-
-    freeaddrinfo(res);
-    return net_info;
+    SmartPtrControl *ctrl = (SmartPtrControl *)pool_alloc(pool);
+    if (ctrl == NULL) {
+        return sp;
+    }
+    atomic_init(&ctrl->ref_count, 1);
+    ctrl->free_block = pool_free;
+    sp.ptr = ctrl->payload;
+    sp.ctrl = ctrl;
+    return sp;
 }
 
 /**
@@ -100,12 +98,10 @@ NetworkInfo get_local_network_info() {
  * @return SmartPtr 스마트 포인터 구조체
  */
 SmartPtr create_smart_ptr(size_t size, ...) {
-    SmartPtr sp;
-    sp.ptr = malloc(size);
-    sp.ref_count = (int *)malloc(sizeof(int));
-    *(sp.ref_count) = 1;
-    sp.mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    pthread_mutex_init(sp.mutex, NULL);
+    SmartPtr sp = smart_ptr_alloc(size);
+    if (sp.ptr == NULL) {
+        kernel_errExit("Failed to allocate smart pointer");
+    }
 
     va_list args;
     va_start(args, size);
@@ -125,12 +121,12 @@ SmartPtr create_smart_ptr(size_t size, ...) {
 /**
  * @brief 스마트 포인터의 참조 카운트를 증가시키는 함수
  *
+ * 이미 참조를 가진 쪽에서만 호출하므로 순서 보장이 필요 없습니다.
+ *
  * @param sp 증가시킬 스마트 포인터
  */
-static void retain(SmartPtr *sp) {
-    pthread_mutex_lock(sp->mutex);
-    (*(sp->ref_count))++;
-    pthread_mutex_unlock(sp->mutex);
+static inline void retain(SmartPtr *sp) {
+    atomic_fetch_add_explicit(&sp->ctrl->ref_count, 1, memory_order_relaxed);
 }
 
 /**
@@ -138,106 +134,15 @@ static void retain(SmartPtr *sp) {
  *
  * @param sp 해제할 스마트 포인터
  */
-static void release(SmartPtr *sp) {
-    int should_free = 0;
-
-    pthread_mutex_lock(sp->mutex);
-    (*(sp->ref_count))--;
-    safe_kernel_printf("Smart pointer released (ref_count: %d)\n", *(sp->ref_count));
-
-    if (*(sp->ref_count) == 0) {
-        should_free = 1;
-        safe_kernel_printf("Reference count is 0, freeing memory...\n");
-    }
-
-    pthread_mutex_unlock(sp->mutex);
-
-    if (should_free) {
-        free(sp->ptr);
+static inline void release(SmartPtr *sp) {
+    if (atomic_fetch_sub_explicit(&sp->ctrl->ref_count, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        sp->ctrl->free_block(sp->ctrl);
         sp->ptr = NULL;
-        free(sp->ref_count);
-        sp->ref_count = NULL;
-
-        pthread_mutex_destroy(sp->mutex);
-        free(sp->mutex);
-        sp->mutex = NULL;
-
-        safe_kernel_printf("Memory has been freed\n");
+        sp->ctrl = NULL;
     }
 }
 
-static void outputError(bool useErr, int err, bool flushStdout, const char *format, va_list ap)
-{
-    char buf[BUF_SIZE], userMsg[BUF_SIZE], errText[BUF_SIZE];
-
-    vsnprintf(userMsg, BUF_SIZE, format, ap);
-
-    if (useErr)
-        snprintf(errText, BUF_SIZE, " [%s %s]",
-                 (err > 0 && err <= MAX_ENAME) ? ename[err] : "?UNKNOWN?", strerror(err));
-    else
-        snprintf(errText, BUF_SIZE, ":");
-
-    if (flushStdout)
-        fflush(stdout);
-
-    fputs(buf, stderr);
-    fflush(stderr);
-}
-
-/**
- * @brief 스레드 안전한 출력 함수
- *
- * @param format 출력할 메시지 형식
- */
-static void safe_kernel_printf(const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-
-    pthread_mutex_lock(&print_mutex);
-    vprintf(format, args);
-    pthread_mutex_unlock(&print_mutex);
-
-    if(errno != 0) {
-        kernel_errExit("Failed to print message");
-    }
-
-    va_end(args);
-}
-
-/**
- * @brief 오류 메시지를 출력하고 프로그램을 종료하는 함수
- *
- * @param format 출력할 오류 메시지 형식
- */
-static void kernel_errExit(const char *format, ...) {
-    va_list argList;
-    va_start(argList, format);
-
-    safe_kernel_printf("ERROR: %s\n", format);
-    fprintf(stderr, "errno: %d (%s)\n", errno, strerror(errno));
-    fflush(stdout);
-    va_end(argList);
-
-    terminate(true);
-}
-
-/**
- * @brief 프로그램 종료 처리 함수
- *
- * @param useExit3 true면 exit() 호출, false면 _exit() 호출
- */
-static void terminate(bool useExit3) {
-    char *s = getenv("EF_DUMPCORE");
-
-    if (s != NULL && *s != '\0')
-        abort();
-    else if (useExit3)
-        exit(EXIT_FAILURE);
-    else
-        _exit(EXIT_FAILURE);
-}
-
 /**
  * @brief 스레드에서 수행할 함수
  *
@@ -256,73 +161,3 @@ void* thread_function(void* arg) {
     safe_kernel_printf("Thread %d: 종료 - 주소 패밀리: %d\n", thread_num, net_info.family);
     return NULL;
 }
-
-/**
- * @brief 소켓을 사용한 메시지 전송 및 수신 함수
- *
- * @param sock_fd 소켓 파일 디스크립터
- * @param message 전송할 메시지
- * @param response 수신할 응답
- * @param response_size 응답 버퍼 크기
- */
-static void kernel_socket_communication(int sock_fd, const char *message, char *response, size_t response_size) {
-    if (write(sock_fd, message, strlen(message)) == -1) {
-        safe_kernel_printf("Failed to send message through socket");
-        kernel_errExit("Failed to send message through socket");
-    }
-
-    ssize_t bytes_read = read(sock_fd, response, response_size - 1);
-    if (bytes_read == -1) {
-        safe_kernel_printf("Failed to receive message from socket");
-        kernel_errExit("Failed to receive message from socket");
-    }
-
-    response[bytes_read] = '\0';
-}
-
-/**
- * @brief 자식 프로세스를 대기하는 함수
- *
- * @param pid 자식 프로세스의 PID
- */
-static void kernel_wait_for_process(pid_t pid) {
-    int status;
-    if (waitpid(pid, &status, 0) < 0) {
-        safe_kernel_printf("Failed to wait for process");
-        kernel_errExit("Failed to wait for process");
-    } else {
-        safe_kernel_printf("Child process exited with status %d\n", status);
-    }
-}
-
-/**
- * @brief 스레드를 생성하는 함수
- *
- * @param thread 생성할 스레드의 포인터
- * @param start_routine 스레드에서 실행할 함수
- * @param arg 스레드 함수에 전달할 인수
- */
-static void kernel_create_thread(pthread_t *thread, void *(*start_routine)(void *), void *arg) {
-    int err = pthread_create(thread, NULL, start_routine, arg);
-    if (err != 0) {
-        safe_kernel_printf("Failed to create thread");
-        kernel_errExit("Failed to create thread");
-    } else {
-        safe_kernel_printf("Thread created successfully\n");
-    }
-}
-
-/**
- * @brief 스레드 종료를 대기하는 함수
- *
- * @param thread 종료 대기할 스레드
- */
-static void kernel_join_thread(pthread_t thread) {
-    int err = pthread_join(thread, NULL);
-    if (err != 0) {
-        safe_kernel_printf("Failed to join thread");
-        kernel_errExit("Failed to join thread");
-    } else {
-        safe_kernel_printf("Thread joined successfully\n");
-    }
-}
\ No newline at end of file
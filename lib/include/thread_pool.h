@@ -0,0 +1,427 @@
+#pragma once
+/**
+ * @file thread_pool.h
+ * @brief 고정 크기 워커 스레드 풀 (작은 스택, CPU 고정, 작업 훔치기)
+ *
+ * 작업을 넣을 때마다 스레드를 만들지 않고, 시작할 때 만든 워커들이 작업을 나눠 실행합니다.
+ * 워커는 작은 스택(기본 256KB)으로 만들어 연결 수와 무관하게 스레드 수와 가상 메모리가 고정되고,
+ * 원하면 워커 i 를 CPU (i % CPU 수) 에 고정합니다.
+ *
+ * 워커마다 작업 큐가 있고, thread_pool_submit() 은 지정한 워커의 큐 끝에 넣습니다. 워커는 자기 큐의
+ * 앞에서 꺼내 실행하고, 비면 다른 워커의 큐 끝에서 작업을 하나 훔칩니다. 그래서 한 워커에 작업이
+ * 몰려도 나머지 워커가 쉬지 않습니다. 자는 워커가 있는데 바쁜 워커의 큐에 작업이 쌓이면 자는 워커 하나를
+ * 깨워 훔쳐 가게 합니다.
+ *
+ * 큐는 워커마다 뮤텍스 하나로 보호하는 원형 배열입니다. 주인과 도둑이 양 끝을 쓰고, 같은 큐를 동시에
+ * 잡는 일은 드뭅니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#define THREAD_POOL_DEFAULT_STACK (256 * 1024)  ///< 워커 스택 기본 크기 (pthread 기본값은 보통 8MB)
+#define THREAD_POOL_INITIAL_TASKS 64            ///< 워커 큐의 처음 용량 (가득 차면 두 배로 늘림)
+#define THREAD_POOL_CACHE_LINE 64               ///< 워커 상태 정렬 단위
+
+/**
+ * @brief 워커가 실행할 함수
+ */
+typedef void (*ThreadPoolFn)(void *arg);
+
+/**
+ * @struct ThreadPoolTask
+ * @brief 작업 하나
+ */
+typedef struct {
+    ThreadPoolFn fn;   ///< 실행할 함수
+    void *arg;         ///< 인자
+} ThreadPoolTask;
+
+struct ThreadPool;
+
+/**
+ * @struct ThreadPoolWorker
+ * @brief 워커 하나의 큐와 통계 (워커마다 캐시 라인을 따로 씀)
+ */
+typedef struct {
+    _Alignas(THREAD_POOL_CACHE_LINE) pthread_mutex_t lock;  ///< 큐와 잠들기 상태 보호
+    pthread_cond_t wake;                ///< 잠든 워커 깨우기
+    ThreadPoolTask *tasks;              ///< 작업 원형 배열
+    uint32_t head;                      ///< 가장 먼저 넣은 작업 위치
+    uint32_t count;                     ///< 큐에 있는 작업 수
+    uint32_t capacity;                  ///< 배열 용량
+    int poked;                          ///< 다른 워커의 작업을 훔치러 가라는 요청 (lock 보호)
+    _Atomic int sleeping;               ///< 큐가 비어 잠들어 있으면 1 (쓰기는 lock 보호)
+    _Atomic uint32_t depth;             ///< count 사본 (잠그지 않고 읽는 통계/훔칠 대상 고르기용)
+    int index;                          ///< 워커 번호
+    int cpu;                            ///< 고정한 CPU (고정하지 않았으면 -1)
+    unsigned seed;                      ///< 훔칠 워커를 고르는 난수 상태
+    pthread_t tid;                      ///< 워커 스레드
+    struct ThreadPool *pool;            ///< 소속 풀
+    atomic_long executed;               ///< 실행한 작업 수 (훔친 작업 포함)
+    atomic_long stolen;                 ///< 다른 워커에서 훔쳐 실행한 작업 수
+    atomic_long busy_ns;                ///< 작업을 실행하는 데 쓴 시간 합
+} ThreadPoolWorker;
+
+/**
+ * @struct ThreadPool
+ * @brief 워커 스레드 풀
+ */
+typedef struct ThreadPool {
+    ThreadPoolWorker *workers;          ///< 워커 배열
+    int count;                          ///< 워커 수
+    size_t stack_size;                  ///< 워커 스택 크기
+    _Atomic int sleepers;               ///< 잠든 워커 수
+    _Atomic int stop;                   ///< 종료 요청
+    uint64_t started_ns;                ///< 시작 시각 (사용률 계산 기준)
+} ThreadPool;
+
+/**
+ * @struct ThreadPoolWorkerStats
+ * @brief 워커 하나의 지표 스냅샷
+ */
+typedef struct {
+    int cpu;                            ///< 고정한 CPU (고정하지 않았으면 -1)
+    uint32_t depth;                     ///< 큐에 쌓인 작업 수
+    long executed;                      ///< 실행한 작업 수
+    long stolen;                        ///< 그중 훔친 작업 수
+    double utilization;                 ///< 시작 이후 작업 실행에 쓴 시간 비율 (0~1)
+} ThreadPoolWorkerStats;
+
+static inline uint64_t thread_pool_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 워커 큐 끝에 작업을 넣음 (worker->lock 을 잡은 상태)
+ *
+ * @return 성공 시 0, 메모리가 없으면 -1
+ */
+static int thread_pool_push_locked(ThreadPoolWorker *worker, ThreadPoolTask task) {
+    if (worker->count == worker->capacity) {
+        uint32_t capacity = worker->capacity * 2;
+        ThreadPoolTask *tasks = (ThreadPoolTask *)malloc(capacity * sizeof(ThreadPoolTask));
+        if (tasks == NULL) {
+            return -1;
+        }
+        for (uint32_t i = 0; i < worker->count; i++) {
+            tasks[i] = worker->tasks[(worker->head + i) % worker->capacity];
+        }
+        free(worker->tasks);
+        worker->tasks = tasks;
+        worker->head = 0;
+        worker->capacity = capacity;
+    }
+    worker->tasks[(worker->head + worker->count) % worker->capacity] = task;
+    worker->count++;
+    atomic_store(&worker->depth, worker->count);
+    return 0;
+}
+
+/**
+ * @brief 자기 큐 앞에서 작업을 꺼냄 (주인 워커)
+ *
+ * @return 꺼냈으면 1, 비었으면 0
+ */
+static int thread_pool_pop(ThreadPoolWorker *worker, ThreadPoolTask *task) {
+    if (atomic_load_explicit(&worker->depth, memory_order_relaxed) == 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&worker->lock);
+    int found = worker->count > 0;
+    if (found) {
+        *task = worker->tasks[worker->head];
+        worker->head = (worker->head + 1) % worker->capacity;
+        worker->count--;
+        atomic_store_explicit(&worker->depth, worker->count, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+/**
+ * @brief 다른 워커의 큐 끝에서 작업 하나를 훔침
+ *
+ * 임의의 워커부터 돌면서, 작업이 쌓인 큐 가운데 잠금을 바로 잡을 수 있는 곳에서 가져옵니다.
+ *
+ * @return 훔쳤으면 1, 모든 큐가 비었으면 0
+ */
+static int thread_pool_steal(ThreadPoolWorker *thief, ThreadPoolTask *task) {
+    ThreadPool *pool = thief->pool;
+    int start = (int)(rand_r(&thief->seed) % (unsigned)pool->count);
+
+    for (int i = 0; i < pool->count; i++) {
+        ThreadPoolWorker *victim = &pool->workers[(start + i) % pool->count];
+        if (victim == thief || atomic_load_explicit(&victim->depth, memory_order_relaxed) == 0 ||
+            pthread_mutex_trylock(&victim->lock) != 0) {
+            continue;
+        }
+        int found = victim->count > 0;
+        if (found) {
+            victim->count--;
+            *task = victim->tasks[(victim->head + victim->count) % victim->capacity];
+            atomic_store_explicit(&victim->depth, victim->count, memory_order_relaxed);
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (found) {
+            atomic_fetch_add_explicit(&thief->stolen, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 자기 큐와 다른 워커의 큐가 모두 빌 때까지 잠듦
+ *
+ * 잠들기 전에 sleepers 를 올리고 모든 큐를 다시 확인합니다. thread_pool_submit() 은 큐에 넣은 뒤
+ * sleepers 를 확인하므로, 어느 쪽이든 상대의 변화를 보게 되어 쌓인 작업을 두고 잠들지 않습니다.
+ */
+static void thread_pool_sleep(ThreadPoolWorker *worker) {
+    ThreadPool *pool = worker->pool;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->count == 0 && !worker->poked && !atomic_load(&pool->stop)) {
+        atomic_store(&worker->sleeping, 1);
+        atomic_fetch_add(&pool->sleepers, 1);
+
+        int pending = 0;
+        for (int i = 0; i < pool->count && !pending; i++) {
+            pending = &pool->workers[i] != worker && atomic_load(&pool->workers[i].depth) > 0;
+        }
+        while (!pending && worker->count == 0 && !worker->poked && !atomic_load(&pool->stop)) {
+            pthread_cond_wait(&worker->wake, &worker->lock);
+        }
+
+        atomic_fetch_sub(&pool->sleepers, 1);
+        atomic_store(&worker->sleeping, 0);
+    }
+    worker->poked = 0;
+    pthread_mutex_unlock(&worker->lock);
+}
+
+/**
+ * @brief 워커 스레드
+ */
+static void *thread_pool_worker(void *arg) {
+    ThreadPoolWorker *worker = (ThreadPoolWorker *)arg;
+    ThreadPool *pool = worker->pool;
+    ThreadPoolTask task;
+
+    while (1) {
+        if (!thread_pool_pop(worker, &task) && !thread_pool_steal(worker, &task)) {
+            if (atomic_load(&pool->stop)) {
+                break;  // 종료 요청 이후 모든 큐가 빈 것을 확인했으므로 남은 작업 없음
+            }
+            thread_pool_sleep(worker);
+            continue;
+        }
+
+        uint64_t start = thread_pool_now_ns();
+        task.fn(task.arg);
+        atomic_fetch_add_explicit(&worker->busy_ns, (long)(thread_pool_now_ns() - start), memory_order_relaxed);
+        atomic_fetch_add_explicit(&worker->executed, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 워커 i 를 CPU (i % CPU 수) 에 고정
+ */
+static void thread_pool_pin(ThreadPoolWorker *worker) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    worker->cpu = (int)(worker->index % (cpus > 0 ? cpus : 1));
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    if (pthread_setaffinity_np(worker->tid, sizeof(set), &set) != 0) {
+        perror("pthread_setaffinity_np()");
+        worker->cpu = -1;
+    }
+}
+
+/**
+ * @brief 시작한 워커 스레드들을 깨워 끝날 때까지 기다리고 풀을 해제
+ *
+ * @param pool 대상 풀 (모든 워커의 잠금/조건 변수가 초기화된 상태)
+ * @param started 스레드를 만든 워커 수 (앞에서부터)
+ */
+static void thread_pool_release(ThreadPool *pool, int started) {
+    atomic_store(&pool->stop, 1);
+    for (int i = 0; i < started; i++) {
+        pthread_mutex_lock(&pool->workers[i].lock);
+        pthread_cond_signal(&pool->workers[i].wake);
+        pthread_mutex_unlock(&pool->workers[i].lock);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool->workers[i].tid, NULL);
+    }
+    for (int i = 0; i < pool->count; i++) {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+        pthread_cond_destroy(&pool->workers[i].wake);
+        free(pool->workers[i].tasks);
+    }
+    free(pool->workers);
+    pool->workers = NULL;
+}
+
+/**
+ * @brief 워커 스레드들을 만들고 시작
+ *
+ * @param pool 초기화할 풀
+ * @param workers 워커 수
+ * @param stack_size 워커 스택 크기 (0 이면 THREAD_POOL_DEFAULT_STACK, PTHREAD_STACK_MIN 보다 작으면 올림)
+ * @param pin 1 이면 워커마다 CPU 하나에 고정
+ * @return 성공 시 0, 실패 시 -1
+ */
+int thread_pool_start(ThreadPool *pool, int workers, size_t stack_size, int pin) {
+    pthread_attr_t attr;
+
+    memset(pool, 0, sizeof(*pool));
+    if (workers <= 0) {
+        return -1;
+    }
+    if (stack_size == 0) {
+        stack_size = THREAD_POOL_DEFAULT_STACK;
+    }
+    if (stack_size < (size_t)PTHREAD_STACK_MIN) {
+        stack_size = (size_t)PTHREAD_STACK_MIN;
+    }
+    pool->workers = (ThreadPoolWorker *)aligned_alloc(THREAD_POOL_CACHE_LINE, workers * sizeof(ThreadPoolWorker));
+    if (pool->workers == NULL) {
+        return -1;
+    }
+    memset(pool->workers, 0, workers * sizeof(ThreadPoolWorker));
+    pool->count = workers;
+    pool->stack_size = stack_size;
+    pool->started_ns = thread_pool_now_ns();
+
+    for (int i = 0; i < workers; i++) {
+        pthread_mutex_init(&pool->workers[i].lock, NULL);
+        pthread_cond_init(&pool->workers[i].wake, NULL);
+    }
+    for (int i = 0; i < workers; i++) {
+        ThreadPoolWorker *worker = &pool->workers[i];
+        worker->tasks = (ThreadPoolTask *)malloc(THREAD_POOL_INITIAL_TASKS * sizeof(ThreadPoolTask));
+        if (worker->tasks == NULL) {
+            thread_pool_release(pool, 0);
+            return -1;
+        }
+        worker->capacity = THREAD_POOL_INITIAL_TASKS;
+        worker->index = i;
+        worker->cpu = -1;
+        worker->seed = 0x9e3779b9u * (unsigned)(i + 1);
+        worker->pool = pool;
+    }
+
+    pthread_attr_init(&attr);
+    if (pthread_attr_setstacksize(&attr, stack_size) != 0) {
+        perror("pthread_attr_setstacksize()");
+    }
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&pool->workers[i].tid, &attr, thread_pool_worker, &pool->workers[i]) != 0) {
+            perror("pthread_create(worker)");
+            pthread_attr_destroy(&attr);
+            thread_pool_release(pool, i);  // 이미 시작한 워커는 빈 큐를 확인하고 끝남
+            return -1;
+        }
+        if (pin) {
+            thread_pool_pin(&pool->workers[i]);
+        }
+    }
+    pthread_attr_destroy(&attr);
+    return 0;
+}
+
+/**
+ * @brief 작업을 워커 큐에 넣음 (어느 스레드에서나 호출 가능)
+ *
+ * 같은 대상의 작업은 같은 워커로 보내면 그 워커의 캐시를 재사용합니다. 그 워커가 바쁘면 쉬는
+ * 워커가 훔쳐 실행합니다.
+ *
+ * @param pool 대상 풀
+ * @param worker 넣을 워커 번호 (워커 수로 나눈 나머지를 씀)
+ * @param fn 실행할 함수
+ * @param arg 인자
+ * @return 성공 시 0, 메모리가 없으면 -1
+ */
+int thread_pool_submit(ThreadPool *pool, unsigned worker, ThreadPoolFn fn, void *arg) {
+    ThreadPoolWorker *target = &pool->workers[worker % (unsigned)pool->count];
+    ThreadPoolTask task = { fn, arg };
+
+    pthread_mutex_lock(&target->lock);
+    if (thread_pool_push_locked(target, task) < 0) {
+        pthread_mutex_unlock(&target->lock);
+        return -1;
+    }
+    int sleeping = atomic_load(&target->sleeping);
+    if (sleeping) {
+        pthread_cond_signal(&target->wake);
+    }
+    pthread_mutex_unlock(&target->lock);
+    if (sleeping || atomic_load(&pool->sleepers) == 0) {
+        return 0;
+    }
+
+    // 받을 워커가 바쁘므로 잠든 워커 하나를 깨워 훔쳐 가게 함
+    for (int i = 0; i < pool->count; i++) {
+        ThreadPoolWorker *helper = &pool->workers[i];
+        if (helper == target || !atomic_load(&helper->sleeping)) {
+            continue;
+        }
+        pthread_mutex_lock(&helper->lock);
+        int woke = atomic_load(&helper->sleeping);
+        if (woke) {
+            helper->poked = 1;
+            pthread_cond_signal(&helper->wake);
+        }
+        pthread_mutex_unlock(&helper->lock);
+        if (woke) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 워커 하나의 지표 스냅샷
+ *
+ * @param pool 대상 풀
+ * @param worker 워커 번호
+ * @param stats 스냅샷 (출력)
+ */
+void thread_pool_get_stats(ThreadPool *pool, int worker, ThreadPoolWorkerStats *stats) {
+    ThreadPoolWorker *w = &pool->workers[worker];
+    uint64_t elapsed = thread_pool_now_ns() - pool->started_ns;
+
+    stats->cpu = w->cpu;
+    stats->depth = atomic_load_explicit(&w->depth, memory_order_relaxed);
+    stats->executed = atomic_load_explicit(&w->executed, memory_order_relaxed);
+    stats->stolen = atomic_load_explicit(&w->stolen, memory_order_relaxed);
+    stats->utilization = elapsed > 0 ? (double)atomic_load_explicit(&w->busy_ns, memory_order_relaxed) / elapsed : 0.0;
+}
+
+/**
+ * @brief 쌓인 작업을 모두 실행한 뒤 워커들을 종료하고 풀을 해제
+ *
+ * @param pool 대상 풀
+ */
+void thread_pool_stop(ThreadPool *pool) {
+    if (pool->workers == NULL) {
+        return;
+    }
+
+    thread_pool_release(pool, pool->count);
+}
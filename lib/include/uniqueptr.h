@@ -1,53 +1,10 @@
-#include <dlfcn.h>
-#include <pthread.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <string.h>
-#include <stdarg.h>
-#include <errno.h>
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/wait.h>
-#include <semaphore.h>
-#include <stdbool.h>
-#include <netdb.h>
-#include <arpa/inet.h>
-
-// 고급 오류 처리 함수 구현
-#include "ename.c.inc"
-
-#define BUF_SIZE 100
-#define NUM_THREADS 3
-#define MAX_STRING_SIZE 100
+#pragma once
+#include <stdatomic.h>
+#include "kernel_util.h"
 
 #define RETAIN_SHARED_PTR(ptr) retain_shared_ptr(ptr);
 #define RELEASE_SHARED_PTR(ptr) release_shared_ptr(ptr);
 
-static pthread_mutex_t print_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-/**
- * @brief 커널 오류 메시지를 출력하고 프로그램을 종료하는 함수
- *
- * @param format 오류 메시지 형식
- */
-static void kernel_errExit(const char *format, ...);
-
-/**
- * @brief 스레드 안전한 출력 함수
- *
- * @param format 출력 메시지 형식
- */
-static void safe_kernel_printf(const char *format, ...);
-
-/**
- * @brief 종료 처리 함수
- *
- * @param useExit3 true면 exit(), false면 _exit() 호출
- */
-static void terminate(bool useExit3);
-
 /**
  * @brief 기본 소멸자 함수 (free 사용)
  *
@@ -58,56 +15,40 @@ void default_deleter(void *ptr) {
 }
 
 /**
- * @struct NetworkInfo
- * @brief 네트워크 정보를 저장하는 구조체
+ * @struct SharedControl
+ * @brief SharedPtr/WeakPtr 가 함께 가리키는 제어 블록
  *
- * IPv4 주소와 주소 패밀리를 저장합니다.
+ * strong 이 0 이 되면 deleter 로 객체를 파괴하고, weak 까지 0 이 되면 제어 블록을 해제합니다.
+ * 살아 있는 SharedPtr 들은 모두 합쳐 weak 하나를 보유하므로, 객체 파괴 중에도 제어 블록은 유지됩니다.
  */
 typedef struct {
-    char ip[INET_ADDRSTRLEN];  ///< IPv4 주소
-    sa_family_t family;        ///< 주소 패밀리 (AF_INET 등)
-} NetworkInfo;
-
-/**
- * @brief 로컬 네트워크 정보를 가져오는 함수
- *
- * @return NetworkInfo 네트워크 정보 구조체
- */
-NetworkInfo get_local_network_info() {
-    struct addrinfo hints, *res;
-    NetworkInfo net_info;
-
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;  // IPv4
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_flags = AI_PASSIVE;  // 로컬 IP 찾기
-
-    char hostname[256];
-    gethostname(hostname, sizeof(hostname));
-    if (getaddrinfo(hostname, NULL, &hints, &res) != 0) {
-        perror("getaddrinfo 실패");
-        exit(EXIT_FAILURE);
-    }
-
-    struct sockaddr_in *ipv4 = (struct sockaddr_in *)res->ai_addr;
-    inet_ntop(AF_INET, &(ipv4->sin_addr), net_info.ip, INET_ADDRSTRLEN);
-    net_info.family = res->ai_family;
-
-    freeaddrinfo(res);
-    return net_info;
-}
+    _Atomic long strong;     ///< SharedPtr 참조 수
+    _Atomic long weak;       ///< WeakPtr 참조 수 (+ strong 이 남아 있으면 1)
+    void (*deleter)(void*);  ///< 소멸자 함수
+} SharedControl;
 
 /**
  * @struct SharedPtr
  * @brief 공유 스마트 포인터
+ *
+ * 값으로 복사해 전달하며, 복사본마다 retain_shared_ptr()/release_shared_ptr() 짝을 맞춥니다.
  */
 typedef struct {
     void *ptr;               ///< 실제 메모리
-    int *ref_count;          ///< 참조 카운트
-    pthread_mutex_t *mutex;  ///< 뮤텍스
-    void (*deleter)(void*);  ///< 소멸자 함수
+    SharedControl *ctrl;     ///< 참조 카운트 제어 블록
 } SharedPtr;
 
+/**
+ * @struct WeakPtr
+ * @brief 객체 수명에 관여하지 않는 SharedPtr 참조
+ *
+ * 객체를 쓰려면 weak_ptr_lock() 으로 SharedPtr 를 얻어야 하며, 이미 파괴되었으면 실패합니다.
+ */
+typedef struct {
+    void *ptr;               ///< 실제 메모리 (직접 역참조 금지)
+    SharedControl *ctrl;     ///< 참조 카운트 제어 블록
+} WeakPtr;
+
 /**
  * @struct UniquePtr
  * @brief 고유 스마트 포인터
@@ -117,22 +58,43 @@ typedef struct {
     void (*deleter)(void*);  ///< 소멸자 함수
 } UniquePtr;
 
+/**
+ * @brief 이미 할당된 객체를 소유하는 shared_ptr 생성 함수
+ *
+ * @param ptr 소유할 객체
+ * @param deleter 소멸자 함수 (NULL 이면 free)
+ * @return 생성된 SharedPtr 구조체, 메모리 부족 시 ptr 이 NULL (객체는 해제하지 않음)
+ */
+SharedPtr adopt_shared_ptr(void *ptr, void (*deleter)(void*)) {
+    SharedPtr sp = { NULL, NULL };
+    SharedControl *ctrl = (SharedControl*)malloc(sizeof(SharedControl));
+
+    if (ctrl == NULL || ptr == NULL) {
+        free(ctrl);
+        return sp;
+    }
+    atomic_init(&ctrl->strong, 1);
+    atomic_init(&ctrl->weak, 1);
+    ctrl->deleter = deleter ? deleter : default_deleter;
+    sp.ptr = ptr;
+    sp.ctrl = ctrl;
+    return sp;
+}
+
 /**
  * @brief shared_ptr 생성 함수
  *
  * @param size 할당할 메모리 크기
- * @param deleter 소멸자 함수
- * @return 생성된 SharedPtr 구조체
+ * @param deleter 소멸자 함수 (NULL 이면 free)
+ * @return 생성된 SharedPtr 구조체, 메모리 부족 시 ptr 이 NULL
  */
 SharedPtr create_shared_ptr(size_t size, void (*deleter)(void*)) {
-    SharedPtr sp;
-    sp.ptr = malloc(size);
-    sp.ref_count = (int*)malloc(sizeof(int));
-    *(sp.ref_count) = 1;
-    sp.mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-    sp.deleter = deleter ? deleter : default_deleter;
-    pthread_mutex_init(sp.mutex, NULL);
+    void *ptr = malloc(size);
+    SharedPtr sp = adopt_shared_ptr(ptr, deleter);
 
+    if (sp.ptr == NULL) {
+        free(ptr);
+    }
     return sp;
 }
 
@@ -153,17 +115,28 @@ UniquePtr create_unique_ptr(size_t size, void (*deleter)(void*)) {
 /**
  * @brief shared_ptr 참조 카운트 증가
  *
- * @param sp 참조할 SharedPtr
+ * @param sp 참조할 SharedPtr (이미 참조를 가진 쪽에서 호출)
  */
 void retain_shared_ptr(SharedPtr *sp) {
-    pthread_mutex_lock(sp->mutex);
-    (*(sp->ref_count))++;
-    pthread_mutex_unlock(sp->mutex);
+    atomic_fetch_add_explicit(&sp->ctrl->strong, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief 제어 블록의 weak 참조 하나를 반납하고, 마지막이면 제어 블록을 해제
+ */
+static void shared_control_release_weak(SharedControl *ctrl) {
+    if (atomic_fetch_sub_explicit(&ctrl->weak, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        free(ctrl);
+    }
 }
 
 /**
  * @brief shared_ptr 참조 카운트 감소 및 메모리 해제
  *
+ * 마지막 SharedPtr 이면 deleter 로 객체를 파괴합니다. WeakPtr 가 남아 있으면 제어 블록은 유지됩니다.
+ * 호출 후 sp 는 비워집니다.
+ *
  * @param sp 해제할 SharedPtr
  */
 void release_shared_ptr(SharedPtr *sp) {
@@ -172,14 +145,89 @@ void release_shared_ptr(SharedPtr *sp) {
         return;
     }
 
-    sp->deleter(sp->ptr);
+    SharedControl *ctrl = sp->ctrl;
+    if (atomic_fetch_sub_explicit(&ctrl->strong, 1, memory_order_release) == 1) {
+        atomic_thread_fence(memory_order_acquire);
+        ctrl->deleter(sp->ptr);
+        shared_control_release_weak(ctrl);
+    }
     sp->ptr = NULL;
+    sp->ctrl = NULL;
+}
 
-    free(sp->ref_count);
-    sp->ref_count = NULL;
-    pthread_mutex_destroy(sp->mutex);
-    free(sp->mutex);
-    sp->mutex = NULL;
+/**
+ * @brief 현재 SharedPtr 참조 수 (진단용, 읽는 즉시 바뀔 수 있음)
+ */
+long shared_ptr_use_count(const SharedPtr *sp) {
+    return sp->ctrl ? atomic_load_explicit(&sp->ctrl->strong, memory_order_relaxed) : 0;
+}
+
+/**
+ * @brief SharedPtr 로부터 WeakPtr 생성
+ *
+ * @param sp 살아 있는 SharedPtr
+ * @return WeakPtr (release_weak_ptr() 로 반납)
+ */
+WeakPtr weak_ptr_from(const SharedPtr *sp) {
+    WeakPtr wp = { sp->ptr, sp->ctrl };
+    atomic_fetch_add_explicit(&sp->ctrl->weak, 1, memory_order_relaxed);
+    return wp;
+}
+
+/**
+ * @brief WeakPtr 참조 수 증가 (복사본을 따로 보관할 때)
+ */
+void retain_weak_ptr(WeakPtr *wp) {
+    atomic_fetch_add_explicit(&wp->ctrl->weak, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief WeakPtr 반납
+ *
+ * @param wp 반납할 WeakPtr (호출 후 비워짐)
+ */
+void release_weak_ptr(WeakPtr *wp) {
+    if (wp->ctrl == NULL) {
+        return;
+    }
+    shared_control_release_weak(wp->ctrl);
+    wp->ptr = NULL;
+    wp->ctrl = NULL;
+}
+
+/**
+ * @brief 객체가 이미 파괴되었는지 확인
+ *
+ * false 여도 직후에 파괴될 수 있으므로, 객체를 쓰려면 weak_ptr_lock() 을 사용합니다.
+ */
+bool weak_ptr_expired(const WeakPtr *wp) {
+    return wp->ctrl == NULL || atomic_load_explicit(&wp->ctrl->strong, memory_order_acquire) == 0;
+}
+
+/**
+ * @brief WeakPtr 로부터 SharedPtr 를 얻음
+ *
+ * strong 이 0 이 아닐 때만 CAS 로 1 증가시키므로, 파괴가 시작된 객체는 되살리지 않습니다.
+ *
+ * @param wp WeakPtr
+ * @param out 성공 시 SharedPtr (release_shared_ptr() 로 반납)
+ * @return 성공 시 0, 이미 파괴되었으면 -1
+ */
+int weak_ptr_lock(const WeakPtr *wp, SharedPtr *out) {
+    if (wp->ctrl == NULL) {
+        return -1;
+    }
+
+    long strong = atomic_load_explicit(&wp->ctrl->strong, memory_order_relaxed);
+    while (strong != 0) {
+        if (atomic_compare_exchange_weak_explicit(&wp->ctrl->strong, &strong, strong + 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            out->ptr = wp->ptr;
+            out->ctrl = wp->ctrl;
+            return 0;
+        }
+    }
+    return -1;
 }
 
 /**
@@ -213,13 +261,13 @@ UniquePtr transfer_unique_ptr(UniquePtr *up) {
  * @return NULL
  */
 void* thread_function_shared(void* arg) {
-    SharedPtr *sp = (SharedPtr*)arg;
-    retain_shared_ptr(sp);
-    printf("스레드에서 shared_ptr 사용 중 - ref_count: %d\n", *(sp->ref_count));
+    SharedPtr sp = *(SharedPtr*)arg;
+    retain_shared_ptr(&sp);
+    printf("스레드에서 shared_ptr 사용 중 - ref_count: %ld\n", shared_ptr_use_count(&sp));
 
     sleep(1);
 
-    release_shared_ptr(sp);
+    release_shared_ptr(&sp);
     return NULL;
 }
 
@@ -236,52 +284,3 @@ void* thread_function_unique(void* arg) {
     sleep(1);
     return NULL;
 }
-
-/**
- * @brief 스레드 안전한 출력 함수
- *
- * @param format 출력 메시지 형식
- */
-static void safe_kernel_printf(const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-
-    pthread_mutex_lock(&print_mutex);
-    vprintf(format, args);
-    pthread_mutex_unlock(&print_mutex);
-
-    if(errno != 0) {
-        kernel_errExit("Failed to print message");
-    }
-
-    va_end(args);
-}
-
-/**
- * @brief 커널 오류 메시지 출력 후 종료
- *
- * @param format 오류 메시지 형식
- */
-static void kernel_errExit(const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    
-    safe_kernel_printf("ERROR: %s\n", format);
-    fprintf(stderr, "errno: %d (%s)\n", errno, strerror(errno));
-    
-    va_end(args);
-    exit(EXIT_FAILURE);
-}
-
-/**
- * @brief 종료 처리 함수
- *
- * @param useExit3 true면 exit(), false면 _exit() 호출
- */
-static void terminate(bool useExit3) {
-    if (useExit3) {
-        exit(EXIT_FAILURE);
-    } else {
-        _exit(EXIT_FAILURE);
-    }
-}
\ No newline at end of file
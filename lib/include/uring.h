@@ -0,0 +1,268 @@
+#pragma once
+/**
+ * @file uring.h
+ * @brief liburing 없이 io_uring 시스템 콜을 직접 사용하는 최소 래퍼
+ *
+ * 링 생성/해제, SQE 획득, 제출, CQE 소비, 연산 지원 여부 확인(probe)만 제공합니다.
+ * SQE 제출은 호출자가 직렬화해야 하며, CQE 소비는 한 스레드에서만 해야 합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/**
+ * @struct Uring
+ * @brief mmap 된 제출/완료 큐 정보를 담는 구조체
+ */
+typedef struct {
+    int ring_fd;                    ///< io_uring 인스턴스 FD
+    unsigned features;              ///< 커널이 알려준 IORING_FEAT_* 플래그
+
+    unsigned *sq_head;              ///< 제출 큐 head (커널이 갱신)
+    unsigned *sq_tail;              ///< 제출 큐 tail (사용자가 갱신)
+    unsigned *sq_mask;              ///< 제출 큐 인덱스 마스크
+    unsigned *sq_array;             ///< 제출 큐 인덱스 배열
+    unsigned sq_entries;            ///< 제출 큐 크기
+    unsigned sqe_tail;              ///< 아직 커널에 공개하지 않은 로컬 tail
+    struct io_uring_sqe *sqes;      ///< SQE 배열
+
+    unsigned *cq_head;              ///< 완료 큐 head (사용자가 갱신)
+    unsigned *cq_tail;              ///< 완료 큐 tail (커널이 갱신)
+    unsigned *cq_mask;              ///< 완료 큐 인덱스 마스크
+    struct io_uring_cqe *cqes;      ///< CQE 배열
+
+    void *sq_ptr;                   ///< 제출 큐 mmap 영역
+    void *cq_ptr;                   ///< 완료 큐 mmap 영역 (SINGLE_MMAP 이면 sq_ptr 과 같음)
+    size_t sq_len;                  ///< 제출 큐 mmap 크기
+    size_t cq_len;                  ///< 완료 큐 mmap 크기
+    size_t sqes_len;                ///< SQE 배열 mmap 크기
+} Uring;
+
+static inline int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static inline int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/**
+ * @brief io_uring 인스턴스를 생성하고 큐를 mmap 하는 함수
+ *
+ * @param ring 초기화할 링
+ * @param entries 제출 큐 크기 (완료 큐는 4배로 잡음)
+ * @return 성공 시 0, 실패 시 -errno
+ */
+int uring_init(Uring *ring, unsigned entries) {
+    struct io_uring_params p;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = entries * 4;
+
+    ring->ring_fd = sys_io_uring_setup(entries, &p);
+    if (ring->ring_fd < 0) {
+        return -errno;
+    }
+    ring->features = p.features;
+
+    ring->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_len > ring->sq_len) {
+            ring->sq_len = ring->cq_len;
+        }
+        ring->cq_len = ring->sq_len;
+    }
+
+    ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr == MAP_FAILED) {
+        int err = errno;
+        close(ring->ring_fd);
+        return -err;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ptr = ring->sq_ptr;
+    } else {
+        ring->cq_ptr = mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ptr == MAP_FAILED) {
+            int err = errno;
+            munmap(ring->sq_ptr, ring->sq_len);
+            close(ring->ring_fd);
+            return -err;
+        }
+    }
+
+    ring->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        int err = errno;
+        if (ring->cq_ptr != ring->sq_ptr) {
+            munmap(ring->cq_ptr, ring->cq_len);
+        }
+        munmap(ring->sq_ptr, ring->sq_len);
+        close(ring->ring_fd);
+        return -err;
+    }
+
+    char *sq = (char *)ring->sq_ptr;
+    char *cq = (char *)ring->cq_ptr;
+    ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+    ring->sq_entries = p.sq_entries;
+    ring->sqe_tail = *ring->sq_tail;
+
+    ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+/**
+ * @brief 링의 mmap 영역과 FD 를 해제하는 함수
+ *
+ * @param ring 해제할 링
+ */
+void uring_exit(Uring *ring) {
+    munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_ptr != ring->sq_ptr) {
+        munmap(ring->cq_ptr, ring->cq_len);
+    }
+    munmap(ring->sq_ptr, ring->sq_len);
+    close(ring->ring_fd);
+}
+
+/**
+ * @brief 비어 있는 SQE 하나를 가져오는 함수
+ *
+ * @param ring 대상 링
+ * @return 0 으로 초기화된 SQE, 제출 큐가 가득 차면 NULL
+ */
+struct io_uring_sqe *uring_get_sqe(Uring *ring) {
+    unsigned head = atomic_load_explicit((_Atomic unsigned *)ring->sq_head, memory_order_acquire);
+    if (ring->sqe_tail - head >= ring->sq_entries) {
+        return NULL;
+    }
+
+    unsigned index = ring->sqe_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    ring->sq_array[index] = index;
+    ring->sqe_tail++;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/**
+ * @brief 쌓아 둔 SQE 를 한 번의 io_uring_enter 로 제출하는 함수
+ *
+ * @param ring 대상 링
+ * @return 제출한 SQE 수, 실패 시 -errno
+ */
+int uring_submit(Uring *ring) {
+    unsigned tail = *ring->sq_tail;
+    unsigned to_submit = ring->sqe_tail - tail;
+
+    if (to_submit == 0) {
+        return 0;
+    }
+    atomic_store_explicit((_Atomic unsigned *)ring->sq_tail, ring->sqe_tail, memory_order_release);
+
+    int ret;
+    do {
+        ret = sys_io_uring_enter(ring->ring_fd, to_submit, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret < 0 ? -errno : ret;
+}
+
+/**
+ * @brief 완료 큐에서 CQE 하나를 꺼내 보는 함수 (소비하지 않음)
+ *
+ * @param ring 대상 링
+ * @return CQE 포인터, 비어 있으면 NULL
+ */
+struct io_uring_cqe *uring_peek_cqe(Uring *ring) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = atomic_load_explicit((_Atomic unsigned *)ring->cq_tail, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+    return &ring->cqes[head & *ring->cq_mask];
+}
+
+/**
+ * @brief uring_peek_cqe() 로 얻은 CQE 를 소비 처리하는 함수
+ *
+ * @param ring 대상 링
+ */
+void uring_cqe_seen(Uring *ring) {
+    atomic_store_explicit((_Atomic unsigned *)ring->cq_head, *ring->cq_head + 1, memory_order_release);
+}
+
+/**
+ * @brief CQE 가 하나 이상 도착할 때까지 대기하는 함수
+ *
+ * 제출 잠금 없이 호출해도 됩니다 (to_submit = 0).
+ *
+ * @param ring 대상 링
+ * @return 성공 시 0, 실패 시 -errno
+ */
+int uring_wait_cqe(Uring *ring) {
+    while (uring_peek_cqe(ring) == NULL) {
+        int ret = sys_io_uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR) {
+            return -errno;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 커널이 주어진 연산들을 모두 지원하는지 확인하는 함수
+ *
+ * @param ring 대상 링
+ * @param ops 확인할 IORING_OP_* 배열
+ * @param num_ops 배열 길이
+ * @return 모두 지원하면 1, 아니면 0
+ */
+int uring_probe_ops(Uring *ring, const int *ops, int num_ops) {
+    size_t len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, len);
+    int supported = 1;
+
+    if (probe == NULL) {
+        return 0;
+    }
+    if (sys_io_uring_register(ring->ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+        free(probe);
+        return 0;
+    }
+
+    for (int i = 0; i < num_ops; i++) {
+        if (ops[i] > probe->last_op || !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) {
+            supported = 0;
+            break;
+        }
+    }
+    free(probe);
+    return supported;
+}
@@ -1,63 +1,95 @@
-#pragma ONCE
+#pragma once
+/**
+ * @file user.h
+ * @brief 사용자명을 키로 하는 선형 탐사 해시 테이블 기반 사용자 데이터베이스
+ *
+ * 사용자 한 명의 네 문자열(host, user, pass, name)은 한 번의 malloc 으로 연속 할당합니다.
+ * 슬롯에는 해시를 함께 두어 탐사 중에 다른 사용자의 레코드를 읽지 않으며, 삭제 시 뒤 항목을 당겨 채워
+ * 삭제 표시를 남기지 않으므로 등록/조회/삭제가 사용자 수와 무관하게 O(1) 입니다.
+ * 조회는 읽기 잠금만 잡으므로 여러 스레드의 로그인 확인이 서로 막지 않습니다.
+ *
+ * 바이너리 스냅샷(user_snapshot.h)을 붙이면 스냅샷은 읽기 전용 바탕이 되고, 해시 테이블은 그 위의
+ * 변경분만 담습니다. 스냅샷에 있는 유저를 삭제하면 해시 테이블에 삭제 표시(info 가 NULL 인 칸)를 남기고,
+ * 다시 등록하면 그 칸을 새 정보로 바꿉니다. 조회는 해시 테이블을 먼저 보고 없을 때만 스냅샷을 봅니다.
+ */
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <pthread.h>
 #include <unistd.h>
 #include "smartptr.h"
+#include "intern.h"
+#include "user_snapshot.h"
+#include "probe.h"
 
 #define MAX_STRING_SIZE 100
-#define MAX_USERS 10
+#define USER_DB_INITIAL_CAPACITY 64   ///< 해시 테이블 초기 크기 (2의 거듭제곱)
 #define USER_DATA_FILE "user_data.txt"
 
 /**
  * @brief 유저 정보 구조체
- * 
- * 각각의 유저 정보를 포함하는 구조체입니다. 
- * 스마트 포인터를 통해 메모리 관리가 이루어집니다.
+ *
+ * 각 필드는 구조체 바로 뒤(data)에 이어 붙은 NUL 종료 문자열을 가리킵니다.
+ * 데이터베이스에 등록된 동안만 유효하므로, 잠금 밖으로 가지고 나가려면 복사해야 합니다.
  */
 typedef struct {
-    SmartPtr host;
-    SmartPtr user;
-    SmartPtr pass;
-    SmartPtr name;
+    const char *host;   ///< 호스트 이름
+    const char *user;   ///< 유저 이름 (키)
+    const char *pass;   ///< 비밀번호
+    const char *name;   ///< 유저의 실제 이름
+    uint32_t hash;      ///< 유저 이름 해시
+    char data[];        ///< host\0user\0pass\0name\0
 } UserInfo;
 
+/**
+ * @brief 해시 테이블 슬롯 (key 가 NULL 이면 빈 칸, info 가 NULL 이면 스냅샷 유저의 삭제 표시)
+ */
+typedef struct {
+    const char *key;    ///< 유저 이름 (info->user 또는 삭제 표시의 경우 스냅샷 안의 유저 이름)
+    UserInfo *info;     ///< 유저 정보
+    uint32_t hash;      ///< 유저 이름 해시 (탐사 중 레코드를 읽지 않도록 슬롯에 복사)
+} UserSlot;
+
 /**
  * @brief 유저 데이터베이스 구조체
- * 
- * 최대 유저 수에 대한 정보를 저장하며, 데이터베이스 동기화를 위한 뮤텍스를 포함합니다.
+ *
+ * 유저 이름 -> 유저 정보 해시 테이블이며, 조회는 읽기 잠금, 등록/삭제는 쓰기 잠금으로 동기화합니다.
  */
 typedef struct {
-    UserInfo users[MAX_USERS];
-    size_t user_count;
-    pthread_mutex_t db_mutex;
+    UserSlot *slots;             ///< 선형 탐사 해시 테이블 (스냅샷 위의 변경분)
+    size_t capacity;             ///< 테이블 크기 (2의 거듭제곱)
+    size_t slot_count;           ///< 사용 중인 칸 수 (삭제 표시 포함)
+    size_t user_count;           ///< 등록된 유저 수 (스냅샷 포함)
+    UserSnapshot base;           ///< 읽기 전용 바탕 스냅샷 (붙이지 않았으면 map 이 NULL)
+    pthread_rwlock_t db_lock;    ///< 조회는 읽기, 등록/삭제는 쓰기 잠금
 } UserDB;
 
 /**
  * @brief 모든 유저 정보를 출력합니다.
- * 
+ *
  * @param db 유저 데이터베이스 포인터
  */
 void display_all_users(UserDB *db);
 
 /**
  * @brief 유저 조회 함수
- * 
+ *
  * 주어진 유저 이름과 비밀번호가 데이터베이스에 있는지 확인합니다.
- * 
+ *
  * @param db 유저 데이터베이스 포인터
  * @param username 유저 이름
  * @param password 비밀번호
- * @return 성공 시 유저 인덱스, 실패 시 -1 반환
+ * @return 성공 시 유저 슬롯 위치(0 이상), 실패 시 -1 반환
  */
 int query_user(UserDB *db, const char *username, const char *password);
 
 /**
  * @brief 유저 등록 함수
- * 
- * 새로운 유저를 데이터베이스에 등록합니다.
- * 
+ *
+ * 새로운 유저를 데이터베이스에 등록합니다. 같은 유저 이름이 이미 있으면 등록하지 않습니다.
+ *
  * @param db 유저 데이터베이스 포인터
  * @param host 호스트 이름
  * @param user 유저 이름
@@ -69,46 +101,49 @@ bool register_user(UserDB *db, const char *host, const char *user, const char *p
 
 /**
  * @brief 유저 데이터베이스 초기화
- * 
- * 유저 데이터베이스를 초기화하고 뮤텍스를 설정합니다.
- * 
+ *
+ * 빈 해시 테이블을 할당하고 읽기/쓰기 잠금을 설정합니다.
+ *
  * @param db 유저 데이터베이스 포인터
  */
-void init_user_db(UserDB *db); 
+void init_user_db(UserDB *db);
 
 /**
- * @brief 유저 로그인 상태 확인
- * 
- * 주어진 유저 이름이 로그인된 상태인지 확인합니다.
- * 
- * @param username 유저 이름
- * @return 로그인 시 true, 아니면 false 반환
+ * @brief 바이너리 스냅샷을 읽기 전용 바탕으로 붙임
+ *
+ * 파일을 mmap 하고 헤더만 검증하므로 유저 수와 무관하게 바로 끝납니다.
+ * 아직 아무도 등록하지 않은 빈 데이터베이스에만 호출합니다.
+ *
+ * @param db 유저 데이터베이스 포인터
+ * @param path 스냅샷 경로
+ * @return 성공 시 0, 파일이 없거나 형식이 잘못되면 -1 반환
  */
-bool is_user_logined_in(const char *username);
+int attach_user_snapshot(UserDB *db, const char *path);
 
 /**
- * @brief 유저 로그인 처리
- * 
- * 주어진 유저 이름을 기반으로 로그인 상태를 기록하는 파일을 생성합니다.
- * 
- * @param username 유저 이름
+ * @brief 모든 유저에 대해 fn 을 호출 (읽기 잠금 안에서 호출되므로 fn 은 데이터베이스를 바꾸면 안 됨)
+ *
+ * @param db 유저 데이터베이스 포인터
+ * @param fn 유저마다 호출할 함수
+ * @param ctx fn 에 넘길 인자
  */
-void log_user_in(const char *username);
+void for_each_user(UserDB *db, void (*fn)(void *ctx, const char *host, const char *user, const char *pass,
+                                          const char *name), void *ctx);
 
 /**
- * @brief 유저 로그아웃 처리 및 파일 삭제
- * 
- * 유저 로그아웃 시 생성된 로그인 파일을 삭제합니다.
- * 
- * @param username 유저 이름
+ * @brief 유저 데이터베이스 해제
+ *
+ * 모든 유저 정보와 해시 테이블을 해제합니다. 다른 스레드가 사용하지 않을 때만 호출합니다.
+ *
+ * @param db 유저 데이터베이스 포인터
  */
-void logout_user(const char *username);
+void free_user_db(UserDB *db);
 
 /**
  * @brief 유저 삭제 함수
- * 
+ *
  * 데이터베이스에서 유저 정보를 삭제합니다.
- * 
+ *
  * @param db 유저 데이터베이스 포인터
  * @param username 유저 이름
  * @return 성공 시 true, 실패 시 false 반환
@@ -117,9 +152,9 @@ bool delete_user(UserDB *db, const char *username);
 
 /**
  * @brief 유저 정보를 파일에 저장
- * 
+ *
  * 주어진 유저 정보를 텍스트 파일에 저장합니다.
- * 
+ *
  * @param host 호스트 이름
  * @param user 유저 이름
  * @param pass 비밀번호
@@ -129,31 +164,49 @@ void save_user_to_file(const char *host, const char *user, const char *pass, con
 
 /**
  * @brief 유저 정보를 파일에서 불러옴
- * 
+ *
  * 텍스트 파일에서 유저 정보를 읽어 데이터베이스에 저장합니다.
- * 
+ *
  * @param db 유저 데이터베이스 포인터
  */
 void load_users_from_file(UserDB *db);
 
 /**
  * @brief 유저 데이터를 텍스트 파일에 기록
- * 
+ *
  * 현재 데이터베이스에 있는 모든 유저 정보를 파일에 기록합니다.
- * 
+ *
  * @param db 유저 데이터베이스 포인터
  * @return 성공 시 0, 실패 시 1 반환
  */
 int write_txt_file(UserDB *db);
 
 /**
- * @brief 모든 유저 정보를 출력
- * 
- * 유저 데이터베이스에 있는 모든 유저 정보를 출력합니다.
- * 
+ * @brief 열린 텍스트 파일에서 유저 정보를 읽어 등록
+ *
  * @param db 유저 데이터베이스 포인터
+ * @param file "host user pass name" 줄로 된 파일
+ * @return 등록한 유저 수
  */
-void display_all_users(UserDB *db);
+size_t read_users(UserDB *db, FILE *file);
+
+/**
+ * @brief 모든 유저 정보를 열린 텍스트 파일에 기록
+ *
+ * @param db 유저 데이터베이스 포인터
+ * @param file 기록할 파일
+ * @return 성공 시 0, 쓰기 오류 시 -1 반환
+ */
+int write_users(UserDB *db, FILE *file);
+
+/**
+ * @brief 모든 유저 정보를 바이너리 스냅샷 파일로 기록 (fsync 포함)
+ *
+ * @param db 유저 데이터베이스 포인터
+ * @param path 기록할 경로 (원자적 교체가 필요하면 임시 경로에 쓰고 호출자가 rename)
+ * @return 성공 시 0, 실패 시 -1 반환
+ */
+int write_user_snapshot(UserDB *db, const char *path);
 
 
 void save_user_to_file(const char *host, const char *user, const char *pass, const char *name) {
@@ -170,6 +223,48 @@ void save_user_to_file(const char *host, const char *user, const char *pass, con
     printf("User data saved successfully.\n");
 }
 
+// 열린 텍스트 파일에서 "host user pass name" 줄을 모두 읽어 등록 (등록한 유저 수 반환)
+size_t read_users(UserDB *db, FILE *file) {
+    char host[MAX_STRING_SIZE], user[MAX_STRING_SIZE], pass[MAX_STRING_SIZE], name[MAX_STRING_SIZE];
+    size_t count = 0;
+
+    while (fscanf(file, "%99s %99s %99s %99s", host, user, pass, name) == 4) {
+        count += register_user(db, host, user, pass, name);
+    }
+    return count;
+}
+
+static void write_user_line(void *ctx, const char *host, const char *user, const char *pass, const char *name) {
+    fprintf((FILE *)ctx, "%s %s %s %s\n", host, user, pass, name);
+}
+
+// 모든 유저를 열린 텍스트 파일에 "host user pass name" 줄로 기록 (쓰기 오류 시 -1)
+int write_users(UserDB *db, FILE *file) {
+    for_each_user(db, write_user_line, file);
+    return ferror(file) ? -1 : 0;
+}
+
+static void add_snapshot_record(void *ctx, const char *host, const char *user, const char *pass, const char *name) {
+    UserSnapshotBuilder *b = (UserSnapshotBuilder *)ctx;
+    if (user_snapshot_builder_add(b, host, user, pass, name) < 0) {
+        b->failed = 1;
+    }
+}
+
+// 모든 유저를 바이너리 스냅샷으로 기록
+int write_user_snapshot(UserDB *db, const char *path) {
+    UserSnapshotBuilder b;
+    int ret = -1;
+
+    user_snapshot_builder_init(&b);
+    for_each_user(db, add_snapshot_record, &b);
+    if (!b.failed) {
+        ret = user_snapshot_builder_write(&b, path);
+    }
+    user_snapshot_builder_free(&b);
+    return ret;
+}
+
 void load_users_from_file(UserDB *db) {
     FILE *file = fopen(USER_DATA_FILE, "r");
     if (file == NULL) {
@@ -177,15 +272,7 @@ void load_users_from_file(UserDB *db) {
         return;
     }
 
-    char host[MAX_STRING_SIZE], user[MAX_STRING_SIZE], pass[MAX_STRING_SIZE], name[MAX_STRING_SIZE];
-    while (fscanf(file, "%s %s %s %s", host, user, pass, name) != EOF) {
-        UserInfo new_user;
-        new_user.host = CREATE_SMART_PTR(char[MAX_STRING_SIZE], host);
-        new_user.user = CREATE_SMART_PTR(char[MAX_STRING_SIZE], user);
-        new_user.pass = CREATE_SMART_PTR(char[MAX_STRING_SIZE], pass);
-        new_user.name = CREATE_SMART_PTR(char[MAX_STRING_SIZE], name);
-        db->users[db->user_count++] = new_user;
-    }
+    read_users(db, file);
 
     fclose(file);
     printf("User data loaded successfully.\n");
@@ -198,13 +285,7 @@ int write_txt_file(UserDB *db) {
         return 1;
     }
 
-    for (size_t i = 0; i < db->user_count; ++i) {
-        fprintf(file, "%s %s %s %s\n",
-            (char *)db->users[i].host.ptr,
-            (char *)db->users[i].user.ptr,
-            (char *)db->users[i].pass.ptr,
-            (char *)db->users[i].name.ptr);
-    }
+    write_users(db, file);
 
     fclose(file);
     printf("User data saved successfully.\n");
@@ -213,114 +294,232 @@ int write_txt_file(UserDB *db) {
 
 // 유저 데이터베이스 초기화
 void init_user_db(UserDB *db) {
+    db->slots = (UserSlot *)calloc(USER_DB_INITIAL_CAPACITY, sizeof(UserSlot));
+    if (db->slots == NULL) {
+        kernel_errExit("Failed to allocate user database");
+    }
+    db->capacity = USER_DB_INITIAL_CAPACITY;
+    db->slot_count = 0;
     db->user_count = 0;
-    pthread_mutex_init(&db->db_mutex, NULL);
+    memset(&db->base, 0, sizeof(db->base));
+    pthread_rwlock_init(&db->db_lock, NULL);
 }
 
-// 유저 로그인 확인
-bool is_user_logined_in(const char *username) {
-    // .username 파일이 존재하는지 확인
-    char filename[MAX_STRING_SIZE + 1] = ".";
-    strncat(filename, username, MAX_STRING_SIZE);
+// 바이너리 스냅샷을 바탕으로 붙임
+int attach_user_snapshot(UserDB *db, const char *path) {
+    UserSnapshot snap;
+
+    if (user_snapshot_open(&snap, path) < 0) {
+        return -1;
+    }
+    pthread_rwlock_wrlock(&db->db_lock);
+    user_snapshot_close(&db->base);
+    db->base = snap;
+    db->user_count += snap.user_count;
+    pthread_rwlock_unlock(&db->db_lock);
+    return 0;
+}
 
-    // 파일이 존재하면 true 반환
-    if (access(filename, F_OK) == 0) {
-        return true;
+// 유저 데이터베이스 해제
+void free_user_db(UserDB *db) {
+    for (size_t i = 0; i < db->capacity; ++i) {
+        free(db->slots[i].info);
     }
-    return false;
+    free(db->slots);
+    db->slots = NULL;
+    db->capacity = 0;
+    db->slot_count = 0;
+    db->user_count = 0;
+    user_snapshot_close(&db->base);
+    pthread_rwlock_destroy(&db->db_lock);
 }
 
-// 유저 로그인 처리
-void log_user_in(const char *username) {
-    // .username 파일을 생성하여 로그인 상태 기록
-    char filename[MAX_STRING_SIZE + 1] = ".";
-    strncat(filename, username, MAX_STRING_SIZE);
+// 슬롯을 찾을 때의 키
+typedef struct {
+    const char *username;   ///< 유저 이름
+    uint32_t hash;          ///< 유저 이름 해시
+} UserSlotKey;
 
-    FILE *file = fopen(filename, "w");
-    if (file == NULL) {
-        perror("Error creating login file");
-        return;
+#define USER_SLOT_EMPTY(slot) ((slot)->key == NULL)
+#define USER_SLOT_HASH(slot) ((slot)->hash)
+#define USER_SLOT_MATCH(slot, k) ((slot)->hash == (k)->hash && strcmp((slot)->key, (k)->username) == 0)
+
+PROBE_TABLE(user_slot, UserSlot, USER_SLOT_EMPTY, USER_SLOT_HASH)
+PROBE_FIND(user_slot_find, UserSlot, const UserSlotKey *, USER_SLOT_EMPTY, USER_SLOT_MATCH)
+
+// 유저 이름으로 슬롯 위치를 찾음 (잠금은 호출자가 잡음, 없으면 -1)
+static long user_db_find(UserDB *db, const char *username, uint32_t hash) {
+    UserSlotKey key = { username, hash };
+    return user_slot_find(db->slots, db->capacity, hash, &key);
+}
+
+// 해시 테이블을 두 배로 키움 (쓰기 잠금 상태에서 호출)
+static int user_db_grow(UserDB *db) {
+    size_t capacity = db->capacity * 2;
+    UserSlot *slots = user_slot_probe_resize(db->slots, db->capacity, capacity);
+    if (slots == NULL) {
+        return -1;
     }
-    fclose(file);
+    db->slots = slots;
+    db->capacity = capacity;
+    return 0;
 }
 
-// 로그아웃 및 숨김 파일 삭제
-void logout_user(const char *username) {
-    // .username 파일 삭제
-    char filename[MAX_STRING_SIZE + 1] = ".";
-    strncat(filename, username, MAX_STRING_SIZE);
+// 빈 칸에 항목을 넣음 (쓰기 잠금 상태에서 호출, 적재율 75% 를 넘지 않도록 먼저 키움)
+static int user_db_insert(UserDB *db, const char *key, UserInfo *info, uint32_t hash) {
+    if ((db->slot_count + 1) * 4 > db->capacity * 3 && user_db_grow(db) < 0) {
+        return -1;
+    }
+    size_t i = user_slot_probe_slot(db->slots, db->capacity, hash);
+    db->slots[i].key = key;
+    db->slots[i].info = info;
+    db->slots[i].hash = hash;
+    db->slot_count++;
+    return 0;
+}
 
-    if (unlink(filename) == 0) {
-        printf("%s 로그아웃 성공, 숨김 파일 삭제됨\n", username);
-    } else {
-        perror("Error deleting login file");
+// 네 문자열을 한 블록에 담은 유저 정보를 만듦 (각 문자열은 MAX_STRING_SIZE - 1 바이트까지)
+static UserInfo *user_info_new(const char *host, const char *user, const char *pass, const char *name,
+                               uint32_t hash) {
+    const char *fields[4] = { host, user, pass, name };
+    size_t lens[4], total = 0;
+
+    for (int i = 0; i < 4; i++) {
+        lens[i] = strnlen(fields[i], MAX_STRING_SIZE - 1);
+        total += lens[i] + 1;
     }
+    UserInfo *info = (UserInfo *)malloc(sizeof(UserInfo) + total);
+    if (info == NULL) {
+        return NULL;
+    }
+
+    const char **targets[4] = { &info->host, &info->user, &info->pass, &info->name };
+    char *p = info->data;
+    for (int i = 0; i < 4; i++) {
+        memcpy(p, fields[i], lens[i]);
+        p[lens[i]] = '\0';
+        *targets[i] = p;
+        p += lens[i] + 1;
+    }
+    info->hash = hash;
+    return info;
 }
 
 // 유저 삭제
 bool delete_user(UserDB *db, const char *username) {
-    pthread_mutex_lock(&db->db_mutex);
-    for (size_t i = 0; i < db->user_count; ++i) {
-        if (strcmp((char *)db->users[i].user.ptr, username) == 0) {
-            for (size_t j = i; j < db->user_count - 1; ++j) {
-                db->users[j] = db->users[j + 1];
-            }
-            db->user_count--;
-            pthread_mutex_unlock(&db->db_mutex);
-            return true;
+    uint32_t hash = intern_hash(username, strlen(username));
+    UserRecordView base;
+    bool ok = false;
+
+    pthread_rwlock_wrlock(&db->db_lock);
+    long pos = user_db_find(db, username, hash);
+    bool in_base = user_snapshot_find(&db->base, username, hash, &base) == 0;
+    if (pos >= 0 && db->slots[pos].info != NULL) {
+        free(db->slots[pos].info);
+        if (in_base) {
+            // 스냅샷의 같은 유저가 다시 보이지 않도록 삭제 표시로 바꿈
+            db->slots[pos].key = base.user;
+            db->slots[pos].info = NULL;
+        } else {
+            // 빈 칸 뒤의 탐사 구간에서 빈 칸 자리로 옮겨도 되는 항목을 당겨 채움
+            user_slot_probe_remove_at(db->slots, db->capacity, (size_t)pos);
+            db->slot_count--;
         }
+        ok = true;
+    } else if (pos < 0 && in_base) {
+        ok = user_db_insert(db, base.user, NULL, hash) == 0;
     }
-    pthread_mutex_unlock(&db->db_mutex);
-    return false;
+    if (ok) {
+        db->user_count--;
+    }
+    pthread_rwlock_unlock(&db->db_lock);
+    return ok;
 }
 
 int query_user(UserDB *db, const char *username, const char *password) {
-    pthread_mutex_lock(&db->db_mutex);
-    for (size_t i = 0; i < db->user_count; ++i) {
-        if (strcmp((char *)db->users[i].user.ptr, username) == 0 &&
-            strcmp((char *)db->users[i].pass.ptr, password) == 0) {
-            pthread_mutex_unlock(&db->db_mutex);
-            return i;  // 로그인 성공
+    uint32_t hash = intern_hash(username, strlen(username));
+    int ret = -1;  // 로그인 실패
+
+    pthread_rwlock_rdlock(&db->db_lock);
+    long pos = user_db_find(db, username, hash);
+    if (pos >= 0) {
+        // 변경분이 있으면 스냅샷보다 우선 (삭제 표시면 실패)
+        UserInfo *info = db->slots[pos].info;
+        if (info != NULL && strcmp(info->pass, password) == 0) {
+            ret = (int)pos;  // 로그인 성공
+        }
+    } else {
+        UserRecordView base;
+        if (user_snapshot_find(&db->base, username, hash, &base) == 0 && strcmp(base.pass, password) == 0) {
+            ret = 0;  // 로그인 성공
         }
     }
-    pthread_mutex_unlock(&db->db_mutex);
-    return -1;  // 로그인 실패
+    pthread_rwlock_unlock(&db->db_lock);
+    return ret;
 }
 
 bool register_user(UserDB *db, const char *host, const char *user, const char *pass, const char *name) {
-    pthread_mutex_lock(&db->db_mutex);
+    uint32_t hash = intern_hash(user, strnlen(user, MAX_STRING_SIZE - 1));
+    // 레코드는 잠금 밖에서 만들어 쓰기 잠금 구간을 짧게 유지
+    UserInfo *info = user_info_new(host, user, pass, name, hash);
+    if (info == NULL) {
+        perror("Failed to allocate user");
+        return false;
+    }
 
-    if (db->user_count >= MAX_USERS) {
-        printf("User database is full.\n");
-        pthread_mutex_unlock(&db->db_mutex);
+    pthread_rwlock_wrlock(&db->db_lock);
+    UserRecordView base;
+    long pos = user_db_find(db, info->user, hash);
+    if ((pos >= 0 && db->slots[pos].info != NULL) ||
+        (pos < 0 && user_snapshot_find(&db->base, info->user, hash, &base) == 0)) {
+        pthread_rwlock_unlock(&db->db_lock);
+        printf("User %s already exists.\n", info->user);
+        free(info);
+        return false;
+    }
+    if (pos >= 0) {
+        // 스냅샷에서 삭제했던 유저를 다시 등록: 삭제 표시 칸을 새 정보로 바꿈
+        db->slots[pos].key = info->user;
+        db->slots[pos].info = info;
+    } else if (user_db_insert(db, info->user, info, hash) < 0) {
+        pthread_rwlock_unlock(&db->db_lock);
+        perror("Failed to grow user database");
+        free(info);
         return false;
     }
+    db->user_count++;
 
-    UserInfo new_user;
-    new_user.host = CREATE_SMART_PTR(char[MAX_STRING_SIZE], host);
-    strcpy((char *)new_user.host.ptr, host);
-    
-    new_user.user = CREATE_SMART_PTR(char[MAX_STRING_SIZE], user);
-    strcpy((char *)new_user.user.ptr, user);
-    
-    new_user.pass = CREATE_SMART_PTR(char[MAX_STRING_SIZE], pass);
-    strcpy((char *)new_user.pass.ptr, pass);
-    
-    new_user.name = CREATE_SMART_PTR(char[MAX_STRING_SIZE], name);
-    strcpy((char *)new_user.name.ptr, name);
-
-    db->users[db->user_count++] = new_user;
-
-    pthread_mutex_unlock(&db->db_mutex);
+    pthread_rwlock_unlock(&db->db_lock);
     return true;
 }
 
-void display_all_users(UserDB *db) {
-    for (size_t i = 0; i < db->user_count; ++i) {
-        printf("Host: %s, User: %s, Pass: %s, Name: %s\n",
-            (char *)db->users[i].host.ptr,
-            (char *)db->users[i].user.ptr,
-            (char *)db->users[i].pass.ptr,
-            (char *)db->users[i].name.ptr);
+// 변경분의 유저, 그다음 변경분에 가려지지 않은 스냅샷 유저 순으로 호출
+void for_each_user(UserDB *db, void (*fn)(void *ctx, const char *host, const char *user, const char *pass,
+                                          const char *name), void *ctx) {
+    pthread_rwlock_rdlock(&db->db_lock);
+    for (size_t i = 0; i < db->capacity; ++i) {
+        UserInfo *info = db->slots[i].info;
+        if (info != NULL) {
+            fn(ctx, info->host, info->user, info->pass, info->name);
+        }
+    }
+    for (uint32_t i = 0; db->base.map != NULL && i < db->base.index_capacity; ++i) {
+        const UserSnapshotSlot *slot = &db->base.index[i];
+        UserRecordView rec;
+        if (slot->offset == USER_SNAPSHOT_EMPTY || user_snapshot_record(&db->base, slot->offset, &rec) < 0) {
+            continue;
+        }
+        if (user_db_find(db, rec.user, slot->hash) < 0) {
+            fn(ctx, rec.host, rec.user, rec.pass, rec.name);
+        }
     }
+    pthread_rwlock_unlock(&db->db_lock);
+}
+
+static void display_user(void *ctx, const char *host, const char *user, const char *pass, const char *name) {
+    printf("Host: %s, User: %s, Pass: %s, Name: %s\n", host, user, pass, name);
+}
+
+void display_all_users(UserDB *db) {
+    for_each_user(db, display_user, NULL);
 }
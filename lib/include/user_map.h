@@ -0,0 +1,230 @@
+#pragma once
+/**
+ * @file user_map.h
+ * @brief 사용자명 -> 연결 핸들 동시성 해시 맵
+ *
+ * 키는 인터닝된 사용자명 핸들이며, 해시는 인터닝 테이블에 이미 계산된 값을 그대로 씁니다.
+ * 맵은 해시 상위 비트로 고른 여러 스트라이프로 나뉘고 스트라이프마다 읽기/쓰기 잠금을 따로 가지므로,
+ * 서로 다른 사용자의 접속/종료/조회가 한 잠금에서 경합하지 않습니다. 스트라이프 안은 선형 탐사(probe.h)이며,
+ * 삭제 시 뒤 항목을 당겨 채워 삭제 표시를 남기지 않습니다. 등록/조회/삭제는 모두 O(1) 입니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "intern.h"
+#include "conn_table.h"
+#include "probe.h"
+
+#define USER_MAP_STRIPE_SHIFT 4                          ///< 스트라이프 수 = 16
+#define USER_MAP_STRIPES (1u << USER_MAP_STRIPE_SHIFT)
+#define USER_MAP_STRIPE_INITIAL 16                       ///< 스트라이프별 초기 크기 (2의 거듭제곱)
+
+/**
+ * @struct UserMapEntry
+ * @brief 사용자 한 명의 항목 (name 이 INTERN_NONE 이면 빈 칸)
+ */
+typedef struct {
+    InternId name;        ///< 사용자명 핸들 (참조는 연결 쪽이 가지고 있음)
+    uint32_t hash;        ///< 사용자명 해시 (재배치 시 다시 계산하지 않도록 보관)
+    ConnHandle handle;    ///< 연결 핸들
+} UserMapEntry;
+
+/**
+ * @struct UserMapStripe
+ * @brief 잠금 하나로 보호하는 맵 조각
+ */
+typedef struct {
+    UserMapEntry *entries;   ///< 선형 탐사 테이블
+    uint32_t capacity;       ///< 테이블 크기 (2의 거듭제곱)
+    uint32_t count;          ///< 사용 중인 칸 수
+    pthread_rwlock_t lock;   ///< 등록/삭제는 쓰기, 조회는 읽기 잠금
+} UserMapStripe;
+
+/**
+ * @struct UserMap
+ * @brief 사용자명 -> 연결 핸들 맵
+ */
+typedef struct {
+    InternTable *names;                       ///< 키 문자열을 비교할 인터닝 테이블
+    UserMapStripe stripes[USER_MAP_STRIPES];  ///< 해시 상위 비트로 나눈 조각
+} UserMap;
+
+static inline UserMapStripe *user_map_stripe(UserMap *map, uint32_t hash) {
+    return &map->stripes[hash >> (32 - USER_MAP_STRIPE_SHIFT)];
+}
+
+/**
+ * @struct UserMapKey
+ * @brief 문자열로 조회할 때의 키
+ */
+typedef struct {
+    InternTable *names;   ///< 항목의 사용자명 문자열을 꺼낼 인터닝 테이블
+    const char *str;      ///< 사용자명
+    size_t len;           ///< 사용자명 길이
+    uint32_t hash;        ///< 사용자명 해시
+} UserMapKey;
+
+/**
+ * @brief 항목의 사용자명이 키 문자열과 같은지 비교
+ *
+ * 맵에 남아 있는 동안은 연결이 사용자명 참조를 가지고 있으므로 문자열을 잠금 없이 읽어도 안전합니다.
+ */
+static inline int user_map_entry_is(const UserMapEntry *entry, const UserMapKey *key) {
+    if (entry->hash != key->hash) {
+        return 0;
+    }
+    InternEntry *name = intern_entry(key->names, entry->name);
+    return name->len == key->len && memcmp(name->str, key->str, key->len) == 0;
+}
+
+#define USER_MAP_EMPTY(entry) ((entry)->name == INTERN_NONE)
+#define USER_MAP_HASH(entry) ((entry)->hash)
+#define USER_MAP_MATCH_ID(entry, id) ((entry)->name == (id))
+
+PROBE_TABLE(user_map, UserMapEntry, USER_MAP_EMPTY, USER_MAP_HASH)
+PROBE_FIND(user_map_find_id, UserMapEntry, InternId, USER_MAP_EMPTY, USER_MAP_MATCH_ID)
+PROBE_FIND(user_map_find_str, UserMapEntry, const UserMapKey *, USER_MAP_EMPTY, user_map_entry_is)
+
+/**
+ * @brief 맵 초기화
+ *
+ * @param map 초기화할 맵
+ * @param names 사용자명을 인터닝하는 테이블
+ * @return 성공 시 0, 실패 시 -1
+ */
+int user_map_init(UserMap *map, InternTable *names) {
+    memset(map, 0, sizeof(*map));
+    map->names = names;
+    for (uint32_t i = 0; i < USER_MAP_STRIPES; i++) {
+        UserMapStripe *stripe = &map->stripes[i];
+        stripe->entries = (UserMapEntry *)calloc(USER_MAP_STRIPE_INITIAL, sizeof(UserMapEntry));
+        if (stripe->entries == NULL) {
+            return -1;
+        }
+        stripe->capacity = USER_MAP_STRIPE_INITIAL;
+        pthread_rwlock_init(&stripe->lock, NULL);
+    }
+    return 0;
+}
+
+/**
+ * @brief 스트라이프에서 사용자명 핸들의 칸을 찾음 (잠금은 호출자가 잡음)
+ *
+ * @return 찾은 칸의 위치, 없으면 -1
+ */
+static long user_map_lookup_id(UserMapStripe *stripe, InternId name, uint32_t hash) {
+    return user_map_find_id(stripe->entries, stripe->capacity, hash, name);
+}
+
+/**
+ * @brief 스트라이프 테이블을 두 배로 키움 (쓰기 잠금 상태에서 호출)
+ *
+ * @return 성공 시 0, 메모리 부족 시 -1
+ */
+static int user_map_grow(UserMapStripe *stripe) {
+    uint32_t capacity = stripe->capacity * 2;
+    UserMapEntry *entries = user_map_probe_resize(stripe->entries, stripe->capacity, capacity);
+    if (entries == NULL) {
+        return -1;
+    }
+    stripe->entries = entries;
+    stripe->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief 사용자명을 연결에 등록 (이미 다른 연결이 쓰고 있으면 등록하지 않음)
+ *
+ * @param map 대상 맵
+ * @param name 사용자명 핸들 (맵에서 제거될 때까지 호출자가 참조를 유지)
+ * @param handle 연결 핸들
+ * @return 등록했으면 0, 이미 사용 중이면 1, 메모리 부족 시 -1
+ */
+int user_map_claim(UserMap *map, InternId name, ConnHandle handle) {
+    uint32_t hash = intern_entry(map->names, name)->hash;
+    UserMapStripe *stripe = user_map_stripe(map, hash);
+
+    pthread_rwlock_wrlock(&stripe->lock);
+    if (user_map_lookup_id(stripe, name, hash) >= 0) {
+        pthread_rwlock_unlock(&stripe->lock);
+        return 1;
+    }
+    // 적재율 50% 를 넘지 않도록 유지
+    if ((stripe->count + 1) * 2 > stripe->capacity && user_map_grow(stripe) < 0) {
+        pthread_rwlock_unlock(&stripe->lock);
+        return -1;
+    }
+
+    size_t i = user_map_probe_slot(stripe->entries, stripe->capacity, hash);
+    stripe->entries[i].name = name;
+    stripe->entries[i].hash = hash;
+    stripe->entries[i].handle = handle;
+    stripe->count++;
+    pthread_rwlock_unlock(&stripe->lock);
+    return 0;
+}
+
+/**
+ * @brief 사용자명으로 연결 핸들을 조회
+ *
+ * @param map 대상 맵
+ * @param name 사용자명 (NUL 로 끝나지 않아도 됨)
+ * @param len 사용자명 길이
+ * @return 연결 핸들, 접속 중이 아니면 CONN_HANDLE_INVALID
+ */
+ConnHandle user_map_find(UserMap *map, const char *name, size_t len) {
+    UserMapKey key = { map->names, name, len, intern_hash(name, len) };
+    UserMapStripe *stripe = user_map_stripe(map, key.hash);
+    ConnHandle handle = CONN_HANDLE_INVALID;
+
+    pthread_rwlock_rdlock(&stripe->lock);
+    long pos = user_map_find_str(stripe->entries, stripe->capacity, key.hash, &key);
+    if (pos >= 0) {
+        handle = stripe->entries[pos].handle;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+    return handle;
+}
+
+/**
+ * @brief 연결이 등록한 사용자명을 제거 (다른 연결이 등록한 항목이면 그대로 둠)
+ *
+ * @param map 대상 맵
+ * @param name 사용자명 핸들 (INTERN_NONE 이면 아무것도 하지 않음)
+ * @param handle 등록할 때 쓴 연결 핸들
+ */
+void user_map_remove(UserMap *map, InternId name, ConnHandle handle) {
+    if (name == INTERN_NONE) {
+        return;
+    }
+    uint32_t hash = intern_entry(map->names, name)->hash;
+    UserMapStripe *stripe = user_map_stripe(map, hash);
+
+    pthread_rwlock_wrlock(&stripe->lock);
+    long pos = user_map_lookup_id(stripe, name, hash);
+    if (pos < 0 || stripe->entries[pos].handle != handle) {
+        pthread_rwlock_unlock(&stripe->lock);
+        return;
+    }
+
+    // 빈 칸을 만들고, 뒤따르는 탐사 구간에서 빈 칸 자리로 옮겨도 되는 항목을 당겨 채움
+    user_map_probe_remove_at(stripe->entries, stripe->capacity, (size_t)pos);
+    stripe->count--;
+    pthread_rwlock_unlock(&stripe->lock);
+}
+
+/**
+ * @brief 등록된 사용자 수
+ */
+uint32_t user_map_count(UserMap *map) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < USER_MAP_STRIPES; i++) {
+        pthread_rwlock_rdlock(&map->stripes[i].lock);
+        count += map->stripes[i].count;
+        pthread_rwlock_unlock(&map->stripes[i].lock);
+    }
+    return count;
+}
@@ -0,0 +1,332 @@
+#pragma once
+/**
+ * @file user_snapshot.h
+ * @brief mmap 으로 바로 조회하는 유저 데이터베이스 바이너리 스냅샷
+ *
+ * 파일 구성: [헤더][해시 인덱스][문자열 아레나]
+ *   - 해시 인덱스: 선형 탐사 테이블 {해시, 아레나 안 레코드 위치}, 크기는 2의 거듭제곱
+ *   - 레코드: [host 길이][user 길이][pass 길이][name 길이] (각 1바이트) + NUL 로 끝나는 네 문자열
+ *
+ * 여는 쪽은 파일을 읽기 전용으로 mmap 하고 헤더만 검증하므로, 유저 수와 무관하게 파싱이나
+ * 레코드별 할당 없이 바로 조회할 수 있습니다. 페이지는 조회할 때 필요한 만큼만 읽힙니다.
+ * 정수는 만든 호스트의 바이트 순서로 저장하며, 다른 바이트 순서의 파일은 거부합니다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "intern.h"
+
+#define USER_SNAPSHOT_MAGIC "USRSNAP1"
+#define USER_SNAPSHOT_VERSION 1
+#define USER_SNAPSHOT_BYTE_ORDER 0x01020304u
+#define USER_SNAPSHOT_EMPTY UINT32_MAX          ///< 빈 인덱스 칸
+#define USER_SNAPSHOT_FIELD_MAX 255             ///< 필드 하나의 최대 길이 (길이를 1바이트로 저장)
+
+/**
+ * @struct UserSnapshotHeader
+ * @brief 스냅샷 파일 헤더
+ */
+typedef struct {
+    char magic[8];              ///< "USRSNAP1"
+    uint32_t version;           ///< 형식 버전
+    uint32_t byte_order;        ///< USER_SNAPSHOT_BYTE_ORDER (바이트 순서 확인용)
+    uint32_t user_count;        ///< 유저 수
+    uint32_t index_capacity;    ///< 인덱스 칸 수 (2의 거듭제곱)
+    uint64_t index_offset;      ///< 파일 안 인덱스 위치
+    uint64_t arena_offset;      ///< 파일 안 아레나 위치
+    uint64_t arena_size;        ///< 아레나 크기
+} UserSnapshotHeader;
+
+/**
+ * @struct UserSnapshotSlot
+ * @brief 인덱스 칸
+ */
+typedef struct {
+    uint32_t hash;      ///< 유저 이름 해시 (intern_hash)
+    uint32_t offset;    ///< 아레나 안 레코드 위치, 빈 칸이면 USER_SNAPSHOT_EMPTY
+} UserSnapshotSlot;
+
+/**
+ * @struct UserSnapshot
+ * @brief 열린 스냅샷 (map 이 NULL 이면 열리지 않은 상태)
+ */
+typedef struct {
+    void *map;                          ///< 파일 전체 매핑
+    size_t map_size;                    ///< 매핑 크기
+    const UserSnapshotSlot *index;      ///< 해시 인덱스
+    uint32_t index_capacity;            ///< 인덱스 칸 수
+    uint32_t user_count;                ///< 유저 수
+    const unsigned char *arena;         ///< 문자열 아레나
+    uint64_t arena_size;                ///< 아레나 크기
+} UserSnapshot;
+
+/**
+ * @struct UserRecordView
+ * @brief 스냅샷 레코드의 네 필드 (매핑 안을 가리키므로 스냅샷을 닫기 전까지만 유효)
+ */
+typedef struct {
+    const char *host;
+    const char *user;
+    const char *pass;
+    const char *name;
+} UserRecordView;
+
+/**
+ * @brief 스냅샷 파일을 읽기 전용으로 매핑하고 헤더를 검증
+ *
+ * @param snap 열린 스냅샷을 받을 구조체
+ * @param path 스냅샷 경로
+ * @return 성공 시 0, 파일이 없거나 형식이 잘못되면 -1
+ */
+int user_snapshot_open(UserSnapshot *snap, const char *path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    memset(snap, 0, sizeof(*snap));
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(UserSnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const UserSnapshotHeader *hdr = (const UserSnapshotHeader *)map;
+    uint64_t size = (uint64_t)st.st_size;
+    uint64_t index_bytes = (uint64_t)hdr->index_capacity * sizeof(UserSnapshotSlot);
+    if (memcmp(hdr->magic, USER_SNAPSHOT_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != USER_SNAPSHOT_VERSION || hdr->byte_order != USER_SNAPSHOT_BYTE_ORDER ||
+        hdr->index_capacity == 0 || (hdr->index_capacity & (hdr->index_capacity - 1)) != 0 ||
+        hdr->user_count >= hdr->index_capacity || hdr->index_offset % sizeof(UserSnapshotSlot) != 0 ||
+        hdr->index_offset > size || index_bytes > size - hdr->index_offset ||
+        hdr->arena_offset > size || hdr->arena_size > size - hdr->arena_offset) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    snap->map = map;
+    snap->map_size = (size_t)st.st_size;
+    snap->index = (const UserSnapshotSlot *)((const char *)map + hdr->index_offset);
+    snap->index_capacity = hdr->index_capacity;
+    snap->user_count = hdr->user_count;
+    snap->arena = (const unsigned char *)map + hdr->arena_offset;
+    snap->arena_size = hdr->arena_size;
+    // 로그인 조회는 임의 위치를 읽으므로 미리 읽기를 끔
+    madvise(map, snap->map_size, MADV_RANDOM);
+    return 0;
+}
+
+/**
+ * @brief 스냅샷 매핑 해제
+ */
+void user_snapshot_close(UserSnapshot *snap) {
+    if (snap->map != NULL) {
+        munmap(snap->map, snap->map_size);
+    }
+    memset(snap, 0, sizeof(*snap));
+}
+
+/**
+ * @brief 아레나 위치의 레코드를 읽음 (아레나를 벗어나는 손상된 레코드는 거부)
+ *
+ * @return 성공 시 0, 손상된 레코드면 -1
+ */
+int user_snapshot_record(const UserSnapshot *snap, uint32_t offset, UserRecordView *view) {
+    const char **fields[4] = { &view->host, &view->user, &view->pass, &view->name };
+
+    if ((uint64_t)offset + 4 > snap->arena_size) {
+        return -1;
+    }
+    const unsigned char *lens = snap->arena + offset;
+    uint64_t pos = (uint64_t)offset + 4;
+    for (int i = 0; i < 4; i++) {
+        if (pos + lens[i] + 1 > snap->arena_size || snap->arena[pos + lens[i]] != '\0') {
+            return -1;
+        }
+        *fields[i] = (const char *)snap->arena + pos;
+        pos += lens[i] + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 유저 이름으로 레코드를 찾음
+ *
+ * @param snap 열린 스냅샷 (열리지 않았으면 항상 실패)
+ * @param username 유저 이름
+ * @param hash intern_hash(username)
+ * @param view 찾은 레코드
+ * @return 찾으면 0, 없으면 -1
+ */
+int user_snapshot_find(const UserSnapshot *snap, const char *username, uint32_t hash, UserRecordView *view) {
+    if (snap->map == NULL) {
+        return -1;
+    }
+    uint32_t mask = snap->index_capacity - 1;
+    for (uint32_t i = hash & mask, probes = 0; probes < snap->index_capacity; i = (i + 1) & mask, probes++) {
+        const UserSnapshotSlot *slot = &snap->index[i];
+        if (slot->offset == USER_SNAPSHOT_EMPTY) {
+            return -1;
+        }
+        if (slot->hash == hash && user_snapshot_record(snap, slot->offset, view) == 0 &&
+            strcmp(view->user, username) == 0) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @struct UserSnapshotBuilder
+ * @brief 레코드를 모아 스냅샷 파일을 쓰는 빌더
+ */
+typedef struct {
+    unsigned char *arena;   ///< 문자열 아레나
+    size_t arena_size;      ///< 사용한 크기
+    size_t arena_capacity;  ///< 할당한 크기
+    uint32_t *hashes;       ///< 레코드별 유저 이름 해시
+    uint32_t *offsets;      ///< 레코드별 아레나 위치
+    uint32_t count;         ///< 레코드 수
+    uint32_t capacity;      ///< hashes/offsets 용량
+    int failed;             ///< 추가 실패가 있었으면 1 (호출자가 모아서 확인할 때 사용)
+} UserSnapshotBuilder;
+
+void user_snapshot_builder_init(UserSnapshotBuilder *b) {
+    memset(b, 0, sizeof(*b));
+}
+
+void user_snapshot_builder_free(UserSnapshotBuilder *b) {
+    free(b->arena);
+    free(b->hashes);
+    free(b->offsets);
+    memset(b, 0, sizeof(*b));
+}
+
+/**
+ * @brief 레코드 하나를 추가 (유저 이름 중복은 호출자가 막음)
+ *
+ * @return 성공 시 0, 필드가 너무 길거나 메모리 부족 시 -1
+ */
+int user_snapshot_builder_add(UserSnapshotBuilder *b, const char *host, const char *user, const char *pass,
+                              const char *name) {
+    const char *fields[4] = { host, user, pass, name };
+    size_t lens[4], need = 4;
+
+    for (int i = 0; i < 4; i++) {
+        lens[i] = strlen(fields[i]);
+        if (lens[i] > USER_SNAPSHOT_FIELD_MAX) {
+            return -1;
+        }
+        need += lens[i] + 1;
+    }
+    if (b->arena_size + need >= USER_SNAPSHOT_EMPTY || b->count + 1 >= (1u << 31)) {
+        return -1;
+    }
+    if (b->arena_size + need > b->arena_capacity) {
+        size_t capacity = b->arena_capacity ? b->arena_capacity * 2 : 1 << 16;
+        while (capacity < b->arena_size + need) {
+            capacity *= 2;
+        }
+        unsigned char *arena = (unsigned char *)realloc(b->arena, capacity);
+        if (arena == NULL) {
+            return -1;
+        }
+        b->arena = arena;
+        b->arena_capacity = capacity;
+    }
+    if (b->count == b->capacity) {
+        uint32_t capacity = b->capacity ? b->capacity * 2 : 1024;
+        uint32_t *hashes = (uint32_t *)realloc(b->hashes, capacity * sizeof(uint32_t));
+        if (hashes == NULL) {
+            return -1;
+        }
+        b->hashes = hashes;
+        uint32_t *offsets = (uint32_t *)realloc(b->offsets, capacity * sizeof(uint32_t));
+        if (offsets == NULL) {
+            return -1;
+        }
+        b->offsets = offsets;
+        b->capacity = capacity;
+    }
+
+    unsigned char *rec = b->arena + b->arena_size;
+    unsigned char *p = rec + 4;
+    for (int i = 0; i < 4; i++) {
+        rec[i] = (unsigned char)lens[i];
+        memcpy(p, fields[i], lens[i] + 1);
+        p += lens[i] + 1;
+    }
+    b->hashes[b->count] = intern_hash(user, lens[1]);
+    b->offsets[b->count] = (uint32_t)b->arena_size;
+    b->count++;
+    b->arena_size += need;
+    return 0;
+}
+
+/**
+ * @brief 인덱스를 만들고 스냅샷 파일을 쓴 뒤 fsync
+ *
+ * @param b 빌더
+ * @param path 쓸 경로 (원자적 교체가 필요하면 임시 경로에 쓰고 호출자가 rename)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int user_snapshot_builder_write(UserSnapshotBuilder *b, const char *path) {
+    UserSnapshotHeader hdr;
+    uint32_t capacity = 16;
+
+    // 적재율 50% 이하
+    while (capacity < 2u * b->count + 1) {
+        capacity *= 2;
+    }
+    UserSnapshotSlot *index = (UserSnapshotSlot *)malloc(capacity * sizeof(UserSnapshotSlot));
+    if (index == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+        index[i].hash = 0;
+        index[i].offset = USER_SNAPSHOT_EMPTY;
+    }
+    for (uint32_t r = 0; r < b->count; r++) {
+        uint32_t i = b->hashes[r] & (capacity - 1);
+        while (index[i].offset != USER_SNAPSHOT_EMPTY) {
+            i = (i + 1) & (capacity - 1);
+        }
+        index[i].hash = b->hashes[r];
+        index[i].offset = b->offsets[r];
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, USER_SNAPSHOT_MAGIC, sizeof(hdr.magic));
+    hdr.version = USER_SNAPSHOT_VERSION;
+    hdr.byte_order = USER_SNAPSHOT_BYTE_ORDER;
+    hdr.user_count = b->count;
+    hdr.index_capacity = capacity;
+    hdr.index_offset = sizeof(hdr);
+    hdr.arena_offset = hdr.index_offset + (uint64_t)capacity * sizeof(UserSnapshotSlot);
+    hdr.arena_size = b->arena_size;
+
+    int ret = -1;
+    FILE *file = fopen(path, "wb");
+    if (file != NULL) {
+        if (fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+            fwrite(index, sizeof(UserSnapshotSlot), capacity, file) == capacity &&
+            (b->arena_size == 0 || fwrite(b->arena, b->arena_size, 1, file) == 1) &&
+            fflush(file) == 0 && fsync(fileno(file)) == 0) {
+            ret = 0;
+        }
+        fclose(file);
+    }
+    free(index);
+    return ret;
+}
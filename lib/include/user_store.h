@@ -0,0 +1,415 @@
+#pragma once
+/**
+ * @file user_store.h
+ * @brief 스냅샷 + 추가 전용 저널로 유저 데이터베이스를 저장하는 저장소
+ *
+ * 등록/삭제는 저널 파일 끝에 한 줄짜리 레코드를 write() 한 번으로 붙이기만 하므로, 유저 수와 무관하게
+ * O(1) 입니다. 백그라운드 압축 스레드는 저널이 일정 크기를 넘으면 저널을 봉인(이름 변경)한 뒤,
+ * 이전 스냅샷 + 봉인된 저널을 새 스냅샷으로 합치고 봉인된 저널을 지웁니다. 압축은 파일만 보고 하므로
+ * 같은 파일을 쓰는 다른 프로세스의 기록도 잃지 않습니다.
+ *
+ * 시작할 때는 스냅샷, 봉인된 저널(압축 도중 종료된 경우), 현재 저널 순으로 재생합니다.
+ * 레코드는 "마지막 기록이 이긴다" 의미이므로, 스냅샷이 저널 일부를 이미 반영하고 있어도 결과가 같습니다.
+ *
+ * 스냅샷은 바이너리 형식(user_snapshot.h, 경로 뒤에 .snap)으로 씁니다. 시작할 때는 이를 mmap 해
+ * 데이터베이스의 바탕으로 붙이기만 하므로 유저 수와 무관하게 빠르고, 저널만 재생합니다.
+ * 바이너리 스냅샷이 아직 없으면 기존 텍스트 파일을 읽으며, 첫 압축부터 바이너리 스냅샷으로 바뀝니다.
+ *
+ * 저널 레코드 형식 (공백 구분, 필드에는 공백이 없음):
+ *   R <host> <user> <pass> <name>   유저 등록
+ *   D <user>                       유저 삭제
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "user.h"
+
+#define USER_STORE_PATH_MAX 256
+#define USER_STORE_RECORD_MAX (2 + 4 * MAX_STRING_SIZE)    ///< 레코드 한 줄 최대 길이
+#define USER_STORE_COMPACT_BYTES (1L << 20)                 ///< 저널이 이 크기를 넘으면 압축
+#define USER_STORE_COMPACT_INTERVAL_MS 1000                 ///< 압축 스레드가 저널 크기를 확인하는 주기
+
+/**
+ * @struct UserStore
+ * @brief 유저 데이터베이스의 파일 저장소
+ *
+ * 파일 이름은 스냅샷 경로를 기준으로 정합니다 (예: user_data.txt, user_data.txt.snap, user_data.txt.journal).
+ */
+typedef struct {
+    UserDB *db;                                     ///< 메모리의 유저 데이터베이스
+    char snapshot_path[USER_STORE_PATH_MAX];        ///< 기존 텍스트 형식 스냅샷 (바이너리 스냅샷이 없을 때만 읽음)
+    char binary_path[USER_STORE_PATH_MAX];          ///< 바이너리 스냅샷
+    char journal_path[USER_STORE_PATH_MAX];         ///< 현재 저널
+    char sealed_path[USER_STORE_PATH_MAX];          ///< 압축 중인 봉인된 저널
+    char lock_path[USER_STORE_PATH_MAX];            ///< 저널 교체 잠금 파일 (추가는 공유, 봉인은 배타)
+    char compact_lock_path[USER_STORE_PATH_MAX];    ///< 압축 잠금 파일 (한 번에 한 압축만)
+    int journal_fd;                                 ///< O_APPEND 로 연 현재 저널
+    int lock_fd;                                    ///< 추가할 때 공유 잠금을 잡는 잠금 파일
+    pthread_mutex_t append_lock;                    ///< 메모리 반영과 저널 추가를 같은 순서로 묶음
+    long compact_bytes;                             ///< 압축을 시작하는 저널 크기
+    pthread_t compactor;                            ///< 백그라운드 압축 스레드
+    pthread_mutex_t compactor_lock;                 ///< stopping/compactor_cond 보호
+    pthread_cond_t compactor_cond;                  ///< 종료 시 압축 스레드를 깨움
+    int stopping;                                   ///< 압축 스레드 종료 요청
+    atomic_long appended;                           ///< 추가한 레코드 수
+    atomic_long compactions;                        ///< 끝낸 압축 횟수
+} UserStore;
+
+/**
+ * @brief 열어 둔 저널이 압축으로 봉인(이름 변경)되었으면 새 저널을 엶
+ *
+ * append_lock 과 잠금 파일의 공유 잠금을 잡은 상태에서 호출합니다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int user_store_reopen_journal(UserStore *store) {
+    struct stat fd_st, path_st;
+
+    if (store->journal_fd >= 0 && fstat(store->journal_fd, &fd_st) == 0 &&
+        stat(store->journal_path, &path_st) == 0 && fd_st.st_ino == path_st.st_ino &&
+        fd_st.st_dev == path_st.st_dev) {
+        return 0;
+    }
+    if (store->journal_fd >= 0) {
+        close(store->journal_fd);
+    }
+    store->journal_fd = open(store->journal_path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    return store->journal_fd >= 0 ? 0 : -1;
+}
+
+/**
+ * @brief 레코드 한 줄을 저널에 추가 (append_lock 은 호출자가 잡음)
+ *
+ * O_APPEND 로 한 번에 쓰므로 다른 프로세스가 동시에 추가해도 줄이 섞이지 않습니다.
+ *
+ * @return 성공 시 0, 실패 시 -1
+ */
+static int user_store_append(UserStore *store, const char *record, size_t len) {
+    int ret = -1;
+
+    flock(store->lock_fd, LOCK_SH);
+    if (user_store_reopen_journal(store) == 0 && write(store->journal_fd, record, len) == (ssize_t)len) {
+        atomic_fetch_add_explicit(&store->appended, 1, memory_order_relaxed);
+        ret = 0;
+    }
+    flock(store->lock_fd, LOCK_UN);
+    return ret;
+}
+
+/**
+ * @brief 저널 파일 하나를 데이터베이스에 재생 (형식이 잘못된 줄, 잘린 마지막 줄은 무시)
+ *
+ * @return 재생한 레코드 수, 파일이 없으면 0
+ */
+static size_t user_store_replay(UserDB *db, const char *path) {
+    char line[USER_STORE_RECORD_MAX + 2];
+    char host[MAX_STRING_SIZE], user[MAX_STRING_SIZE], pass[MAX_STRING_SIZE], name[MAX_STRING_SIZE];
+    size_t count = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strchr(line, '\n') == NULL) {
+            continue;  // 기록 도중 종료되어 잘린 줄
+        }
+        if (line[0] == 'R' && sscanf(line + 1, "%99s %99s %99s %99s", host, user, pass, name) == 4) {
+            // 마지막 기록이 이기도록 기존 항목을 지우고 다시 등록
+            delete_user(db, user);
+            register_user(db, host, user, pass, name);
+            count++;
+        } else if (line[0] == 'D' && sscanf(line + 1, "%99s", user) == 1) {
+            delete_user(db, user);
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+/**
+ * @brief 기록 도중 종료되어 줄바꿈 없이 끝난 저널 꼬리를 잘라냄
+ *
+ * 잘린 레코드를 남겨 두면 다음에 추가하는 레코드와 한 줄로 붙어 다른 레코드로 읽힐 수 있습니다.
+ * 잠금 파일의 배타 잠금을 잡은 상태에서 호출합니다.
+ */
+static void user_store_trim_journal(const char *path) {
+    char buf[512];
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    off_t end;
+
+    if (fd < 0) {
+        return;
+    }
+    end = lseek(fd, 0, SEEK_END);
+    // 마지막 줄바꿈을 뒤에서부터 찾음
+    while (end > 0) {
+        off_t start = end > (off_t)sizeof(buf) ? end - (off_t)sizeof(buf) : 0;
+        ssize_t n = pread(fd, buf, (size_t)(end - start), start);
+        if (n <= 0) {
+            break;
+        }
+        ssize_t i = n - 1;
+        while (i >= 0 && buf[i] != '\n') {
+            i--;
+        }
+        if (i >= 0) {
+            end = start + i + 1;
+            break;
+        }
+        end = start;
+    }
+    if (end != lseek(fd, 0, SEEK_END) && ftruncate(fd, end) == 0) {
+        printf("사용자 저널 %s: 잘린 레코드를 버렸습니다.\n", path);
+    }
+    close(fd);
+}
+
+/**
+ * @brief 스냅샷을 데이터베이스에 읽어 들임 (바이너리 스냅샷은 매핑만, 없으면 텍스트 파일을 파싱)
+ *
+ * @return 읽은 유저 수, 파일이 없으면 0
+ */
+static size_t user_store_load_snapshot(UserStore *store, UserDB *db) {
+    if (attach_user_snapshot(db, store->binary_path) == 0) {
+        return db->base.user_count;
+    }
+    FILE *file = fopen(store->snapshot_path, "r");
+    size_t count;
+
+    if (file == NULL) {
+        return 0;
+    }
+    count = read_users(db, file);
+    fclose(file);
+    return count;
+}
+
+/**
+ * @brief 저널을 스냅샷으로 합침
+ *
+ * 1. 교체 잠금(배타) 안에서 현재 저널을 봉인된 저널로 이름을 바꿈 (이후 추가는 새 저널로 감)
+ * 2. 이전 스냅샷 + 봉인된 저널을 별도 데이터베이스에 재생해 바이너리 스냅샷 임시 파일에 쓰고 fsync 후 교체
+ * 3. 봉인된 저널 삭제
+ *
+ * 어느 단계에서 종료되어도 다음 시작 시 스냅샷 + 봉인된 저널 + 현재 저널 재생으로 복구됩니다.
+ * 다른 스레드/프로세스가 압축 중이면 아무것도 하지 않습니다.
+ *
+ * @param store 저장소
+ * @return 압축했으면 1, 다른 압축이 진행 중이면 0, 실패 시 -1
+ */
+int user_store_compact(UserStore *store) {
+    char tmp_path[USER_STORE_PATH_MAX + 8];
+    UserDB merged;
+    int ret = -1;
+
+    int compact_fd = open(store->compact_lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (compact_fd < 0) {
+        return -1;
+    }
+    if (flock(compact_fd, LOCK_EX | LOCK_NB) < 0) {
+        close(compact_fd);
+        return 0;
+    }
+
+    // 이전 압축이 도중에 끝났으면 남은 봉인된 저널부터 합침 (현재 저널은 다음 압축에서)
+    if (access(store->sealed_path, F_OK) != 0) {
+        int rotate_fd = open(store->lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (rotate_fd < 0) {
+            goto out;
+        }
+        flock(rotate_fd, LOCK_EX);
+        int renamed = rename(store->journal_path, store->sealed_path);
+        flock(rotate_fd, LOCK_UN);
+        close(rotate_fd);
+        if (renamed < 0) {
+            ret = errno == ENOENT ? 0 : -1;  // 저널이 아직 없음
+            goto out;
+        }
+    }
+
+    init_user_db(&merged);
+    user_store_load_snapshot(store, &merged);
+    user_store_replay(&merged, store->sealed_path);
+
+    // 이전 스냅샷의 매핑은 교체 후에도 유효하므로 열려 있는 데이터베이스는 그대로 둬도 됨
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", store->binary_path);
+    ret = write_user_snapshot(&merged, tmp_path);
+    free_user_db(&merged);
+
+    if (ret == 0 && rename(tmp_path, store->binary_path) == 0) {
+        unlink(store->sealed_path);
+        atomic_fetch_add_explicit(&store->compactions, 1, memory_order_relaxed);
+        ret = 1;
+    } else {
+        unlink(tmp_path);
+        ret = -1;
+    }
+
+out:
+    flock(compact_fd, LOCK_UN);
+    close(compact_fd);
+    return ret;
+}
+
+/**
+ * @brief 주기적으로 저널 크기를 확인해 압축하는 스레드
+ */
+static void *user_store_compactor(void *arg) {
+    UserStore *store = (UserStore *)arg;
+    struct timespec deadline;
+    struct stat st;
+
+    pthread_mutex_lock(&store->compactor_lock);
+    while (!store->stopping) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += USER_STORE_COMPACT_INTERVAL_MS / 1000;
+        deadline.tv_nsec += (USER_STORE_COMPACT_INTERVAL_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&store->compactor_cond, &store->compactor_lock, &deadline);
+        if (store->stopping) {
+            break;
+        }
+
+        pthread_mutex_unlock(&store->compactor_lock);
+        if (stat(store->journal_path, &st) == 0 && st.st_size >= store->compact_bytes) {
+            user_store_compact(store);
+        }
+        pthread_mutex_lock(&store->compactor_lock);
+    }
+    pthread_mutex_unlock(&store->compactor_lock);
+    return NULL;
+}
+
+/**
+ * @brief 저장소를 열고 스냅샷과 저널을 재생해 데이터베이스를 채운 뒤 압축 스레드를 시작
+ *
+ * @param store 초기화할 저장소
+ * @param db 채울 유저 데이터베이스 (init_user_db() 로 초기화된 빈 상태)
+ * @param snapshot_path 스냅샷 경로 (저널 등은 이 경로 뒤에 접미사를 붙인 이름)
+ * @return 성공 시 0, 실패 시 -1
+ */
+int user_store_open(UserStore *store, UserDB *db, const char *snapshot_path) {
+    memset(store, 0, sizeof(*store));
+    store->db = db;
+    store->journal_fd = -1;
+    store->compact_bytes = USER_STORE_COMPACT_BYTES;
+    snprintf(store->snapshot_path, sizeof(store->snapshot_path), "%s", snapshot_path);
+    snprintf(store->binary_path, sizeof(store->binary_path), "%s.snap", snapshot_path);
+    snprintf(store->journal_path, sizeof(store->journal_path), "%s.journal", snapshot_path);
+    snprintf(store->sealed_path, sizeof(store->sealed_path), "%s.journal.old", snapshot_path);
+    snprintf(store->lock_path, sizeof(store->lock_path), "%s.lock", snapshot_path);
+    snprintf(store->compact_lock_path, sizeof(store->compact_lock_path), "%s.compact", snapshot_path);
+
+    store->lock_fd = open(store->lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (store->lock_fd < 0) {
+        return -1;
+    }
+    pthread_mutex_init(&store->append_lock, NULL);
+    pthread_mutex_init(&store->compactor_lock, NULL);
+    pthread_cond_init(&store->compactor_cond, NULL);
+
+    // 다른 프로세스의 압축이 끝날 때까지 기다렸다가 읽음 (압축 중에는 파일 이름이 바뀜)
+    int compact_fd = open(store->compact_lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (compact_fd >= 0) {
+        flock(compact_fd, LOCK_SH);
+    }
+    flock(store->lock_fd, LOCK_EX);
+    user_store_trim_journal(store->journal_path);
+    flock(store->lock_fd, LOCK_SH);  // 배타 잠금을 공유 잠금으로 낮춤
+    user_store_load_snapshot(store, db);
+    user_store_replay(db, store->sealed_path);
+    user_store_replay(db, store->journal_path);
+    int opened = user_store_reopen_journal(store);
+    flock(store->lock_fd, LOCK_UN);
+    if (compact_fd >= 0) {
+        close(compact_fd);
+    }
+    if (opened < 0) {
+        close(store->lock_fd);
+        return -1;
+    }
+
+    if (pthread_create(&store->compactor, NULL, user_store_compactor, store) != 0) {
+        close(store->journal_fd);
+        close(store->lock_fd);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 유저를 등록하고 저널에 기록
+ *
+ * @return 성공 시 true, 이미 있는 유저이거나 기록 실패 시 false
+ */
+bool user_store_register(UserStore *store, const char *host, const char *user, const char *pass, const char *name) {
+    char record[USER_STORE_RECORD_MAX + 2];
+    int len = snprintf(record, sizeof(record), "R %.99s %.99s %.99s %.99s\n", host, user, pass, name);
+    bool ok = false;
+
+    // 같은 유저의 등록/삭제가 메모리와 저널에 같은 순서로 남도록 묶어서 처리
+    pthread_mutex_lock(&store->append_lock);
+    if (register_user(store->db, host, user, pass, name)) {
+        ok = user_store_append(store, record, (size_t)len) == 0;
+        if (!ok) {
+            perror("Failed to append user journal");
+            delete_user(store->db, user);
+        }
+    }
+    pthread_mutex_unlock(&store->append_lock);
+    return ok;
+}
+
+/**
+ * @brief 유저를 삭제하고 저널에 기록
+ *
+ * 삭제한 유저는 되살릴 정보가 남지 않으므로 저널에 먼저 기록하고, 기록에 성공한 경우에만 메모리에서
+ * 지웁니다. 없는 유저였다면 재생할 때 아무 일도 하지 않는 삭제 레코드 하나가 남습니다.
+ *
+ * @return 삭제했으면 true, 없는 유저이거나 기록 실패 시 false
+ */
+bool user_store_delete(UserStore *store, const char *user) {
+    char record[USER_STORE_RECORD_MAX + 2];
+    int len = snprintf(record, sizeof(record), "D %.99s\n", user);
+    bool ok = false;
+
+    pthread_mutex_lock(&store->append_lock);
+    if (user_store_append(store, record, (size_t)len) < 0) {
+        perror("Failed to append user journal");
+    } else {
+        ok = delete_user(store->db, user);
+    }
+    pthread_mutex_unlock(&store->append_lock);
+    return ok;
+}
+
+/**
+ * @brief 압축 스레드를 멈추고 파일을 닫음 (데이터베이스는 호출자가 해제)
+ */
+void user_store_close(UserStore *store) {
+    pthread_mutex_lock(&store->compactor_lock);
+    store->stopping = 1;
+    pthread_cond_signal(&store->compactor_cond);
+    pthread_mutex_unlock(&store->compactor_lock);
+    pthread_join(store->compactor, NULL);
+
+    close(store->journal_fd);
+    close(store->lock_fd);
+    pthread_mutex_destroy(&store->append_lock);
+    pthread_mutex_destroy(&store->compactor_lock);
+    pthread_cond_destroy(&store->compactor_cond);
+}
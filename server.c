@@ -3,6 +3,7 @@
  * @brief 서버 코드. 클라이언트와의 채팅 통신을 관리하고, 스마트 포인터를 이용해 클라이언트 정보를 처리합니다.
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -10,57 +11,139 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <stdarg.h>
+#include "lib/include/smartptr.h"
+#include "lib/include/pool.h"
+#include "lib/include/intern.h"
 #include "lib/include/uniqueptr.h"
 #include <fcntl.h>
 #include <pthread.h>
+#include <errno.h>
+#include <poll.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include "lib/include/epoch.h"
+#include "lib/include/conn_table.h"
+#include "lib/include/user_map.h"
+#include "lib/include/presence.h"
+#include "lib/include/user_store.h"
+#include "lib/include/session.h"
+#include "lib/include/room.h"
+#include "lib/include/queue.h"
+#include "lib/include/thread_pool.h"
+#include "lib/include/protocol.h"
+#include "lib/include/chatlog.h"
+#include "lib/include/logsearch.h"
+#ifdef USE_IO_URING
+#include "lib/include/uring.h"
+#endif
 
 #define DEFAULT_TCP_PORT 5100
-#define MAX_CLIENTS 10
 #define BUFFER_SIZE 1024
+#define MAX_EPOLL_EVENTS 64   /**< epoll_wait 한 번에 처리할 최대 이벤트 수 */
+#define OUTBOX_LIMIT 256        /**< 클라이언트 송신 대기열 기본 상한 (메시지 수) */
+#define OUTBOX_IOV_MAX 64       /**< 한 번의 벡터 전송에 묶는 최대 메시지 수 */
+#define MESSAGE_POOL_OBJECT_SIZE 512  /**< 풀에서 할당하는 메시지 블록 크기 (넘는 메시지는 malloc) */
+#define CACHE_LINE_SIZE 64       /**< ClientInfo 핫 필드 정렬 단위 */
+#define URING_ENTRIES 4096       /**< io_uring 제출 큐 크기 */
+#define URING_BUFFER_COUNT 1024  /**< io_uring 수신용 provided buffer 개수 */
+#define URING_BUFFER_GROUP 0     /**< provided buffer 그룹 ID */
+#define LISTEN_BACKLOG 1024      /**< listen() 대기열 길이 */
+#define EPOLL_LISTEN_TAG (1ULL << 63)  /**< epoll data 에서 리스닝 소켓(샤드 번호)을 표시하는 비트 */
+#define EPOLL_MAILBOX_TAG (1ULL << 62) /**< epoll data 에서 워커 우편함 eventfd 를 표시하는 비트 */
+#define MAILBOX_CAPACITY 4096    /**< 워커 우편함 큐 칸 수 (넘치면 넘침 목록에 이어 붙임) */
+#define MAILBOX_BATCH 32         /**< 워커가 우편함 큐에서 한 번에 꺼내는 우편 수 */
+#define AUTH_MAX_FAILURES 5      /**< 연결 하나에서 허용하는 로그인 실패 횟수 */
+#define ROOM_LIST_TOP 20         /**< list 명령이 자세히 보여 주는 채팅방 수 (초당 메시지가 많은 순) */
+#define KICK_DRAIN_TIMEOUT_MS 5000  /**< 강제 퇴장한 연결이 송신 대기열을 비우기를 기다리는 최대 시간 */
+#define KICK_REAPER_INTERVAL_MS 500 /**< 퇴장 기한이 지난 연결을 확인하는 주기 */
 
+/**
+ * @brief 서버 I/O 처리 방식
+ */
+typedef enum {
+    IO_MODE_THREAD = 0,  /**< 고정 크기 워커 스레드 풀이 준비된 연결을 나눠 처리하는 방식 (작업 훔치기) */
+    IO_MODE_EPOLL,       /**< 고정된 수의 이벤트 루프 스레드가 epoll(ET)로 처리하는 방식 */
+    IO_MODE_URING,       /**< io_uring 으로 accept/recv/send 를 일괄 제출하는 방식 (미지원 시 epoll) */
+    IO_MODE_ROOM         /**< 방마다 소유 워커(코어) 하나가 팬아웃을 전담하는 epoll 방식 */
+} IoMode;
 
 /**
- * @brief 자동 데몬화 모드 함수
- * @param void
- * @return void
+ * @brief 송신 대기열이 상한에 도달한 느린 클라이언트 처리 정책
  */
-void auto_daemon_mode();
-void manual_server_mode();
+typedef enum {
+    SLOW_POLICY_DROP_OLDEST = 0,  /**< 가장 오래된 (아직 전송을 시작하지 않은) 메시지를 버림 */
+    SLOW_POLICY_DROP_NEWEST,      /**< 새 메시지를 버림 */
+    SLOW_POLICY_DISCONNECT        /**< 연결을 끊음 */
+} SlowPolicy;
 
 /**
- * @brief 스마트 포인터 구조체
- * 
- * 동적 할당된 메모리를 안전하게 관리하며, 참조 카운트를 통해 메모리를 자동 해제합니다.
+ * @brief 서버 실행 설정 구조체
+ *
+ * 시작 시 명령행 옵션으로 채워집니다.
  */
-typedef struct SmartPtr {
-    void *ptr;                   /**< 포인터가 가리키는 실제 데이터 */
-    int *ref_count;              /**< 참조 카운트 */
-    pthread_mutex_t *mutex;      /**< 멀티스레드 환경에서 참조 카운트를 보호하는 뮤텍스 */
-} SmartPtr;
+typedef struct {
+    IoMode io_mode;      /**< I/O 처리 방식 */
+    int event_loops;     /**< epoll/room 모드의 이벤트 루프(워커) 스레드 수, thread 모드의 워커 풀 크기 (0이면 CPU 수) */
+    int shards;          /**< 포트마다 SO_REUSEPORT 로 여는 리스닝 소켓(샤드) 수 */
+    int outbox_limit;    /**< 클라이언트 송신 대기열 상한 (메시지 수) */
+    SlowPolicy slow_policy; /**< 상한 도달 시 처리 정책 */
+    ChatLogSync log_sync;   /**< 채팅 로그 fsync 정책 */
+    int room_idle_grace;    /**< 마지막 멤버가 나간 채팅방을 회수하기까지 유예 시간 (초) */
+    int worker_stack_kb;    /**< thread 모드 워커 스레드 스택 크기 (KB) */
+    int pin_workers;        /**< thread 모드 워커를 CPU 하나씩에 고정할지 여부 */
+    char user_data_path[USER_STORE_PATH_MAX]; /**< 사용자 데이터베이스 파일 (데몬화로 작업 디렉터리가 바뀌므로 절대 경로) */
+} ServerConfig;
+
+ServerConfig server_config = { IO_MODE_EPOLL, 0, 1, OUTBOX_LIMIT, SLOW_POLICY_DROP_OLDEST, { CHATLOG_SYNC_NONE, 0 },
+                               ROOM_IDLE_GRACE_MS / 1000, THREAD_POOL_DEFAULT_STACK / 1024, 0, "" };
 
 /**
- * @brief 스마트 포인터를 생성하는 함수
- * 
- * 동적 메모리를 할당받고 참조 카운트를 초기화하며 뮤텍스를 생성합니다.
- * 
- * @param ptr 스마트 포인터가 관리할 동적 메모리의 포인터
- * @return SmartPtr 새롭게 생성된 스마트 포인터 구조체
+ * @brief 방 소유 워커 방식(room 모드)인지 확인하는 함수
+ *
+ * room 모드에서는 연결마다 그 연결을 소유한 워커만 송신 대기열을 건드리고, 다른 스레드는 소유 워커의
+ * 우편함으로 작업을 넘깁니다.
+ *
+ * @return int room 모드이면 1
  */
-SmartPtr create_smart_ptr(void *ptr);
+static inline int room_affinity(void) {
+    return server_config.io_mode == IO_MODE_ROOM;
+}
+
+ChatLog chat_log;  /**< 비동기 채팅 로그 (writer 스레드가 기록) */
+LogIndex log_index;  /**< 채팅 로그 검색 색인 (로그 writer 가 기록할 때마다 갱신) */
 
 /**
- * @brief 스마트 포인터의 참조를 증가시키는 함수
- * 
- * @param sp 참조를 증가시킬 스마트 포인터의 포인터
+ * @brief 리스닝 샤드 구조체
+ *
+ * 샤드마다 SO_REUSEPORT 리스닝 소켓을 따로 가지며, 커널이 새 연결을 샤드들에 분산합니다.
+ * 각 샤드는 자신이 수락한 연결을 소유합니다.
  */
-void retain(SmartPtr *sp);
+typedef struct {
+    int index;               /**< 샤드 번호 */
+    int port;                /**< 리스닝 포트 */
+    int listen_fd;           /**< 샤드 전용 리스닝 소켓 */
+    pthread_t tid;           /**< 디스패처 스레드 (thread 모드) */
+    int epoll_fd;            /**< 리스닝 소켓과 이 샤드가 수락한 연결을 감시하는 epoll (thread 모드) */
+    atomic_int connections;  /**< 현재 연결 수 */
+    atomic_long accepted;    /**< 누적 수락 수 */
+} Shard;
+
+Shard *shards = NULL;   /**< 리스닝 샤드 배열 */
+int num_shards = 0;     /**< 리스닝 샤드 수 */
+ThreadPool client_workers;  /**< 준비된 연결을 처리하는 워커 풀 (thread 모드) */
+
 
 /**
- * @brief 스마트 포인터의 참조를 해제하고, 마지막 참조 해제 시 메모리를 반환하는 함수
- * 
- * @param sp 참조를 해제할 스마트 포인터의 포인터
+ * @brief 자동 데몬화 모드 함수
+ * @param void
+ * @return void
  */
-void release(SmartPtr *sp);
+void auto_daemon_mode();
+void manual_server_mode();
 
 /**
  * @brief 고유 포인터 구조체
@@ -77,38 +160,272 @@ void list_users();
 void kill_user(const char *username);
 
 /**
- * @brief 클라이언트를 강제로 퇴장시키는 함수
+ * @brief 채팅방의 모든 클라이언트를 강제로 퇴장시키는 함수
  * 
- * @param username 퇴장시킬 클라이언트의 사용자명
+ * @param name 닫을 채팅방 이름 (숫자 방은 번호)
  */
-void kill_room(int room_id);
+void kill_room(const char *name);
 
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
- * 
- * @note 최대 MAX_CLIENTS 개의 클라이언트를 관리합니다.
+ * @brief 클라이언트를 강제로 퇴장시키는 함수
+ *
+ * @param username 퇴장시킬 클라이언트의 사용자명
  */
 void kick_user(const char *username);
 
+/**
+ * @brief 클라이언트 핸드셰이크 진행 상태
+ *
+ * AUTH 프레임으로 로그인(비밀번호 또는 세션 토큰)에 성공하면 HELLO 대기 상태가 되고,
+ * 채팅방 번호를 담은 HELLO 프레임 하나를 받으면 채팅 상태가 됩니다.
+ */
+typedef enum {
+    CLIENT_STATE_AUTH = 0,       /**< 로그인 대기 (가입/삭제 요청도 이 상태에서 처리) */
+    CLIENT_STATE_HELLO,          /**< HELLO 프레임 수신 대기 */
+    CLIENT_STATE_CHAT            /**< 채팅 메시지 처리 중 */
+} ClientState;
+
+/**
+ * @brief 클라이언트별 송신 대기열
+ *
+ * 공유 메시지(Message)의 참조를 원형 배열에 담으며, 상한까지 필요한 만큼만 늘어납니다.
+ * client_mutex 로 보호합니다. io_uring 백엔드에서는 count 만 사용합니다 (uring 잠금으로 보호).
+ */
+typedef struct {
+    SmartPtr *items;       /**< 메시지 참조 원형 배열 */
+    uint32_t head;         /**< 가장 오래된 메시지 위치 */
+    uint32_t count;        /**< 대기 중인 메시지 수 */
+    uint32_t capacity;     /**< 배열 용량 */
+    uint32_t head_offset;  /**< head 메시지 중 이미 전송한 바이트 수 (프레임은 FRAME_MAX_PAYLOAD 이하) */
+} Outbox;
+
 /**
  * @brief 클라이언트 정보를 담는 구조체
  * 
  * 각 클라이언트의 소켓 FD, ID, 채팅방 ID, 사용자명을 포함하고 있으며, 뮤텍스를 관리합니다.
+ * 연결 테이블 슬롯의 SharedPtr 가 소유하며, 마지막 참조가 반납되면 client_info_destroy() 가 해제를
+ * client_epoch 유예 기간 뒤로 미룹니다. 그래서 팬아웃/관리자 명령은 읽기 구역 안에서 연결 테이블이나
+ * 방 멤버 목록에서 읽은 포인터를 참조 카운트 없이 바로 씁니다.
+ *
+ * 팬아웃이 수신자마다 건드리는 필드는 첫 캐시 라인에 모으고, 접속/입장/통계에만 쓰는 필드는 그 뒤에 둡니다.
+ * 사용자명은 usernames 인터닝 테이블의 핸들로만 가지고 있습니다.
  */
 typedef struct {
+    // 핫 필드 (팬아웃 경로, 한 캐시 라인)
+    _Alignas(CACHE_LINE_SIZE) WeakPtr self; /**< 자기 자신에 대한 약한 참조 (방 멤버 포인터에서 SharedPtr 를 얻을 때 사용) */
+    pthread_mutex_t *client_mutex; /**< 클라이언트 별 뮤텍스 (전송 직렬화) */
+    ConnHandle handle;           /**< 연결 테이블 핸들 (epoll/io_uring 이벤트 식별에 사용) */
+    Outbox outbox;               /**< 송신 대기열 */
     int client_fd;               /**< 클라이언트의 소켓 파일 디스크립터 */
+    ClientState state;           /**< 핸드셰이크 진행 상태 */
+
+    // 콜드 필드
+    struct UringSend *send_head; /**< io_uring 전송 대기열 head (항상 커널에 제출된 상태) */
+    struct UringSend *send_tail; /**< io_uring 전송 대기열 tail */
+    Room *room;                  /**< 참여한 채팅방 (입장 전에는 NULL) */
+    uint32_t room_index;         /**< 채팅방 멤버 배열 안의 위치 */
+    char room_name[ROOM_NAME_MAX]; /**< HELLO 로 고른 채팅방 이름 (숫자 방은 "7" 처럼 10진수) */
     int client_id;               /**< 클라이언트 ID */
-    int room_id;                 /**< 클라이언트가 참여한 채팅방 ID */
-    char username[BUFFER_SIZE];  /**< 클라이언트 사용자명 */
-    pthread_mutex_t *client_mutex; /**< 클라이언트 별 뮤텍스 */
+    int shard_id;                /**< 연결을 수락한 샤드 번호 */
+    int loop_index;              /**< 연결을 소유한 이벤트 루프 (room 모드에서는 입장할 때 방 소유 워커로 바뀜, 그 밖에는 -1) */
+    InternId username;           /**< 로그인한 사용자명 (usernames 핸들, 로그인 전에는 INTERN_NONE) */
+    int auth_failures;           /**< 로그인 실패 횟수 (AUTH_MAX_FAILURES 에 이르면 연결 종료) */
+    long presence_slot;          /**< 접속 현황 테이블 칸 (등록하지 않았으면 -1) */
+    long dropped;                /**< 느린 클라이언트 정책에 따라 버린 메시지 수 */
+    atomic_int closing;          /**< 강제 퇴장 중 (수신 프레임은 버리고, 송신 대기열이 비거나 기한이 지나면 끊음) */
+    _Atomic uint32_t pool_events; /**< 디스패처가 알렸지만 워커가 아직 처리하지 않은 이벤트 수 (thread 모드) */
+    FrameReader rx;              /**< 수신 프레임 재조립 버퍼 */
 } ClientInfo;
 
+_Static_assert(offsetof(ClientInfo, send_head) == CACHE_LINE_SIZE, "ClientInfo 핫 필드는 한 캐시 라인에 들어가야 합니다");
+_Static_assert(HELLO_ROOM_NAME_MAX < ROOM_NAME_MAX && HELLO_ROOM_ID_MAX <= ROOM_ID_NUMERIC_MAX,
+               "HELLO 로 고를 수 있는 방은 방 레지스트리가 담을 수 있어야 합니다");
+
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
- * 
- * @note 최대 MAX_CLIENTS 개의 클라이언트를 관리합니다.
+ * @brief 한 번만 직렬화되어 모든 수신자가 공유하는 메시지
+ *
+ * SmartPtr 제어 블록, 헤더, 프레임을 한 번에 할당하며, 참조 카운트로 마지막 수신자의 전송이 끝날 때 해제됩니다.
+ */
+typedef struct {
+    size_t len;          /**< 프레임 전체 길이 (프레임 헤더 포함, NUL 제외) */
+    char data[];         /**< 직렬화된 프레임 (프레임 헤더 + payload, NUL 종료) */
+} Message;
+
+/**
+ * @brief 메시지 프레임의 payload (NUL 종료 문자열)
+ */
+static inline char *message_payload(Message *message) {
+    return message->data + FRAME_HEADER_SIZE;
+}
+
+/**
+ * @brief 팬아웃 통계 (관리자 'stats' 명령으로 출력)
+ */
+typedef struct {
+    atomic_long messages;          /**< 생성(직렬화)한 메시지 수 */
+    atomic_long bytes_serialized;  /**< 직렬화한 바이트 수 */
+    atomic_long deliveries;        /**< 수신자별 전달 요청 수 */
+    atomic_long bytes_sent;        /**< 소켓으로 실제 전송한 바이트 수 */
+} FanoutStats;
+
+FanoutStats fanout_stats;
+
+/**
+ * @brief 여러 수신자에게 같은 메시지를 보내는 팬아웃 묶음
+ *
+ * 모든 수신자가 같은 Message 를 참조로 공유합니다. io_uring 백엔드에서는
+ * fanout_end() 에서 한 번의 io_uring_enter 로 제출합니다.
+ */
+typedef struct {
+    SmartPtr message;    /**< 공유 메시지 (Message) */
+    int use_uring;       /**< io_uring 백엔드 사용 여부 */
+    int kick;            /**< 퇴장 알림 여부 (대기열 상한을 넘겨서라도 넣고, 그 뒤로는 아무것도 넣지 않음) */
+} FanoutBatch;
+
+/**
+ * @brief room 모드에서 다른 스레드가 워커에게 넘기는 작업 종류
+ */
+typedef enum {
+    MAIL_ADOPT = 0,      /**< 핸드셰이크를 마친 연결을 넘겨받아 방에 입장시킴 */
+    MAIL_DELIVER,        /**< 소유한 연결 하나에 메시지 전달 (다른 방에서 온 귓속말 등) */
+    MAIL_ANNOUNCE,       /**< 소유한 모든 방의 멤버에게 메시지 전달 (서버 공지) */
+    MAIL_KICK,           /**< 소유한 연결에 알림을 보내고, 송신 대기열이 비면 연결을 끊음 */
+    MAIL_KILL_ROOM       /**< 소유한 방의 모든 멤버에게 알림을 보내고, 각자 송신 대기열이 비면 연결을 끊음 */
+} MailType;
+
+/**
+ * @brief 워커 우편함에 들어가는 작업 하나
+ */
+typedef struct {
+    MailType type;       /**< 작업 종류 */
+    ConnHandle handle;   /**< 대상 연결 (ADOPT/DELIVER/KICK) */
+    int room_id;         /**< 대상 방 (KILL_ROOM) */
+    SmartPtr message;    /**< 보낼 메시지 (ADOPT 는 없음) */
+} Mail;
+
+/**
+ * @brief 우편함 큐가 가득 찼을 때 쓰는 넘침 목록 항목
+ */
+typedef struct MailOverflow {
+    struct MailOverflow *next;  /**< 다음 항목 */
+    Mail mail;                  /**< 작업 */
+} MailOverflow;
+
+/**
+ * @brief 워커 우편함
+ *
+ * 여러 스레드가 lock-free MPSC 큐에 값으로 넣고 소유 워커 하나가 묶음으로 꺼냅니다. 워커가 eventfd 를
+ * 비운 뒤 처음 넣는 스레드만 eventfd 로 워커의 epoll_wait 를 깨웁니다.
+ *
+ * 큐가 가득 차면 우편을 버리지 않고 뮤텍스로 보호하는 넘침 목록에 이어 붙입니다. 넘침 목록을 쓰는 동안에는
+ * 모든 우편이 목록으로 가고, 워커는 목록보다 먼저 큐를 비우므로 보낸 스레드별 순서가 유지됩니다.
+ */
+typedef struct {
+    MpscQueue queue;              /**< Mail 큐 */
+    pthread_mutex_t lock;         /**< 넘침 목록 보호 */
+    MailOverflow *overflow_head;  /**< 넘침 목록의 가장 먼저 넣은 작업 */
+    MailOverflow *overflow_tail;  /**< 넘침 목록의 마지막에 넣은 작업 */
+    _Atomic int overflowing;      /**< 넘침 목록을 쓰는 중이면 1 (워커가 목록을 다 비우면 0) */
+    _Atomic int signaled;         /**< eventfd 에 깨우기를 써 두었고 워커가 아직 비우지 않았으면 1 */
+    atomic_long overflowed;       /**< 넘침 목록으로 간 우편 수 */
+    int event_fd;                 /**< 워커를 깨우는 eventfd */
+} Mailbox;
+
+/**
+ * @brief epoll 이벤트 루프 구조체
+ *
+ * 각 루프는 자신의 epoll 인스턴스를 가지며, 수락한 연결을 끝까지 소유합니다.
+ * room 모드에서는 루프가 방 소유 워커가 되어, 자기 방으로 넘겨받은 연결을 소유합니다.
+ */
+typedef struct {
+    int index;           /**< 루프 번호 */
+    int epoll_fd;        /**< epoll 인스턴스 FD */
+    int cpu;             /**< 고정한 CPU (room 모드, 그 밖에는 -1) */
+    pthread_t tid;       /**< 루프 스레드 ID */
+    Mailbox mailbox;     /**< 다른 스레드가 넘긴 작업 (room 모드) */
+    FanoutStats stats;   /**< 워커가 혼자 기록하는 팬아웃 통계 (room 모드) */
+    atomic_long mails;   /**< 처리한 우편 수 (워커만 기록) */
+} EventLoop;
+
+EventLoop *event_loops = NULL;  /**< 이벤트 루프 배열 (epoll/room 모드, 우편을 보낼 워커를 찾을 때 사용) */
+int num_event_loops = 0;        /**< 이벤트 루프 수 */
+static __thread EventLoop *current_loop;    /**< 현재 스레드가 실행 중인 이벤트 루프 (루프 스레드가 아니면 NULL) */
+static __thread FanoutStats *worker_stats;  /**< room 워커 스레드의 통계 (그 밖의 스레드는 NULL, 전역 통계에 기록) */
+
+/**
+ * @brief 팬아웃 통계 항목을 늘리는 매크로
+ *
+ * room 워커는 자기 통계를 혼자 기록하므로 원자적 덧셈(잠금 접두어) 없이 읽고 저장합니다.
+ */
+#define FANOUT_COUNT(field, n) do {                                                                   \
+    if (worker_stats != NULL) {                                                                     \
+        atomic_store_explicit(&worker_stats->field,                                                 \
+                              atomic_load_explicit(&worker_stats->field, memory_order_relaxed) + (n), \
+                              memory_order_relaxed);                                                \
+    } else {                                                                                        \
+        atomic_fetch_add(&fanout_stats.field, (n));                                                 \
+    }                                                                                               \
+} while (0)
+
+/**
+ * @brief 접속 중인 클라이언트의 스마트 포인터를 담는 연결 테이블
+ *
+ * 슬롯 주소는 연결이 닫힐 때까지 유지되며, 핸들의 세대 값으로 재사용된 슬롯을 구분합니다.
+ */
+ConnTable client_table;
+
+/**
+ * @brief 채팅방 ID 로 방과 멤버 목록을 찾는 방 레지스트리
  */
-SmartPtr client_infos[MAX_CLIENTS];
+RoomRegistry room_registry;
+
+/**
+ * @brief 연결 테이블/방 멤버 목록을 잠금 없이 읽는 쪽을 위한 회수 도메인
+ *
+ * 떠난 클라이언트 정보와 교체된 멤버 목록은 진행 중인 읽기 구역이 모두 끝난 뒤에 해제됩니다.
+ */
+EpochDomain client_epoch;
+
+ObjectPool client_pool;   /**< ClientInfo 풀 */
+ObjectPool mutex_pool;    /**< 클라이언트 뮤텍스 풀 (한 번 초기화한 뮤텍스를 재사용) */
+ObjectPool message_pool;  /**< 짧은 메시지 프레임 풀 (SmartPtr 제어 블록 포함) */
+InternTable usernames;    /**< 사용자명 인터닝 테이블 (같은 이름은 한 번만 저장) */
+UserMap user_map;         /**< 접속 중인 사용자명 -> 연결 핸들 (중복 로그인 거부, 귓속말, 강제 퇴장) */
+PresenceTable presence;   /**< 호스트 전체 접속 현황 (공유 메모리, 다른 서버 프로세스/클라이언트와 공유) */
+UserDB user_db;           /**< 가입한 사용자 (로그인 확인은 서버만 함) */
+UserStore user_store;     /**< user_db 의 스냅샷 + 저널 저장소 */
+SessionTable sessions;    /**< 로그인에 성공한 연결에 발급한 세션 토큰 (재접속 시 비밀번호 확인 생략) */
+
+/**
+ * @brief 송신 대기열을 비우기를 기다리는 강제 퇴장 연결 하나
+ */
+typedef struct {
+    ConnHandle handle;      /**< 퇴장시킨 연결 */
+    int64_t deadline_ms;    /**< 이 시각까지 대기열을 비우지 못하면 끊음 (CLOCK_MONOTONIC) */
+} KickDeadline;
+
+/**
+ * @brief 강제 퇴장 기한 목록
+ *
+ * 읽지 않는 클라이언트는 송신 대기열이 영영 비지 않으므로, 회수 스레드가 기한이 지난 연결을 직접 끊습니다.
+ */
+typedef struct {
+    pthread_mutex_t lock;   /**< 목록 보호 */
+    KickDeadline *items;    /**< 기한 배열 (순서 없음) */
+    uint32_t count;         /**< 항목 수 */
+    uint32_t capacity;      /**< 배열 용량 */
+} KickReaper;
+
+KickReaper kick_reaper = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/**
+ * @brief 클라이언트 사용자명 (HELLO 전에는 빈 문자열)
+ * @param client_info 클라이언트 정보 (호출자가 참조를 가지고 있어야 함)
+ * @return const char* 사용자명
+ */
+static inline const char *client_username(const ClientInfo *client_info) {
+    return intern_str(&usernames, client_info->username);
+}
 
 /**
  * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
@@ -129,34 +446,49 @@ int create_network_tcp_process(int num_tcp_proc, ...);
 /**
  * @brief 특정 채팅방에 있는 모든 클라이언트에게 메시지를 브로드캐스트하는 함수
  * 
- * @param sender_fd 메시지를 보낸 클라이언트의 파일 디스크립터
- * @param message 브로드캐스트할 메시지
- * @param room_id 메시지를 보낼 채팅방의 ID
+ * @param sender 메시지를 보낸 클라이언트
+ * @param message 브로드캐스트할 메시지 (NUL 로 끝나지 않아도 됨)
+ * @param len 메시지 길이
  */
-void broadcast_message(int sender_fd, char *message, int room_id);
+void broadcast_message(ClientInfo *sender, const char *message, size_t len);
 
 /**
  * @brief 서버 측에서 발생한 채팅 메시지를 로그로 저장하는 함수
  * 
+ * 로그 큐에 넣기만 하고 바로 반환하며, 파일 기록은 로그 writer 스레드가 묶어서 처리합니다.
+ * 
  * @param message 저장할 메시지
  */
 void log_chat_message(const char *message);
 
 /**
- * @brief 클라이언트와의 통신을 처리하는 스레드 함수
- * 
- * @param arg 클라이언트 정보를 담고 있는 스마트 포인터 구조체의 포인터
- * @return void* 스레드 종료 시 반환값 (NULL)
+ * @brief 채팅 로그 지표를 출력하는 함수
  */
-void *client_handler(void *arg);
+void print_log_stats(void);
 
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
+ * @brief 객체 풀 적중/실패 지표를 출력하는 함수
+ */
+void print_pool_stats(void);
+
+/**
+ * @brief 준비된 연결 하나를 처리하는 워커 풀 작업 (thread 모드)
  * 
- * @param client_infos 클라이언트 정보를 담는 스마트 포인터 배열
- * @return void
+ * @param arg 연결 테이블 핸들 (ConnHandle 을 포인터로 바꾼 값)
+ */
+void client_service(void *arg);
+
+/**
+ * @brief 워커 풀의 워커별 사용률과 큐 길이를 출력하는 함수 (thread 모드)
+ */
+void print_worker_stats(void);
+
+/**
+ * @brief 클라이언트 연결을 강제로 끊는 함수
+ *
+ * @param client_info 끊을 클라이언트
  */
-void release_client(int sock);
+void release_client(ClientInfo *client_info);
 
 /**
  * @brief 서버 측에서 사용자 입력을 처리하는 스레드 함수
@@ -170,6 +502,8 @@ void *server_input_handler(void *arg);
 /**
  * @brief 서버 메시지를 브로드캐스트하는 함수
  * 
+ * 모든 모드에서 채팅방에 입장한 클라이언트만 받습니다 (로그인/입장 전인 연결은 받지 않음).
+ *
  * @param message 서버에서 브로드캐스트할 메시지
  * @return void
  */
@@ -181,411 +515,2837 @@ void send_server_message(char *message);
  * @param username 퇴장시킬 클라이언트의 사용자명
  * @return void
  */
-void kill_user(const char *username);
+void kill_user(const char *username);
+
+/**
+ * @brief 새로 수락한 소켓에 대한 클라이언트 정보를 생성하고 등록하는 함수
+ *
+ * @param csock 수락한 클라이언트 소켓
+ * @param cliaddr 클라이언트 주소
+ * @param shard 연결을 수락한 샤드
+ * @return SharedPtr* 연결 테이블에 등록된 공유 포인터 슬롯, 실패 시 NULL (소켓은 닫힘)
+ */
+SharedPtr *register_client(int csock, struct sockaddr_in *cliaddr, Shard *shard);
+
+/**
+ * @brief 수신 버퍼에 쌓인 완성된 프레임을 모두 처리하는 함수
+ *
+ * 모든 I/O 방식이 같은 프로토콜 처리 로직을 공유합니다. 마지막에 남은 불완전한 프레임은
+ * 다음 수신 데이터와 이어 붙여 처리합니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @return int 성공 시 0, room 모드에서 방 소유 워커로 넘겨야 하면 1, 프로토콜 오류 시 -1 (호출자가 연결을 닫음)
+ */
+int process_client_frames(ClientInfo *client_info);
+
+/**
+ * @brief 논블로킹 소켓을 EAGAIN 까지 수신 버퍼로 직접 읽어 프레임을 처리하는 함수
+ *
+ * 스레드 방식과 epoll 방식이 같은 수신 로직을 공유합니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @return int 계속 읽을 수 있으면 1, room 모드에서 방 소유 워커로 넘겨야 하면 2, EOF 이면 0, 오류/프로토콜 위반이면 -1
+ */
+int client_read_frames(ClientInfo *client_info);
+
+/**
+ * @brief 클라이언트 연결을 닫고 연결 테이블에서 제거한 뒤 테이블의 참조를 반납하는 함수
+ *
+ * 연결을 소유한 스레드(클라이언트 스레드 또는 이벤트 루프)만 호출합니다. 팬아웃 중인 스레드가
+ * 아직 참조를 들고 있으면 소켓과 송신 대기열은 그 참조가 반납될 때 정리됩니다.
+ *
+ * @param sp 클라이언트 공유 포인터 슬롯
+ */
+void close_client(SharedPtr *sp);
+
+/**
+ * @brief 클라이언트에게 프레임 하나를 보내는 함수
+ *
+ * 데이터를 송신 대기열에 넣고 소켓이 받아 주는 만큼 바로 전송하며, 절대 블로킹하지 않습니다.
+ * 남은 데이터는 연결을 소유한 스레드가 소켓이 쓰기 가능해질 때 client_flush() 로 보냅니다.
+ *
+ * @param client_info 수신 클라이언트
+ * @param type 프레임 종류
+ * @param data 전송할 데이터
+ * @param len 데이터 길이
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+int send_to_client(ClientInfo *client_info, uint8_t type, const char *data, size_t len);
+
+/**
+ * @brief 연결 핸들로 클라이언트의 강한 참조를 얻는 함수
+ *
+ * @param handle 연결 핸들
+ * @param out 얻은 참조 (사용 후 release_shared_ptr() 로 반납)
+ * @return int 성공 시 0, 이미 종료된 연결이면 -1
+ */
+int client_acquire(ConnHandle handle, SharedPtr *out);
+
+/**
+ * @brief 귓속말(/w <사용자> <메시지>)을 대상 사용자 한 명에게만 전달하는 함수
+ *
+ * 사용자명 맵에서 대상 연결을 O(1) 로 찾으며, 대상이 없거나 형식이 잘못되면 보낸 사람에게 알립니다.
+ *
+ * @param sender 보낸 클라이언트
+ * @param args "/w " 뒤의 "<사용자> <메시지>" (NUL 로 끝나지 않아도 됨)
+ * @param len args 길이
+ */
+void whisper_message(ClientInfo *sender, const char *args, size_t len);
+
+/**
+ * @brief 공유 메시지를 클라이언트 송신 대기열에 넣고 가능한 만큼 전송하는 함수
+ *
+ * @param client_info 수신 클라이언트
+ * @param message 전송할 메시지 (대기열이 참조를 하나 늘려 보관)
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+int client_send(ClientInfo *client_info, SmartPtr message);
+
+/**
+ * @brief 송신 대기열을 소켓이 받아 주는 만큼 전송하는 함수
+ *
+ * @param client_info 대상 클라이언트
+ * @return int 대기열이 비었으면 0, 남았으면 1, 소켓 오류면 -1
+ */
+int client_flush(ClientInfo *client_info);
+
+/**
+ * @brief epoll 이벤트 루프들을 시작하고 종료될 때까지 대기하는 함수
+ *
+ * 샤드가 하나면 모든 루프가 그 리스닝 소켓을 EPOLLEXCLUSIVE 로 공유하고,
+ * 샤드가 여러 개면 샤드마다 전용 루프 하나가 자신의 리스닝 소켓만 감시합니다.
+ *
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int run_event_loops(void);
+
+/**
+ * @brief io_uring 백엔드를 실행하는 함수
+ *
+ * 빌드에서 제외되었거나 커널이 필요한 연산을 지원하지 않으면 epoll 이벤트 루프로 대체합니다.
+ *
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int run_uring_backend(void);
+
+/**
+ * @brief 워커 풀과 샤드마다 디스패처 스레드를 띄워 연결을 처리하는 함수 (thread 모드)
+ *
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int run_accept_threads(void);
+
+/**
+ * @brief 리스닝 소켓을 생성하는 함수
+ *
+ * @param port 리스닝 포트
+ * @param reuseport SO_REUSEPORT 사용 여부 (샤딩 시 1)
+ * @return int 리스닝 소켓, 실패 시 -1
+ */
+int open_listen_socket(int port, int reuseport);
+
+/**
+ * @brief printf 형식으로 메시지 프레임을 한 번 직렬화해 생성하는 함수
+ *
+ * @param type 프레임 종류
+ * @param fmt 형식 문자열
+ * @param ... 형식 인자
+ * @return SmartPtr Message 를 가리키는 스마트 포인터
+ */
+SmartPtr message_create(uint8_t type, const char *fmt, ...);
+
+/**
+ * @brief 바이트열을 payload 로 복사해 메시지 프레임을 생성하는 함수
+ *
+ * @param type 프레임 종류
+ * @param data 본문
+ * @param len 본문 길이
+ * @return SmartPtr Message 를 가리키는 스마트 포인터
+ */
+SmartPtr message_from(uint8_t type, const char *data, size_t len);
+
+/**
+ * @brief 팬아웃 통계를 출력하는 함수
+ */
+void print_fanout_stats(void);
+
+/**
+ * @brief 팬아웃 묶음을 시작하는 함수
+ *
+ * @param batch 초기화할 묶음
+ * @param message 전송할 메시지 (참조 하나를 묶음이 넘겨받아 fanout_end() 에서 반납)
+ */
+void fanout_begin(FanoutBatch *batch, SmartPtr message);
+
+/**
+ * @brief 팬아웃 묶음에 수신자를 추가하는 함수
+ *
+ * @param batch 팬아웃 묶음
+ * @param client_info 수신 클라이언트
+ */
+void fanout_add(FanoutBatch *batch, ClientInfo *client_info);
+
+/**
+ * @brief 팬아웃 묶음을 제출하고 정리하는 함수
+ *
+ * @param batch 팬아웃 묶음
+ */
+void fanout_end(FanoutBatch *batch);
+
+/**
+ * @brief 채팅방을 소유하는 워커 번호를 구하는 함수 (room 모드)
+ *
+ * @param name_hash 채팅방 이름 해시 (room_name_hash())
+ * @return int 워커(이벤트 루프) 번호
+ */
+int room_worker_of(uint32_t name_hash);
+
+/**
+ * @brief 워커 우편함에 작업을 넣는 함수 (room 모드, 어느 스레드에서나 호출 가능)
+ *
+ * @param loop 작업을 처리할 워커
+ * @param type 작업 종류
+ * @param handle 대상 연결
+ * @param room_id 대상 방
+ * @param message 보낼 메시지 (참조 하나를 넘겨받음)
+ */
+void mailbox_post(EventLoop *loop, MailType type, ConnHandle handle, int room_id, SmartPtr message);
+
+/**
+ * @brief 서버 관리자용 고정 메뉴 출력 함수
+ */
+void print_fixed_menu() {
+    // ANSI 색상 코드
+    const char *color_reset = "\033[0m";
+    const char *color_red = "\033[1;31m";
+    const char *color_green = "\033[1;32m";
+    const char *color_blue = "\033[1;34m";
+    const char *color_cyan = "\033[1;36m";
+
+    // 메뉴 출력
+    printf("\n%s================= 서버 관리자 메뉴 =================%s\n", color_blue, color_reset);
+    printf("%s|%s 1. %s'list'%s : 현재 접속한 유저와 채팅방 상태 출력     %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s|%s 2. %s'kill <user> (구현 예정)'%s : 특정 유저 강제 퇴장 (구현 예정)              %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s|%s 3. %s'kill room <num> (구현 예정)'%s : 특정 채팅방 강제 종료 (구현 예정)          %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s|%s 4. %s'grep -r \"<message>\"'%s : 채팅 로그에서 메시지 검색  %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s|%s 5. %s'stats'%s : 메시지 직렬화/전송 바이트 통계 출력        %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s|%s 6. %s'exit'%s : 서버 종료                                 %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
+    printf("%s=====================================================%s\n\n", color_blue, color_reset);
+}
+
+/**
+ * @brief 클라이언트를 강제로 퇴장시키는 함수
+ * @param username 퇴장시킬 클라이언트의 사용자명
+ * @return void
+ */
+void list_users() {
+    printf("현재 접속 중인 유저 목록:\n");
+    // 잠금 없이 순회 (읽기 구역이 끝날 때까지 그 사이 끊긴 클라이언트의 정보도 해제되지 않음)
+    uint32_t online = 0;
+    uint32_t cursor = 0;
+    SharedPtr sp;
+    epoch_enter(&client_epoch);
+    while (conn_table_next(&client_table, &cursor, &sp)) {
+        ClientInfo *client_info = (ClientInfo *)sp.ptr;
+        printf("User: %s, Room: %s, 대기열: %u, 버림: %ld\n", client_username(client_info),
+               client_info->room_name[0] != '\0' ? client_info->room_name : "-",
+               client_info->outbox.count, client_info->dropped);
+        online++;
+    }
+    epoch_exit(&client_epoch);
+    printf("총 접속자: %u명 (로그인 %u명, 세션 %u개)\n", online, user_map_count(&user_map), session_count(&sessions));
+
+    // 방마다 지표를 원자 변수로 유지하므로 멤버 목록을 읽지 않고, 방이 수만 개여도 출력은 바쁜 방
+    // ROOM_LIST_TOP 개로 제한 (삽입 정렬로 상위만 유지)
+    Room *top[ROOM_LIST_TOP];
+    RoomStats top_stats[ROOM_LIST_TOP];
+    RoomStats stats;
+    int shown = 0;
+    uint32_t occupied = 0;
+    double total_rate = 0;
+    int64_t now = room_now_ms();
+    room_registry_rdlock(&room_registry);
+    uint32_t room_count = room_registry.room_count;
+    for (uint32_t i = 0; i < room_count; i++) {
+        room_get_stats(room_registry.rooms[i], &stats, now);
+        occupied += stats.members > 0;
+        total_rate += stats.rate;
+        int pos = shown < ROOM_LIST_TOP ? shown++ : ROOM_LIST_TOP;
+        while (pos > 0 && (top_stats[pos - 1].rate < stats.rate ||
+                           (top_stats[pos - 1].rate == stats.rate && top_stats[pos - 1].members < stats.members))) {
+            if (pos < ROOM_LIST_TOP) {
+                top[pos] = top[pos - 1];
+                top_stats[pos] = top_stats[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < ROOM_LIST_TOP) {
+            top[pos] = room_registry.rooms[i];
+            top_stats[pos] = stats;
+        }
+    }
+    for (int i = 0; i < shown; i++) {
+        printf("Room %s (ID %d): %u명, 메시지 %.1f/초 (누적 %ld), 마지막 활동 %.0f초 전", top[i]->name, top[i]->room_id,
+               top_stats[i].members, top_stats[i].rate, top_stats[i].messages, top_stats[i].idle_ms / 1000.0);
+        if (room_affinity()) {
+            printf(" (워커 %d)", room_worker_of(top[i]->name_hash));
+        }
+        printf("\n");
+    }
+    room_registry_unlock(&room_registry);
+    printf("채팅방 %u개 (사람 있는 방 %u개, 표시 %d개), 초당 메시지 %.1f, 누적 생성 %ld개, 회수 %ld개\n", room_count,
+           occupied, shown, total_rate, atomic_load(&room_registry.created), atomic_load(&room_registry.reclaimed));
+
+    for (int i = 0; i < num_shards; i++) {
+        printf("Shard %d (port %d): %d명 접속 중, 누적 %ld명\n", shards[i].index, shards[i].port,
+               atomic_load(&shards[i].connections), atomic_load(&shards[i].accepted));
+    }
+}
+
+/**
+ * @brief 클라이언트를 강제로 퇴장시키는 함수
+ * @param username 퇴장시킬 클라이언트의 사용자명
+ * @return void
+ */
+void kill_room(const char *name) {
+    const char *notice = "The room has been closed. You have been kicked out.";
+    FanoutBatch batch;
+
+    // 찾은 방은 읽기 구역이 끝날 때까지 회수되지 않음
+    epoch_enter(&client_epoch);
+    Room *room = room_registry_find_name(&room_registry, name, strlen(name));
+    if (room == NULL) {
+        epoch_exit(&client_epoch);
+        printf("Room %s does not exist.\n", name);
+        return;
+    }
+    if (room_affinity()) {
+        int worker = room_worker_of(room->name_hash);
+        mailbox_post(&event_loops[worker], MAIL_KILL_ROOM, CONN_HANDLE_INVALID, room->room_id,
+                     message_from(FRAME_NOTICE, notice, strlen(notice)));
+        epoch_exit(&client_epoch);
+        printf("Room %s will be closed by worker %d.\n", name, worker);
+        return;
+    }
+
+    // 링 잠금을 먼저 잡아야 close_client() 가 이미 정리한 연결에 전송 요청을 남기지 않음
+    fanout_begin(&batch, message_from(FRAME_NOTICE, notice, strlen(notice)));
+    batch.kick = 1;
+    RoomMembers *members = room_members(room);
+    uint32_t count = room_members_count(members);
+    for (uint32_t i = 0; i < count; i++) {
+        ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+        if (client_info != NULL) {
+            fanout_add(&batch, client_info);
+        }
+    }
+    fanout_end(&batch);
+
+    // 알림 전송을 모두 제출한 뒤에 끊음 (각 연결은 알림을 보낸 다음 shutdown 됨)
+    for (uint32_t i = 0; i < count; i++) {
+        ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+        if (client_info != NULL) {
+            release_client(client_info);
+        }
+    }
+    epoch_exit(&client_epoch);
+    printf("Room %s has been closed, and all users have been kicked.\n", name);
+}
+
+#ifdef USE_IO_URING
+/**
+ * @brief io_uring 요청 종류 (user_data 하위 3비트에 저장)
+ */
+enum {
+    URING_TAG_ACCEPT = 1,   /**< multishot accept (상위 비트에 샤드 번호) */
+    URING_TAG_RECV,         /**< provided buffer 수신 (상위 비트에 연결 핸들) */
+    URING_TAG_SEND,         /**< 전송 (상위 비트에 UringSend 포인터) */
+    URING_TAG_PROVIDE       /**< 수신 버퍼 반납 */
+};
+#define URING_TAG_MASK 7ULL
+
+/**
+ * @brief io_uring 전송 요청
+ *
+ * 같은 Message(SmartPtr)를 여러 요청이 공유하며, 마지막 요청이 완료될 때 해제됩니다.
+ * 요청 자체는 send_pool 에서 받으므로, uring_backend.lock 을 잡은 채 수신자마다 할당해도
+ * 대개 스레드별 캐시에서 끝나고 malloc 의 전역 잠금을 거치지 않습니다.
+ */
+typedef struct UringSend {
+    struct UringSend *next;   /**< 같은 클라이언트의 다음 전송 요청 */
+    SmartPtr message;         /**< 공유 메시지 (Message) */
+    size_t offset;            /**< 이미 전송한 바이트 수 */
+    size_t len;               /**< 메시지 길이 */
+    int client_fd;            /**< 수신 클라이언트 소켓 */
+    ConnHandle handle;        /**< 완료 시 클라이언트가 아직 살아 있는지 확인할 핸들 */
+} UringSend;
+
+/**
+ * @brief io_uring 백엔드 상태
+ */
+typedef struct {
+    Uring ring;               /**< io_uring 인스턴스 */
+    pthread_mutex_t lock;     /**< SQE 제출 및 클라이언트 전송 대기열 보호 */
+    int multishot_accept;     /**< multishot accept 사용 여부 (미지원 커널이면 0) */
+    char *buffers;            /**< provided buffer 영역 */
+    atomic_int active;        /**< 백엔드 동작 여부 */
+} UringBackend;
+
+UringBackend uring_backend = { .lock = PTHREAD_MUTEX_INITIALIZER };
+ObjectPool send_pool;     /**< UringSend 풀 (팬아웃마다 수신자 수만큼 할당하고 전송 완료 시 반납) */
+
+/**
+ * @brief 전송 요청을 해제하는 함수 (공유 메시지 참조도 반납)
+ * @param req 해제할 요청
+ * @return void
+ */
+static void uring_free_send(UringSend *req) {
+    release(&req->message);
+    pool_free(req);
+}
+
+/**
+ * @brief 종료하는 클라이언트의 대기 중인 전송 요청을 버리는 함수
+ *
+ * 대기열 head 는 이미 커널에 제출되어 있으므로 완료(CQE) 시점에 해제됩니다.
+ *
+ * @param client_info 종료하는 클라이언트
+ * @return void
+ */
+static void uring_drop_sends(ClientInfo *client_info) {
+    if (!atomic_load(&uring_backend.active)) {
+        return;
+    }
+
+    pthread_mutex_lock(&uring_backend.lock);
+    UringSend *head = client_info->send_head;
+    if (head != NULL) {
+        UringSend *req = head->next;
+        while (req != NULL) {
+            UringSend *next = req->next;
+            uring_free_send(req);
+            req = next;
+        }
+        head->next = NULL;
+    }
+    client_info->send_head = NULL;
+    client_info->send_tail = NULL;
+    client_info->outbox.count = 0;
+    pthread_mutex_unlock(&uring_backend.lock);
+}
+
+/**
+ * @brief io_uring 전송 대기열이 상한이면 느린 클라이언트 정책을 적용하는 함수
+ * @note uring_backend.lock 을 잡은 상태에서 호출합니다.
+ * @param client_info 수신 클라이언트
+ * @param kick 퇴장 알림이면 1 (상한과 관계없이 받고 연결을 퇴장 중으로 표시)
+ * @return int 새 요청을 넣어도 되면 0, 버려야 하면 -1
+ */
+static int uring_outbox_admit(ClientInfo *client_info, int kick) {
+    Outbox *outbox = &client_info->outbox;
+
+    if (atomic_load_explicit(&client_info->closing, memory_order_relaxed)) {
+        return -1;  // 퇴장 알림 뒤에는 아무것도 보내지 않음
+    }
+    if (kick) {
+        atomic_store_explicit(&client_info->closing, 1, memory_order_relaxed);
+        return 0;
+    }
+    if (outbox->count < (uint32_t)server_config.outbox_limit) {
+        return 0;
+    }
+
+    client_info->dropped++;
+    if (server_config.slow_policy == SLOW_POLICY_DROP_OLDEST && client_info->send_head != NULL &&
+        client_info->send_head->next != NULL) {
+        // head 는 이미 커널에 제출되어 있으므로 그 다음 요청을 버림
+        UringSend *oldest = client_info->send_head->next;
+        client_info->send_head->next = oldest->next;
+        if (client_info->send_tail == oldest) {
+            client_info->send_tail = client_info->send_head;
+        }
+        uring_free_send(oldest);
+        outbox->count--;
+        return 0;
+    }
+    if (server_config.slow_policy == SLOW_POLICY_DISCONNECT) {
+        shutdown(client_info->client_fd, SHUT_RDWR);
+    }
+    return -1;
+}
+#else
+static void uring_drop_sends(ClientInfo *client_info) {
+}
+#endif
+
+/**
+ * @brief 송신 대기열의 모든 메시지 참조를 반납하고 배열을 해제하는 함수
+ * @param outbox 송신 대기열
+ * @return void
+ */
+static void outbox_clear(Outbox *outbox) {
+    for (uint32_t i = 0; i < outbox->count; i++) {
+        release(&outbox->items[(outbox->head + i) % outbox->capacity]);
+    }
+    free(outbox->items);
+    outbox->items = NULL;
+    outbox->head = 0;
+    outbox->count = 0;
+    outbox->capacity = 0;
+    outbox->head_offset = 0;
+}
+
+/**
+ * @brief 송신 대기열 용량을 두 배로 늘리는 함수 (상한까지, 상한을 넘겨 넣는 퇴장 알림은 한 칸 더)
+ * @param outbox 송신 대기열
+ * @return int 성공 시 0, 실패 시 -1
+ */
+static int outbox_grow(Outbox *outbox) {
+    uint32_t limit = (uint32_t)server_config.outbox_limit;
+    uint32_t capacity = outbox->capacity ? outbox->capacity * 2 : 8;
+    if (capacity > limit) {
+        capacity = outbox->count < limit ? limit : outbox->count + 1;
+    }
+
+    SmartPtr *items = (SmartPtr *)malloc(capacity * sizeof(SmartPtr));
+    if (items == NULL) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < outbox->count; i++) {
+        items[i] = outbox->items[(outbox->head + i) % outbox->capacity];
+    }
+    free(outbox->items);
+    outbox->items = items;
+    outbox->head = 0;
+    outbox->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief 메시지를 송신 대기열에 넣는 함수 (상한이면 느린 클라이언트 정책 적용)
+ *
+ * 퇴장 알림은 정책과 관계없이 상한을 넘겨 넣고 연결을 퇴장 중으로 표시하며, 그 뒤로 오는 메시지는
+ * 모두 버리므로 알림이 대기열의 마지막 메시지가 됩니다.
+ *
+ * @note client_mutex 를 잡은 상태에서 호출합니다.
+ * @param client_info 수신 클라이언트
+ * @param message 넣을 메시지
+ * @param kick 퇴장 알림이면 1
+ * @return int 넣었으면 0, 버렸거나 연결을 끊었으면 -1
+ */
+static int outbox_push(ClientInfo *client_info, SmartPtr message, int kick) {
+    Outbox *outbox = &client_info->outbox;
+
+    if (atomic_load_explicit(&client_info->closing, memory_order_relaxed)) {
+        return -1;  // 퇴장 알림 뒤에는 아무것도 보내지 않음
+    }
+    if (kick) {
+        atomic_store_explicit(&client_info->closing, 1, memory_order_relaxed);
+    } else if (outbox->count >= (uint32_t)server_config.outbox_limit) {
+        client_info->dropped++;
+        if (server_config.slow_policy == SLOW_POLICY_DISCONNECT) {
+            shutdown(client_info->client_fd, SHUT_RDWR);
+            return -1;
+        }
+        if (server_config.slow_policy == SLOW_POLICY_DROP_NEWEST) {
+            return -1;
+        }
+
+        // 일부 전송된 head 는 스트림이 깨지므로 그 다음 메시지를 버림
+        uint32_t victim = outbox->head_offset > 0 ? 1 : 0;
+        if (victim >= outbox->count) {
+            return -1;
+        }
+        uint32_t victim_pos = (outbox->head + victim) % outbox->capacity;
+        release(&outbox->items[victim_pos]);
+        if (victim == 1) {
+            outbox->items[victim_pos] = outbox->items[outbox->head];
+        }
+        outbox->head = (outbox->head + 1) % outbox->capacity;
+        outbox->count--;
+    }
+
+    if (outbox->count == outbox->capacity && outbox_grow(outbox) < 0) {
+        client_info->dropped++;
+        return -1;
+    }
+
+    retain(&message);
+    outbox->items[(outbox->head + outbox->count) % outbox->capacity] = message;
+    outbox->count++;
+    return 0;
+}
+
+/**
+ * @brief 송신 대기열을 벡터 전송으로 소켓이 받아 주는 만큼 보내는 함수
+ * @note client_mutex 를 잡은 상태에서 호출합니다.
+ * @param client_info 대상 클라이언트
+ * @return int 대기열이 비었으면 0, 남았으면 1, 소켓 오류면 -1
+ */
+static int outbox_flush_locked(ClientInfo *client_info) {
+    Outbox *outbox = &client_info->outbox;
+
+    while (outbox->count > 0) {
+        struct iovec iov[OUTBOX_IOV_MAX];
+        int iovcnt = 0;
+
+        for (uint32_t i = 0; i < outbox->count && iovcnt < OUTBOX_IOV_MAX; i++) {
+            Message *message = (Message *)outbox->items[(outbox->head + i) % outbox->capacity].ptr;
+            size_t skip = i == 0 ? outbox->head_offset : 0;
+            iov[iovcnt].iov_base = message->data + skip;
+            iov[iovcnt].iov_len = message->len - skip;
+            iovcnt++;
+        }
+
+        // writev 와 같지만 MSG_NOSIGNAL 로 끊긴 소켓에서 SIGPIPE 를 받지 않음
+        struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+        ssize_t n = sendmsg(client_info->client_fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        }
+        FANOUT_COUNT(bytes_sent, (long)n);
+
+        size_t left = (size_t)n;
+        while (outbox->count > 0) {
+            SmartPtr *head = &outbox->items[outbox->head];
+            size_t remain = ((Message *)head->ptr)->len - outbox->head_offset;
+            if (left < remain) {
+                outbox->head_offset += left;
+                break;
+            }
+            left -= remain;
+            release(head);
+            outbox->head = (outbox->head + 1) % outbox->capacity;
+            outbox->count--;
+            outbox->head_offset = 0;
+        }
+    }
+    if (atomic_load_explicit(&client_info->closing, memory_order_relaxed)) {
+        shutdown(client_info->client_fd, SHUT_RDWR);  // 퇴장 알림까지 모두 보냄
+    }
+    return 0;
+}
+
+/**
+ * @brief 송신 대기열을 잠그는 함수
+ *
+ * room 모드에서는 연결을 소유한 워커만 송신 대기열을 건드리므로(다른 스레드는 우편으로 넘김) 잠그지 않습니다.
+ *
+ * @param client_info 대상 클라이언트
+ * @return void
+ */
+static inline void client_lock(ClientInfo *client_info) {
+    if (!room_affinity()) {
+        pthread_mutex_lock(client_info->client_mutex);
+    }
+}
+
+/**
+ * @brief client_lock() 으로 잡은 송신 대기열 잠금을 푸는 함수
+ * @param client_info 대상 클라이언트
+ * @return void
+ */
+static inline void client_unlock(ClientInfo *client_info) {
+    if (!room_affinity()) {
+        pthread_mutex_unlock(client_info->client_mutex);
+    }
+}
+
+/**
+ * @brief 송신 대기열을 소켓이 받아 주는 만큼 전송하는 함수
+ * @param client_info 대상 클라이언트
+ * @return int 대기열이 비었으면 0, 남았으면 1, 소켓 오류면 -1
+ */
+int client_flush(ClientInfo *client_info) {
+    client_lock(client_info);
+    int ret = outbox_flush_locked(client_info);
+    client_unlock(client_info);
+    return ret;
+}
+
+/**
+ * @brief 공유 메시지(또는 퇴장 알림)를 송신 대기열에 넣고 가능한 만큼 전송하는 함수
+ * @param client_info 수신 클라이언트
+ * @param message 전송할 메시지
+ * @param kick 퇴장 알림이면 1
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+static int client_enqueue(ClientInfo *client_info, SmartPtr message, int kick) {
+    if (((Message *)message.ptr)->len == 0) {
+        return 0;
+    }
+
+    client_lock(client_info);
+    int ret = outbox_push(client_info, message, kick);
+    if (ret == 0) {
+        outbox_flush_locked(client_info);  // 남은 데이터는 소유 스레드가 쓰기 가능 시점에 전송
+    }
+    client_unlock(client_info);
+    return ret;
+}
+
+/**
+ * @brief 공유 메시지를 클라이언트 송신 대기열에 넣고 가능한 만큼 전송하는 함수
+ * @param client_info 수신 클라이언트
+ * @param message 전송할 메시지
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+int client_send(ClientInfo *client_info, SmartPtr message) {
+    return client_enqueue(client_info, message, 0);
+}
+
+static inline int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 강제 퇴장한 연결의 대기열 비우기 기한을 등록하는 함수
+ * @param handle 퇴장시킨 연결
+ * @return int 성공 시 0, 메모리 부족 시 -1
+ */
+static int kick_reaper_add(ConnHandle handle) {
+    KickReaper *reaper = &kick_reaper;
+    int ret = 0;
+
+    pthread_mutex_lock(&reaper->lock);
+    if (reaper->count == reaper->capacity) {
+        uint32_t capacity = reaper->capacity ? reaper->capacity * 2 : 16;
+        KickDeadline *items = (KickDeadline *)realloc(reaper->items, capacity * sizeof(KickDeadline));
+        if (items == NULL) {
+            ret = -1;
+        } else {
+            reaper->items = items;
+            reaper->capacity = capacity;
+        }
+    }
+    if (ret == 0) {
+        reaper->items[reaper->count].handle = handle;
+        reaper->items[reaper->count].deadline_ms = monotonic_ms() + KICK_DRAIN_TIMEOUT_MS;
+        reaper->count++;
+    }
+    pthread_mutex_unlock(&reaper->lock);
+    return ret;
+}
+
+/**
+ * @brief 기한이 지나도록 송신 대기열을 비우지 못한 강제 퇴장 연결을 끊는 회수 스레드
+ *
+ * 이미 닫힌 연결은 핸들 세대가 맞지 않아 건너뛰고, 대기열을 비워 먼저 끊긴 연결에 다시 shutdown 해도
+ * 아무 일도 일어나지 않습니다.
+ *
+ * @param arg 미사용
+ * @return void* NULL
+ */
+static void *kick_reaper_thread(void *arg) {
+    KickReaper *reaper = &kick_reaper;
+    struct timespec interval = { KICK_REAPER_INTERVAL_MS / 1000, (KICK_REAPER_INTERVAL_MS % 1000) * 1000000L };
+    SharedPtr sp;
+
+    while (1) {
+        nanosleep(&interval, NULL);
+        int64_t now = monotonic_ms();
+
+        pthread_mutex_lock(&reaper->lock);
+        for (uint32_t i = 0; i < reaper->count;) {
+            if (reaper->items[i].deadline_ms > now) {
+                i++;
+                continue;
+            }
+            if (client_acquire(reaper->items[i].handle, &sp) == 0) {
+                ClientInfo *client_info = (ClientInfo *)sp.ptr;
+                printf("클라이언트 %d 퇴장 대기 시간 초과, 연결을 끊습니다.\n", client_info->client_id);
+                shutdown(client_info->client_fd, SHUT_RDWR);
+                release_shared_ptr(&sp);
+            }
+            reaper->items[i] = reaper->items[--reaper->count];  // 마지막 항목이 i 로 옮겨오므로 i 를 그대로 둠
+        }
+        pthread_mutex_unlock(&reaper->lock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 클라이언트 연결을 강제로 끊는 함수
+ *
+ * 연결을 퇴장 중으로 표시하고, 송신 대기열이 이미 비었으면 바로, 아니면 대기열을 비우는 쪽(소유 스레드의
+ * 쓰기 가능 처리나 io_uring 전송 완료)이 마지막 전송 뒤에 소켓을 shutdown 합니다. 그래서 직전에 보낸 퇴장
+ * 알림이 버려지지 않습니다. 읽지 않는 클라이언트는 대기열이 비지 않으므로 KICK_DRAIN_TIMEOUT_MS 가 지나면
+ * 회수 스레드가 끊고, 그동안 클라이언트가 보낸 프레임은 process_client_frames() 가 버립니다.
+ * shutdown 하면 연결을 소유한 스레드(또는 이벤트 루프)가 EOF 를 받아 close_client() 로 정리합니다.
+ * 여기서 직접 해제하면 소유 스레드와 이중 해제가 발생합니다.
+ *
+ * @note io_uring 백엔드에서는 링 잠금을 잡으므로 fanout_end() 뒤에 호출해야 합니다.
+ * @param client_info 끊을 클라이언트
+ * @return void
+ */
+void release_client(ClientInfo *client_info) {
+    int empty;
+
+    // 표시를 먼저 해 두면, 대기열을 비우는 쪽이 아래 확인보다 늦게 돌아도 표시를 보고 끊음
+    atomic_store(&client_info->closing, 1);
+#ifdef USE_IO_URING
+    if (atomic_load(&uring_backend.active)) {
+        pthread_mutex_lock(&uring_backend.lock);
+        empty = client_info->send_head == NULL;
+        pthread_mutex_unlock(&uring_backend.lock);
+    } else
+#endif
+    {
+        client_lock(client_info);
+        empty = client_info->outbox.count == 0;
+        client_unlock(client_info);
+    }
+    if (empty || kick_reaper_add(client_info->handle) < 0) {
+        shutdown(client_info->client_fd, SHUT_RDWR);
+    }
+    printf("클라이언트 %d 연결 종료 요청 완료\n", client_info->client_id);
+}
+
+/**
+ * @brief 유예 기간이 지난 클라이언트 정보를 해제하는 함수 (회수 스레드에서 호출)
+ *
+ * 팬아웃 중인 스레드가 close_client() 이후에도 소켓에 쓸 수 있으므로, 소켓은 여기서 닫아야
+ * 번호가 재사용된 다른 연결로 데이터가 새지 않습니다.
+ *
+ * @param ptr ClientInfo
+ * @return void
+ */
+static void client_info_reclaim(void *ptr) {
+    ClientInfo *client_info = (ClientInfo *)ptr;
+
+    outbox_clear(&client_info->outbox);
+    pool_free(client_info->client_mutex);  // 잠기지 않은 상태로 반납되므로 파괴하지 않고 재사용
+    release_weak_ptr(&client_info->self);
+    intern_release(&usernames, client_info->username);
+    close(client_info->client_fd);
+    pool_free(client_info);
+}
+
+/**
+ * @brief 클라이언트 정보의 마지막 참조가 반납될 때 호출되는 소멸자
+ *
+ * 잠금 없이 방 멤버 목록이나 연결 테이블을 읽던 쪽이 아직 이 클라이언트를 보고 있을 수 있으므로,
+ * 뮤텍스/송신 대기열/소켓까지 모두 유예 기간 뒤에 한꺼번에 정리합니다.
+ *
+ * @param ptr ClientInfo
+ * @return void
+ */
+static void client_info_destroy(void *ptr) {
+    epoch_retire(&client_epoch, ptr, client_info_reclaim);
+}
+
+/**
+ * @brief 새로 수락한 소켓에 대한 클라이언트 정보를 생성하고 등록하는 함수
+ * @param csock 수락한 클라이언트 소켓
+ * @param cliaddr 클라이언트 주소
+ * @param shard 연결을 수락한 샤드
+ * @return SharedPtr* 연결 테이블에 등록된 공유 포인터 슬롯, 실패 시 NULL
+ */
+SharedPtr *register_client(int csock, struct sockaddr_in *cliaddr, Shard *shard) {
+    static atomic_int client_count = 1;
+    char client_ip[INET_ADDRSTRLEN];
+    int client_id = atomic_fetch_add(&client_count, 1);
+
+    inet_ntop(AF_INET, &cliaddr->sin_addr, client_ip, INET_ADDRSTRLEN);
+    printf("[ 클라이언트 %d가 연결되었습니다. IP: %s ]\n", client_id, client_ip);
+
+    // 접속/종료가 잦아도 malloc/free 를 반복하지 않도록 클라이언트 정보와 뮤텍스는 풀에서 할당
+    pthread_mutex_t *client_mutex = (pthread_mutex_t *)pool_alloc(&mutex_pool);
+    ClientInfo *pooled = (ClientInfo *)pool_alloc(&client_pool);
+
+    // 클라이언트 정보는 약한 참조를 지원하는 공유 포인터로 관리 (소멸자가 풀로 반납)
+    SharedPtr sp = { NULL, NULL };
+    if (client_mutex != NULL && pooled != NULL) {
+        sp = adopt_shared_ptr(pooled, client_info_destroy);
+    }
+    if (sp.ptr == NULL) {
+        perror("Failed to allocate client info");
+        pool_free(pooled);
+        pool_free(client_mutex);
+        close(csock);
+        return NULL;
+    }
+    ClientInfo *client_info = (ClientInfo *)sp.ptr;
+    client_info->client_fd = csock;
+    client_info->client_id = client_id;
+    client_info->room_name[0] = '\0';
+    client_info->room = NULL;
+    client_info->room_index = 0;
+    client_info->shard_id = shard->index;
+    client_info->loop_index = current_loop != NULL ? current_loop->index : -1;
+    client_info->state = CLIENT_STATE_AUTH;
+    client_info->username = INTERN_NONE;
+    client_info->auth_failures = 0;
+    client_info->presence_slot = -1;
+    client_info->dropped = 0;
+    atomic_init(&client_info->closing, 0);
+    atomic_init(&client_info->pool_events, 0);
+    client_info->client_mutex = client_mutex;
+    client_info->send_head = NULL;
+    client_info->send_tail = NULL;
+    memset(&client_info->outbox, 0, sizeof(client_info->outbox));
+    frame_reader_init(&client_info->rx);
+    client_info->self = weak_ptr_from(&sp);
+
+    SharedPtr *slot;
+    client_info->handle = conn_table_insert(&client_table, &sp, (void **)&slot);
+    if (client_info->handle == CONN_HANDLE_INVALID) {
+        printf("연결 테이블이 가득 차 클라이언트 %d 연결을 거부합니다.\n", client_id);
+        release_shared_ptr(&sp);  // 뮤텍스와 소켓은 client_info_destroy() 가 정리
+        return NULL;
+    }
+
+    atomic_fetch_add(&shard->connections, 1);
+    atomic_fetch_add(&shard->accepted, 1);
+    return slot;
+}
+
+/**
+ * @brief 클라이언트 연결을 닫고 슬롯과 테이블의 참조를 반납하는 함수
+ * @param sp 클라이언트 공유 포인터 슬롯
+ * @return void
+ */
+void close_client(SharedPtr *sp) {
+    SharedPtr owned = *sp;
+    ClientInfo *client_info = (ClientInfo *)owned.ptr;
+
+    if (client_info == NULL) {
+        return;
+    }
+    // 테이블에서 먼저 제거해 다른 스레드의 브로드캐스트 대상에서 제외 (이후 슬롯은 재사용될 수 있음)
+    if (conn_table_remove(&client_table, client_info->handle) < 0) {
+        return;
+    }
+    // 같은 이름으로 바로 다시 접속할 수 있도록 사용자명 등록 해제 (중복 로그인으로 거부된 연결은 항목이 없음)
+    user_map_remove(&user_map, client_info->username, client_info->handle);
+    presence_release(&presence, client_info->presence_slot);
+    if (client_info->room != NULL) {
+        room_leave(client_info->room, &client_info->room_index);
+        printf("클라이언트 %d가 채팅방 %s에서 퇴장했습니다.\n", client_info->client_id, client_info->room_name);
+    }
+    // 방에서 빠진 뒤에 버려야, 방 멤버를 모은 팬아웃이 링 잠금을 놓기 전에 넣은 요청까지 정리됨
+    uring_drop_sends(client_info);
+    frame_reader_free(&client_info->rx);
+
+    printf("클라이언트 %d 연결 종료.\n", client_info->client_id);
+    atomic_fetch_sub(&shards[client_info->shard_id].connections, 1);
+    release_shared_ptr(&owned);  // 남은 참조가 없으면 client_info_destroy() 가 소켓까지 정리
+}
+
+/**
+ * @brief 채팅방을 소유하는 워커 번호를 구하는 함수 (room 모드)
+ * @param name_hash 채팅방 이름 해시 (room_name_hash())
+ * @return int 워커(이벤트 루프) 번호
+ */
+int room_worker_of(uint32_t name_hash) {
+    return (int)(name_hash % (uint32_t)num_event_loops);
+}
+
+/**
+ * @brief 큐가 가득 찬 우편함의 넘침 목록에 우편을 넣는 함수
+ * @param mailbox 대상 우편함
+ * @param mail 넣을 작업
+ * @return 성공 시 0, 메모리가 없으면 -1
+ */
+static int mailbox_overflow(Mailbox *mailbox, const Mail *mail) {
+    MailOverflow *node = (MailOverflow *)malloc(sizeof(MailOverflow));
+
+    if (node == NULL) {
+        perror("Failed to allocate mail");
+        return -1;
+    }
+    node->next = NULL;
+    node->mail = *mail;
+
+    pthread_mutex_lock(&mailbox->lock);
+    if (!atomic_load_explicit(&mailbox->overflowing, memory_order_relaxed)) {
+        // 워커가 그 사이에 목록을 다 비우고 큐로 돌아왔으면 큐에 다시 넣어 봄
+        if (mpsc_enqueue(&mailbox->queue, mail) == 0) {
+            pthread_mutex_unlock(&mailbox->lock);
+            free(node);
+            return 0;
+        }
+        atomic_store_explicit(&mailbox->overflowing, 1, memory_order_relaxed);
+    }
+    if (mailbox->overflow_tail == NULL) {
+        mailbox->overflow_head = node;
+    } else {
+        mailbox->overflow_tail->next = node;
+    }
+    mailbox->overflow_tail = node;
+    pthread_mutex_unlock(&mailbox->lock);
+    atomic_fetch_add_explicit(&mailbox->overflowed, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief 워커 우편함에 작업을 넣는 함수 (어느 스레드에서나 호출 가능)
+ * @param loop 작업을 처리할 워커
+ * @param type 작업 종류
+ * @param handle 대상 연결 (없으면 CONN_HANDLE_INVALID)
+ * @param room_id 대상 방 (없으면 0)
+ * @param message 보낼 메시지 (참조 하나를 넘겨받음, 없으면 ptr 가 NULL)
+ * @return void
+ */
+void mailbox_post(EventLoop *loop, MailType type, ConnHandle handle, int room_id, SmartPtr message) {
+    Mailbox *mailbox = &loop->mailbox;
+    Mail mail = { .type = type, .handle = handle, .room_id = room_id, .message = message };
+
+    if ((atomic_load_explicit(&mailbox->overflowing, memory_order_acquire) ||
+         mpsc_enqueue(&mailbox->queue, &mail) < 0) &&
+        mailbox_overflow(mailbox, &mail) < 0) {
+        if (message.ptr != NULL) {
+            release(&message);
+        }
+        return;
+    }
+
+    // 게시 뒤의 울타리가 워커의 signaled 초기화 뒤 울타리와 짝을 이뤄, 워커가 이 우편을 못 보고
+    // 지나쳤다면 여기서 signaled 가 0 으로 보여 반드시 깨움
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_exchange_explicit(&mailbox->signaled, 1, memory_order_relaxed)) {
+        uint64_t one = 1;
+        if (write(mailbox->event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            perror("write(eventfd)");
+        }
+    }
+}
+
+/**
+ * @brief 이미 만든 메시지를 클라이언트 한 명에게 보내고 메시지 참조를 반납하는 함수
+ * @param client_info 수신 클라이언트
+ * @param message 전송할 메시지 (참조 하나를 넘겨받음)
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+static int client_deliver(ClientInfo *client_info, SmartPtr message) {
+    int ret = 0;
+
+    // room 모드에서 다른 워커가 소유한 연결이면 소유 워커가 보내도록 넘김
+    if (room_affinity() && (current_loop == NULL || current_loop->index != client_info->loop_index)) {
+        mailbox_post(&event_loops[client_info->loop_index], MAIL_DELIVER, client_info->handle, 0, message);
+        return 0;
+    }
+
+#ifdef USE_IO_URING
+    if (atomic_load(&uring_backend.active)) {
+        FanoutBatch batch;
+        fanout_begin(&batch, message);
+        fanout_add(&batch, client_info);
+        fanout_end(&batch);
+        return 0;
+    }
+#endif
+
+    ret = client_send(client_info, message);
+    release(&message);
+    return ret;
+}
+
+/**
+ * @brief 퇴장 알림을 보내고 연결을 끊는 함수
+ *
+ * 알림은 송신 대기열 상한과 느린 클라이언트 정책에 관계없이 들어가고 그 뒤로는 아무것도 들어가지 않으므로,
+ * 클라이언트가 KICK_DRAIN_TIMEOUT_MS 안에 대기열을 읽어 가면 알림을 받은 다음 연결이 끊깁니다.
+ *
+ * @note room 모드에서는 연결을 소유한 워커에서 호출해야 합니다.
+ * @param client_info 퇴장시킬 클라이언트
+ * @param notice 퇴장 알림 (참조 하나를 넘겨받음)
+ * @return void
+ */
+static void client_kick(ClientInfo *client_info, SmartPtr notice) {
+    FanoutBatch batch;
+
+    fanout_begin(&batch, notice);
+    batch.kick = 1;
+    fanout_add(&batch, client_info);
+    fanout_end(&batch);
+    release_client(client_info);  // 링 잠금을 잡으므로 fanout_end() 뒤에 호출
+}
+
+/**
+ * @brief 클라이언트에게 프레임 하나를 보내는 함수
+ * @param client_info 수신 클라이언트
+ * @param type 프레임 종류
+ * @param data 전송할 데이터
+ * @param len 데이터 길이
+ * @return int 성공 시 0, 대기열 상한으로 버려지거나 연결이 끊기면 -1
+ */
+int send_to_client(ClientInfo *client_info, uint8_t type, const char *data, size_t len) {
+    return client_deliver(client_info, message_from(type, data, len));
+}
+
+/**
+ * @brief 연결 핸들로 클라이언트의 강한 참조를 얻는 함수
+ * @param handle 연결 핸들 (CONN_HANDLE_INVALID 가능)
+ * @param out 얻은 참조
+ * @return int 성공 시 0, 이미 종료된 연결이면 -1
+ */
+int client_acquire(ConnHandle handle, SharedPtr *out) {
+    int ret = -1;
+
+    if (handle == CONN_HANDLE_INVALID) {
+        return -1;
+    }
+    // 슬롯 값을 복사한 뒤 파괴가 시작되지 않았을 때만 참조를 늘림. 제어 블록은 클라이언트 정보의
+    // 약한 참조(self)가 유예 기간 뒤에야 반납되므로 읽기 구역 안에서는 해제되지 않음
+    SharedPtr slot;
+    epoch_enter(&client_epoch);
+    if (conn_table_read(&client_table, handle, &slot) == 0) {
+        WeakPtr weak = { slot.ptr, slot.ctrl };
+        ret = weak_ptr_lock(&weak, out);
+    }
+    epoch_exit(&client_epoch);
+    return ret;
+}
+
+/**
+ * @brief 귓속말을 대상 사용자에게 전달하는 함수
+ * @param sender 보낸 클라이언트
+ * @param args "<사용자> <메시지>"
+ * @param len args 길이
+ * @return void
+ */
+void whisper_message(ClientInfo *sender, const char *args, size_t len) {
+    const char *usage = "사용법: /w <사용자> <메시지>";
+    const char *space = memchr(args, ' ', len);
+    SharedPtr sp;
+
+    if (space == NULL || space == args || space + 1 == args + len) {
+        send_to_client(sender, FRAME_NOTICE, usage, strlen(usage));
+        return;
+    }
+    size_t name_len = (size_t)(space - args);
+    const char *text = space + 1;
+    int text_len = (int)(args + len - text);
+
+    if (client_acquire(user_map_find(&user_map, args, name_len), &sp) < 0) {
+        char notice[BUFFER_SIZE];
+        int n = snprintf(notice, sizeof(notice), "%.*s 사용자는 접속 중이 아닙니다.", (int)name_len, args);
+        send_to_client(sender, FRAME_NOTICE, notice, n < (int)sizeof(notice) ? (size_t)n : sizeof(notice) - 1);
+        return;
+    }
+
+    ClientInfo *target = (ClientInfo *)sp.ptr;
+    SmartPtr whisper = message_create(FRAME_MESSAGE, "[%s -> %s (귓속말)]: %.*s", client_username(sender),
+                                      client_username(target), text_len, text);
+    client_deliver(target, whisper);
+    release_shared_ptr(&sp);
+}
+
+/**
+ * @brief 클라이언트를 강제로 퇴장시키는 함수
+ *
+ * client_kick() 으로 퇴장 알림을 대기열 끝에 넣고 표시만 하므로, 송신 대기열에 먼저 쌓여 있던 메시지와
+ * 알림까지 모두 전송된 다음에 연결이 끊깁니다 (읽지 않는 클라이언트는 KICK_DRAIN_TIMEOUT_MS 뒤에 끊김).
+ *
+ * @param username 퇴장시킬 클라이언트의 사용자명
+ * @return void
+ */
+void kill_user(const char *username) {
+    const char *notice = "You have been kicked from the chat.";
+    SharedPtr sp;
+
+    // 접속 중인 사용자를 이름으로 바로 찾음 (전체 연결 순회 없음)
+    if (client_acquire(user_map_find(&user_map, username, strlen(username)), &sp) < 0) {
+        printf("User %s is not connected.\n", username);
+        return;
+    }
+    ClientInfo *client_info = (ClientInfo *)sp.ptr;
+    if (room_affinity()) {
+        // 알림이 나간 뒤에 끊기도록 소유 워커에게 둘 다 맡김
+        mailbox_post(&event_loops[client_info->loop_index], MAIL_KICK, client_info->handle, 0,
+                     message_from(FRAME_NOTICE, notice, strlen(notice)));
+    } else {
+        client_kick(client_info, message_from(FRAME_NOTICE, notice, strlen(notice)));
+    }
+    printf("User %s has been kicked.\n", username);
+    release_shared_ptr(&sp);
+}
+
+/**
+ * @brief 특정 채팅방에 있는 모든 클라이언트에게 메시지를 브로드캐스트하는 함수
+ * @param sender 메시지를 보낸 클라이언트
+ * @param message 브로드캐스트할 메시지
+ * @param len 메시지 길이
+ * @return void
+ */
+void broadcast_message(ClientInfo *sender, const char *message, size_t len) {
+    // 메시지는 한 번만 프레임으로 직렬화해 로그와 모든 수신자가 공유
+    SmartPtr broadcast = message_create(FRAME_MESSAGE, "[%s]: %.*s", client_username(sender), (int)len, message);
+    log_chat_message(message_payload((Message *)broadcast.ptr));
+
+    // 보낸 사람이 멤버로 있는 동안 방은 회수되지 않음
+    Room *room = sender->room;
+    if (room == NULL) {
+        release(&broadcast);
+        return;
+    }
+    room_note_message(room);
+
+    // 멤버 목록은 잠금 없이 읽고, 수신자 정보는 읽기 구역이 끝날 때까지 해제되지 않으므로 참조 카운트도
+    // 늘리지 않음. 입장/퇴장은 브로드캐스트와 서로 막지 않음. room 모드에서는 이 워커가 방의 유일한
+    // 작성자이고 멤버도 모두 이 워커 소유이므로 읽기 구역도 필요 없음
+    int owned = room_affinity();
+    FanoutBatch batch;
+    fanout_begin(&batch, broadcast);
+    if (!owned) {
+        epoch_enter(&client_epoch);
+    }
+    RoomMembers *members = room_members(room);
+    uint32_t count = room_members_count(members);
+    for (uint32_t i = 0; i < count; i++) {
+        ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+        if (client_info != NULL && client_info != sender) {
+            fanout_add(&batch, client_info);
+        }
+    }
+    if (!owned) {
+        epoch_exit(&client_epoch);
+    }
+    fanout_end(&batch);
+}
+
+
+/**
+ * @brief 채팅 메시지를 로그 파일에 저장하는 함수
+ * @param message 저장할 메시지
+ * @return void
+ */
+void log_chat_message(const char *message) {
+    // 로그 파일은 writer 스레드가 열어 두고 자정마다 교체
+    // 반드시 /var/log 에 파일을 만들 권한이 있어야 함
+    chatlog_write(&chat_log, message, strlen(message));
+}
+
+/**
+ * @brief 채팅 로그 지표를 출력하는 함수
+ * @return void
+ */
+void print_log_stats(void) {
+    ChatLogStats stats;
+    chatlog_get_stats(&chat_log, &stats);
+
+    printf("로그: 요청 %ld건, 기록 %ld건 (%ld bytes, write %ld회, fsync %ld회), 버림 %ld건\n",
+           stats.enqueued, stats.written, stats.bytes, stats.writes, stats.fsyncs, stats.dropped);
+    printf("로그 넣기 지연: 평균 %.0f ns, 최대 %ld ns / 기록 대기: 평균 %.1f us, 최대 %.1f us\n",
+           stats.enqueued > 0 ? (double)stats.enqueue_ns_total / stats.enqueued : 0.0, stats.enqueue_ns_max,
+           stats.written + stats.dropped > 0 ? stats.lag_ns_total / 1000.0 / (stats.written + stats.dropped) : 0.0,
+           stats.lag_ns_max / 1000.0);
+}
+
+/**
+ * @brief 객체 풀 적중/실패 지표를 출력하는 함수
+ * @return void
+ */
+void print_pool_stats(void) {
+    ObjectPool *pools[] = {
+        &client_pool, &mutex_pool, &message_pool,
+#ifdef USE_IO_URING
+        &send_pool,
+#endif
+    };
+
+    printf("메모리 회수: 세대 %lu, 유예 대기 %ld개, 회수 %ld개\n", (unsigned long)atomic_load(&client_epoch.global),
+           epoch_pending(&client_epoch), atomic_load(&client_epoch.reclaimed_count));
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+        PoolStats stats;
+        pool_get_stats(pools[i], &stats);
+        long allocs = stats.hits + stats.refills + stats.misses;
+        printf("풀 %s: 할당 %ld회 (캐시 적중 %ld, 전역 적중 %ld, 실패 %ld, 적중률 %.1f%%), 사용 중 %ld / %ld개\n",
+               pools[i]->name, allocs, stats.hits, stats.refills, stats.misses,
+               allocs > 0 ? 100.0 * (stats.hits + stats.refills) / allocs : 0.0, stats.in_use, stats.capacity);
+    }
+
+    uint32_t names;
+    size_t name_bytes;
+    intern_get_stats(&usernames, &names, &name_bytes);
+    printf("사용자명 인터닝: %u개, %zu bytes (클라이언트 정보 %zu bytes/연결)\n", names, name_bytes,
+           client_pool.block_size);
+}
+
+/**
+ * @brief 워커 풀의 워커별 사용률과 큐 길이를 출력하는 함수 (thread 모드)
+ * @return void
+ */
+void print_worker_stats(void) {
+    for (int i = 0; i < client_workers.count; i++) {
+        ThreadPoolWorkerStats stats;
+        thread_pool_get_stats(&client_workers, i, &stats);
+        printf("워커 %d (CPU %d): 사용률 %.1f%%, 작업 %ld건 (훔침 %ld건), 대기 %u건\n", i, stats.cpu,
+               100.0 * stats.utilization, stats.executed, stats.stolen, stats.depth);
+    }
+}
+
+/**
+ * @brief 뮤텍스 풀의 새 객체 초기화 함수 (재사용할 때는 다시 초기화하지 않음)
+ * @param obj pthread_mutex_t
+ * @return void
+ */
+static void mutex_pool_init(void *obj) {
+    pthread_mutex_init((pthread_mutex_t *)obj, NULL);
+}
+
+/**
+ * @brief 소켓을 논블로킹 모드로 설정하는 함수
+ * @param fd 대상 소켓
+ * @return int 성공 시 0, 실패 시 -1
+ */
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl(O_NONBLOCK)");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 준비된 연결 하나를 처리하는 워커 풀 작업 (thread 모드)
+ *
+ * 디스패처는 연결의 pool_events 를 0 에서 올린 경우에만 작업을 제출하므로, 한 연결을 처리하는 작업은
+ * 언제나 하나뿐이고 연결을 닫는 것도 이 작업뿐입니다. 작업은 본 만큼의 이벤트를 처리한 뒤 그 수를
+ * 빼고, 그 사이에 새 이벤트가 들어와 남아 있으면 다시 처리합니다. 소켓은 엣지 트리거로 감시하므로
+ * 매번 EAGAIN 까지 읽고, 송신 대기열이 막혔다가 풀리면 EPOLLOUT 으로 다시 불려 나머지를 보냅니다.
+ *
+ * @param arg 연결 테이블 핸들 (ConnHandle 을 포인터로 바꾼 값)
+ * @return void
+ */
+void client_service(void *arg) {
+    SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, (ConnHandle)(uintptr_t)arg);
+    if (sp == NULL) {
+        return;
+    }
+    ClientInfo *client_info = (ClientInfo *)sp->ptr;
+    uint32_t seen = atomic_load(&client_info->pool_events);
+
+    while (1) {
+        client_flush(client_info);
+        if (client_read_frames(client_info) <= 0) {
+            break;
+        }
+        seen = atomic_fetch_sub(&client_info->pool_events, seen) - seen;
+        if (seen == 0) {
+            return;
+        }
+    }
+
+    if (client_info->state != CLIENT_STATE_CHAT) {
+        printf("로그인/HELLO 전에 클라이언트 연결 종료\n");
+    }
+    // pool_events 를 0 으로 되돌리지 않으므로 디스패처는 이 연결로 작업을 더 제출하지 않음
+    epoll_ctl(shards[client_info->shard_id].epoll_fd, EPOLL_CTL_DEL, client_info->client_fd, NULL);
+    close_client(sp);
+}
+
+/**
+ * @brief 인증 결과 프레임을 보내는 함수
+ * @param client_info 클라이언트 정보
+ * @param status AUTH_OK 또는 AUTH_FAILED
+ * @param text 세션 토큰 + 사용자명, 또는 사유
+ * @return void
+ */
+static void send_auth_result(ClientInfo *client_info, uint8_t status, const char *text) {
+    char reply[1 + BUFFER_SIZE];
+    size_t len = strnlen(text, BUFFER_SIZE);
+
+    reply[0] = (char)status;
+    memcpy(reply + 1, text, len);
+    send_to_client(client_info, FRAME_AUTH_RESULT, reply, 1 + len);
+}
+
+/**
+ * @brief 로그인/재접속에 성공한 연결에 사용자명을 붙이고 세션 토큰을 알려 주는 함수
+ * @param client_info 클라이언트 정보
+ * @param name 사용자명 핸들 (참조를 넘겨받음)
+ * @param token 재접속이면 받은 토큰, 비밀번호 로그인이면 NULL (새로 발급)
+ * @return int 성공 시 0, 세션 발급 실패 시 -1
+ */
+static int auth_accept(ClientInfo *client_info, InternId name, const char *token) {
+    char hex[SESSION_TOKEN_HEX + 1];
+    char reply[SESSION_TOKEN_HEX + 1 + BUFFER_SIZE];
+
+    client_info->username = name;
+    if (token == NULL) {
+        if (session_create(&sessions, name, hex) < 0) {
+            send_auth_result(client_info, AUTH_FAILED, "세션을 만들 수 없습니다.");
+            return -1;
+        }
+        token = hex;
+    }
+    snprintf(reply, sizeof(reply), "%.*s %s", SESSION_TOKEN_HEX, token, client_username(client_info));
+    send_auth_result(client_info, AUTH_OK, reply);
+    client_info->state = CLIENT_STATE_HELLO;
+    return 0;
+}
+
+/**
+ * @brief AUTH 프레임을 처리하는 함수 (로그인, 세션 토큰 재접속, 회원가입, 사용자 삭제)
+ *
+ * 사용자 데이터베이스는 서버만 가지고 있으며, 재접속은 세션 테이블 조회 한 번으로 끝납니다.
+ * 로그인 실패가 AUTH_MAX_FAILURES 번 쌓이면 연결을 끊습니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @param payload [요청 1바이트][사용자명\0비밀번호 또는 세션 토큰]
+ * @param len payload 길이
+ * @return int 성공 또는 재시도 가능한 실패 시 0, 연결을 끊어야 하면 -1
+ */
+static int handle_auth(ClientInfo *client_info, const char *payload, uint32_t len) {
+    char user[MAX_STRING_SIZE], pass[MAX_STRING_SIZE];
+    const char *fields = payload + 1;
+    uint32_t fields_len = len - 1;
+
+    if (len < 2 || len > 1 + 2 * MAX_STRING_SIZE) {
+        printf("클라이언트 %d 잘못된 AUTH 프레임 (길이 %u)\n", client_info->client_id, len);
+        return -1;
+    }
+    if (payload[0] == AUTH_RESUME) {
+        InternId name = session_resume(&sessions, fields, fields_len);
+        if (name != INTERN_NONE) {
+            printf("클라이언트 %d 세션 재접속: %s\n", client_info->client_id, intern_str(&usernames, name));
+            return auth_accept(client_info, name, fields);
+        }
+        send_auth_result(client_info, AUTH_FAILED, "세션이 만료되었습니다. 다시 로그인하세요.");
+        return ++client_info->auth_failures >= AUTH_MAX_FAILURES ? -1 : 0;
+    }
+
+    // 나머지 요청은 "사용자명\0비밀번호"
+    const char *sep = memchr(fields, '\0', fields_len);
+    size_t user_len = sep != NULL ? (size_t)(sep - fields) : 0;
+    size_t pass_len = sep != NULL ? fields_len - user_len - 1 : 0;
+    if (sep == NULL || user_len == 0 || user_len >= MAX_STRING_SIZE || pass_len == 0 || pass_len >= MAX_STRING_SIZE ||
+        memchr(fields, ' ', user_len) != NULL || memchr(sep + 1, ' ', pass_len) != NULL) {
+        send_auth_result(client_info, AUTH_FAILED, "사용자명과 비밀번호를 확인하세요.");
+        return 0;
+    }
+    memcpy(user, fields, user_len);
+    user[user_len] = '\0';
+    memcpy(pass, sep + 1, pass_len);
+    pass[pass_len] = '\0';
+
+    switch (payload[0]) {
+        case AUTH_LOGIN:
+            if (query_user(&user_db, user, pass) >= 0) {
+                InternId name = intern_acquire(&usernames, user, user_len);
+                if (name == INTERN_NONE) {
+                    printf("클라이언트 %d 사용자명 등록 실패 (메모리 부족)\n", client_info->client_id);
+                    return -1;
+                }
+                printf("클라이언트 %d 로그인: %s\n", client_info->client_id, user);
+                return auth_accept(client_info, name, NULL);
+            }
+            send_auth_result(client_info, AUTH_FAILED, "존재하지 않는 사용자이거나 비밀번호가 틀렸습니다.");
+            return ++client_info->auth_failures >= AUTH_MAX_FAILURES ? -1 : 0;
+        case AUTH_REGISTER:
+            if (user_store_register(&user_store, "localhost", user, pass, "user")) {
+                send_auth_result(client_info, AUTH_OK, "회원가입이 완료되었습니다.");
+            } else {
+                send_auth_result(client_info, AUTH_FAILED, "이미 있는 사용자명입니다.");
+            }
+            return 0;
+        case AUTH_DELETE:
+            if (query_user(&user_db, user, pass) >= 0 && user_store_delete(&user_store, user)) {
+                // 삭제한 사용자의 세션 토큰으로 다시 들어오지 못하도록 폐기
+                InternId name = intern_acquire(&usernames, user, user_len);
+                if (name != INTERN_NONE) {
+                    session_revoke_user(&sessions, name);
+                    intern_release(&usernames, name);
+                }
+                send_auth_result(client_info, AUTH_OK, "사용자가 삭제되었습니다.");
+                return 0;
+            }
+            send_auth_result(client_info, AUTH_FAILED, "존재하지 않는 사용자이거나 비밀번호가 틀렸습니다.");
+            return ++client_info->auth_failures >= AUTH_MAX_FAILURES ? -1 : 0;
+        default:
+            printf("클라이언트 %d 알 수 없는 AUTH 요청 (%d)\n", client_info->client_id, payload[0]);
+            return -1;
+    }
+}
+
+/**
+ * @brief HELLO 프레임을 처리해 로그인한 사용자를 채팅방에 입장시키는 함수
+ *
+ * 채팅방은 숫자 ID 나 이름으로 고르고, 숫자 방은 "7" 처럼 10진수 이름의 방과 같습니다. 처음 입장하는
+ * 방이면 이때 만들어집니다. room 모드에서 채팅방을 다른 워커가 소유하면 여기서 입장하지 않고, 연결을
+ * 그 워커에게 넘기라고 알립니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @param payload [채팅방 ID 4바이트, 빅엔디언][사용자명 (생략 가능, 있으면 로그인한 이름과 같아야 함)]
+ *                [\0 채팅방 이름 (ID 가 0 일 때만)]
+ * @param len payload 길이
+ * @return int 입장했으면 0, 방 소유 워커로 넘겨야 하면 1, 잘못된 HELLO 이면 -1
+ */
+static int handle_hello(ClientInfo *client_info, const char *payload, uint32_t len) {
+    InternEntry *name = intern_entry(&usernames, client_info->username);
+    const char *sep = len > 4 ? (const char *)memchr(payload + 4, '\0', len - 4) : NULL;
+    uint32_t user_len = sep != NULL ? (uint32_t)(sep - payload - 4) : (len > 4 ? len - 4 : 0);
+    uint32_t room_len = sep != NULL ? (uint32_t)(payload + len - sep - 1) : 0;
+    uint32_t room_be;
+    int valid = len >= 4 &&
+                (user_len == 0 || (user_len == name->len && memcmp(payload + 4, name->str, name->len) == 0));
+
+    if (valid) {
+        memcpy(&room_be, payload, 4);
+        uint32_t room_id = ntohl(room_be);
+        if (room_id != 0) {
+            valid = sep == NULL && room_id <= HELLO_ROOM_ID_MAX;
+            snprintf(client_info->room_name, sizeof(client_info->room_name), "%u", room_id);
+        } else {
+            // 이름은 1 ~ HELLO_ROOM_NAME_MAX 바이트, 제어 문자 불가 (목록/로그에 그대로 찍힘)
+            valid = room_len > 0 && room_len <= HELLO_ROOM_NAME_MAX;
+            for (uint32_t i = 0; valid && i < room_len; i++) {
+                valid = (uint8_t)sep[1 + i] >= 0x20 && sep[1 + i] != 0x7f;
+            }
+            if (valid) {
+                memcpy(client_info->room_name, sep + 1, room_len);
+                client_info->room_name[room_len] = '\0';
+            }
+        }
+    }
+    if (!valid) {
+        client_info->room_name[0] = '\0';
+        printf("클라이언트 %d 잘못된 HELLO 프레임 (길이 %u, 로그인한 사용자 %s)\n", client_info->client_id, len,
+               client_username(client_info));
+        return -1;
+    }
+    size_t room_name_len = strlen(client_info->room_name);
+    // room 모드에서는 이름으로 이 연결을 찾은 다른 스레드가 우편을 보낼 곳이 방 소유 워커가 되도록 먼저 바꿈
+    int accept_loop = client_info->loop_index;
+    if (room_affinity()) {
+        client_info->loop_index = room_worker_of(room_name_hash(client_info->room_name, room_name_len));
+    }
+    // 같은 이름으로 이미 접속한 연결이 있으면 거부 (해시 맵에서 O(1) 로 확인)
+    int claimed = user_map_claim(&user_map, client_info->username, client_info->handle);
+    if (claimed == 0) {
+        // 같은 호스트의 다른 서버 프로세스에 접속 중인 이름도 거부 (공유 메모리가 없으면 확인 생략)
+        client_info->presence_slot = presence_claim(&presence, name->str, name->len);
+        if (client_info->presence_slot == PRESENCE_BUSY) {
+            user_map_remove(&user_map, client_info->username, client_info->handle);
+            client_info->presence_slot = -1;
+            claimed = 1;
+        }
+    }
+    if (claimed != 0) {
+        const char *notice = claimed > 0 ? "이미 접속 중인 사용자명입니다." : "사용자명 등록에 실패했습니다.";
+        client_info->loop_index = accept_loop;
+        printf("클라이언트 %d 로그인 거부: %s (%s)\n", client_info->client_id, client_username(client_info), notice);
+        // 새 연결이라 송신 대기열이 비어 있으므로 바로 쓰고, 이어서 연결을 닫음
+        frame_send(client_info->client_fd, FRAME_NOTICE, notice, (uint32_t)strlen(notice));
+        return -1;
+    }
+    printf("사용자명: %s\n", client_username(client_info));
+    if (client_info->loop_index != accept_loop) {
+        client_info->state = CLIENT_STATE_CHAT;  // 입장은 넘겨받은 워커가 함
+        return 1;
+    }
+
+    client_info->room = room_registry_join(&room_registry, client_info->room_name, room_name_len, client_info,
+                                           &client_info->room_index);
+    if (client_info->room == NULL) {
+        printf("클라이언트 %d 채팅방 %s 입장 실패 (메모리 부족)\n", client_info->client_id, client_info->room_name);
+        return -1;
+    }
+    printf("클라이언트 %d가 채팅방 %s에 입장했습니다.\n", client_info->client_id, client_info->room_name);
+    client_info->state = CLIENT_STATE_CHAT;
+    return 0;
+}
+
+/**
+ * @brief 수신 버퍼에 쌓인 완성된 프레임을 모두 처리하는 함수
+ *
+ * room 모드에서 연결을 방 소유 워커로 넘겨야 하면 남은 프레임은 그 워커가 처리하도록 멈춥니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @return int 성공 시 0, 방 소유 워커로 넘겨야 하면 1, 프로토콜 오류 시 -1
+ */
+int process_client_frames(ClientInfo *client_info) {
+    const char *payload;
+    uint32_t len;
+    uint8_t type;
+    int ret;
+
+    while ((ret = frame_reader_next(&client_info->rx, &type, &payload, &len)) > 0) {
+        if (atomic_load_explicit(&client_info->closing, memory_order_relaxed)) {
+            continue;  // 강제 퇴장 중이면 대기열을 비우는 동안 들어온 프레임은 읽어서 버림
+        }
+        if (client_info->state == CLIENT_STATE_AUTH) {
+            if (type != FRAME_AUTH || handle_auth(client_info, payload, len) < 0) {
+                return -1;
+            }
+        } else if (client_info->state == CLIENT_STATE_HELLO) {
+            int hello = type == FRAME_HELLO ? handle_hello(client_info, payload, len) : -1;
+            if (hello != 0) {
+                return hello;
+            }
+        } else if (type == FRAME_CHAT && len >= 3 && memcmp(payload, "/w ", 3) == 0) {
+            whisper_message(client_info, payload + 3, len - 3);
+        } else if (type == FRAME_CHAT) {
+            printf("클라이언트 %d (%s) 메시지: %.*s\n", client_info->client_id, client_username(client_info), (int)len, payload);
+            broadcast_message(client_info, payload, len);
+        } else {
+            printf("클라이언트 %d 알 수 없는 프레임 (type %u)\n", client_info->client_id, type);
+            return -1;
+        }
+    }
+    if (ret < 0) {
+        printf("클라이언트 %d 프레임 길이 초과\n", client_info->client_id);
+    }
+    return ret;
+}
+
+/**
+ * @brief 논블로킹 소켓을 EAGAIN 까지 수신 버퍼로 직접 읽어 프레임을 처리하는 함수
+ *
+ * 읽을 때마다 완성된 프레임을 모두 처리하므로, 한 번의 read() 로 여러 메시지를 처리합니다.
+ *
+ * @param client_info 클라이언트 정보
+ * @return int 계속 읽을 수 있으면 1, 방 소유 워커로 넘겨야 하면 2, EOF 이면 0, 오류/프로토콜 위반이면 -1
+ */
+int client_read_frames(ClientInfo *client_info) {
+    while (1) {
+        size_t avail;
+        char *space = frame_reader_space(&client_info->rx, BUFFER_SIZE, &avail);
+        if (space == NULL) {
+            return -1;
+        }
+
+        ssize_t nbytes = read(client_info->client_fd, space, avail);
+        if (nbytes > 0) {
+            frame_reader_commit(&client_info->rx, (size_t)nbytes);
+            int ret = process_client_frames(client_info);
+            if (ret != 0) {
+                return ret < 0 ? -1 : 2;
+            }
+            continue;
+        }
+        if (nbytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        }
+        return nbytes == 0 ? 0 : -1;
+    }
+}
+
+/**
+ * @brief 클라이언트 소켓을 이벤트 루프의 epoll 에 등록하는 함수
+ * @param loop 연결을 소유할 이벤트 루프
+ * @param client_info 등록할 클라이언트
+ * @return int 성공 시 0, 실패 시 -1
+ */
+static int event_loop_watch(EventLoop *loop, ClientInfo *client_info) {
+    // EPOLLOUT 도 엣지 트리거로 등록해 두면 송신 대기열이 막혔다가 풀릴 때만 깨어남
+    struct epoll_event ev = {
+        .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data.u64 = client_info->handle
+    };
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, client_info->client_fd, &ev) < 0) {
+        perror("epoll_ctl(ADD client)");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 리스닝 소켓에 쌓인 연결을 EAGAIN 이 날 때까지 모두 수락하는 함수
+ * @param loop 연결을 소유할 이벤트 루프
+ * @param shard 이벤트가 발생한 리스닝 샤드
+ * @return void
+ */
+static void event_loop_accept(EventLoop *loop, Shard *shard) {
+    while (1) {
+        struct sockaddr_in cliaddr;
+        socklen_t clen = sizeof(cliaddr);
+        int csock = accept4(shard->listen_fd, (struct sockaddr *)&cliaddr, &clen, SOCK_NONBLOCK);
+        if (csock < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept4()");
+            }
+            return;
+        }
+
+        SharedPtr *sp = register_client(csock, &cliaddr, shard);
+        if (sp != NULL && event_loop_watch(loop, (ClientInfo *)sp->ptr) < 0) {
+            close_client(sp);
+        }
+    }
+}
+
+/**
+ * @brief 핸드셰이크를 마친 연결을 방 소유 워커에게 넘기는 함수 (room 모드)
+ *
+ * 이 루프의 epoll 에서 뺀 뒤 우편을 보내며, 그 뒤로는 연결 정보를 건드리지 않습니다.
+ * HELLO 뒤에 이미 읽어 둔 프레임은 수신 버퍼에 남아 넘겨받은 워커가 처리합니다.
+ *
+ * @param loop 지금까지 연결을 소유한 이벤트 루프
+ * @param sp 클라이언트 공유 포인터 슬롯
+ * @return void
+ */
+static void event_loop_hand_off(EventLoop *loop, SharedPtr *sp) {
+    ClientInfo *client_info = (ClientInfo *)sp->ptr;
+    ConnHandle handle = client_info->handle;
+    EventLoop *owner = &event_loops[client_info->loop_index];
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, client_info->client_fd, NULL) < 0) {
+        perror("epoll_ctl(DEL client)");
+        close_client(sp);
+        return;
+    }
+    mailbox_post(owner, MAIL_ADOPT, handle, 0, (SmartPtr){ .ptr = NULL });
+}
+
+/**
+ * @brief 엣지 트리거 방식으로 클라이언트 소켓을 EAGAIN 까지 읽어 처리하는 함수
+ * @param loop 연결을 소유한 이벤트 루프
+ * @param sp 클라이언트 공유 포인터 슬롯
+ * @return void
+ */
+static void event_loop_read(EventLoop *loop, SharedPtr *sp) {
+    int ret = client_read_frames((ClientInfo *)sp->ptr);
+
+    if (ret == 2) {
+        event_loop_hand_off(loop, sp);
+    } else if (ret <= 0) {
+        close_client(sp);  // EOF, 오류 또는 프로토콜 위반
+    }
+}
+
+/**
+ * @brief 넘겨받은 연결을 방에 입장시키고 이 워커의 epoll 에 등록하는 함수 (room 모드)
+ * @param loop 방 소유 워커
+ * @param handle 넘겨받은 연결
+ * @return void
+ */
+static void room_worker_adopt(EventLoop *loop, ConnHandle handle) {
+    // 넘긴 뒤로는 이 워커만 연결을 닫을 수 있으므로 그대로 남아 있음
+    SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, handle);
+    if (sp == NULL) {
+        return;
+    }
+
+    ClientInfo *client_info = (ClientInfo *)sp->ptr;
+    client_info->room = room_registry_join(&room_registry, client_info->room_name, strlen(client_info->room_name),
+                                           client_info, &client_info->room_index);
+    if (client_info->room == NULL) {
+        printf("클라이언트 %d 채팅방 %s 입장 실패 (메모리 부족)\n", client_info->client_id, client_info->room_name);
+        close_client(sp);
+        return;
+    }
+    printf("클라이언트 %d가 채팅방 %s에 입장했습니다. (워커 %d)\n", client_info->client_id, client_info->room_name,
+           loop->index);
+
+    // 등록하면 엣지 트리거라도 지금 읽기/쓰기 가능한 상태가 한 번 통지됨
+    if (event_loop_watch(loop, client_info) < 0 || process_client_frames(client_info) < 0) {
+        close_client(sp);
+    }
+}
+
+/**
+ * @brief 이 워커가 소유한 방의 멤버 모두에게 메시지를 보내는 함수 (room 모드)
+ * @param room 방
+ * @param message 보낼 메시지 (호출자의 참조는 그대로 둠)
+ * @param kick 보낸 뒤 연결을 끊을지 여부
+ * @return void
+ */
+static void room_worker_fanout(Room *room, SmartPtr message, int kick) {
+    FanoutBatch batch;
+
+    retain(&message);
+    fanout_begin(&batch, message);
+    batch.kick = kick;
+    RoomMembers *members = room_members(room);
+    uint32_t count = room_members_count(members);
+    for (uint32_t i = 0; i < count; i++) {
+        ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+        if (client_info != NULL) {
+            fanout_add(&batch, client_info);
+        }
+    }
+    fanout_end(&batch);
+
+    // 송신 대기열이 비면(알림까지 보내면) 끊기도록 표시
+    for (uint32_t i = 0; kick && i < count; i++) {
+        ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+        if (client_info != NULL) {
+            release_client(client_info);
+        }
+    }
+}
+
+/**
+ * @brief 우편 하나를 처리하는 함수 (room 모드)
+ * @param loop 우편을 받은 워커
+ * @param mail 처리할 우편
+ * @return void
+ */
+static void room_worker_handle(EventLoop *loop, Mail *mail) {
+    SharedPtr *sp;
+    Room *room;
+
+    switch (mail->type) {
+    case MAIL_ADOPT:
+        room_worker_adopt(loop, mail->handle);
+        break;
+    case MAIL_DELIVER:
+    case MAIL_KICK:
+        // 우편을 보낸 뒤 끊긴 연결이면 핸들 세대가 맞지 않아 NULL
+        sp = (SharedPtr *)conn_table_get(&client_table, mail->handle);
+        if (sp == NULL) {
+            break;
+        }
+        if (mail->type == MAIL_KICK) {
+            retain(&mail->message);  // 우편의 참조는 꺼낸 쪽이 반납
+            client_kick((ClientInfo *)sp->ptr, mail->message);  // outbox_flush_locked() 가 대기열을 비운 뒤 끊음
+        } else {
+            client_send((ClientInfo *)sp->ptr, mail->message);
+        }
+        break;
+    case MAIL_ANNOUNCE:
+        room_registry_rdlock(&room_registry);
+        for (uint32_t i = 0; i < room_registry.room_count; i++) {
+            room = room_registry.rooms[i];
+            if (room_worker_of(room->name_hash) == loop->index) {
+                room_worker_fanout(room, mail->message, 0);
+            }
+        }
+        room_registry_unlock(&room_registry);
+        break;
+    case MAIL_KILL_ROOM:
+        // 우편을 보낸 뒤 회수됐을 수 있으므로 ID 로 다시 찾음 (회수는 레지스트리 쓰기 잠금을 잡음)
+        room_registry_rdlock(&room_registry);
+        room = room_registry_lookup(&room_registry, mail->room_id);
+        if (room != NULL) {
+            room_worker_fanout(room, mail->message, 1);
+            printf("Room %s has been closed, and all users have been kicked.\n", room->name);
+        }
+        room_registry_unlock(&room_registry);
+        break;
+    }
+}
+
+/**
+ * @brief 우편함 큐에서 우편을 묶음으로 꺼내 처리하는 함수 (room 모드)
+ * @param loop 우편함을 가진 워커
+ * @param until 이 위치까지는 생산자가 채우는 중인 칸도 게시될 때까지 기다려 처리 (기다리지 않으려면 현재 head)
+ * @return 처리한 우편 수
+ */
+static long room_worker_drain_queue(EventLoop *loop, size_t until) {
+    MpscQueue *queue = &loop->mailbox.queue;
+    Mail batch[MAILBOX_BATCH];
+    long handled = 0;
+
+    while (1) {
+        size_t count = mpsc_dequeue_batch(queue, batch, MAILBOX_BATCH);
+        if (count == 0) {
+            if ((intptr_t)(until - queue->head) <= 0) {
+                break;
+            }
+            sched_yield();  // 칸을 차지한 생산자가 아직 채우는 중
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            room_worker_handle(loop, &batch[i]);
+            if (batch[i].message.ptr != NULL) {
+                release(&batch[i].message);
+            }
+        }
+        handled += (long)count;
+    }
+    return handled;
+}
+
+/**
+ * @brief 우편함에 쌓인 작업을 한꺼번에 꺼내 처리하는 함수 (room 모드)
+ * @param loop 우편함을 가진 워커
+ * @return void
+ */
+static void room_worker_drain(EventLoop *loop) {
+    Mailbox *mailbox = &loop->mailbox;
+    uint64_t wakeups;
+    long handled = 0;
+
+    // 꺼내기 전에 eventfd 와 signaled 를 비워야, 그 사이에 들어온 우편의 깨우기를 놓치지 않음
+    if (read(mailbox->event_fd, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN) {
+        perror("read(eventfd)");
+    }
+    atomic_store_explicit(&mailbox->signaled, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    handled += room_worker_drain_queue(loop, mailbox->queue.head);
+    while (atomic_load_explicit(&mailbox->overflowing, memory_order_acquire)) {
+        pthread_mutex_lock(&mailbox->lock);
+        MailOverflow *node = mailbox->overflow_head;
+        mailbox->overflow_head = NULL;
+        mailbox->overflow_tail = NULL;
+        pthread_mutex_unlock(&mailbox->lock);
+
+        // 목록의 우편보다 먼저 큐에 넣기 시작한 우편을 모두 처리해야 보낸 스레드별 순서가 유지됨
+        handled += room_worker_drain_queue(loop, mpsc_reserved(&mailbox->queue));
+        while (node != NULL) {
+            MailOverflow *next = node->next;
+            room_worker_handle(loop, &node->mail);
+            if (node->mail.message.ptr != NULL) {
+                release(&node->mail.message);
+            }
+            free(node);
+            node = next;
+            handled++;
+        }
+
+        pthread_mutex_lock(&mailbox->lock);
+        if (mailbox->overflow_head == NULL) {
+            atomic_store_explicit(&mailbox->overflowing, 0, memory_order_relaxed);
+        }
+        pthread_mutex_unlock(&mailbox->lock);
+    }
+    atomic_store_explicit(&loop->mails, atomic_load_explicit(&loop->mails, memory_order_relaxed) + handled,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief 이벤트 루프 스레드 함수
+ * @param arg EventLoop 구조체 포인터
+ * @return void* 스레드 종료 시 반환값 (NULL)
+ */
+static void *event_loop_thread(void *arg) {
+    EventLoop *loop = (EventLoop *)arg;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+
+    current_loop = loop;
+    if (room_affinity()) {
+        worker_stats = &loop->stats;
+    }
+
+    while (1) {
+        int n = epoll_wait(loop->epoll_fd, events, MAX_EPOLL_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait()");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            uint64_t data = events[i].data.u64;
+            if (data & EPOLL_LISTEN_TAG) {
+                event_loop_accept(loop, &shards[data & ~EPOLL_LISTEN_TAG]);
+                continue;
+            }
+            if (data & EPOLL_MAILBOX_TAG) {
+                room_worker_drain(loop);
+                continue;
+            }
+
+            // 같은 배치 안에서 이미 닫힌 연결이면 핸들 세대가 맞지 않아 NULL
+            SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, data);
+            if (sp == NULL) {
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                client_flush((ClientInfo *)sp->ptr);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                event_loop_read(loop, sp);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief room 모드 워커의 우편함을 만들고 epoll 에 등록하는 함수
+ * @param loop 워커
+ * @return int 성공 시 0, 실패 시 -1
+ */
+static int room_worker_init(EventLoop *loop) {
+    Mailbox *mailbox = &loop->mailbox;
+
+    if (mpsc_init(&mailbox->queue, MAILBOX_CAPACITY, sizeof(Mail)) < 0) {
+        perror("Failed to allocate mailbox");
+        return -1;
+    }
+    pthread_mutex_init(&mailbox->lock, NULL);
+    mailbox->overflow_head = NULL;
+    mailbox->overflow_tail = NULL;
+    mailbox->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mailbox->event_fd < 0) {
+        perror("eventfd()");
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EPOLL_MAILBOX_TAG | (uint64_t)loop->index };
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, mailbox->event_fd, &ev) < 0) {
+        perror("epoll_ctl(ADD mailbox)");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief room 모드 워커 스레드를 CPU 하나에 고정하는 함수
+ *
+ * 워커 i 는 CPU (i % CPU 수) 에 고정되어, 그 워커가 소유한 방의 멤버 목록과 송신 대기열은 한 코어의
+ * 캐시에만 머뭅니다.
+ *
+ * @param loop 워커
+ * @return void
+ */
+static void room_worker_pin(EventLoop *loop) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    loop->cpu = (int)(loop->index % (cpus > 0 ? cpus : 1));
+    CPU_ZERO(&set);
+    CPU_SET(loop->cpu, &set);
+    int err = pthread_setaffinity_np(loop->tid, sizeof(set), &set);
+    if (err != 0) {
+        fprintf(stderr, "워커 %d CPU %d 고정 실패: %s\n", loop->index, loop->cpu, strerror(err));
+        loop->cpu = -1;
+    }
+}
+
+/**
+ * @brief epoll 이벤트 루프들을 시작하고 종료될 때까지 대기하는 함수
+ *
+ * room 모드에서는 루프마다 우편함을 두고 CPU 에 고정합니다. 수락과 핸드셰이크는 어느 루프나 하고,
+ * HELLO 를 받으면 연결을 방 소유 워커로 넘깁니다.
+ *
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int run_event_loops(void) {
+    int room_mode = room_affinity();
+    int sharded = num_shards > 1 && !room_mode;
+    int num_loops = sharded ? num_shards : server_config.event_loops;
+    EventLoop *loops = (EventLoop *)calloc(num_loops, sizeof(EventLoop));
+    if (loops == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < num_shards; i++) {
+        if (set_nonblocking(shards[i].listen_fd) < 0) {
+            free(loops);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < num_loops; i++) {
+        loops[i].index = i;
+        loops[i].cpu = -1;
+        loops[i].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (loops[i].epoll_fd < 0) {
+            perror("epoll_create1()");
+            return -1;
+        }
+        if (room_mode && room_worker_init(&loops[i]) < 0) {
+            return -1;
+        }
+
+        // 샤딩 시 루프는 자기 샤드의 소켓만, 아니면 모든 루프가 공유 소켓을 EPOLLEXCLUSIVE 로 감시
+        for (int j = 0; j < num_shards; j++) {
+            if (sharded && j != i) {
+                continue;
+            }
+            struct epoll_event ev = {
+                .events = sharded ? EPOLLIN : (EPOLLIN | EPOLLEXCLUSIVE),
+                .data.u64 = EPOLL_LISTEN_TAG | (uint64_t)j
+            };
+            if (epoll_ctl(loops[i].epoll_fd, EPOLL_CTL_ADD, shards[j].listen_fd, &ev) < 0) {
+                perror("epoll_ctl(ADD listen)");
+                return -1;
+            }
+        }
+    }
+
+    // 루프가 시작되기 전에 공개해야 다른 루프나 관리자 스레드가 우편을 보낼 수 있음
+    num_event_loops = num_loops;
+    event_loops = loops;
+    for (int i = 0; i < num_loops; i++) {
+        pthread_create(&loops[i].tid, NULL, event_loop_thread, &loops[i]);
+        if (room_mode) {
+            room_worker_pin(&loops[i]);
+        }
+    }
+    if (room_mode) {
+        printf("방 소유 워커 %d개로 클라이언트를 처리합니다. (워커마다 CPU 하나에 고정)\n", num_loops);
+    } else {
+        printf("epoll 이벤트 루프 %d개로 클라이언트를 처리합니다.%s\n", num_loops,
+               sharded ? " (샤드당 루프 1개)" : "");
+    }
+
+    for (int i = 0; i < num_loops; i++) {
+        pthread_join(loops[i].tid, NULL);
+        close(loops[i].epoll_fd);
+    }
+    return 0;
+}
+
+#ifdef USE_IO_URING
+/**
+ * @brief 빈 SQE 를 얻는 함수 (제출 큐가 가득 차면 먼저 제출)
+ * @note uring_backend.lock 을 잡은 상태에서 호출합니다.
+ * @return struct io_uring_sqe* SQE
+ */
+static struct io_uring_sqe *uring_backend_sqe(void) {
+    struct io_uring_sqe *sqe;
+    while ((sqe = uring_get_sqe(&uring_backend.ring)) == NULL) {
+        uring_submit(&uring_backend.ring);
+    }
+    return sqe;
+}
+
+/**
+ * @brief 샤드의 리스닝 소켓에 (multishot) accept 를 등록하는 함수
+ * @param shard 리스닝 샤드
+ * @return void
+ */
+static void uring_arm_accept(Shard *shard) {
+    struct io_uring_sqe *sqe = uring_backend_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = shard->listen_fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    if (uring_backend.multishot_accept) {
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    }
+    sqe->user_data = ((uint64_t)shard->index << 3) | URING_TAG_ACCEPT;
+}
+
+/**
+ * @brief provided buffer 그룹에서 버퍼를 골라 받는 recv 를 등록하는 함수
+ * @param fd 클라이언트 소켓
+ * @param handle 클라이언트 연결 핸들
+ * @return void
+ */
+static void uring_arm_recv(int fd, ConnHandle handle) {
+    struct io_uring_sqe *sqe = uring_backend_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->len = BUFFER_SIZE;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = ((uint64_t)handle << 3) | URING_TAG_RECV;
+}
+
+/**
+ * @brief 수신 버퍼를 커널에 (다시) 제공하는 함수
+ * @param bid 시작 버퍼 ID
+ * @param count 버퍼 개수
+ * @return void
+ */
+static void uring_provide_buffers(int bid, int count) {
+    struct io_uring_sqe *sqe = uring_backend_sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    sqe->addr = (uint64_t)(uintptr_t)(uring_backend.buffers + (size_t)bid * BUFFER_SIZE);
+    sqe->len = BUFFER_SIZE;
+    sqe->off = bid;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = URING_TAG_PROVIDE;
+}
 
 /**
- * @brief 서버 관리자용 고정 메뉴 출력 함수
+ * @brief 전송 요청의 남은 부분을 SEND 로 등록하는 함수
+ * @param req 전송 요청
+ * @return void
  */
-void print_fixed_menu() {
-    // ANSI 색상 코드
-    const char *color_reset = "\033[0m";
-    const char *color_red = "\033[1;31m";
-    const char *color_green = "\033[1;32m";
-    const char *color_blue = "\033[1;34m";
-    const char *color_cyan = "\033[1;36m";
-
-    // 메뉴 출력
-    printf("\n%s================= 서버 관리자 메뉴 =================%s\n", color_blue, color_reset);
-    printf("%s|%s 1. %s'list'%s : 현재 접속한 유저와 채팅방 상태 출력     %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
-    printf("%s|%s 2. %s'kill <user> (구현 예정)'%s : 특정 유저 강제 퇴장 (구현 예정)              %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
-    printf("%s|%s 3. %s'kill room <num> (구현 예정)'%s : 특정 채팅방 강제 종료 (구현 예정)          %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
-    printf("%s|%s 4. %s'grep -r \"<message>\"'%s : 채팅 로그에서 메시지 검색  %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
-    printf("%s|%s 5. %s'exit'%s : 서버 종료                                 %s|%s\n", color_cyan, color_reset, color_green, color_reset, color_cyan, color_reset);
-    printf("%s=====================================================%s\n\n", color_blue, color_reset);
+static void uring_start_send(UringSend *req) {
+    struct io_uring_sqe *sqe = uring_backend_sqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = req->client_fd;
+    sqe->addr = (uint64_t)(uintptr_t)(((Message *)req->message.ptr)->data + req->offset);
+    sqe->len = req->len - req->offset;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = (uint64_t)(uintptr_t)req | URING_TAG_SEND;
 }
 
 /**
- * @brief 서버 메시지를 브로드캐스트하는 함수
- * @param message 서버에서 브로드캐스트할 메시지
- * @param argument message 서버에서 브로드캐스트할 메시지
- * @return void
+ * @brief 핸들로 아직 살아 있는 클라이언트를 찾는 함수
+ * @param handle 클라이언트 연결 핸들
+ * @return ClientInfo* 클라이언트, 이미 종료되었으면 NULL
  */
-SmartPtr create_smart_ptr(void *ptr) {
-    SmartPtr sp;
-    sp.ptr = ptr;
-    sp.ref_count = (int *)malloc(sizeof(int));
-    if (sp.ref_count == NULL) {
-        perror("Failed to allocate memory for ref_count");
-        exit(EXIT_FAILURE);
-    }
-    *(sp.ref_count) = 1;
-    sp.mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    if (sp.mutex == NULL) {
-        perror("Failed to allocate memory for mutex");
-        free(sp.ref_count);
-        exit(EXIT_FAILURE);
-    }
-    pthread_mutex_init(sp.mutex, NULL);
-    return sp;
+static ClientInfo *uring_lookup_client(ConnHandle handle) {
+    SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, handle);
+    return sp != NULL ? (ClientInfo *)sp->ptr : NULL;
 }
 
 /**
- * @brief 스마트 포인터 retain 함수 구현
- * @param sp 참조를 증가시킬 스마트 포인터의 포인터
+ * @brief accept 완료 처리 함수
+ * @param csock 수락된 소켓
+ * @param shard 연결을 수락한 샤드
  * @return void
  */
-void retain(SmartPtr *sp) {
-    pthread_mutex_lock(sp->mutex);
-    (*(sp->ref_count))++;
-    pthread_mutex_unlock(sp->mutex);
+static void uring_on_accept(int csock, Shard *shard) {
+    struct sockaddr_in cliaddr;
+    socklen_t clen = sizeof(cliaddr);
+
+    memset(&cliaddr, 0, sizeof(cliaddr));
+    getpeername(csock, (struct sockaddr *)&cliaddr, &clen);
+
+    // 팬아웃이 핸들이 채워지기 전의 클라이언트를 보지 않도록 링 잠금 안에서 등록
+    pthread_mutex_lock(&uring_backend.lock);
+    SharedPtr *sp = register_client(csock, &cliaddr, shard);
+    if (sp != NULL) {
+        uring_arm_recv(csock, ((ClientInfo *)sp->ptr)->handle);
+    }
+    pthread_mutex_unlock(&uring_backend.lock);
 }
 
 /**
- * @brief 스마트 포인터 release 함수 구현
- * @param sp 해제할 스마트 포인터의 포인터
+ * @brief recv 완료 처리 함수
+ * @param handle 클라이언트 연결 핸들
+ * @param cqe 완료 항목
  * @return void
  */
-void release(SmartPtr *sp) {
-    int should_free = 0;
-    pthread_mutex_lock(sp->mutex);
-    (*(sp->ref_count))--;
-    if (*(sp->ref_count) == 0) {
-        should_free = 1;
+static void uring_on_recv(ConnHandle handle, struct io_uring_cqe *cqe) {
+    SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, handle);
+
+    int failed = 0;
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        int bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        if (cqe->res > 0 && sp != NULL) {
+            // provided buffer 는 바로 반납해야 하므로 연결별 수신 버퍼에 이어 붙여 재조립
+            ClientInfo *client_info = (ClientInfo *)sp->ptr;
+            char *buffer = uring_backend.buffers + (size_t)bid * BUFFER_SIZE;
+            failed = frame_reader_append(&client_info->rx, buffer, cqe->res) < 0 ||
+                     process_client_frames(client_info) < 0;
+        }
+        pthread_mutex_lock(&uring_backend.lock);
+        uring_provide_buffers(bid, 1);
+        pthread_mutex_unlock(&uring_backend.lock);
     }
-    pthread_mutex_unlock(sp->mutex);
 
-    if (should_free) {
-        free(sp->ptr);
-        free(sp->ref_count);
-        pthread_mutex_destroy(sp->mutex);
-        free(sp->mutex);
+    if (sp == NULL) {
+        return;
+    }
+    if (!failed && (cqe->res > 0 || cqe->res == -ENOBUFS)) {
+        pthread_mutex_lock(&uring_backend.lock);
+        uring_arm_recv(((ClientInfo *)sp->ptr)->client_fd, handle);
+        pthread_mutex_unlock(&uring_backend.lock);
+    } else {
+        close_client(sp);  // EOF 또는 오류
     }
 }
 
 /**
- * @brief 클라이언트를 강제로 퇴장시키는 함수
- * @param username 퇴장시킬 클라이언트의 사용자명
+ * @brief send 완료 처리 함수
+ *
+ * 부분 전송이면 나머지를 다시 제출하고, 끝났으면 같은 클라이언트의 다음 요청을 제출합니다.
+ *
+ * @param req 완료된 전송 요청
+ * @param res 전송 결과
  * @return void
  */
-void list_users() {
-    printf("현재 접속 중인 유저 목록:\n");
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_infos[i].ptr != NULL) {
-            ClientInfo *client_info = (ClientInfo *)client_infos[i].ptr;
-            printf("User: %s, Room: %d\n", client_info->username, client_info->room_id);
-        }
+static void uring_on_send(UringSend *req, int res) {
+    pthread_mutex_lock(&uring_backend.lock);
+    ClientInfo *client_info = uring_lookup_client(req->handle);
+
+    if (res > 0) {
+        atomic_fetch_add(&fanout_stats.bytes_sent, res);
     }
 
-    for (int room_id = 1; room_id <= 5; room_id++) {
-        int user_count = 0;
-        for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (client_infos[i].ptr != NULL) {
-                ClientInfo *client_info = (ClientInfo *)client_infos[i].ptr;
-                if (client_info->room_id == room_id) {
-                    user_count++;
-                }
+    if (client_info != NULL && res > 0 && req->offset + res < req->len) {
+        req->offset += res;
+        uring_start_send(req);
+        pthread_mutex_unlock(&uring_backend.lock);
+        return;
+    }
+
+    if (client_info != NULL) {
+        if (res < 0) {
+            printf("클라이언트 %d 전송 실패: %s\n", client_info->client_id, strerror(-res));
+        }
+        client_info->send_head = req->next;
+        client_info->outbox.count--;
+        if (client_info->send_head == NULL) {
+            client_info->send_tail = NULL;
+            if (atomic_load_explicit(&client_info->closing, memory_order_relaxed)) {
+                shutdown(client_info->client_fd, SHUT_RDWR);  // 퇴장 알림까지 모두 보냄
             }
+        } else {
+            uring_start_send(client_info->send_head);
         }
-        printf("Room %d: %d명\n", room_id, user_count);
     }
+    pthread_mutex_unlock(&uring_backend.lock);
+
+    uring_free_send(req);
 }
 
 /**
- * @brief 클라이언트를 강제로 퇴장시키는 함수
- * @param username 퇴장시킬 클라이언트의 사용자명
+ * @brief 완료 항목(CQE) 하나를 종류에 따라 처리하는 함수
+ * @param cqe 완료 항목
  * @return void
  */
-void kill_room(int room_id) {
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_infos[i].ptr != NULL) {
-            ClientInfo *client_info = (ClientInfo *)client_infos[i].ptr;
-            if (client_info->room_id == room_id) {
-                send(client_info->client_fd, "The room has been closed. You have been kicked out.\n", strlen("The room has been closed. You have been kicked out.\n"), 0);
-                release_client(i);  // Properly release client
+static void uring_handle_cqe(struct io_uring_cqe *cqe) {
+    Shard *shard;
+
+    switch (cqe->user_data & URING_TAG_MASK) {
+    case URING_TAG_ACCEPT:
+        shard = &shards[cqe->user_data >> 3];
+        if (cqe->res >= 0) {
+            uring_on_accept(cqe->res, shard);
+        } else if (cqe->res == -EINVAL && uring_backend.multishot_accept) {
+            printf("multishot accept 를 지원하지 않는 커널입니다. 단일 accept 로 전환합니다.\n");
+            uring_backend.multishot_accept = 0;
+        } else {
+            printf("accept 실패: %s\n", strerror(-cqe->res));
+            if (cqe->res == -EINVAL) {
+                return;
             }
         }
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            pthread_mutex_lock(&uring_backend.lock);
+            uring_arm_accept(shard);
+            pthread_mutex_unlock(&uring_backend.lock);
+        }
+        break;
+    case URING_TAG_RECV:
+        uring_on_recv(cqe->user_data >> 3, cqe);
+        break;
+    case URING_TAG_SEND:
+        uring_on_send((UringSend *)(uintptr_t)(cqe->user_data & ~URING_TAG_MASK), cqe->res);
+        break;
+    case URING_TAG_PROVIDE:
+        if (cqe->res < 0) {
+            printf("수신 버퍼 등록 실패: %s\n", strerror(-cqe->res));
+        }
+        break;
     }
-    printf("Room %d has been closed, and all users have been kicked.\n", room_id);
 }
+#endif
 
 /**
- * @brief 서버 메시지를 브로드캐스트하는 함수
- * @param message 서버에서 브로드캐스트할 메시지
- * @param argument message 서버에서 브로드캐스트할 메시지
- * @return void
+ * @brief io_uring 백엔드를 실행하는 함수
+ * @return int 성공 시 0, 실패 시 -1
  */
-SmartPtr client_infos[MAX_CLIENTS];
+int run_uring_backend(void) {
+#ifdef USE_IO_URING
+    static const int required_ops[] = {
+        IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_PROVIDE_BUFFERS
+    };
+    Uring *ring = &uring_backend.ring;
+
+    int ret = uring_init(ring, URING_ENTRIES);
+    if (ret < 0) {
+        printf("io_uring 초기화 실패 (%s). epoll 이벤트 루프로 대체합니다.\n", strerror(-ret));
+        return run_event_loops();
+    }
+    if (!uring_probe_ops(ring, required_ops, sizeof(required_ops) / sizeof(required_ops[0]))) {
+        printf("커널이 필요한 io_uring 연산을 지원하지 않습니다. epoll 이벤트 루프로 대체합니다.\n");
+        uring_exit(ring);
+        return run_event_loops();
+    }
+
+    uring_backend.buffers = (char *)malloc((size_t)URING_BUFFER_COUNT * BUFFER_SIZE);
+    if (uring_backend.buffers == NULL) {
+        perror("Failed to allocate io_uring buffers");
+        uring_exit(ring);
+        return -1;
+    }
+    uring_backend.multishot_accept = 1;
+
+    pthread_mutex_lock(&uring_backend.lock);
+    uring_provide_buffers(0, URING_BUFFER_COUNT);
+    for (int i = 0; i < num_shards; i++) {
+        uring_arm_accept(&shards[i]);  // 모든 샤드의 리스닝 소켓을 한 링에서 처리
+    }
+    uring_submit(ring);
+    pthread_mutex_unlock(&uring_backend.lock);
+
+    atomic_store(&uring_backend.active, 1);
+    printf("io_uring 백엔드로 클라이언트를 처리합니다.\n");
+
+    // 완료 큐는 이 스레드만 소비하고, 처리 중 쌓인 SQE 는 한 번에 제출
+    while (uring_wait_cqe(ring) == 0) {
+        struct io_uring_cqe *cqe;
+        while ((cqe = uring_peek_cqe(ring)) != NULL) {
+            struct io_uring_cqe done = *cqe;
+            uring_cqe_seen(ring);
+            uring_handle_cqe(&done);
+        }
+
+        pthread_mutex_lock(&uring_backend.lock);
+        uring_submit(ring);
+        pthread_mutex_unlock(&uring_backend.lock);
+    }
+
+    atomic_store(&uring_backend.active, 0);
+    uring_exit(ring);
+    free(uring_backend.buffers);
+    return -1;
+#else
+    printf("io_uring 백엔드 없이 빌드되었습니다 (USE_IO_URING=0). epoll 이벤트 루프로 대체합니다.\n");
+    return run_event_loops();
+#endif
+}
 
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
- * @param client_infos 클라이언트 정보를 담는 스마트 포인터 배열
- * @return void
+ * @brief payload 길이만큼 Message 를 할당하고 프레임 헤더를 기록하는 함수
+ * @param type 프레임 종류
+ * @param len payload 길이
+ * @return SmartPtr Message 를 가리키는 스마트 포인터
  */
-void add_new_client(int sock, int client_id, const char *username) {
-    ClientInfo *client_info = (ClientInfo *)malloc(sizeof(ClientInfo));
-    client_info->client_fd = sock;
-    client_info->client_id = client_id;
-    strcpy(client_info->username, username); 
-    pthread_mutex_t *client_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-    pthread_mutex_init(client_mutex, NULL);
-    client_info->client_mutex = client_mutex;
-    
-    client_infos[sock] = create_smart_ptr(client_info);
+static SmartPtr message_alloc(uint8_t type, size_t len) {
+    SmartPtr sp = smart_ptr_alloc_pooled(&message_pool, sizeof(Message) + FRAME_HEADER_SIZE + len + 1);
+    Message *message = (Message *)sp.ptr;
+    if (message == NULL) {
+        perror("Failed to allocate message");
+        exit(EXIT_FAILURE);
+    }
+    message->len = FRAME_HEADER_SIZE + len;
+    frame_encode_header(message->data, type, (uint32_t)len);
+    message->data[message->len] = '\0';
+
+    FANOUT_COUNT(messages, 1);
+    FANOUT_COUNT(bytes_serialized, (long)message->len);
+    return sp;
 }
 
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
- * @param client_infos 클라이언트 정보를 담는 스마트 포인터 배열
- * @return void
+ * @brief printf 형식으로 메시지 프레임을 한 번 직렬화해 생성하는 함수
+ * @param type 프레임 종류
+ * @param fmt 형식 문자열
+ * @param ... 형식 인자
+ * @return SmartPtr Message 를 가리키는 스마트 포인터
  */
-void release_client(int sock) {
-    if (client_infos[sock].ptr != NULL) {
-        ClientInfo *client_info = (ClientInfo *)client_infos[sock].ptr;
-        close(client_info->client_fd);
-        release_shared_ptr((SharedPtr*)&client_infos[sock]);
-        printf("클라이언트 %d 연결 종료 및 메모리 해제 완료\n", client_info->client_id);
+SmartPtr message_create(uint8_t type, const char *fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (len < 0) {
+        len = 0;
     }
+
+    SmartPtr sp = message_alloc(type, (size_t)len);
+    va_start(args, fmt);
+    vsnprintf(message_payload((Message *)sp.ptr), (size_t)len + 1, fmt, args);
+    va_end(args);
+    return sp;
 }
 
+/**
+ * @brief 바이트열을 payload 로 복사해 메시지 프레임을 생성하는 함수
+ * @param type 프레임 종류
+ * @param data 본문
+ * @param len 본문 길이
+ * @return SmartPtr Message 를 가리키는 스마트 포인터
+ */
+SmartPtr message_from(uint8_t type, const char *data, size_t len) {
+    SmartPtr sp = message_alloc(type, len);
+    memcpy(message_payload((Message *)sp.ptr), data, len);
+    return sp;
+}
 
 /**
- * @brief 클라이언트 정보를 스마트 포인터로 관리하는 배열
- * @param client_infos 클라이언트 정보를 담는 스마트 포인터 배열
+ * @brief 팬아웃 통계를 출력하는 함수
  * @return void
  */
-void kill_user(const char *username) {
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_infos[i].ptr != NULL) {
-            ClientInfo *client_info = (ClientInfo *)client_infos[i].ptr;
-            if (strcmp(client_info->username, username) == 0) {
-                send(client_info->client_fd, "You have been kicked from the chat.\n", strlen("You have been kicked from the chat.\n"), 0);
-                release_client(i);  // Properly release client
-                printf("User %s has been kicked.\n", username);
-                break;
-            }
-        }
+void print_fanout_stats(void) {
+    long messages = atomic_load(&fanout_stats.messages);
+    long serialized = atomic_load(&fanout_stats.bytes_serialized);
+    long deliveries = atomic_load(&fanout_stats.deliveries);
+    long sent = atomic_load(&fanout_stats.bytes_sent);
+
+    // room 모드 워커는 자기 통계에 따로 기록하므로 합산
+    for (int i = 0; i < num_event_loops && room_affinity(); i++) {
+        FanoutStats *stats = &event_loops[i].stats;
+        messages += atomic_load_explicit(&stats->messages, memory_order_relaxed);
+        serialized += atomic_load_explicit(&stats->bytes_serialized, memory_order_relaxed);
+        deliveries += atomic_load_explicit(&stats->deliveries, memory_order_relaxed);
+        sent += atomic_load_explicit(&stats->bytes_sent, memory_order_relaxed);
+    }
+
+    printf("메시지: %ld개, 직렬화: %ld bytes\n", messages, serialized);
+    printf("전달 요청: %ld건, 전송: %ld bytes (직렬화 대비 %.2f배)\n",
+           deliveries, sent, serialized > 0 ? (double)sent / serialized : 0.0);
+    for (int i = 0; i < num_event_loops && room_affinity(); i++) {
+        EventLoop *loop = &event_loops[i];
+        printf("워커 %d (CPU %d): 메시지 %ld개, 전달 %ld건, 우편 %ld건 (넘침 %ld건)\n", loop->index, loop->cpu,
+               atomic_load_explicit(&loop->stats.messages, memory_order_relaxed),
+               atomic_load_explicit(&loop->stats.deliveries, memory_order_relaxed),
+               atomic_load_explicit(&loop->mails, memory_order_relaxed),
+               atomic_load_explicit(&loop->mailbox.overflowed, memory_order_relaxed));
     }
 }
 
 /**
- * @brief 특정 채팅방에 있는 모든 클라이언트에게 메시지를 브로드캐스트하는 함수
- * @param sender_fd 메시지를 보낸 클라이언트의 파일 디스크립터
- * @param message 브로드캐스트할 메시지
- * @param room_id 메시지를 보낼 채팅방의 ID
+ * @brief 팬아웃 묶음을 시작하는 함수
+ * @param batch 초기화할 묶음
+ * @param message 전송할 메시지 (참조 하나를 넘겨받음)
  * @return void
  */
-void broadcast_message(int sender_fd, char *message, int room_id) {
-    char broadcast_message[BUFFER_SIZE + 50];
-    ClientInfo *sender_info = (ClientInfo *)client_infos[sender_fd].ptr;
-
-    snprintf(broadcast_message, sizeof(broadcast_message), "[%s]: %s", sender_info->username, message);
-    log_chat_message(broadcast_message);
-
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_infos[i].ptr != NULL) {
-            ClientInfo *client_info = (ClientInfo *)client_infos[i].ptr;
-            if (client_info->room_id == room_id && client_info->client_fd != sender_fd) {
-                write(client_info->client_fd, broadcast_message, strlen(broadcast_message));
-            }
-        }
+void fanout_begin(FanoutBatch *batch, SmartPtr message) {
+    batch->message = message;
+    batch->use_uring = 0;
+    batch->kick = 0;
+
+#ifdef USE_IO_URING
+    if (atomic_load(&uring_backend.active)) {
+        batch->use_uring = 1;
+        pthread_mutex_lock(&uring_backend.lock);
     }
+#endif
 }
 
-
-#include <time.h>
-
-pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 /**
- * @brief 채팅 메시지를 로그 파일에 저장하는 함수
- * @param message 저장할 메시지
+ * @brief 팬아웃 묶음에 수신자를 추가하는 함수
+ *
+ * io_uring 백엔드에서는 메시지를 복사하지 않고 참조만 늘려 전송 요청에 붙입니다.
+ *
+ * @param batch 팬아웃 묶음
+ * @param client_info 수신 클라이언트
  * @return void
  */
-void log_chat_message(const char *message) {
-    // 절대 경로로 로그 파일 지정
-    char log_path[BUFFER_SIZE];
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-
-    // 현재 날짜를 기반으로 로그 파일명을 만듦
-    // 반드시 touch 명령어로 해당 파일을 미리 생성해두어야 함
-    // 권한에 대해서도 고려해야 함
-    // sudo touch /var/log/chatlog_20240915.log
-    // sudo chmod 777 /var/log/chatlog_20240915.log
-    strftime(log_path, sizeof(log_path), "/var/log/chatlog_%Y%m%d.log", t);
-
-    // 뮤텍스 잠금으로 동시 접근 제어
-    pthread_mutex_lock(&log_mutex);
-
-    FILE *log_file = fopen(log_path, "a");
-    if (log_file == NULL) {
-        perror("로그 파일을 열 수 없습니다.");
-        pthread_mutex_unlock(&log_mutex);  // 잠금 해제
+void fanout_add(FanoutBatch *batch, ClientInfo *client_info) {
+    Message *message = (Message *)batch->message.ptr;
+
+    FANOUT_COUNT(deliveries, 1);
+#ifdef USE_IO_URING
+    if (batch->use_uring) {
+        UringSend *req = (UringSend *)pool_alloc(&send_pool);
+        if (req == NULL) {
+            client_info->dropped++;  // 메모리가 없으면 이 수신자에게는 버림 (상한 초과와 같게 셈)
+            return;
+        }
+        req->next = NULL;
+        req->message = batch->message;
+        retain(&req->message);
+        req->offset = 0;
+        req->len = message->len;
+        req->client_fd = client_info->client_fd;
+        req->handle = client_info->handle;
+
+        if (uring_outbox_admit(client_info, batch->kick) < 0) {
+            uring_free_send(req);
+            return;
+        }
+        client_info->outbox.count++;
+
+        // 같은 소켓에는 한 번에 하나의 SEND 만 제출해 순서를 보장
+        if (client_info->send_tail != NULL) {
+            client_info->send_tail->next = req;
+            client_info->send_tail = req;
+        } else {
+            client_info->send_head = req;
+            client_info->send_tail = req;
+            uring_start_send(req);
+        }
         return;
     }
-
-    // 로그 파일에 메시지 기록
-    fprintf(log_file, "%s\n", message);
-    fclose(log_file);
-
-    // 뮤텍스 잠금 해제
-    pthread_mutex_unlock(&log_mutex);
+#endif
+    client_enqueue(client_info, batch->message, batch->kick);
 }
 
 /**
- * @brief 클라이언트와의 통신을 처리하는 스레드 함수
- * @param arg 클라이언트 정보를 담고 있는 스마트 포인터 구조체의 포인터
- * @return void* 스레드 종료 시 반환값 (NULL)
+ * @brief 팬아웃 묶음을 제출하고 정리하는 함수
+ * @param batch 팬아웃 묶음
+ * @return void
  */
-void *client_handler(void *arg) {
-    SmartPtr *sp = (SmartPtr *)arg;
-    ClientInfo *client_info = (ClientInfo *)sp->ptr;
-    char buffer[BUFFER_SIZE];
-    int nbytes;
-
-    // 사용자명 수신
-    memset(buffer, 0, sizeof(buffer));
-    nbytes = read(client_info->client_fd, buffer, BUFFER_SIZE);
-    if (nbytes <= 0) {
-        printf("사용자명 수신 실패 또는 클라이언트 연결 종료\n");
-        close(client_info->client_fd);
-        release(sp);
-        return NULL;
+void fanout_end(FanoutBatch *batch) {
+#ifdef USE_IO_URING
+    if (batch->use_uring) {
+        uring_submit(&uring_backend.ring);  // 방 전체 팬아웃을 한 번의 io_uring_enter 로 제출
+        pthread_mutex_unlock(&uring_backend.lock);
     }
-    strncpy(client_info->username, buffer, BUFFER_SIZE);
-    printf("사용자명: %s\n", client_info->username);
-
-    // 채팅방 선택 수신
-    memset(buffer, 0, sizeof(buffer));
-    nbytes = read(client_info->client_fd, buffer, BUFFER_SIZE);
-    if (nbytes <= 0) {
-        printf("채팅방 수신 실패 또는 클라이언트 연결 종료\n");
-        close(client_info->client_fd);
-
-        // 클라이언트 종료 시 뮤텍스 제거
-        printf("클라이언트 %d 연결 종료에 따른 뮤텍스 파괴", client_info->client_id);
-        pthread_mutex_destroy(client_info -> client_mutex);
-        free(client_info -> client_mutex);
-        printf("뮤텍스 파괴 완료. 클라이언트 아이디 : [ %d ] -> destroyed\n", client_info->client_id);
+#endif
+    release(&batch->message);  // 남은 참조는 아직 전송 중인 요청들이 보유
+}
 
-        if(client_info->room_id != 0) {
-            printf("클라이언트 %d가 채팅방 %d에서 퇴장했습니다.\n", client_info->client_id, client_info->room_id);
-        } else {
-            printf("클라이언트 %d 연결 종료\n", client_info->client_id);
-        }
+/**
+ * @brief 리스닝 소켓을 생성하는 함수
+ * @param port 리스닝 포트
+ * @param reuseport SO_REUSEPORT 사용 여부
+ * @return int 리스닝 소켓, 실패 시 -1
+ */
+int open_listen_socket(int port, int reuseport) {
+    int ssock;
+    struct sockaddr_in servaddr;
 
-        release(sp);
-        return NULL;
+    if ((ssock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+        perror("socket()");
+        return -1;
     }
-    
-    client_info->room_id = atoi(buffer);
-    printf("클라이언트 %d가 채팅방 %d에 입장했습니다.\n", client_info->client_id, client_info->room_id);
 
-    // 메시지 처리
-    while ((nbytes = read(client_info->client_fd, buffer, BUFFER_SIZE)) > 0) {
-        buffer[nbytes] = '\0';
-        printf("클라이언트 %d (%s) 메시지: %s\n", client_info->client_id, client_info->username, buffer);
-        broadcast_message(client_info->client_fd, buffer, client_info->room_id);
+    int enable = 1;
+    if (setsockopt(ssock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int)) < 0) {
+        perror("setsockopt(SO_REUSEADDR) failed");
+        close(ssock);
+        return -1;
+    }
+    if (reuseport && setsockopt(ssock, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int)) < 0) {
+        perror("setsockopt(SO_REUSEPORT) failed");
+        close(ssock);
+        return -1;
     }
 
-    printf("클라이언트 %d 연결 종료\n", client_info->client_id);
+    memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family = AF_INET;
+    servaddr.sin_addr.s_addr = htons(INADDR_ANY);
+    servaddr.sin_port = htons(port);
 
-    // 뮤텍스 파괴 및 참조 감소 확인
-    printf("클라이언트 %d 연결 종료. 뮤텍스 파괴 중...\n", client_info->client_id);
-    pthread_mutex_destroy(client_info -> client_mutex);
-    free(client_info -> client_mutex);
-    printf("뮤텍스 파괴 완료. 클라이언트 아이디 : [ %d ] -> destroyed\n", client_info->client_id);
+    if (bind(ssock, (struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
+        perror("bind()");
+        close(ssock);
+        return -1;
+    }
 
-    close(client_info->client_fd);
-    release(sp);  // 스마트 포인터 해제
-    return NULL;
+    if (listen(ssock, LISTEN_BACKLOG) < 0) {
+        perror("listen()");
+        close(ssock);
+        return -1;
+    }
+    return ssock;
 }
+
 /**
- * @brief TCP 서버를 생성하고 클라이언트 연결을 처리하는 함수
- * @param num_tcp_proc 생성할 TCP 프로세스 수
- * @param ... 서버의 IP 주소와 포트를 인자로 받습니다.
- * @return int 성공 시 0, 실패 시 -1 반환
+ * @brief 샤드의 리스닝 소켓에 쌓인 연결을 모두 수락해 디스패처 epoll 에 등록하는 함수 (thread 모드)
+ * @param shard 이벤트가 발생한 리스닝 샤드
+ * @return void
  */
-int create_network_tcp_process(int num_tcp_proc, ...) {
-    va_list args;
-    va_start(args, num_tcp_proc);
+static void shard_accept(Shard *shard) {
+    while (1) {
+        struct sockaddr_in cliaddr;
+        socklen_t clen = sizeof(cliaddr);
+        int csock = accept4(shard->listen_fd, (struct sockaddr *)&cliaddr, &clen, SOCK_NONBLOCK);
+        if (csock < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("accept4()");
+            }
+            return;
+        }
 
-    for (int i = 0; i < num_tcp_proc; i++) {
-        int ssock, client_count = 1;
-        socklen_t clen;
-        struct sockaddr_in servaddr, cliaddr;
-        char buffer[BUFFER_SIZE];
-        char client_ip[INET_ADDRSTRLEN];
+        SharedPtr *sp = register_client(csock, &cliaddr, shard);
+        if (sp == NULL) {
+            continue;
+        }
+        ClientInfo *client_info = (ClientInfo *)sp->ptr;
+        struct epoll_event ev = {
+            .events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+            .data.u64 = client_info->handle
+        };
+        if (epoll_ctl(shard->epoll_fd, EPOLL_CTL_ADD, csock, &ev) < 0) {
+            perror("epoll_ctl(ADD client)");
+            close_client(sp);
+        }
+    }
+}
 
-        const char *ip_address = va_arg(args, const char*);
-        int port = va_arg(args, int);
+/**
+ * @brief 샤드의 연결 이벤트를 워커 풀에 작업으로 넘기는 디스패처 스레드 함수 (thread 모드)
+ *
+ * 스레드를 만들지 않고 준비된 연결만 워커 풀로 넘깁니다. 같은 연결은 늘 같은 워커(클라이언트 ID 로
+ * 고름)의 큐로 보내 캐시를 재사용하고, 그 워커가 바쁘면 쉬는 워커가 훔쳐 갑니다.
+ *
+ * @param arg Shard 구조체 포인터
+ * @return void* 스레드 종료 시 반환값 (NULL)
+ */
+static void *shard_dispatch_thread(void *arg) {
+    Shard *shard = (Shard *)arg;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
 
-        if ((ssock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-            perror("socket()");
-            return -1;
+    while (1) {
+        int n = epoll_wait(shard->epoll_fd, events, MAX_EPOLL_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait()");
+            break;
         }
 
-        int enable = 1;
-        if (setsockopt(ssock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int)) < 0) {
-            perror("setsockopt(SO_REUSEADDR) failed");
-            return -1;
+        // 작업이 연결을 닫아도 읽기 구역이 끝날 때까지 ClientInfo 는 해제되지 않음
+        epoch_enter(&client_epoch);
+        for (int i = 0; i < n; i++) {
+            uint64_t data = events[i].data.u64;
+            if (data & EPOLL_LISTEN_TAG) {
+                shard_accept(shard);
+                continue;
+            }
+            SharedPtr *sp = (SharedPtr *)conn_table_get(&client_table, data);
+            if (sp == NULL) {
+                continue;
+            }
+            ClientInfo *client_info = (ClientInfo *)sp->ptr;
+            if (atomic_fetch_add(&client_info->pool_events, 1) == 0 &&
+                thread_pool_submit(&client_workers, (unsigned)client_info->client_id, client_service,
+                                   (void *)(uintptr_t)data) < 0) {
+                // 실행 중인 작업이 없으므로 여기서 닫음. pool_events 가 0 이 아니어서 더 제출되지도 않음
+                perror("Failed to queue client");
+                epoll_ctl(shard->epoll_fd, EPOLL_CTL_DEL, client_info->client_fd, NULL);
+                close_client(sp);
+            }
         }
+        epoch_exit(&client_epoch);
+    }
+    return NULL;
+}
 
-        memset(&servaddr, 0, sizeof(servaddr));
-        servaddr.sin_family = AF_INET;
-        servaddr.sin_addr.s_addr = htons(INADDR_ANY);
-        servaddr.sin_port = htons(port);
-
-        if (bind(ssock, (struct sockaddr *)&servaddr, sizeof(servaddr)) < 0) {
-            perror("bind()");
+/**
+ * @brief 워커 풀과 샤드마다 디스패처 스레드를 띄워 연결을 처리하는 함수 (thread 모드)
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int run_accept_threads(void) {
+    if (thread_pool_start(&client_workers, server_config.event_loops, (size_t)server_config.worker_stack_kb * 1024,
+                          server_config.pin_workers) < 0) {
+        perror("Failed to start worker pool");
+        return -1;
+    }
+    for (int i = 0; i < num_shards; i++) {
+        shards[i].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EPOLL_LISTEN_TAG | (uint64_t)i };
+        if (shards[i].epoll_fd < 0 || set_nonblocking(shards[i].listen_fd) < 0 ||
+            epoll_ctl(shards[i].epoll_fd, EPOLL_CTL_ADD, shards[i].listen_fd, &ev) < 0) {
+            perror("epoll(dispatch)");
             return -1;
         }
-
-        if (listen(ssock, 8) < 0) {
-            perror("listen()");
+        if (pthread_create(&shards[i].tid, NULL, shard_dispatch_thread, &shards[i]) != 0) {
+            perror("pthread_create(dispatch)");
             return -1;
-        } else {
-            printf("서버가 포트 %d에서 듣고 있습니다.\n", port);
         }
+    }
+    printf("워커 %d개(스택 %dKB%s)로 클라이언트를 처리합니다.\n", client_workers.count,
+           (int)(client_workers.stack_size / 1024), server_config.pin_workers ? ", CPU 고정" : "");
+    for (int i = 0; i < num_shards; i++) {
+        pthread_join(shards[i].tid, NULL);
+    }
+    return 0;
+}
 
-        printf("서버가 클라이언트의 연결을 기다립니다...\n");
-
-        pthread_t tid;
-        pthread_create(&tid, NULL, server_input_handler, NULL); // 서버 입력 처리 스레드 생성
-
-        while (1) {
-            clen = sizeof(cliaddr);
-            int csock = accept(ssock, (struct sockaddr *)&cliaddr, &clen);
-            if (csock > 0) {
-                inet_ntop(AF_INET, &cliaddr.sin_addr, client_ip, INET_ADDRSTRLEN);
-                printf("[ 클라이언트 %d가 연결되었습니다. IP: %s ]\n", client_count, client_ip);
+/**
+ * @brief 열 수 있는 파일 디스크립터 수(soft limit)를 hard limit 까지 올리는 함수
+ *
+ * 기본 soft limit(보통 1024)로는 대량 동시 접속을 받을 수 없으므로 시작 시 한 번 올립니다.
+ *
+ * @return void
+ */
+static void raise_fd_limit(void) {
+    struct rlimit rl;
 
-                pthread_mutex_t *client_mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t));
-                pthread_mutex_init(client_mutex, NULL);
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0) {
+        perror("getrlimit(RLIMIT_NOFILE)");
+        return;
+    }
+    if (rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &rl) < 0) {
+            perror("setrlimit(RLIMIT_NOFILE)");
+            return;
+        }
+    }
+    printf("최대 파일 디스크립터 수: %llu\n", (unsigned long long)rl.rlim_cur);
+}
 
-                ClientInfo *client_info = (ClientInfo *)malloc(sizeof(ClientInfo));
-                client_info->client_fd = csock;
-                client_info->client_id = client_count++;
-                client_info->client_mutex = client_mutex;
+/**
+ * @brief TCP 서버를 생성하고 클라이언트 연결을 처리하는 함수
+ *
+ * 가변 인자로 받은 (IP, 포트) 쌍마다 server_config.shards 개의 리스닝 샤드를 열고,
+ * 선택한 I/O 방식으로 모든 샤드를 동시에 처리합니다.
+ *
+ * @param num_tcp_proc (IP, 포트) 쌍의 수
+ * @param ... 서버의 IP 주소와 포트를 인자로 받습니다.
+ * @return int 성공 시 0, 실패 시 -1 반환
+ */
+int create_network_tcp_process(int num_tcp_proc, ...) {
+    va_list args;
+    int per_port = server_config.shards;
+    int ret;
+
+    raise_fd_limit();
+    log_index_init(&log_index, CHAT_LOG_PATH_FORMAT);
+    if (chatlog_open(&chat_log, CHAT_LOG_PATH_FORMAT, server_config.log_sync) < 0) {
+        perror("Failed to start chat logger");
+        return -1;
+    }
+    chatlog_set_flush_hook(&chat_log, log_index_on_flush, &log_index);
+    if (pool_init_aligned(&client_pool, "client", sizeof(ClientInfo), _Alignof(ClientInfo), NULL) < 0 ||
+        pool_init(&mutex_pool, "mutex", sizeof(pthread_mutex_t), mutex_pool_init) < 0 ||
+        pool_init(&message_pool, "message", MESSAGE_POOL_OBJECT_SIZE, NULL) < 0
+#ifdef USE_IO_URING
+        || pool_init(&send_pool, "uring_send", sizeof(UringSend), NULL) < 0
+#endif
+        ) {
+        perror("Failed to initialize object pools");
+        return -1;
+    }
+    if (intern_init(&usernames) < 0 || user_map_init(&user_map, &usernames) < 0 ||
+        session_table_init(&sessions, &usernames) < 0) {
+        perror("Failed to allocate username table");
+        return -1;
+    }
+    // 로그인 확인은 서버의 사용자 데이터베이스로만 함 (클라이언트는 사용자 파일을 읽지 않음)
+    init_user_db(&user_db);
+    if (user_store_open(&user_store, &user_db, server_config.user_data_path) < 0) {
+        perror("Failed to open user store");
+        return -1;
+    }
+    printf("가입한 사용자 %zu명을 불러왔습니다.\n", user_db.user_count);
+    if (conn_table_init(&client_table, sizeof(SharedPtr)) < 0 || epoch_domain_init(&client_epoch) < 0 ||
+        room_registry_init(&room_registry, &client_epoch) < 0 || epoch_start_reclaimer(&client_epoch) < 0 ||
+        room_registry_start_sweeper(&room_registry, server_config.room_idle_grace * 1000LL) < 0) {
+        perror("Failed to allocate connection table");
+        return -1;
+    }
+    if (presence_open(&presence, PRESENCE_SHM_NAME) < 0 || presence_start_heartbeat(&presence) < 0) {
+        perror("Failed to open presence table (host-wide duplicate login check disabled)");
+    }
 
-                // 클라이언트 정보를 스마트 포인터로 관리
-                client_infos[csock] = create_smart_ptr(client_info);
+    num_shards = num_tcp_proc * per_port;
+    shards = (Shard *)calloc(num_shards, sizeof(Shard));
+    if (shards == NULL) {
+        perror("Failed to allocate shards");
+        return -1;
+    }
 
-                // 클라이언트 스레드 생성
-                pthread_create(&tid, NULL, client_handler, (void *)&client_infos[csock]);
+    va_start(args, num_tcp_proc);
+    for (int i = 0; i < num_tcp_proc; i++) {
+        const char *ip_address = va_arg(args, const char*);
+        int port = va_arg(args, int);
 
-                printf("mutex %d called\n", client_info->client_id);
-                
-                // 추가: 클라이언트 종료 시 뮤텍스 제거
-                pthread_detach(tid);  // 스레드 분리
+        for (int j = 0; j < per_port; j++) {
+            Shard *shard = &shards[i * per_port + j];
+            shard->index = i * per_port + j;
+            shard->port = port;
+            shard->listen_fd = open_listen_socket(port, per_port > 1);
+            if (shard->listen_fd < 0) {
+                va_end(args);
+                return -1;
             }
         }
+        printf("서버가 포트 %d에서 듣고 있습니다. (리스닝 샤드 %d개)\n", port, per_port);
+    }
+    va_end(args);
+
+    printf("서버가 클라이언트의 연결을 기다립니다...\n");
+
+    pthread_t tid;
+    pthread_create(&tid, NULL, server_input_handler, NULL); // 서버 입력 처리 스레드 생성
+    pthread_create(&tid, NULL, kick_reaper_thread, NULL);   // 강제 퇴장 기한 회수 스레드 생성
 
-        close(ssock);  // 소켓 닫기
+    if (server_config.io_mode == IO_MODE_URING) {
+        ret = run_uring_backend();
+    } else if (server_config.io_mode == IO_MODE_EPOLL || server_config.io_mode == IO_MODE_ROOM) {
+        ret = run_event_loops();
+    } else {
+        ret = run_accept_threads();
     }
 
-    va_end(args);
-    return 0;
+    for (int i = 0; i < num_shards; i++) {
+        close(shards[i].listen_fd);  // 소켓 닫기
+    }
+    return ret;
 }
 
 /**
@@ -602,13 +3362,16 @@ void *server_input_handler(void *arg) {
     print_fixed_menu();  // 메뉴 출력
 
     while (1) {
-        // 표준 입력으로부터 메시지 입력받기
-        fgets(buffer, BUFFER_SIZE, stdin);
+        // 표준 입력으로부터 메시지 입력받기 (데몬 모드에서는 stdin 이 닫혀 있음)
+        if (fgets(buffer, BUFFER_SIZE, stdin) == NULL) {
+            break;
+        }
         buffer[strcspn(buffer, "\n")] = '\0';  // 개행 문자 제거
 
         // 종료 명령어 처리
         if (strcmp(buffer, "exit") == 0 || strcmp(buffer, "...") == 0) {
             printf("채팅을 종료합니다.\n");
+            chatlog_close(&chat_log);  // 남은 로그를 모두 기록
             exit(0);
         }
 
@@ -616,6 +3379,16 @@ void *server_input_handler(void *arg) {
         if (strcmp(buffer, "list") == 0) {
             list_users();
         }
+
+        // stats 명령어 처리
+        if (strcmp(buffer, "stats") == 0) {
+            print_fanout_stats();
+            print_log_stats();
+            print_pool_stats();
+            if (server_config.io_mode == IO_MODE_THREAD) {
+                print_worker_stats();
+            }
+        }
         
         // kill 명령어 처리
         if (strncmp(buffer, "kill ", 5) == 0) {
@@ -625,23 +3398,13 @@ void *server_input_handler(void *arg) {
         
         // kill room 명령어 처리
         if (strncmp(buffer, "kill room ", 10) == 0) {
-            int room_id = atoi(buffer + 10);
-            kill_room(room_id);
+            kill_room(buffer + 10);
         }
 
-        // grep -r 명령어 처리
+        // grep -r 명령어 처리 (색인 검색, 예: grep -r "good morning" alice -d 20240901:20240930)
         if (strncmp(buffer, "grep -r", 7) == 0) {
-            char command[BUFFER_SIZE + 100];
-            char log_filename[50];
-            time_t now = time(NULL);
-            struct tm *t = localtime(&now);
-
-            // 로그 파일명에 날짜 붙이기
-            strftime(log_filename, sizeof(log_filename), "/var/log/chatlog_%Y%m%d.log", t);
-
-            // grep 명령어에 로그 파일 경로 포함
-            snprintf(command, sizeof(command), "%s %s", buffer, log_filename);
-            system(command);  // 로그 파일에서 grep 명령 실행
+            log_index_search(&log_index, buffer + 7, stdout);
+            continue;
         }
 
         if (strlen(buffer) > 0) {
@@ -657,16 +3420,37 @@ void *server_input_handler(void *arg) {
  * @return void
  */
 void send_server_message(char *message) {
-    char server_message[BUFFER_SIZE + 50];
-    snprintf(server_message, sizeof(server_message), "[서버]: %s", message);
-    log_chat_message(server_message);
+    SmartPtr server_message = message_create(FRAME_MESSAGE, "[서버]: %s", message);
+    log_chat_message(message_payload((Message *)server_message.ptr));
+
+    // room 모드에서는 워커마다 자기 방의 멤버에게 보냄
+    if (room_affinity()) {
+        for (int i = 0; i < num_event_loops; i++) {
+            retain(&server_message);
+            mailbox_post(&event_loops[i], MAIL_ANNOUNCE, CONN_HANDLE_INVALID, 0, server_message);
+        }
+        release(&server_message);
+        return;
+    }
 
-    // 채팅방에 있는 클라이언트들에게 메시지 전송
-    for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_infos[i].ptr != NULL) {
-            write(i, server_message, strlen(server_message));
+    // room 모드와 같게 채팅방 멤버에게만 보냄 (방 목록은 레지스트리 읽기 잠금, 멤버 배열은 읽기 구역 안에서 읽음)
+    FanoutBatch batch;
+    epoch_enter(&client_epoch);
+    room_registry_rdlock(&room_registry);
+    fanout_begin(&batch, server_message);
+    for (uint32_t r = 0; r < room_registry.room_count; r++) {
+        RoomMembers *members = room_members(room_registry.rooms[r]);
+        uint32_t count = room_members_count(members);
+        for (uint32_t i = 0; i < count; i++) {
+            ClientInfo *client_info = (ClientInfo *)room_member_at(members, i);
+            if (client_info != NULL) {
+                fanout_add(&batch, client_info);
+            }
         }
-    }   
+    }
+    fanout_end(&batch);
+    room_registry_unlock(&room_registry);
+    epoch_exit(&client_epoch);
 }
 
 /**
@@ -715,10 +3499,13 @@ void daemonize() {
         exit(EXIT_FAILURE);
     }
 
-    // stdin, stdout, stderr 닫기
-    close(STDIN_FILENO);
-    close(STDOUT_FILENO);
-    close(STDERR_FILENO);
+    // stdin 은 /dev/null 로 돌림. 0~2 번을 닫아 두면 클라이언트 소켓이 그 번호를 받아
+    // stdout 으로 찍은 로그가 클라이언트에게 전송되어 프레임 스트림이 깨짐
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        close(null_fd);
+    }
 }
 
 void logo() {
@@ -772,15 +3559,151 @@ void manual_server_mode() {
     create_network_tcp_process(1, "127.0.0.1", DEFAULT_TCP_PORT);
 }
 
+/**
+ * @brief 명령행 사용법 출력 함수
+ * @param prog 프로그램 이름
+ * @return void
+ */
+void print_usage(const char *prog) {
+    printf("사용법: %s [-m epoll|uring|thread|room] [-n 이벤트루프수] [-s 샤드수] [-q 대기열상한] [-p 정책] [-f 로그동기화] [-r 빈방유예초] [-u 사용자파일] [-t 스택KB] [-a]\n", prog);
+    printf("  -m  I/O 처리 방식 (기본값: epoll, uring 은 io_uring 백엔드, thread 는 고정 크기 워커 풀 방식,\n");
+    printf("      room 은 방마다 CPU 에 고정된 소유 워커 하나가 팬아웃을 전담하는 방식)\n");
+    printf("  -n  epoll 이벤트 루프(room 워커, thread 워커 풀) 스레드 수 (기본값: CPU 수, epoll 샤딩 시 샤드당 1개)\n");
+    printf("  -s  SO_REUSEPORT 리스닝 샤드 수 (기본값: 1)\n");
+    printf("  -q  클라이언트 송신 대기열 상한, 메시지 수 (기본값: %d)\n", OUTBOX_LIMIT);
+    printf("  -p  상한 도달 시 정책: drop-oldest(기본값) | drop-newest | disconnect\n");
+    printf("  -f  채팅 로그 fsync 정책: none(기본값) | interval:<밀리초> | records:<레코드수>\n");
+    printf("  -r  마지막 멤버가 나간 채팅방을 회수하기까지 유예 시간, 초 (기본값: %d)\n", ROOM_IDLE_GRACE_MS / 1000);
+    printf("  -u  사용자 데이터베이스 파일 (기본값: 시작한 디렉터리의 %s)\n", USER_DATA_FILE);
+    printf("  -t  thread 모드 워커 스레드 스택 크기, KB (기본값: %d)\n", THREAD_POOL_DEFAULT_STACK / 1024);
+    printf("  -a  thread 모드 워커를 CPU 하나씩에 고정\n");
+}
+
+/**
+ * @brief 명령행 옵션을 해석하여 server_config 를 채우는 함수
+ * @param argc 인수 개수
+ * @param argv 인수 배열
+ * @return int 성공 시 0, 실패 시 -1
+ */
+int parse_server_options(int argc, char *argv[]) {
+    const char *user_data_file = USER_DATA_FILE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:s:q:p:f:r:u:t:ah")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (strcmp(optarg, "epoll") == 0) {
+                server_config.io_mode = IO_MODE_EPOLL;
+            } else if (strcmp(optarg, "uring") == 0) {
+                server_config.io_mode = IO_MODE_URING;
+            } else if (strcmp(optarg, "thread") == 0) {
+                server_config.io_mode = IO_MODE_THREAD;
+            } else if (strcmp(optarg, "room") == 0) {
+                server_config.io_mode = IO_MODE_ROOM;
+            } else {
+                printf("알 수 없는 I/O 방식입니다: %s\n", optarg);
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'n':
+            server_config.event_loops = atoi(optarg);
+            if (server_config.event_loops <= 0) {
+                printf("이벤트 루프 수는 1 이상이어야 합니다.\n");
+                return -1;
+            }
+            break;
+        case 's':
+            server_config.shards = atoi(optarg);
+            if (server_config.shards <= 0) {
+                printf("샤드 수는 1 이상이어야 합니다.\n");
+                return -1;
+            }
+            break;
+        case 'q':
+            server_config.outbox_limit = atoi(optarg);
+            if (server_config.outbox_limit <= 0) {
+                printf("송신 대기열 상한은 1 이상이어야 합니다.\n");
+                return -1;
+            }
+            break;
+        case 'p':
+            if (strcmp(optarg, "drop-oldest") == 0) {
+                server_config.slow_policy = SLOW_POLICY_DROP_OLDEST;
+            } else if (strcmp(optarg, "drop-newest") == 0) {
+                server_config.slow_policy = SLOW_POLICY_DROP_NEWEST;
+            } else if (strcmp(optarg, "disconnect") == 0) {
+                server_config.slow_policy = SLOW_POLICY_DISCONNECT;
+            } else {
+                printf("알 수 없는 정책입니다: %s\n", optarg);
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'f':
+            if (chatlog_parse_sync(optarg, &server_config.log_sync) < 0) {
+                printf("알 수 없는 로그 동기화 정책입니다: %s\n", optarg);
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'r':
+            server_config.room_idle_grace = atoi(optarg);
+            if (server_config.room_idle_grace < 0 || (server_config.room_idle_grace == 0 && strcmp(optarg, "0") != 0)) {
+                printf("채팅방 유예 시간은 0 이상의 초여야 합니다.\n");
+                return -1;
+            }
+            break;
+        case 'u':
+            user_data_file = optarg;
+            break;
+        case 't':
+            server_config.worker_stack_kb = atoi(optarg);
+            if (server_config.worker_stack_kb <= 0) {
+                printf("워커 스택 크기는 1KB 이상이어야 합니다.\n");
+                return -1;
+            }
+            break;
+        case 'a':
+            server_config.pin_workers = 1;
+            break;
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (server_config.event_loops <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        server_config.event_loops = cpus > 0 ? (int)cpus : 1;
+    }
+
+    // daemonize() 가 "/" 로 이동하기 전에 사용자 파일 경로를 절대 경로로 바꿔 둠
+    char cwd[PATH_MAX];
+    if (user_data_file[0] == '/' || getcwd(cwd, sizeof(cwd)) == NULL) {
+        snprintf(server_config.user_data_path, sizeof(server_config.user_data_path), "%s", user_data_file);
+    } else if (snprintf(server_config.user_data_path, sizeof(server_config.user_data_path), "%s/%s", cwd,
+                        user_data_file) >= (int)sizeof(server_config.user_data_path)) {
+        printf("사용자 파일 경로가 너무 깁니다: %s\n", user_data_file);
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief main 함수
- * @param void
+ * @param argc 인수 개수
+ * @param argv 인수 배열
  * @return int
  */
-int main()
+int main(int argc, char *argv[])
 {
     char yn = '\0'; // 문자를 저장할 변수
 
+    if (parse_server_options(argc, argv) < 0) {
+        return -1;
+    }
+
     // 스크립트를 통해 바로 시작을 하고 싶으면
     auto_daemon_mode();
 
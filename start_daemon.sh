@@ -3,6 +3,8 @@
 
 SERVER_PATH="/home/ubuntu/Desktop/workspace/exam_chat_mutex_server/save"
 LOG_FILE="/home/ubuntu/Desktop/workspace/exam_chat_mutex_server/save/chatlog_$(date +'%Y%m%d').log"
+# 서버 실행 옵션 (예: "-m epoll -n 4", 기존 스레드 방식은 "-m thread")
+SERVER_OPTS=""
 
 start() {
     # SERVER_PATH 확인
@@ -20,7 +22,7 @@ start() {
 
     echo "Starting chat server..."
     # nohup으로 백그라운드 실행 시 stdin을 /dev/null로 연결하여 입력 대기 없앰
-    nohup $SERVER_PATH/chat_server > $LOG_FILE 2>&1 < /dev/null &
+    nohup $SERVER_PATH/chat_server $SERVER_OPTS > $LOG_FILE 2>&1 < /dev/null &
     echo "Chat server started. Log is being written to $LOG_FILE"
 }
 